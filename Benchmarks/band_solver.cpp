@@ -0,0 +1,204 @@
+#include <cmath>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "bench_util.h"
+
+#include "band_diagonal_factorized.h"
+#include "band_diagonal_matrix.h"
+#include "derivatives.h"
+#include "grid.h"
+#include "matrix_equation_solver.h"
+
+
+// Scaling of band-diagonal matrix equation solvers with system order.
+// Theta-scheme left-hand-side, identity - 0.5 * dt * d2dx2, with boundary
+// rows eliminated beforehand. Nominal memory traffic per node: The
+// diagonals are read and the column is read and written once.
+template <class T>
+T lhs_matrix(const int order, T (*derivative)(const std::vector<double>&)) {
+
+	const std::vector<double> grid = grid::uniform(0.0, 1.0, order);
+
+	T matrix = derivative(grid);
+	matrix *= -0.5 * 1.0e-4;
+	matrix += matrix.identity();
+
+	std::vector<double> column(order, 0.0);
+	matrix.adjust_boundary(column);
+
+	return matrix;
+
+}
+
+
+std::vector<double> rhs_column(const int order) {
+
+	std::vector<double> column(order, 0.0);
+	for (int i = 0; i != order; ++i) {
+		column[i] = std::sin(0.001 * i);
+	}
+
+	return column;
+
+}
+
+
+void BM_Tri_Thomas(benchmark::State& state) {
+
+	const int order = (int)state.range(0);
+	const TriDiagonal matrix = lhs_matrix<TriDiagonal>(order, d2dx2::uniform::c2b1);
+	const std::vector<double> rhs = rhs_column(order);
+
+	std::vector<double> column(order, 0.0);
+	std::vector<double> vec_tmp(order, 0.0);
+
+	for (auto _ : state) {
+		column = rhs;
+		tridiagonal_matrix_solver(matrix.matrix[0], matrix.matrix[1], matrix.matrix[2], column, vec_tmp);
+		benchmark::DoNotOptimize(column.data());
+	}
+
+	set_throughput(state, order, 8.0 * (matrix.matrix.size() + 2));
+
+}
+
+
+void BM_Penta_Sequential(benchmark::State& state) {
+
+	const int order = (int)state.range(0);
+	const PentaDiagonal matrix = lhs_matrix<PentaDiagonal>(order, d2dx2::uniform::c4b0);
+	const std::vector<double> rhs = rhs_column(order);
+
+	std::vector<double> column(order, 0.0);
+	std::vector<double> sub_tmp(order, 0.0);
+	std::vector<double> main_tmp(order, 0.0);
+	std::vector<double> super_tmp(order, 0.0);
+	std::vector<double> vec_tmp(order, 0.0);
+
+	for (auto _ : state) {
+		column = rhs;
+		pentadiagonal_matrix_solver(
+			matrix.matrix[0], matrix.matrix[1], matrix.matrix[2], matrix.matrix[3], matrix.matrix[4], 
+			column, sub_tmp, main_tmp, super_tmp, vec_tmp);
+		benchmark::DoNotOptimize(column.data());
+	}
+
+	set_throughput(state, order, 8.0 * (matrix.matrix.size() + 2));
+
+}
+
+
+template <class T>
+void BM_CyclicReduction(benchmark::State& state, T (*derivative)(const std::vector<double>&)) {
+
+	const int order = (int)state.range(0);
+	const T matrix = lhs_matrix<T>(order, derivative);
+	const std::vector<double> rhs = rhs_column(order);
+
+	std::vector<double> column(order, 0.0);
+
+	for (auto _ : state) {
+		column = rhs;
+		cyclic_reduction_matrix_solver(matrix.matrix, column);
+		benchmark::DoNotOptimize(column.data());
+	}
+
+	set_throughput(state, order, 8.0 * (matrix.matrix.size() + 2));
+
+}
+
+
+// Partition solver; range(1): Number of partitions (threads).
+template <class T>
+void BM_Partition(benchmark::State& state, T (*derivative)(const std::vector<double>&)) {
+
+	const int order = (int)state.range(0);
+	const int n_partitions = (int)state.range(1);
+	const T matrix = lhs_matrix<T>(order, derivative);
+	const std::vector<double> rhs = rhs_column(order);
+
+	std::vector<double> column(order, 0.0);
+
+	for (auto _ : state) {
+		column = rhs;
+		partition_matrix_solver(matrix.matrix, column, n_partitions);
+		benchmark::DoNotOptimize(column.data());
+	}
+
+	set_throughput(state, order, 8.0 * (matrix.matrix.size() + 2));
+
+}
+
+
+// Factorized matrix, double precision.
+template <class T>
+void BM_Factorized(benchmark::State& state, T (*derivative)(const std::vector<double>&)) {
+
+	const int order = (int)state.range(0);
+	const T matrix = lhs_matrix<T>(order, derivative);
+	const std::vector<double> rhs = rhs_column(order);
+
+	const FactorizedBandDiagonal factorized(matrix);
+
+	std::vector<double> column(order, 0.0);
+
+	for (auto _ : state) {
+		column = rhs;
+		factorized.solve(column);
+		benchmark::DoNotOptimize(column.data());
+	}
+
+	set_throughput(state, order, 8.0 * (matrix.matrix.size() + 2));
+
+}
+
+
+// Factorized matrix, single precision; range(1): Number of refinement steps.
+template <class T>
+void BM_MixedPrecision(benchmark::State& state, T (*derivative)(const std::vector<double>&)) {
+
+	const int order = (int)state.range(0);
+	const T matrix = lhs_matrix<T>(order, derivative);
+	const std::vector<double> rhs = rhs_column(order);
+
+	const MixedPrecisionBandDiagonal factorized(matrix, (int)state.range(1));
+
+	std::vector<double> column(order, 0.0);
+
+	for (auto _ : state) {
+		column = rhs;
+		factorized.solve(column);
+		benchmark::DoNotOptimize(column.data());
+	}
+
+	set_throughput(state, order, 8.0 * (matrix.matrix.size() + 2));
+
+}
+
+
+BENCHMARK(BM_Tri_Thomas)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_Penta_Sequential)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+
+BENCHMARK_CAPTURE(BM_CyclicReduction, Tri, d2dx2::uniform::c2b1)
+	->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK_CAPTURE(BM_CyclicReduction, Penta, d2dx2::uniform::c4b0)
+	->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+
+BENCHMARK_CAPTURE(BM_Partition, Tri, d2dx2::uniform::c2b1)
+	->ArgsProduct({ benchmark::CreateRange(1 << 13, 1 << 22, 8), { 1, 2, 4, 8 } })
+	->UseRealTime();
+BENCHMARK_CAPTURE(BM_Partition, Penta, d2dx2::uniform::c4b0)
+	->ArgsProduct({ benchmark::CreateRange(1 << 13, 1 << 22, 8), { 1, 2, 4, 8 } })
+	->UseRealTime();
+
+BENCHMARK_CAPTURE(BM_Factorized, Tri, d2dx2::uniform::c2b1)
+	->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK_CAPTURE(BM_Factorized, Penta, d2dx2::uniform::c4b0)
+	->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+
+BENCHMARK_CAPTURE(BM_MixedPrecision, Tri, d2dx2::uniform::c2b1)
+	->ArgsProduct({ benchmark::CreateRange(1 << 10, 1 << 22, 8), { 0, 1, 2 } });
+BENCHMARK_CAPTURE(BM_MixedPrecision, Penta, d2dx2::uniform::c4b0)
+	->ArgsProduct({ benchmark::CreateRange(1 << 10, 1 << 22, 8), { 0, 1, 2 } });
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+
+// Throughput counters, reported per iteration of the benchmark loop.
+//	- ns_per_node: Wall time per grid node (inverted rate).
+//	- GB_per_s: Nominal memory traffic, bytes of the operators and functions
+//	  read and written once per node. Caches are not modelled.
+// Items and bytes processed are set as well, see compare.py.
+inline void set_throughput(
+	benchmark::State& state,
+	const double n_nodes,
+	const double bytes_per_node) {
+
+	state.SetItemsProcessed((int64_t)(state.iterations() * n_nodes));
+	state.SetBytesProcessed((int64_t)(state.iterations() * n_nodes * bytes_per_node));
+
+	state.counters["ns_per_node"] = benchmark::Counter(
+		1.0e-9 * n_nodes,
+		benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+	state.counters["GB_per_s"] = benchmark::Counter(
+		1.0e-9 * n_nodes * bytes_per_node,
+		benchmark::Counter::kIsIterationInvariantRate);
+
+}
+
+
+// Smooth test function on N-dimensional grid, order (x1, x2, ..., xN).
+inline std::vector<double> test_function(const int n_nodes) {
+
+	std::vector<double> func(n_nodes, 0.0);
+	for (int i = 0; i != n_nodes; ++i) {
+		func[i] = std::sin(0.001 * i) + 1.0;
+	}
+
+	return func;
+
+}
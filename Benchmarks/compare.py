@@ -0,0 +1,96 @@
+"""Compare two Google Benchmark JSON outputs and flag regressions.
+
+Usage:
+    ./build/Benchmarks/bench --benchmark_out=base.json --benchmark_out_format=json
+    ./build/Benchmarks/bench --benchmark_out=new.json --benchmark_out_format=json
+    python3 Benchmarks/compare.py base.json new.json --threshold 0.05
+
+A benchmark is a regression if its ns/node (or real time per iteration, if
+the benchmark does not report throughput) increases by more than the
+threshold. With repetitions, the median aggregate is compared. The exit code
+is 1 if any benchmark regressed.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(file_name):
+    """Map benchmark name to (ns/node, GB/s) of a benchmark JSON file."""
+    with open(file_name) as file:
+        data = json.load(file)
+
+    runs = {}
+    medians = {}
+    for entry in data["benchmarks"]:
+        name = entry.get("run_name", entry["name"])
+        if entry.get("run_type") == "aggregate":
+            if entry.get("aggregate_name") == "median":
+                medians[name] = entry
+        else:
+            runs.setdefault(name, entry)
+
+    results = {}
+    for name, entry in runs.items():
+        entry = medians.get(name, entry)
+        if "ns_per_node" in entry:
+            time = entry["ns_per_node"]
+        else:
+            time = to_ns(entry["real_time"], entry["time_unit"])
+        results[name] = (time, entry.get("GB_per_s", 0.0))
+
+    return data.get("context", {}), results
+
+
+def to_ns(time, unit):
+    return time * {"ns": 1.0, "us": 1.0e3, "ms": 1.0e6, "s": 1.0e9}[unit]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline", help="Benchmark JSON of the reference build.")
+    parser.add_argument("contender", help="Benchmark JSON of the new build.")
+    parser.add_argument("--threshold", type=float, default=0.05,
+                        help="Relative slowdown flagged as regression (default 0.05).")
+    args = parser.parse_args()
+
+    context_base, base = load(args.baseline)
+    context_new, new = load(args.contender)
+
+    for key in ("host_name", "num_cpus", "mhz_per_cpu"):
+        if context_base.get(key) != context_new.get(key):
+            print("Warning: {} differs ({} vs {})".format(
+                key, context_base.get(key), context_new.get(key)))
+
+    print("{:<60} {:>12} {:>12} {:>9} {:>9}".format(
+        "Benchmark", "ns/node old", "ns/node new", "change", "GB/s new"))
+
+    regressions = []
+    for name in sorted(set(base) & set(new)):
+        time_base, _ = base[name]
+        time_new, bandwidth_new = new[name]
+        change = time_new / time_base - 1.0 if time_base > 0.0 else 0.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions.append(name)
+        elif change < -args.threshold:
+            flag = "  improvement"
+        print("{:<60} {:>12.4g} {:>12.4g} {:>+8.1%} {:>9.3g}{}".format(
+            name, time_base, time_new, change, bandwidth_new, flag))
+
+    for name in sorted(set(base) ^ set(new)):
+        print("{:<60} only in {}".format(
+            name, args.baseline if name in base else args.contender))
+
+    if regressions:
+        print("\n{} regression(s) above {:.1%}.".format(len(regressions), args.threshold))
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "bench_util.h"
+
+#include "band_diagonal_matrix.h"
+#include "derivatives.h"
+#include "grid.h"
+#include "sparse_matrix.h"
+#include "utility.h"
+#include "workspace.h"
+
+
+// Microbenchmarks of finite difference operators.
+
+
+// Band-diagonal matrix-vector product, including boundary rows.
+// Nominal memory traffic per node: The diagonals and the vector are read
+// and the result is written once.
+template <class T>
+void BM_MatrixMultiplyVector(benchmark::State& state, T (*derivative)(const std::vector<double>&)) {
+
+	const int order = (int)state.range(0);
+	const T matrix = derivative(grid::uniform(0.0, 1.0, order));
+	const std::vector<double> vector = test_function(order);
+
+	std::vector<double> result(order, 0.0);
+
+	for (auto _ : state) {
+		std::fill(result.begin(), result.end(), 0.0);
+		matrix_multiply_vector<T>(matrix, vector, result);
+		benchmark::DoNotOptimize(result.data());
+	}
+
+	set_throughput(state, order, 8.0 * (matrix.matrix.size() + 2));
+
+}
+
+
+// Operator along one dimension of a 2-dimensional grid, n x n points.
+// range(1): filter (1: strips along x, 2: strips along y), see action_2d.
+// range(2): 0: matrix-vector product, 1: matrix equation solve.
+// Nominal memory traffic per node: The function is read and the result is
+// written once, each strip is gathered and scattered, and the diagonals
+// are read once per strip.
+template <class T>
+void BM_Action2D(benchmark::State& state, T (*derivative)(const std::vector<double>&)) {
+
+	const int n_points = (int)state.range(0);
+	const int filter = (int)state.range(1);
+	const bool solve_equation = state.range(2) == 1;
+
+	T matrix = derivative(grid::uniform(0.0, 1.0, n_points));
+	matrix *= -0.5 * 1.0e-4;
+	matrix += matrix.identity();
+
+	const std::vector<double> func = test_function(n_points * n_points);
+	std::vector<double> result(func.size(), 0.0);
+
+	Workspace workspace;
+
+	for (auto _ : state) {
+		action_2d(n_points, n_points, filter, solve_equation, matrix, func, result, workspace);
+		benchmark::DoNotOptimize(result.data());
+	}
+
+	set_throughput(state, (double)n_points * n_points, 8.0 * (matrix.matrix.size() + 4));
+
+}
+
+
+// Assembled generator on 2-dimensional grid, n x n points, including the
+// mixed derivative term, see sparse::generator.
+// range(1): 0: CSR, 1: SELL-C-sigma.
+// Nominal memory traffic per node: The stored elements (value and column
+// index, including padding) are read once, as are the vector and the row
+// pointers (CSR), and the result is written once.
+void BM_SpMV(benchmark::State& state) {
+
+	const int n_points = (int)state.range(0);
+	const bool sell_format = state.range(1) == 1;
+
+	const std::vector<double> grid = grid::uniform(0.0, 1.0, n_points);
+
+	std::vector<TriDiagonal> derivatives{ d2dx2::uniform::c2b1(grid), d2dx2::uniform::c2b1(grid) };
+	derivatives[0] += d1dx1::uniform::c2b1(grid);
+
+	const std::vector<MixedDerivative<TriDiagonal, TriDiagonal>> mixed{
+		MixedDerivative<TriDiagonal, TriDiagonal>(d1dx1::uniform::c2b1(grid), d1dx1::uniform::c2b1(grid)) };
+
+	const SparseMatrix csr = sparse::generator({ n_points, n_points }, derivatives, mixed);
+	const SlicedEllpack sell(csr);
+
+	const std::vector<double> vector = test_function(csr.n_rows());
+	std::vector<double> result(csr.n_rows(), 0.0);
+
+	for (auto _ : state) {
+		if (sell_format) {
+			sell.multiply(vector, result);
+		}
+		else {
+			csr.multiply(vector, result);
+		}
+		benchmark::DoNotOptimize(result.data());
+	}
+
+	const double n_nodes = (double)n_points * n_points;
+	const double bytes = sell_format ? 12.0 * sell.n_elements() : 12.0 * csr.n_nonzeros() + 4.0 * n_nodes;
+	set_throughput(state, n_nodes, bytes / n_nodes + 16.0);
+
+}
+
+
+BENCHMARK_CAPTURE(BM_MatrixMultiplyVector, Tri, d2dx2::uniform::c2b1)
+	->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK_CAPTURE(BM_MatrixMultiplyVector, Penta, d2dx2::uniform::c4b0)
+	->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+
+BENCHMARK_CAPTURE(BM_Action2D, Tri, d2dx2::uniform::c2b1)
+	->ArgsProduct({ { 64, 256, 1024 }, { 1, 2 }, { 0, 1 } });
+BENCHMARK_CAPTURE(BM_Action2D, Penta, d2dx2::uniform::c4b0)
+	->ArgsProduct({ { 64, 256, 1024 }, { 1, 2 }, { 0, 1 } });
+
+BENCHMARK(BM_SpMV)
+	->ArgsProduct({ { 64, 256, 1024 }, { 0, 1 } });
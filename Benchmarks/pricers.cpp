@@ -0,0 +1,419 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "bench_util.h"
+
+#include "BlackScholesUtility.h"
+#include "HestonUtility.h"
+#include "SabrUtility.h"
+#include "VasicekUtility.h"
+#include "band_diagonal_matrix.h"
+#include "curve.h"
+#include "derivatives.h"
+#include "grid.h"
+#include "instrument.h"
+#include "local_vol.h"
+#include "lsm.h"
+#include "portfolio.h"
+#include "propagation.h"
+#include "scheduler.h"
+
+
+// Macrobenchmarks of full pricings. For PDE pricers a node is a point of
+// the space-time grid; for closed-form pricers a node is one price.
+
+
+// European call, Black-Scholes PDE propagated by the theta scheme on 100
+// time steps. range(0): Number of spatial grid points.
+void BM_BlackScholesPDE(benchmark::State& state) {
+
+	const int n_points = (int)state.range(0);
+	const int n_steps = 100;
+
+	const std::vector<double> time_grid = grid::uniform(0.0, 1.0, n_steps + 1);
+	const std::vector<double> spatial_grid = grid::uniform(0.0, 400.0, n_points);
+
+	const std::vector<std::function<TriDiagonal(std::vector<double>)>>
+		deriv{ d1dx1::uniform::c2b2, d2dx2::uniform::c2b1 };
+
+	for (auto _ : state) {
+
+		TriDiagonal derivative =
+			bs::pde::generator::derivative_full<TriDiagonal>(0.03, 0.2, spatial_grid, deriv);
+
+		std::vector<double> func(n_points, 0.0);
+		for (int i = 0; i != n_points; ++i) {
+			func[i] = bs::call::payoff(spatial_grid[i], 100.0);
+		}
+
+		propagation::theta_1d::full(time_grid, derivative, func);
+
+		benchmark::DoNotOptimize(func.data());
+
+	}
+
+	set_throughput(state, (double)n_points * n_steps, 2 * 8.0 * (3 + 2));
+
+}
+
+
+// Batch of 64 European calls with different rates, volatilities and strikes.
+void BM_BlackScholesBatch(benchmark::State& state) {
+
+	const int n_points = (int)state.range(0);
+	const int n_steps = 100;
+	const int n_problems = 64;
+
+	const std::vector<double> time_grid = grid::uniform(0.0, 1.0, n_steps + 1);
+	const std::vector<double> spatial_grid = grid::uniform(0.0, 400.0, n_points);
+
+	const std::vector<std::function<TriDiagonal(std::vector<double>)>>
+		deriv{ d1dx1::uniform::c2b2, d2dx2::uniform::c2b1 };
+
+	std::vector<bs::pde::Parameters> parameters;
+	for (int i = 0; i != n_problems; ++i) {
+		const double strike = 80.0 + 0.5 * i;
+		parameters.push_back({ 0.01 + 0.0005 * i, 0.15 + 0.002 * i,
+			[strike](const double spot) { return bs::call::payoff(spot, strike); } });
+	}
+
+	for (auto _ : state) {
+		std::vector<std::vector<double>> func =
+			bs::pde::batch<TriDiagonal>(time_grid, spatial_grid, parameters, deriv);
+		benchmark::DoNotOptimize(func.data());
+	}
+
+	set_throughput(state, (double)n_points * n_steps * n_problems, 2 * 8.0 * (3 + 2));
+
+}
+
+
+// Strip of 32 Heston calls, closed form.
+void BM_HestonClosedForm(benchmark::State& state) {
+
+	const int n_strikes = 32;
+
+	for (auto _ : state) {
+		for (int i = 0; i != n_strikes; ++i) {
+			const double strike = 70.0 + 2.0 * i;
+			benchmark::DoNotOptimize(
+				heston::call(100.0, 0.04, 0.03, 1.5, 0.04, 0.3, -0.7, strike, 1.0));
+		}
+	}
+
+	set_throughput(state, n_strikes, 0.0);
+
+}
+
+
+// European call, Heston PDE on an n_s x n_s / 2 grid with 50 time steps.
+// range(1): Scheme, 0: DR, 1: CS, 2: MCS, 3: HV.
+void BM_HestonPDE(benchmark::State& state) {
+
+	const int n_s = (int)state.range(0);
+	const int n_v = n_s / 2;
+	const int n_steps = 50;
+	const std::string scheme =
+		std::vector<std::string>{ "DR", "CS", "MCS", "HV" }[state.range(1)];
+
+	const std::vector<double> time_grid = grid::uniform(0.0, 1.0, n_steps + 1);
+
+	const std::vector<std::vector<double>> spatial_grid =
+		heston::pde::generator::grid(800.0, n_s, 100.0, 5.0, n_v, 0.04, 0.1, 0.01);
+
+	auto payoff = [](const double price) {
+		return std::max(price - 100.0, 0.0);
+	};
+
+	for (auto _ : state) {
+		std::vector<double> func = heston::pde::solve(
+			time_grid, spatial_grid, 0.03, 1.5, 0.04, 0.3, -0.7, payoff, scheme);
+		benchmark::DoNotOptimize(func.data());
+	}
+
+	set_throughput(state, (double)n_s * n_v * n_steps, 8 * 8.0 * (3 + 2));
+
+}
+
+
+// Smile of 64 SABR implied volatilities, Hagan's expansion.
+void BM_SabrSmile(benchmark::State& state) {
+
+	const int n_strikes = 64;
+
+	for (auto _ : state) {
+		for (int i = 0; i != n_strikes; ++i) {
+			const double strike = 0.01 + 0.001 * i;
+			benchmark::DoNotOptimize(
+				sabr::implied_vol::black_scholes(0.04, 0.2, 0.4, 0.5, -0.3, strike, 1.0));
+		}
+	}
+
+	set_throughput(state, n_strikes, 0.0);
+
+}
+
+
+// Heterogeneous portfolio: 408 Black-Scholes and 32 Heston closed form
+// trades, 64 Black-Scholes PDEs on two grids and 8 Heston PDEs of different
+// size, in trade order. range(0): 0 longest first, 1 static partitioning.
+// A node is a trade.
+void BM_Portfolio(benchmark::State& state) {
+
+	std::vector<portfolio::Trade> trades;
+	for (int i = 0; i != 512; ++i) {
+
+		portfolio::Trade t;
+		t.strike = 80.0 + 0.1 * i;
+		t.rate = 0.03;
+		t.lambda = 2.0;
+		t.eta = 0.3;
+		t.rho = -0.7;
+
+		if (i % 64 == 0) {
+			t.kind = portfolio::Kind::heston_pde;
+			t.n_points_s = 64 + 8 * (i / 64);
+			t.n_points_v = 32;
+			t.n_steps = 50;
+		}
+		else if (i % 8 == 1) {
+			t.kind = portfolio::Kind::bs_pde;
+			t.n_points_s = i % 16 == 1 ? 401 : 801;
+		}
+		else if (i % 16 == 2) {
+			t.kind = portfolio::Kind::heston_closed_form;
+		}
+
+		trades.push_back(t);
+
+	}
+
+	portfolio::Options options;
+	options.schedule = state.range(0) == 0
+		? portfolio::Schedule::longest_first : portfolio::Schedule::static_partition;
+
+	tasks::Scheduler scheduler;
+	portfolio::Statistics statistics;
+
+	double imbalance = 0.0;
+	double tail_time = 0.0;
+
+	for (auto _ : state) {
+		std::vector<double> prices = portfolio::price(trades, scheduler, statistics, options);
+		benchmark::DoNotOptimize(prices.data());
+		imbalance += statistics.imbalance;
+		tail_time += statistics.tail_time;
+	}
+
+	set_throughput(state, (double)trades.size(), 0.0);
+
+	state.counters["imbalance"] = imbalance / state.iterations();
+	state.counters["tail_ms"] = 1.0e3 * tail_time / state.iterations();
+	state.counters["threads"] = scheduler.n_threads();
+
+}
+
+
+// Ladder of 40 annual coupon bonds (1 to 40 years) sharing Vasicek
+// parameters. range(0): 0 PDE rollback (201 grid points, dt_max = 0.01),
+// 1 trinomial tree (4000 steps), 2 BondRollback with time-invariant work
+// done once (repricing). A node is a bond.
+void BM_VasicekLadder(benchmark::State& state) {
+
+	const double rate = 0.03;
+	const double kappa = 0.5;
+	const double theta = 0.04;
+	const double sigma = 0.01;
+
+	std::vector<vasicek::Claim> claims;
+	for (int maturity = 1; maturity <= 40; ++maturity) {
+		vasicek::Claim bond;
+		for (int i = 1; i <= maturity; ++i) {
+			bond.times.push_back((double)i);
+			bond.cash_flows.push_back(0.04);
+		}
+		bond.cash_flows.back() += 1.0;
+		claims.push_back(bond);
+	}
+
+	std::vector<Bond> bonds;
+	for (const vasicek::Claim& claim : claims) {
+		std::vector<double> event_grid{ 0.0 };
+		std::vector<double> cash_flows{ 0.0 };
+		event_grid.insert(event_grid.end(), claim.times.begin(), claim.times.end());
+		cash_flows.insert(cash_flows.end(), claim.cash_flows.begin(), claim.cash_flows.end());
+		bonds.push_back(Bond(event_grid, cash_flows));
+	}
+	BondRollback rollback(bonds,
+		vasicek::pde::generator::grid(rate, kappa, theta, sigma, 40.0, 201));
+
+	for (auto _ : state) {
+		std::vector<double> prices;
+		if (state.range(0) == 2) {
+			rollback.solve(kappa, theta, sigma);
+			prices.push_back(rollback.bond(0).price(rate, 0));
+		}
+		else if (state.range(0) == 0) {
+			prices = vasicek::pde::price(claims, rate, kappa, theta, sigma);
+		}
+		else {
+			const vasicek::tree::Tree tree = vasicek::tree::build(kappa, sigma, 40.0, 4000,
+				[=](const double t) { return vasicek::zcb::price(rate, 0.0, t, kappa, theta, sigma); });
+			prices = vasicek::tree::price(tree, claims);
+		}
+		benchmark::DoNotOptimize(prices.data());
+	}
+
+	set_throughput(state, (double)claims.size(), 0.0);
+
+}
+
+
+// Discount factors of 4096 sorted times on a 30-node monotone convex
+// curve. range(0): 0 batch evaluation, 1 one call per time (interval
+// search). A node is a discount factor.
+void BM_CurveDiscount(benchmark::State& state) {
+
+	std::vector<double> node_times;
+	std::vector<double> node_rates;
+	for (int i = 1; i <= 30; ++i) {
+		node_times.push_back((double)i);
+		node_rates.push_back(0.03 + 0.01 * std::sin(0.3 * i));
+	}
+	const curve::ZeroCurve curve(node_times, node_rates, curve::Interpolation::monotone_convex);
+
+	const std::vector<double> times = grid::uniform(0.0, 30.0, 4096);
+
+	for (auto _ : state) {
+		std::vector<double> df;
+		if (state.range(0) == 0) {
+			df = curve.df(times);
+		}
+		else {
+			df.resize(times.size());
+			for (int k = 0; k != times.size(); ++k) {
+				df[k] = curve.df(times[k]);
+			}
+		}
+		benchmark::DoNotOptimize(df.data());
+	}
+
+	set_throughput(state, (double)times.size(), 2.0 * sizeof(double));
+
+}
+
+
+// European call under SABR local volatility on 100 time steps; the local
+// variance table has 26 rows on the PDE spot grid. range(0): Number of
+// spatial grid points. Surface construction is not timed.
+void BM_LocalVolPDE(benchmark::State& state) {
+
+	const int n_points = (int)state.range(0);
+	const int n_steps = 100;
+
+	const std::vector<double> time_grid = grid::uniform(0.0, 1.0, n_steps + 1);
+	const std::vector<double> spatial_grid = grid::uniform(0.0, 400.0, n_points);
+
+	const std::vector<std::function<TriDiagonal(std::vector<double>)>>
+		deriv{ d1dx1::uniform::c2b2, d2dx2::uniform::c2b1 };
+
+	const curve::ZeroCurve curve({ 1.0 }, { 0.03 });
+	const local_vol::Surface surface = local_vol::dupire(
+		local_vol::sabr(100.0, curve, 2.0, 0.4, 0.5, -0.3),
+		100.0, curve, grid::uniform(0.0, 1.0, 26), spatial_grid);
+
+	for (auto _ : state) {
+
+		std::vector<double> func = local_vol::pde::solve<TriDiagonal>(
+			time_grid, spatial_grid, surface, curve,
+			[](const double s) { return bs::call::payoff(s, 100.0); }, deriv);
+
+		benchmark::DoNotOptimize(func.data());
+
+	}
+
+	// Solution, two variance rows and two operators of 3 diagonals.
+	set_throughput(state, (double)n_points * n_steps, 8.0 * (2 + 2 + 2 * 3));
+
+}
+
+
+// Discretely monitored double knock-out put (weekly monitoring) on 104
+// time steps, grid aligned with strike and barriers, smoothed payoff.
+// range(0): Number of spatial grid points.
+void BM_BarrierPDE(benchmark::State& state) {
+
+	const int n_points = (int)state.range(0);
+
+	bs::barrier::Option option;
+	option.type = bs::barrier::Type::double_out;
+	option.call = false;
+	option.strike = 105.0;
+	option.lower = 80.0;
+	option.upper = 120.0;
+	for (int i = 1; i <= 52; ++i) {
+		option.monitoring.push_back(i / 52.0);
+	}
+
+	const std::vector<double> time_grid = bs::barrier::pde::time_grid(option, 104);
+	const std::vector<double> spatial_grid = bs::barrier::pde::grid(option, 100.0, 400.0, n_points);
+
+	const std::vector<std::function<TriDiagonal(std::vector<double>)>>
+		deriv{ d1dx1::nonuniform::c2b2, d2dx2::nonuniform::c2b1 };
+
+	for (auto _ : state) {
+
+		std::vector<double> func = bs::barrier::pde::solve<TriDiagonal>(
+			time_grid, spatial_grid, option, 0.03, 0.25, deriv);
+
+		benchmark::DoNotOptimize(func.data());
+
+	}
+
+	set_throughput(state, (double)n_points * ((int)time_grid.size() - 1), 2 * 8.0 * (3 + 2));
+
+}
+
+
+// Least-squares Monte Carlo Bermudan max-call on two assets, 9 exercise
+// dates, 2^16 paths (simulated once), degree-3 Laguerre basis.
+// range(0): Number of threads accumulating the Gram matrix.
+void BM_LsmMaxCall(benchmark::State& state) {
+
+	const int n_paths = 1 << 16;
+	const std::vector<double> times = grid::uniform(0.0, 3.0, 10);
+
+	const lsm::Paths paths = lsm::simulate(
+		{ 100.0, 100.0 }, 0.05, { 0.1, 0.1 }, { 0.2, 0.2 }, {}, times, n_paths);
+
+	lsm::Options options;
+	options.n_threads = (int)state.range(0);
+
+	for (auto _ : state) {
+		double price = lsm::price(paths, 0.05, lsm::max_call(100.0), options);
+		benchmark::DoNotOptimize(price);
+	}
+
+	// Regressors and cash flows per path and exercise date.
+	set_throughput(state, (double)n_paths * (times.size() - 2), 8.0 * (2 + 3));
+
+}
+
+
+BENCHMARK(BM_BlackScholesPDE)->RangeMultiplier(4)->Range(1 << 8, 1 << 14);
+BENCHMARK(BM_BlackScholesBatch)->RangeMultiplier(4)->Range(1 << 8, 1 << 12);
+BENCHMARK(BM_HestonClosedForm);
+BENCHMARK(BM_HestonPDE)->ArgsProduct({ { 64, 128, 256 }, { 0, 1, 2, 3 } })
+	->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SabrSmile);
+BENCHMARK(BM_Portfolio)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_VasicekLadder)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CurveDiscount)->Arg(0)->Arg(1);
+BENCHMARK(BM_LocalVolPDE)->RangeMultiplier(4)->Range(1 << 8, 1 << 14);
+BENCHMARK(BM_BarrierPDE)->RangeMultiplier(4)->Range(1 << 6, 1 << 12);
+BENCHMARK(BM_LsmMaxCall)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
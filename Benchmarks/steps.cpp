@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "bench_util.h"
+
+#include "band_diagonal_batch.h"
+#include "band_diagonal_matrix.h"
+#include "derivatives.h"
+#include "fused_operator.h"
+#include "grid.h"
+#include "HestonUtility.h"
+#include "propagator.h"
+#include "workspace.h"
+
+
+// Mesobenchmarks of single time steps. Nominal memory traffic per node:
+// 8 bytes times (diagonals + 2) for each operator application (matrix-vector
+// product, matrix equation solve or mixed derivative) of the step.
+
+
+// Theta scheme, 1-dimensional. The operators are assembled in each step.
+template <class T>
+void BM_Theta1D(benchmark::State& state, T (*derivative)(const std::vector<double>&)) {
+
+	const int order = (int)state.range(0);
+	T matrix = derivative(grid::uniform(0.0, 1.0, order));
+	const T identity = matrix.identity();
+
+	std::vector<double> func = test_function(order);
+
+	for (auto _ : state) {
+		propagator::theta_1d::full(1.0e-4, identity, matrix, func);
+		benchmark::DoNotOptimize(func.data());
+	}
+
+	set_throughput(state, order, 2 * 8.0 * (matrix.matrix.size() + 2));
+
+}
+
+
+// Theta scheme, batch of 8 interleaved 1-dimensional problems with
+// pre-factorized operators.
+void BM_ThetaBatch(benchmark::State& state) {
+
+	const int order = (int)state.range(0);
+	const int width = 8;
+
+	std::vector<TriDiagonal> derivatives(
+		width, d2dx2::uniform::c2b1(grid::uniform(0.0, 1.0, order)));
+	const TriDiagonal identity = derivatives[0].identity();
+
+	const BatchTriDiagonal rhs = propagator::batch::rhs(1.0e-4, identity, derivatives, 0, width);
+	const BatchTriDiagonal lhs = propagator::batch::lhs(1.0e-4, identity, derivatives, 0, width);
+
+	std::vector<double> func = test_function(order * width);
+	std::vector<double> func_tmp(func.size(), 0.0);
+
+	for (auto _ : state) {
+		propagator::batch::theta_1d(rhs, lhs, func, func_tmp);
+		benchmark::DoNotOptimize(func.data());
+	}
+
+	set_throughput(state, (double)order * width, 2 * 8.0 * (3 + 2));
+
+}
+
+
+// Heston operators on an n_s x n_s / 2 grid.
+struct HestonOperators {
+
+	int n_s;
+	int n_v;
+
+	std::vector<double> grid_s;
+	std::vector<double> grid_v;
+
+	std::vector<TriDiagonal> derivatives_s;
+	std::vector<TriDiagonal> derivatives_v;
+
+	FusedOperator<TriDiagonal> operator_s;
+	FusedOperator<TriDiagonal> operator_v;
+
+	MixedDerivative<TriDiagonal, TriDiagonal> mixed;
+
+	HestonOperators(const int n_points) :
+		n_s(n_points),
+		n_v(n_points / 2),
+		grid_s(grid::hyperbolic_full(0.0, 400.0, n_s, 100.0, 0.1)),
+		grid_v(grid::hyperbolic_full(0.0, 2.0, n_v, 0.04, 0.05)),
+		derivatives_s(heston::pde::generator::derivatives_s(grid_s)),
+		derivatives_v(heston::pde::generator::derivatives_v(grid_v, 1.5, 0.04, 0.3)),
+		operator_s(n_s, n_v, 1,
+			heston::pde::generator::prefactor_s(0.03, { grid_s, grid_v }), derivatives_s),
+		operator_v(n_v, n_s, 2,
+			heston::pde::generator::prefactor_v(0.03, 1.5, 0.04, 0.3, { grid_s, grid_v }), derivatives_v),
+		mixed(derivatives_s[1], derivatives_v[1]) {
+
+		std::vector<double> coef_s = grid_s;
+		for (int i = 0; i != n_s; ++i) {
+			coef_s[i] *= -0.7 * 0.3;
+		}
+		mixed.set_prefactors(coef_s, grid_v);
+
+	}
+
+	std::vector<double> payoff() const {
+
+		std::vector<double> func(n_s * n_v, 0.0);
+		for (int j = 0; j != n_v; ++j) {
+			for (int i = 0; i != n_s; ++i) {
+				func[i + n_s * j] = std::max(grid_s[i] - 100.0, 0.0);
+			}
+		}
+
+		return func;
+
+	}
+
+};
+
+
+// Douglas-Rachford step, pre-assembled operators.
+void BM_DR2D(benchmark::State& state) {
+
+	HestonOperators problem((int)state.range(0));
+
+	std::vector<double> func = problem.payoff();
+
+	Workspace workspace;
+
+	for (auto _ : state) {
+		propagator::adi::dr_2d(1.0e-3, problem.operator_s, problem.operator_v, func, workspace);
+		benchmark::DoNotOptimize(func.data());
+	}
+
+	set_throughput(state, (double)func.size(), 4 * 8.0 * (3 + 2));
+
+}
+
+
+// Craig-Sneyd step, pre-assembled operators.
+void BM_CS2D(benchmark::State& state) {
+
+	HestonOperators problem((int)state.range(0));
+
+	std::vector<double> func = problem.payoff();
+
+	Workspace workspace;
+
+	for (auto _ : state) {
+		propagator::adi::cs_2d(
+			1.0e-3, problem.operator_s, problem.operator_v, problem.mixed, func, workspace);
+		benchmark::DoNotOptimize(func.data());
+	}
+
+	set_throughput(state, (double)func.size(), 8 * 8.0 * (3 + 2));
+
+}
+
+
+BENCHMARK_CAPTURE(BM_Theta1D, Tri, d2dx2::uniform::c2b1)
+	->RangeMultiplier(8)->Range(1 << 10, 1 << 19);
+BENCHMARK_CAPTURE(BM_Theta1D, Penta, d2dx2::uniform::c4b0)
+	->RangeMultiplier(8)->Range(1 << 10, 1 << 19);
+
+BENCHMARK(BM_ThetaBatch)->RangeMultiplier(8)->Range(1 << 7, 1 << 16);
+
+BENCHMARK(BM_DR2D)->RangeMultiplier(2)->Range(64, 1024);
+BENCHMARK(BM_CS2D)->RangeMultiplier(2)->Range(64, 1024);
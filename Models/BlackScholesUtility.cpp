@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <utility>
 
 #include "BlackScholesUtility.h"
 #include "distributions.h"
@@ -122,6 +124,18 @@ double bs::call::price(
 }
 
 
+double bs::call::price(
+	const double spot_price,
+	const curve::ZeroCurve& curve,
+	const double sigma,
+	const double strike,
+	const double tau) {
+
+	return bs::call::price(spot_price, curve.zero(tau), sigma, strike, tau);
+
+}
+
+
 // European call option delta.
 double bs::call::delta(
 	const double spot_price,
@@ -212,7 +226,7 @@ double bs::call::implied_vol(
 	double sigma_2 = 0.2;
 
 	// Newton-Raphson root-search method.
-	while (abs(sigma_2 - sigma_1) > 1.0e-8) {
+	while (std::abs(sigma_2 - sigma_1) > 1.0e-8) {
 
 		sigma_1 = sigma_2;
 
@@ -245,6 +259,18 @@ double bs::put::price(
 }
 
 
+double bs::put::price(
+	const double spot_price,
+	const curve::ZeroCurve& curve,
+	const double sigma,
+	const double strike,
+	const double tau) {
+
+	return bs::put::price(spot_price, curve.zero(tau), sigma, strike, tau);
+
+}
+
+
 // European put option delta.
 double bs::put::delta(
 	const double spot_price,
@@ -329,7 +355,7 @@ double bs::put::implied_vol(
 	double sigma_2 = 0.5;
 
 	// Newton-Raphson root-search method.
-	while (abs(sigma_2 - sigma_1) > 1.0e-5) {
+	while (std::abs(sigma_2 - sigma_1) > 1.0e-5) {
 
 		sigma_1 = sigma_2;
 
@@ -343,3 +369,488 @@ double bs::put::implied_vol(
 	return sigma_2;
 
 }
+
+
+// Cash-or-nothing digital call option payoff.
+double bs::digital::call::payoff(
+	const double spot_price,
+	const double strike) {
+
+	return spot_price > strike ? 1.0 : 0.0;
+
+}
+
+
+// Cash-or-nothing digital call option price.
+double bs::digital::call::price(
+	const double spot_price,
+	const double rate,
+	const double sigma,
+	const double strike,
+	const double tau) {
+
+	if (tau > 1.0e-10) {
+		const double d_m = d_minus(spot_price, rate, sigma, strike, tau);
+		return std::exp(-rate * tau) * normal::cdf(d_m);
+	}
+	else {
+		return bs::digital::call::payoff(spot_price, strike);
+	}
+
+}
+
+
+std::function<std::vector<double>
+	(const double, const std::vector<std::vector<double>>&)>
+	bs::digital::call::solution_func(
+		const double rate,
+		const double sigma,
+		const double strike) {
+
+	return [rate, sigma, strike](
+		const double tau,
+		const std::vector<std::vector<double>>& spatial_grid) {
+			return bs::digital::call::solution_full(spatial_grid[0], rate, sigma, strike, tau);
+		};
+
+}
+
+
+std::vector<double> bs::digital::call::solution_full(
+	const std::vector<double>& spatial_grid,
+	const double rate,
+	const double sigma,
+	const double strike,
+	const double tau) {
+
+	std::vector<double> result(spatial_grid.size(), 0.0);
+
+	for (int i = 0; i != spatial_grid.size(); ++i) {
+		result[i] = bs::digital::call::price(spatial_grid[i], rate, sigma, strike, tau);
+	}
+
+	return result;
+
+}
+
+
+// Cash-or-nothing digital put option payoff.
+double bs::digital::put::payoff(
+	const double spot_price,
+	const double strike) {
+
+	return spot_price < strike ? 1.0 : 0.0;
+
+}
+
+
+// Cash-or-nothing digital put option price.
+double bs::digital::put::price(
+	const double spot_price,
+	const double rate,
+	const double sigma,
+	const double strike,
+	const double tau) {
+
+	if (tau > 1.0e-10) {
+		// Digital put-call parity.
+		return std::exp(-rate * tau)
+			- bs::digital::call::price(spot_price, rate, sigma, strike, tau);
+	}
+	else {
+		return bs::digital::put::payoff(spot_price, strike);
+	}
+
+}
+
+
+namespace {
+
+	const double infinity = std::numeric_limits<double>::infinity();
+
+	// Continuity correction of discrete monitoring (Broadie, Glasserman and Kou).
+	const double bgk_beta = 0.5826;
+
+	// Price of payoff of option restricted to lower < spot < upper at expiry,
+	// by call and digital call spreads.
+	double restricted(
+		const double spot_price,
+		const double rate,
+		const double sigma,
+		const bs::barrier::Option& option,
+		const double lower,
+		const double upper) {
+
+		const double tau = option.tau;
+		const double strike = option.strike;
+		const double discount = std::exp(-rate * tau);
+
+		auto call = [&](const double k) {
+			if (k == 0.0) {
+				return spot_price;
+			}
+			return k == infinity ? 0.0 : bs::call::price(spot_price, rate, sigma, k, tau);
+		};
+
+		auto put = [&](const double k) {
+			return k == 0.0 ? 0.0 : bs::put::price(spot_price, rate, sigma, k, tau);
+		};
+
+		auto digital_call = [&](const double k) {
+			if (k == 0.0) {
+				return discount;
+			}
+			return k == infinity ? 0.0 : bs::digital::call::price(spot_price, rate, sigma, k, tau);
+		};
+
+		auto digital_put = [&](const double k) {
+			return discount - digital_call(k);
+		};
+
+		if (option.call) {
+
+			const double lo = std::max(lower, strike);
+			if (lo >= upper) {
+				return 0.0;
+			}
+
+			if (option.digital) {
+				return digital_call(lo) - digital_call(upper);
+			}
+
+			// (s - K) * 1{lo < s < upper}
+			//	= (s - lo)^+ - (s - upper)^+ - (upper - lo) * 1{s > upper} + (lo - K) * 1{lo < s < upper}.
+			double result = call(lo) + (lo - strike) * (digital_call(lo) - digital_call(upper));
+			if (upper != infinity) {
+				result -= call(upper) + (upper - lo) * digital_call(upper);
+			}
+			return result;
+
+		}
+		else {
+
+			const double hi = std::min(upper, strike);
+			if (lower >= hi) {
+				return 0.0;
+			}
+
+			if (option.digital) {
+				return digital_call(lower) - digital_call(hi);
+			}
+
+			// (K - s) * 1{lower < s < hi}
+			//	= (hi - s)^+ - (lower - s)^+ - (hi - lower) * 1{s < lower} + (K - hi) * 1{lower < s < hi}.
+			return put(hi) - put(lower) - (hi - lower) * digital_put(lower)
+				+ (strike - hi) * (digital_put(hi) - digital_put(lower));
+
+		}
+
+	}
+
+	// Lower and upper end of cell of node i, see bs::barrier::pde::smooth.
+	std::pair<double, double> cell(
+		const std::vector<double>& grid,
+		const int i) {
+
+		const int n = (int)grid.size();
+
+		const double left = i == 0 ? grid[0] : 0.5 * (grid[i - 1] + grid[i]);
+		const double right = i == n - 1 ? grid[n - 1] : 0.5 * (grid[i] + grid[i + 1]);
+
+		return { left, right };
+
+	}
+
+}
+
+
+bool bs::barrier::has_lower(const Option& option) {
+
+	return option.type == Type::down_out || option.type == Type::down_in
+		|| option.type == Type::double_out || option.type == Type::double_in;
+
+}
+
+
+bool bs::barrier::has_upper(const Option& option) {
+
+	return option.type == Type::up_out || option.type == Type::up_in
+		|| option.type == Type::double_out || option.type == Type::double_in;
+
+}
+
+
+bool bs::barrier::knock_in(const Option& option) {
+
+	return option.type == Type::down_in || option.type == Type::up_in
+		|| option.type == Type::double_in;
+
+}
+
+
+bs::barrier::Option bs::barrier::knock_out(const Option& option) {
+
+	Option result = option;
+
+	if (option.type == Type::down_in) {
+		result.type = Type::down_out;
+	}
+	else if (option.type == Type::up_in) {
+		result.type = Type::up_out;
+	}
+	else if (option.type == Type::double_in) {
+		result.type = Type::double_out;
+	}
+
+	return result;
+
+}
+
+
+double bs::barrier::payoff(
+	const Option& option,
+	const double spot_price) {
+
+	if (option.digital) {
+		return option.call
+			? bs::digital::call::payoff(spot_price, option.strike)
+			: bs::digital::put::payoff(spot_price, option.strike);
+	}
+
+	return option.call
+		? bs::call::payoff(spot_price, option.strike)
+		: std::max(option.strike - spot_price, 0.0);
+
+}
+
+
+double bs::barrier::price(
+	const double spot_price,
+	const double rate,
+	const double sigma,
+	const Option& option) {
+
+	if (option.type == Type::none) {
+		return restricted(spot_price, rate, sigma, option, 0.0, infinity);
+	}
+
+	if (knock_in(option)) {
+		Option vanilla = option;
+		vanilla.type = Type::none;
+		return price(spot_price, rate, sigma, vanilla) - price(spot_price, rate, sigma, knock_out(option));
+	}
+
+	double lower = has_lower(option) ? option.lower : 0.0;
+	double upper = has_upper(option) ? option.upper : infinity;
+
+	if (!option.monitoring.empty()) {
+		const double dt = option.tau / (double)option.monitoring.size();
+		const double shift = std::exp(bgk_beta * sigma * std::sqrt(dt));
+		lower /= shift;
+		upper *= shift;
+	}
+
+	if (spot_price <= lower || spot_price >= upper) {
+		return 0.0;
+	}
+
+	if (option.tau <= 1.0e-10) {
+		return payoff(option, spot_price);
+	}
+
+	// Exponent of image prefactors, 2 * (r - sigma^2 / 2) / sigma^2.
+	const double k = 2.0 * rate / (sigma * sigma) - 1.0;
+
+	if (option.type == Type::down_out) {
+		return restricted(spot_price, rate, sigma, option, lower, upper)
+			- std::pow(lower / spot_price, k)
+			* restricted(lower * lower / spot_price, rate, sigma, option, lower, upper);
+	}
+
+	if (option.type == Type::up_out) {
+		return restricted(spot_price, rate, sigma, option, lower, upper)
+			- std::pow(upper / spot_price, k)
+			* restricted(upper * upper / spot_price, rate, sigma, option, lower, upper);
+	}
+
+	// Image series of double barrier, images shifted by (upper / lower)^(2 * n).
+	const double ratio = upper / lower;
+	const double reflection = std::pow(lower / spot_price, k);
+
+	auto term = [&](const int n) {
+		const double shift = std::pow(ratio, 2 * n);
+		return std::pow(ratio, n * k)
+			* (restricted(spot_price * shift, rate, sigma, option, lower, upper)
+				- reflection * restricted(lower * lower / spot_price * shift, rate, sigma, option, lower, upper));
+	};
+
+	double result = term(0);
+
+	for (int n = 1; n != 100; ++n) {
+		const double increment = term(n) + term(-n);
+		result += increment;
+		if (std::abs(increment) < 1.0e-14) {
+			break;
+		}
+	}
+
+	return result;
+
+}
+
+
+std::function<std::vector<double>
+	(const double, const std::vector<std::vector<double>>&)>
+	bs::barrier::solution_func(
+		const double rate,
+		const double sigma,
+		const Option& option) {
+
+	return [rate, sigma, option](
+		const double tau,
+		const std::vector<std::vector<double>>& spatial_grid) {
+			return bs::barrier::solution_full(spatial_grid[0], rate, sigma, option, tau);
+		};
+
+}
+
+
+std::vector<double> bs::barrier::solution_full(
+	const std::vector<double>& spatial_grid,
+	const double rate,
+	const double sigma,
+	const Option& option,
+	const double tau) {
+
+	Option option_tau = option;
+	option_tau.tau = tau;
+
+	std::vector<double> result(spatial_grid.size(), 0.0);
+
+	for (int i = 0; i != spatial_grid.size(); ++i) {
+		result[i] = bs::barrier::price(spatial_grid[i], rate, sigma, option_tau);
+	}
+
+	return result;
+
+}
+
+
+std::vector<double> bs::barrier::pde::grid(
+	const Option& option,
+	const double spot_price,
+	const double s_max,
+	const int n_points,
+	const double scaling) {
+
+	std::vector<double> aligned{ spot_price, option.strike };
+	if (has_lower(option)) {
+		aligned.push_back(option.lower);
+	}
+	if (has_upper(option)) {
+		aligned.push_back(option.upper);
+	}
+	std::sort(aligned.begin(), aligned.end());
+	aligned.erase(std::unique(aligned.begin(), aligned.end()), aligned.end());
+
+	::grid::Builder builder(0.0, s_max, 1.0);
+	builder.concentrate(spot_price, scaling).concentrate(option.strike, scaling);
+
+	for (const double x : aligned) {
+		builder.align(x);
+	}
+
+	return builder.build(n_points);
+
+}
+
+
+std::vector<double> bs::barrier::pde::time_grid(
+	const Option& option,
+	const int n_steps) {
+
+	std::vector<double> events{ 0.0, option.tau };
+	for (const double t : option.monitoring) {
+		events.push_back(option.tau - t);
+	}
+
+	return ::grid::with_events(events, option.tau / n_steps);
+
+}
+
+
+std::vector<double> bs::barrier::pde::smooth(
+	const std::function<double(double)>& payoff,
+	const std::vector<double>& spatial_grid,
+	const std::vector<double>& breaks) {
+
+	// 3-point Gauss-Legendre quadrature on [-1, 1].
+	const double nodes[3] = { -std::sqrt(0.6), 0.0, std::sqrt(0.6) };
+	const double weights[3] = { 5.0 / 9.0, 8.0 / 9.0, 5.0 / 9.0 };
+
+	std::vector<double> sorted = breaks;
+	std::sort(sorted.begin(), sorted.end());
+
+	std::vector<double> result(spatial_grid.size(), 0.0);
+	std::vector<double> points;
+
+	for (int i = 0; i != spatial_grid.size(); ++i) {
+
+		const std::pair<double, double> c = cell(spatial_grid, i);
+
+		if (c.second <= c.first) {
+			result[i] = payoff(spatial_grid[i]);
+			continue;
+		}
+
+		points.assign(1, c.first);
+		for (const double x : sorted) {
+			if (x > c.first && x < c.second) {
+				points.push_back(x);
+			}
+		}
+		points.push_back(c.second);
+
+		double integral = 0.0;
+		for (int k = 0; k != points.size() - 1; ++k) {
+			const double center = 0.5 * (points[k] + points[k + 1]);
+			const double half_width = 0.5 * (points[k + 1] - points[k]);
+			for (int q = 0; q != 3; ++q) {
+				integral += half_width * weights[q] * payoff(center + half_width * nodes[q]);
+			}
+		}
+
+		result[i] = integral / (c.second - c.first);
+
+	}
+
+	return result;
+
+}
+
+
+void bs::barrier::pde::project(
+	const Option& option,
+	const std::vector<double>& spatial_grid,
+	std::vector<double>& func) {
+
+	const double lower = has_lower(option) ? option.lower : -infinity;
+	const double upper = has_upper(option) ? option.upper : infinity;
+
+	for (int i = 0; i != spatial_grid.size(); ++i) {
+
+		const std::pair<double, double> c = cell(spatial_grid, i);
+
+		if (c.second <= c.first) {
+			if (spatial_grid[i] <= lower || spatial_grid[i] >= upper) {
+				func[i] = 0.0;
+			}
+			continue;
+		}
+
+		const double inside = std::min(c.second, upper) - std::max(c.first, lower);
+		func[i] *= std::max(inside, 0.0) / (c.second - c.first);
+
+	}
+
+}
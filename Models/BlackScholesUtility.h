@@ -3,6 +3,9 @@
 #include <functional>
 #include <vector>
 
+#include "curve.h"
+#include "propagation.h"
+
 
 namespace bs {
 
@@ -22,6 +25,13 @@ namespace bs {
 
 	namespace pde {
 
+		// Parameters of a Black-Scholes PDE, one element per problem in a batch.
+		struct Parameters {
+			double rate;
+			double sigma;
+			std::function<double(double)> payoff;
+		};
+
 		namespace generator {
 
 			std::vector<std::vector<double>> prefactor(
@@ -64,6 +74,129 @@ namespace bs {
 
 			}
 
+			// Derivative operators of a batch of problems. The finite difference
+			// matrices are set up once and shared by all problems.
+			template <class T>
+			std::vector<T> derivative_batch(
+				const std::vector<Parameters>& parameters,
+				const std::vector<double>& spatial_grid,
+				const std::vector<std::function<T(std::vector<double>)>>& deriv) {
+
+				T d1 = deriv[0](spatial_grid);
+				T d2 = deriv[1](spatial_grid);
+				T identity = d1.identity();
+
+				std::vector<T> derivatives;
+				derivatives.reserve(parameters.size());
+
+				for (const auto& p : parameters) {
+
+					std::vector<std::vector<double>> prefactor_
+						= prefactor(p.rate, p.sigma, spatial_grid);
+
+					T derivative = identity;
+					derivative = derivative.pre_vector(prefactor_[0]);
+					T tmp = d1;
+					derivative += tmp.pre_vector(prefactor_[1]);
+					tmp = d2;
+					derivative += tmp.pre_vector(prefactor_[2]);
+
+					derivatives.push_back(derivative);
+
+				}
+
+				return derivatives;
+
+			}
+
+		}
+
+		// Batch of Black-Scholes PDEs on common time and spatial grids, 
+		// propagated by the theta scheme in groups of "width" SIMD lanes.
+		// Returns the solution of each problem at the end of the time grid.
+		template <class T>
+		std::vector<std::vector<double>> batch(
+			const std::vector<double>& time_grid,
+			const std::vector<double>& spatial_grid,
+			const std::vector<Parameters>& parameters,
+			const std::vector<std::function<T(std::vector<double>)>>& deriv,
+			const double theta = 0.5,
+			const int width = 8) {
+
+			std::vector<T> derivatives =
+				generator::derivative_batch<T>(parameters, spatial_grid, deriv);
+
+			std::vector<double> inner(spatial_grid.size(), 0.0);
+			std::vector<std::vector<double>> func(parameters.size(), inner);
+
+			for (int i = 0; i != parameters.size(); ++i) {
+				for (int j = 0; j != spatial_grid.size(); ++j) {
+					func[i][j] = parameters[i].payoff(spatial_grid[j]);
+				}
+			}
+
+			propagation::batch::theta_1d(time_grid, derivatives, func, theta, width);
+
+			return func;
+
+		}
+
+		// Black-Scholes PDE with term-structured rate. The time grid is in
+		// time to maturity; over each time step the rate is the forward rate
+		// of the curve, hence discounting is exact. The operator is rebuilt
+		// only if the forward rate changes. Returns the solution at the end of
+		// the time grid.
+		template <class T>
+		std::vector<double> solve(
+			const std::vector<double>& time_grid,
+			const std::vector<double>& spatial_grid,
+			const curve::ZeroCurve& curve,
+			const double sigma,
+			const std::function<double(double)>& payoff,
+			const std::vector<std::function<T(std::vector<double>)>>& deriv,
+			const double theta = 0.5) {
+
+			NFS_SCOPE("bs::pde::solve");
+
+			const int n_steps = (int)time_grid.size() - 1;
+			const double maturity = time_grid.back();
+
+			// Calendar time interval of each time step.
+			std::vector<double> time_1(n_steps, 0.0);
+			std::vector<double> time_2(n_steps, 0.0);
+			for (int i = 0; i != n_steps; ++i) {
+				time_1[i] = maturity - time_grid[i + 1];
+				time_2[i] = maturity - time_grid[i];
+			}
+			const std::vector<double> rates = curve.fwd(time_1, time_2);
+
+			T d1 = deriv[0](spatial_grid);
+			T d2 = deriv[1](spatial_grid);
+			T identity = d1.identity();
+			T derivative = identity;
+
+			std::vector<double> func(spatial_grid.size(), 0.0);
+			for (int j = 0; j != spatial_grid.size(); ++j) {
+				func[j] = payoff(spatial_grid[j]);
+			}
+
+			for (int i = 0; i != n_steps; ++i) {
+
+				if (i == 0 || rates[i] != rates[i - 1]) {
+					std::vector<std::vector<double>> prefactor_
+						= generator::prefactor(rates[i], sigma, spatial_grid);
+					derivative = identity.pre_vector(prefactor_[0]);
+					derivative += d1.pre_vector(prefactor_[1]);
+					derivative += d2.pre_vector(prefactor_[2]);
+				}
+
+				propagator::theta_1d::full(
+					time_grid[i + 1] - time_grid[i], identity, derivative, func, theta);
+
+			}
+
+			return func;
+
 		}
 
 	}
@@ -82,6 +215,14 @@ namespace bs {
 			const double strike,
 			const double tau);
 
+		// Term-structured rate: Zero rate of curve at tau.
+		double price(
+			const double spot_price,
+			const curve::ZeroCurve& curve,
+			const double sigma,
+			const double strike,
+			const double tau);
+
 		double delta(
 			const double spot_price,
 			const double rate,
@@ -150,6 +291,14 @@ namespace bs {
 			const double strike,
 			const double tau);
 
+		// Term-structured rate: Zero rate of curve at tau.
+		double price(
+			const double spot_price,
+			const curve::ZeroCurve& curve,
+			const double sigma,
+			const double strike,
+			const double tau);
+
 		double delta(
 			const double spot_price,
 			const double rate,
@@ -194,4 +343,315 @@ namespace bs {
 
 	}
 
+
+	// Cash-or-nothing digital options paying 1.
+	namespace digital {
+
+		namespace call {
+
+			double payoff(
+				const double spot_price,
+				const double strike);
+
+			double price(
+				const double spot_price,
+				const double rate,
+				const double sigma,
+				const double strike,
+				const double tau);
+
+			std::function<std::vector<double>
+				(const double, const std::vector<std::vector<double>>&)>
+				solution_func(
+					const double rate,
+					const double sigma,
+					const double strike);
+
+			std::vector<double> solution_full(
+				const std::vector<double>& spatial_grid,
+				const double rate,
+				const double sigma,
+				const double strike,
+				const double tau);
+
+		}
+
+		namespace put {
+
+			double payoff(
+				const double spot_price,
+				const double strike);
+
+			double price(
+				const double spot_price,
+				const double rate,
+				const double sigma,
+				const double strike,
+				const double tau);
+
+		}
+
+	}
+
+	// Barrier options on vanilla or digital payoffs.
+	//
+	// Knock-out options expire worthless once the spot reaches a barrier
+	// (no rebate); knock-in options are the vanilla (digital) option minus
+	// the knock-out option. Barriers are monitored continuously, or at
+	// discrete monitoring dates.
+	//
+	// Discontinuous payoffs and barriers spoil the convergence of the PDE
+	// solution unless
+	//	- the spatial grid has nodes exactly on the strike and barriers,
+	//	- the payoff is replaced by its average over the cell of each node,
+	//	- knock-out at a monitoring date multiplies the value at each node
+	//	  by the part of its cell inside the barriers (projection),
+	//	- the first time steps after expiry and after each monitoring date
+	//	  are fully implicit (Rannacher start).
+	// Continuously monitored knock-out options are solved on the part of the
+	// grid between the barriers, with Dirichlet boundary rows at barriers.
+	//
+	// References:
+	// - Pooley, Vetzal and Forsyth (2003), Convergence remedies for
+	//   non-smooth payoffs in option pricing.
+	// - Broadie, Glasserman and Kou (1997), A continuity correction for
+	//   discrete barrier options.
+	namespace barrier {
+
+		enum class Type { none, down_out, up_out, double_out, down_in, up_in, double_in };
+
+		struct Option {
+			Type type = Type::none;
+			bool call = true;
+			// Cash-or-nothing payoff of 1, otherwise vanilla payoff.
+			bool digital = false;
+			double strike = 100.0;
+			double tau = 1.0;
+			double lower = 0.0;
+			double upper = 0.0;
+			// Monitoring dates, measured from valuation in (0, tau]. Empty for
+			// continuous monitoring.
+			std::vector<double> monitoring;
+		};
+
+		bool has_lower(const Option& option);
+
+		bool has_upper(const Option& option);
+
+		bool knock_in(const Option& option);
+
+		// Knock-out option with the barriers of option.
+		Option knock_out(const Option& option);
+
+		// Payoff at expiry, disregarding barriers.
+		double payoff(
+			const Option& option,
+			const double spot_price);
+
+		// Closed form price by the method of images (image series for double
+		// barriers). Discrete monitoring is approximated by shifting the
+		// barriers away from the spot by exp(0.5826 * sigma * sqrt(dt)),
+		// where dt is the mean time between monitoring dates.
+		double price(
+			const double spot_price,
+			const double rate,
+			const double sigma,
+			const Option& option);
+
+		// Closed form solution at time to maturity tau.
+		std::function<std::vector<double>
+			(const double, const std::vector<std::vector<double>>&)>
+			solution_func(
+				const double rate,
+				const double sigma,
+				const Option& option);
+
+		std::vector<double> solution_full(
+			const std::vector<double>& spatial_grid,
+			const double rate,
+			const double sigma,
+			const Option& option,
+			const double tau);
+
+		namespace pde {
+
+			// Spatial grid on [0, s_max] with nodes on spot, strike and barriers,
+			// and concentrated around spot and strike, see grid::Builder.
+			std::vector<double> grid(
+				const Option& option,
+				const double spot_price,
+				const double s_max,
+				const int n_points,
+				const double scaling = 0.1);
+
+			// Time grid in time to maturity, containing every monitoring date,
+			// with time steps no longer than tau / n_steps.
+			std::vector<double> time_grid(
+				const Option& option,
+				const int n_steps);
+
+			// Average of payoff over the cell [x_{i - 1/2}, x_{i + 1/2}] of each
+			// node (half cells at the ends of the grid). Cells are split at
+			// breaks (strike, barriers), and each part is integrated by 3-point
+			// Gauss-Legendre quadrature, exact for piecewise linear payoffs.
+			std::vector<double> smooth(
+				const std::function<double(double)>& payoff,
+				const std::vector<double>& spatial_grid,
+				const std::vector<double>& breaks);
+
+			// Knock-out at monitoring date: func at each node is multiplied by
+			// the part of its cell between the barriers.
+			void project(
+				const Option& option,
+				const std::vector<double>& spatial_grid,
+				std::vector<double>& func);
+
+			// Solution on spatial_grid at the end of time_grid, see grid and
+			// time_grid. Returns the barrier option on the whole grid, also
+			// outside continuously monitored barriers.
+			template <class T>
+			std::vector<double> solve(
+				const std::vector<double>& time_grid,
+				const std::vector<double>& spatial_grid,
+				const Option& option,
+				const double rate,
+				const double sigma,
+				const std::vector<std::function<T(std::vector<double>)>>& deriv,
+				const double theta = 0.5,
+				const bool smoothing = true) {
+
+				NFS_SCOPE("bs::barrier::pde::solve");
+
+				const int n_points = (int)spatial_grid.size();
+				const int n_steps = (int)time_grid.size() - 1;
+				const Option out = knock_out(option);
+				const bool continuous = option.monitoring.empty();
+
+				std::vector<double> breaks{ option.strike };
+				if (has_lower(option)) {
+					breaks.push_back(option.lower);
+				}
+				if (has_upper(option)) {
+					breaks.push_back(option.upper);
+				}
+
+				// Option without barriers, needed for knock-in options.
+				auto vanilla_payoff = [&option](const double s) { return payoff(option, s); };
+				std::vector<double> vanilla(n_points, 0.0);
+				if (smoothing) {
+					vanilla = smooth(vanilla_payoff, spatial_grid, breaks);
+				}
+				else {
+					for (int j = 0; j != n_points; ++j) {
+						vanilla[j] = vanilla_payoff(spatial_grid[j]);
+					}
+				}
+
+				// Knock-out option on nodes i_lower, ..., i_upper.
+				int i_lower = 0;
+				int i_upper = n_points - 1;
+				if (continuous && has_lower(option)) {
+					i_lower = ::grid::find(spatial_grid, option.lower);
+				}
+				if (continuous && has_upper(option)) {
+					i_upper = ::grid::find(spatial_grid, option.upper);
+				}
+				if (i_lower < 0 || i_upper < 0) {
+					throw std::invalid_argument("Spatial grid should have nodes on barriers.");
+				}
+
+				const std::vector<double> grid_out(
+					spatial_grid.begin() + i_lower, spatial_grid.begin() + i_upper + 1);
+				std::vector<double> func(
+					vanilla.begin() + i_lower, vanilla.begin() + i_upper + 1);
+
+				// Monitoring dates on time grid.
+				std::vector<bool> monitor(time_grid.size(), false);
+				for (const double t : option.monitoring) {
+					const int idx = ::grid::find(time_grid, option.tau - t);
+					if (idx < 0) {
+						throw std::invalid_argument("Time grid should contain monitoring dates.");
+					}
+					monitor[idx] = true;
+				}
+
+				// Knock-out at expiry.
+				if (continuous && has_lower(option)) {
+					func.front() = 0.0;
+				}
+				if (continuous && has_upper(option)) {
+					func.back() = 0.0;
+				}
+				if (monitor[0]) {
+					project(out, grid_out, func);
+				}
+
+				T identity = deriv[0](spatial_grid).identity();
+				T derivative = bs::pde::generator::derivative_full<T>(rate, sigma, spatial_grid, deriv);
+
+				T identity_out = identity;
+				T derivative_out = derivative;
+				if (continuous && option.type != Type::none) {
+
+					identity_out = deriv[0](grid_out).identity();
+					derivative_out = bs::pde::generator::derivative_full<T>(rate, sigma, grid_out, deriv);
+
+					// Dirichlet boundary rows: Zero time derivative at barriers.
+					const int n_rows = derivative_out.n_boundary_rows();
+					const int n_elements = derivative_out.n_boundary_elements();
+					if (has_lower(option)) {
+						boundary<T>(0, std::vector<double>(n_elements, 0.0), derivative_out);
+					}
+					if (has_upper(option)) {
+						boundary<T>(2 * n_rows - 1,
+							std::vector<double>(n_elements - (n_rows - 1), 0.0), derivative_out);
+					}
+
+				}
+
+				// Rannacher start: Two fully implicit time steps damp the
+				// oscillations of the theta scheme at discontinuities.
+				int n_implicit = 2;
+
+				for (int i = 0; i != n_steps; ++i) {
+
+					const double dt = time_grid[i + 1] - time_grid[i];
+					const double theta_step = n_implicit > 0 ? 1.0 : theta;
+
+					propagator::theta_1d::full(dt, identity_out, derivative_out, func, theta_step);
+
+					if (knock_in(option)) {
+						propagator::theta_1d::full(dt, identity, derivative, vanilla, i < 2 ? 1.0 : theta);
+					}
+
+					--n_implicit;
+					if (monitor[i + 1]) {
+						project(out, grid_out, func);
+						n_implicit = 2;
+					}
+
+				}
+
+				if (option.type == Type::none) {
+					return func;
+				}
+
+				// Knock-out option is zero outside barriers.
+				std::vector<double> result(n_points, 0.0);
+				std::copy(func.begin(), func.end(), result.begin() + i_lower);
+
+				if (knock_in(option)) {
+					for (int j = 0; j != n_points; ++j) {
+						result[j] = vanilla[j] - result[j];
+					}
+				}
+
+				return result;
+
+			}
+
+		}
+
+	}
+
 }
@@ -1,10 +1,15 @@
 #define _USE_MATH_DEFINES
+#include <algorithm>
 #include <cmath>
 #include <complex>
 #include <stdexcept>
 #include <string>
 
 #include "HestonUtility.h"
+#include "derivatives.h"
+#include "grid.h"
+#include "instrumentation.h"
+#include "propagation.h"
 
 
 // Heston model, see Gatheral (2006).
@@ -62,6 +67,38 @@ double heston::put(
 }
 
 
+double heston::call(
+	const double price,
+	const double variance,
+	const curve::ZeroCurve& curve,
+	const double lambda,
+	const double theta,
+	const double eta,
+	const double rho,
+	const double strike,
+	const double tau) {
+
+	return heston::call(price, variance, curve.zero(tau), lambda, theta, eta, rho, strike, tau);
+
+}
+
+
+double heston::put(
+	const double price,
+	const double variance,
+	const curve::ZeroCurve& curve,
+	const double lambda,
+	const double theta,
+	const double eta,
+	const double rho,
+	const double strike,
+	const double tau) {
+
+	return heston::put(price, variance, curve.zero(tau), lambda, theta, eta, rho, strike, tau);
+
+}
+
+
 std::complex<double> heston::alpha(
 	const double j,
 	const double k) {
@@ -243,3 +280,290 @@ double heston::probability(
 	return 0.5 + integral / M_PI;
 
 }
+
+
+// Heston PDE in time-to-maturity, see Andersen and Piterbarg (2010):
+//		dV/dtau = 0.5 * v * S^2 * d2V/dS2 + rho * eta * v * S * d2V/dSdv 
+//			+ 0.5 * eta^2 * v * d2V/dv2 + rate * S * dV/dS 
+//			+ lambda * (theta - v) * dV/dv - rate * V.
+// The discounting term is split evenly between the two dimensions.
+bool heston::pde::feller(
+	const double lambda,
+	const double theta,
+	const double eta) {
+
+	return 2.0 * lambda * theta >= eta * eta;
+
+}
+
+
+std::vector<std::vector<double>> heston::pde::generator::grid(
+	const double s_max,
+	const int n_points_s,
+	const double strike,
+	const double v_max,
+	const int n_points_v,
+	const double variance,
+	const double scaling_s,
+	const double scaling_v) {
+
+	std::vector<double> grid_s =
+		grid::hyperbolic_full(0.0, s_max, n_points_s, strike, scaling_s);
+
+	std::vector<double> grid_v =
+		grid::hyperbolic_full(0.0, v_max, n_points_v, variance, scaling_v);
+
+	return { grid_s, grid_v };
+
+}
+
+
+std::vector<std::vector<double>> heston::pde::generator::prefactor_s(
+	const double rate,
+	const std::vector<std::vector<double>>& spatial_grid) {
+
+	const std::vector<double>& grid_s = spatial_grid[0];
+	const std::vector<double>& grid_v = spatial_grid[1];
+
+	std::vector<std::vector<double>> prefactor(3, { 1.0 });
+
+	// First order derivative: rate * S.
+	prefactor[0][0] = rate;
+	// Second order derivative: 0.5 * S^2 * v.
+	prefactor[1][0] = 0.5;
+	// Inhomogeneous term: -0.5 * rate.
+	prefactor[2][0] = -0.5 * rate;
+
+	for (int i = 0; i != grid_s.size(); ++i) {
+		prefactor[0].push_back(grid_s[i]);
+		prefactor[1].push_back(grid_s[i] * grid_s[i]);
+		prefactor[2].push_back(1.0);
+	}
+
+	for (int i = 0; i != grid_v.size(); ++i) {
+		prefactor[0].push_back(1.0);
+		prefactor[1].push_back(grid_v[i]);
+		prefactor[2].push_back(1.0);
+	}
+
+	return prefactor;
+
+}
+
+
+std::vector<std::vector<double>> heston::pde::generator::prefactor_v(
+	const double rate,
+	const double lambda,
+	const double theta,
+	const double eta,
+	const std::vector<std::vector<double>>& spatial_grid) {
+
+	const std::vector<double>& grid_s = spatial_grid[0];
+	const std::vector<double>& grid_v = spatial_grid[1];
+
+	std::vector<std::vector<double>> prefactor(3, { 1.0 });
+
+	// First order derivative: lambda * (theta - v).
+	prefactor[0][0] = lambda;
+	// Second order derivative: 0.5 * eta^2 * v.
+	prefactor[1][0] = 0.5 * eta * eta;
+	// Inhomogeneous term: -0.5 * rate.
+	prefactor[2][0] = -0.5 * rate;
+
+	for (int i = 0; i != grid_s.size(); ++i) {
+		prefactor[0].push_back(1.0);
+		prefactor[1].push_back(1.0);
+		prefactor[2].push_back(1.0);
+	}
+
+	for (int i = 0; i != grid_v.size(); ++i) {
+		prefactor[0].push_back(theta - grid_v[i]);
+		prefactor[1].push_back(grid_v[i]);
+		prefactor[2].push_back(1.0);
+	}
+
+	return prefactor;
+
+}
+
+
+std::vector<double> heston::pde::generator::prefactor_mixed(
+	const double eta,
+	const double rho,
+	const std::vector<std::vector<double>>& spatial_grid) {
+
+	const std::vector<double>& grid_s = spatial_grid[0];
+	const std::vector<double>& grid_v = spatial_grid[1];
+
+	std::vector<double> prefactor(grid_s.size() * grid_v.size(), 0.0);
+
+	// Mixed derivative: rho * eta * S * v.
+	int index = 0;
+	for (int i = 0; i != grid_s.size(); ++i) {
+		for (int j = 0; j != grid_v.size(); ++j) {
+			prefactor[index] = rho * eta * grid_s[i] * grid_v[j];
+			++index;
+		}
+	}
+
+	return prefactor;
+
+}
+
+
+std::vector<TriDiagonal> heston::pde::generator::derivatives_s(
+	const std::vector<double>& grid_s) {
+
+	TriDiagonal d1 = d1dx1::nonuniform::c2b1(grid_s);
+	TriDiagonal d2 = d2dx2::nonuniform::c2b0(grid_s);
+
+	return { d1.identity(), d1, d2 };
+
+}
+
+
+std::vector<TriDiagonal> heston::pde::generator::derivatives_v(
+	const std::vector<double>& grid_v,
+	const double lambda,
+	const double theta,
+	const double eta) {
+
+	if (heston::pde::feller(lambda, theta, eta)) {
+
+		TriDiagonal d1 = d1dx1::nonuniform::c2b2(grid_v);
+		TriDiagonal d2 = d2dx2::nonuniform::c2b1(grid_v);
+
+		return { d1.identity(), d1, d2 };
+
+	}
+	else {
+
+		TriDiagonal d1 = d1dx1::nonuniform::c2b1(grid_v);
+		TriDiagonal d2 = d2dx2::nonuniform::c2b0(grid_v);
+
+		return { d1.identity(), d1, d2 };
+
+	}
+
+}
+
+
+std::vector<double> heston::pde::solve(
+	const std::vector<double>& time_grid,
+	const std::vector<std::vector<double>>& spatial_grid,
+	const double rate,
+	const double lambda,
+	const double theta,
+	const double eta,
+	const double rho,
+	const std::function<double(double)>& payoff,
+	const std::string scheme) {
+
+	NFS_SCOPE("heston::pde::solve");
+
+	const std::vector<double>& grid_s = spatial_grid[0];
+	const std::vector<double>& grid_v = spatial_grid[1];
+
+	std::vector<std::vector<double>> prefactors_s =
+		generator::prefactor_s(rate, spatial_grid);
+
+	std::vector<std::vector<double>> prefactors_v =
+		generator::prefactor_v(rate, lambda, theta, eta, spatial_grid);
+
+	std::vector<TriDiagonal> derivatives_s = generator::derivatives_s(grid_s);
+
+	std::vector<TriDiagonal> derivatives_v =
+		generator::derivatives_v(grid_v, lambda, theta, eta);
+
+	MixedDerivative<TriDiagonal, TriDiagonal> mixed(derivatives_s[1], derivatives_v[1]);
+	// Mixed derivative: rho * eta * S * v, kept in separable form.
+	std::vector<double> prefactor_s_mixed = grid_s;
+	for (int i = 0; i != prefactor_s_mixed.size(); ++i) {
+		prefactor_s_mixed[i] *= rho * eta;
+	}
+	mixed.set_prefactors(prefactor_s_mixed, grid_v);
+
+	// Initial condition, order (S, v).
+	std::vector<double> func(grid_s.size() * grid_v.size(), 0.0);
+	int index = 0;
+	for (int i = 0; i != grid_s.size(); ++i) {
+		const double value = payoff(grid_s[i]);
+		for (int j = 0; j != grid_v.size(); ++j) {
+			func[index] = value;
+			++index;
+		}
+	}
+
+	if (scheme == "DR") {
+		propagation::adi::dr_2d(
+			time_grid,
+			prefactors_s, prefactors_v,
+			derivatives_s, derivatives_v,
+			mixed,
+			func);
+	}
+	else if (scheme == "CS") {
+		propagation::adi::cs_2d(
+			time_grid,
+			prefactors_s, prefactors_v,
+			derivatives_s, derivatives_v,
+			mixed,
+			func);
+	}
+	else if (scheme == "MCS") {
+		propagation::adi::mcs_2d(
+			time_grid,
+			prefactors_s, prefactors_v,
+			derivatives_s, derivatives_v,
+			mixed,
+			func);
+	}
+	else if (scheme == "HV") {
+		propagation::adi::hv_2d(
+			time_grid,
+			prefactors_s, prefactors_v,
+			derivatives_s, derivatives_v,
+			mixed,
+			func);
+	}
+	else {
+		throw std::invalid_argument("Unknown scheme.");
+	}
+
+	return func;
+
+}
+
+
+double heston::pde::interpolate(
+	const std::vector<std::vector<double>>& spatial_grid,
+	const std::vector<double>& func,
+	const double price,
+	const double variance) {
+
+	const std::vector<double>& grid_s = spatial_grid[0];
+	const std::vector<double>& grid_v = spatial_grid[1];
+
+	const int n_points_v = (int)grid_v.size();
+
+	// Index of lower grid point of interval containing point.
+	auto lower = [](const std::vector<double>& grid, const double x) {
+		int index = (int)(std::upper_bound(grid.begin(), grid.end(), x) - grid.begin()) - 1;
+		return std::min(std::max(index, 0), (int)grid.size() - 2);
+	};
+
+	const int i = lower(grid_s, price);
+	const int j = lower(grid_v, variance);
+
+	const double w_s = (price - grid_s[i]) / (grid_s[i + 1] - grid_s[i]);
+	const double w_v = (variance - grid_v[j]) / (grid_v[j + 1] - grid_v[j]);
+
+	const double f_00 = func[i * n_points_v + j];
+	const double f_01 = func[i * n_points_v + j + 1];
+	const double f_10 = func[(i + 1) * n_points_v + j];
+	const double f_11 = func[(i + 1) * n_points_v + j + 1];
+
+	return (1.0 - w_s) * ((1.0 - w_v) * f_00 + w_v * f_01)
+		+ w_s * ((1.0 - w_v) * f_10 + w_v * f_11);
+
+}
@@ -1,7 +1,12 @@
 #pragma once
 
 #include <complex>
+#include <functional>
 #include <string>
+#include <vector>
+
+#include "band_diagonal_matrix.h"
+#include "curve.h"
 
 
 namespace heston {
@@ -28,6 +33,29 @@ namespace heston {
 		const double strike,
 		const double tau);
 
+	// Term-structured rate: Zero rate of curve at tau.
+	double call(
+		const double price,
+		const double variance,
+		const curve::ZeroCurve& curve,
+		const double lambda,
+		const double theta,
+		const double eta,
+		const double rho,
+		const double strike,
+		const double tau);
+
+	double put(
+		const double price,
+		const double variance,
+		const curve::ZeroCurve& curve,
+		const double lambda,
+		const double theta,
+		const double eta,
+		const double rho,
+		const double strike,
+		const double tau);
+
 
 	std::complex<double> alpha(
 		const double j,
@@ -98,4 +126,92 @@ namespace heston {
 		const double rho,
 		const double tau);
 
+	namespace pde {
+
+		// Feller condition: Zero variance is unattainable if 2 * lambda * theta >= eta^2.
+		bool feller(
+			const double lambda,
+			const double theta,
+			const double eta);
+
+		namespace generator {
+
+			// Spatial grids {S, v} with hyperbolic concentration around strike 
+			// and spot variance, respectively.
+			std::vector<std::vector<double>> grid(
+				const double s_max,
+				const int n_points_s,
+				const double strike,
+				const double v_max,
+				const int n_points_v,
+				const double variance,
+				const double scaling_s = 0.1,
+				const double scaling_v = 0.1);
+
+			// Prefactors C * f(S) * g(v) of operators along S-dimension, see action_2d.
+			// Order: 1st order derivative, 2nd order derivative, inhomogeneous term.
+			std::vector<std::vector<double>> prefactor_s(
+				const double rate,
+				const std::vector<std::vector<double>>& spatial_grid);
+
+			// Prefactors C * f(S) * g(v) of operators along v-dimension, see action_2d.
+			// Order: 1st order derivative, 2nd order derivative, inhomogeneous term.
+			std::vector<std::vector<double>> prefactor_v(
+				const double rate,
+				const double lambda,
+				const double theta,
+				const double eta,
+				const std::vector<std::vector<double>>& spatial_grid);
+
+			// Prefactors of mixed derivative operator, order (S, v).
+			std::vector<double> prefactor_mixed(
+				const double eta,
+				const double rho,
+				const std::vector<std::vector<double>>& spatial_grid);
+
+			// Finite difference operators {identity, d1dx1, d2dx2} along S-dimension.
+			std::vector<TriDiagonal> derivatives_s(
+				const std::vector<double>& grid_s);
+
+			// Finite difference operators {identity, d1dx1, d2dx2} along v-dimension.
+			// At v = 0 the PDE degenerates to a first order equation in v, which 
+			// is discretized by the forward difference (upwind) boundary row. 
+			// If the Feller condition is satisfied the solution is smooth at v = 0,
+			// and the 2nd order boundary row is used. Otherwise the monotone 1st 
+			// order boundary row is used.
+			std::vector<TriDiagonal> derivatives_v(
+				const std::vector<double>& grid_v,
+				const double lambda,
+				const double theta,
+				const double eta);
+
+		}
+
+		// Solution of Heston PDE on spatial grid {S, v} at the end of time grid
+		// (time-to-maturity). The initial condition is given by payoff(S).
+		// scheme
+		//	- "DR": Douglas-Rachford, mixed derivative term treated explicitly.
+		//	- "CS": Craig-Sneyd.
+		//	- "MCS": Modified Craig-Sneyd.
+		//	- "HV": Hundsdorfer-Verwer.
+		std::vector<double> solve(
+			const std::vector<double>& time_grid,
+			const std::vector<std::vector<double>>& spatial_grid,
+			const double rate,
+			const double lambda,
+			const double theta,
+			const double eta,
+			const double rho,
+			const std::function<double(double)>& payoff,
+			const std::string scheme = "HV");
+
+		// Bilinear interpolation of solution on spatial grid {S, v}, order (S, v).
+		double interpolate(
+			const std::vector<std::vector<double>>& spatial_grid,
+			const std::vector<double>& func,
+			const double price,
+			const double variance);
+
+	}
+
 }
@@ -127,7 +127,7 @@ double sabr::call::payoff(
 	const double spot_forward,
 	const double strike) {
 
-	bs::call::payoff(spot_forward, strike);
+	return bs::call::payoff(spot_forward, strike);
 
 }
 
@@ -1,6 +1,17 @@
+#include <algorithm>
 #include <cmath>
+#include <map>
+#include <stdexcept>
+#include <utility>
 
 #include "VasicekUtility.h"
+#include "band_diagonal_factorized.h"
+#include "band_diagonal_matrix.h"
+#include "derivatives.h"
+#include "distributions.h"
+#include "grid.h"
+#include "instrumentation.h"
+#include "vasicek.h"
 
 
 double vasicek::b_func(
@@ -62,3 +73,683 @@ double vasicek::dadt_func(
 		- 2 * sigma_sq * b * dbdt / (4 * kappa);
 
 }
+
+
+namespace {
+
+	// Tolerance for matching event times with time grid points.
+	const double time_tolerance = 1.0e-10;
+
+	// Cash flows and exercises of claims at each index of a time grid.
+	struct Events {
+		// Claim index and cash flow.
+		std::vector<std::vector<std::pair<int, double>>> flows;
+		// Claim index of options expiring.
+		std::vector<std::vector<int>> exercises;
+	};
+
+	// Cash flow is held by claim. An option only holds cash flows paid after
+	// expiry.
+	bool held(const vasicek::Claim& claim, const int i) {
+		return !claim.option || claim.times[i] > claim.expiry + time_tolerance;
+	}
+
+	// Payment dates and expiries of claims.
+	std::vector<double> event_times(const std::vector<vasicek::Claim>& claims) {
+
+		std::vector<double> times;
+
+		for (const vasicek::Claim& claim : claims) {
+
+			if (claim.times.size() != claim.cash_flows.size()) {
+				throw std::invalid_argument("Number of payment dates and cash flows differ.");
+			}
+
+			for (int i = 0; i != claim.times.size(); ++i) {
+				if (held(claim, i)) {
+					times.push_back(claim.times[i]);
+				}
+			}
+			if (claim.option) {
+				times.push_back(claim.expiry);
+			}
+
+		}
+
+		return times;
+
+	}
+
+	// Events of claims, index(time) is the time grid index of time.
+	Events schedule(
+		const std::vector<vasicek::Claim>& claims,
+		const int n_indices,
+		const std::function<int(double)>& index) {
+
+		Events events;
+		events.flows.resize(n_indices);
+		events.exercises.resize(n_indices);
+
+		for (int c = 0; c != claims.size(); ++c) {
+
+			const vasicek::Claim& claim = claims[c];
+
+			for (int i = 0; i != claim.times.size(); ++i) {
+				if (held(claim, i)) {
+					events.flows[index(claim.times[i])].push_back({ c, claim.cash_flows[i] });
+				}
+			}
+			if (claim.option) {
+				events.exercises[index(claim.expiry)].push_back(c);
+			}
+
+		}
+
+		return events;
+
+	}
+
+	// Add cash flows and exercise options at time grid index.
+	void apply(
+		const std::vector<vasicek::Claim>& claims,
+		const Events& events,
+		const int index,
+		std::vector<std::vector<double>>& func) {
+
+		for (const std::pair<int, double>& flow : events.flows[index]) {
+			for (double& value : func[flow.first]) {
+				value += flow.second;
+			}
+		}
+
+		for (int c : events.exercises[index]) {
+			const double strike = claims[c].strike;
+			if (claims[c].call) {
+				for (double& value : func[c]) {
+					value = std::max(value - strike, 0.0);
+				}
+			}
+			else {
+				for (double& value : func[c]) {
+					value = std::max(strike - value, 0.0);
+				}
+			}
+		}
+
+	}
+
+	// Linear interpolation of func on grid at x, constant extrapolation.
+	double interpolate(
+		const std::vector<double>& grid,
+		const std::vector<double>& func,
+		const double x) {
+
+		if (x <= grid.front()) {
+			return func.front();
+		}
+		if (x >= grid.back()) {
+			return func.back();
+		}
+
+		const int i = (int)(std::upper_bound(grid.begin(), grid.end(), x) - grid.begin()) - 1;
+		const double weight = (x - grid[i]) / (grid[i + 1] - grid[i]);
+
+		return (1.0 - weight) * func[i] + weight * func[i + 1];
+
+	}
+
+	// Option on coupon bond by Jamshidian decomposition: The option is a
+	// portfolio of options on zero-coupon bonds, with strikes given by the
+	// zero-coupon bond prices at expiry at the short rate r* for which the
+	// coupon bond is worth the strike.
+	double jamshidian(
+		const vasicek::Claim& claim,
+		const double rate,
+		const double kappa,
+		const double theta,
+		const double sigma) {
+
+		std::vector<double> a;
+		std::vector<double> b;
+		std::vector<double> cash_flows;
+		std::vector<double> maturities;
+
+		for (int i = 0; i != claim.times.size(); ++i) {
+			if (held(claim, i)) {
+				a.push_back(vasicek::a_func(claim.expiry, claim.times[i], kappa, theta, sigma));
+				b.push_back(vasicek::b_func(claim.expiry, claim.times[i], kappa));
+				cash_flows.push_back(claim.cash_flows[i]);
+				maturities.push_back(claim.times[i]);
+			}
+		}
+
+		if (cash_flows.empty()) {
+			throw std::invalid_argument("Option without cash flows after expiry.");
+		}
+
+		// Newton iteration for r*. The bond price is decreasing and convex
+		// in r for positive cash flows.
+		double r_star = rate;
+		for (int iteration = 0; iteration != 100; ++iteration) {
+
+			double value = -claim.strike;
+			double derivative = 0.0;
+			for (int i = 0; i != cash_flows.size(); ++i) {
+				const double p = cash_flows[i] * std::exp(a[i] - b[i] * r_star);
+				value += p;
+				derivative -= b[i] * p;
+			}
+
+			const double step = value / derivative;
+			r_star -= step;
+
+			if (std::abs(step) < 1.0e-14) {
+				break;
+			}
+
+		}
+
+		double price = 0.0;
+		for (int i = 0; i != cash_flows.size(); ++i) {
+
+			const double strike = std::exp(a[i] - b[i] * r_star);
+
+			price += cash_flows[i] * (claim.call
+				? vasicek::zcb::call(rate, 0.0, claim.expiry, maturities[i], strike, kappa, theta, sigma)
+				: vasicek::zcb::put(rate, 0.0, claim.expiry, maturities[i], strike, kappa, theta, sigma));
+
+		}
+
+		return price;
+
+	}
+
+}
+
+
+double vasicek::zcb::price(
+	const double rate,
+	const double time_1,
+	const double time_2,
+	const double kappa,
+	const double theta,
+	const double sigma) {
+
+	return std::exp(a_func(time_1, time_2, kappa, theta, sigma)
+		- b_func(time_1, time_2, kappa) * rate);
+
+}
+
+
+std::vector<double> vasicek::zcb::price(
+	const double rate,
+	const double time,
+	const std::vector<double>& maturities,
+	const double kappa,
+	const double theta,
+	const double sigma) {
+
+	std::vector<double> prices(maturities.size(), 0.0);
+
+	for (int i = 0; i != maturities.size(); ++i) {
+		prices[i] = price(rate, time, maturities[i], kappa, theta, sigma);
+	}
+
+	return prices;
+
+}
+
+
+double vasicek::zcb::call(
+	const double rate,
+	const double time,
+	const double expiry,
+	const double maturity,
+	const double strike,
+	const double kappa,
+	const double theta,
+	const double sigma) {
+
+	const double p_expiry = price(rate, time, expiry, kappa, theta, sigma);
+	const double p_maturity = price(rate, time, maturity, kappa, theta, sigma);
+
+	// Volatility of log(P(expiry, maturity)).
+	const double sigma_p = std::sqrt(y_func(kappa, sigma, expiry - time))
+		* b_func(expiry, maturity, kappa);
+
+	const double h = std::log(p_maturity / (strike * p_expiry)) / sigma_p + sigma_p / 2.0;
+
+	return p_maturity * normal::cdf(h) - strike * p_expiry * normal::cdf(h - sigma_p);
+
+}
+
+
+double vasicek::zcb::put(
+	const double rate,
+	const double time,
+	const double expiry,
+	const double maturity,
+	const double strike,
+	const double kappa,
+	const double theta,
+	const double sigma) {
+
+	const double p_expiry = price(rate, time, expiry, kappa, theta, sigma);
+	const double p_maturity = price(rate, time, maturity, kappa, theta, sigma);
+
+	const double sigma_p = std::sqrt(y_func(kappa, sigma, expiry - time))
+		* b_func(expiry, maturity, kappa);
+
+	const double h = std::log(p_maturity / (strike * p_expiry)) / sigma_p + sigma_p / 2.0;
+
+	return strike * p_expiry * normal::cdf(sigma_p - h) - p_maturity * normal::cdf(-h);
+
+}
+
+
+std::vector<double> vasicek::price(
+	const std::vector<Claim>& claims,
+	const double rate,
+	const double kappa,
+	const double theta,
+	const double sigma) {
+
+	NFS_SCOPE("vasicek::price");
+
+	std::vector<double> prices(claims.size(), 0.0);
+
+	// Discount factors of payment dates.
+	std::map<double, double> discount;
+
+	for (int c = 0; c != claims.size(); ++c) {
+
+		const Claim& claim = claims[c];
+
+		if (claim.times.size() != claim.cash_flows.size()) {
+			throw std::invalid_argument("Number of payment dates and cash flows differ.");
+		}
+
+		if (claim.option) {
+			prices[c] = jamshidian(claim, rate, kappa, theta, sigma);
+			continue;
+		}
+
+		for (int i = 0; i != claim.times.size(); ++i) {
+
+			auto it = discount.find(claim.times[i]);
+			if (it == discount.end()) {
+				it = discount.emplace(claim.times[i],
+					zcb::price(rate, 0.0, claim.times[i], kappa, theta, sigma)).first;
+			}
+
+			prices[c] += claim.cash_flows[i] * it->second;
+
+		}
+
+	}
+
+	return prices;
+
+}
+
+
+std::function<double(double)> vasicek::hull_white::theta(
+	const std::function<double(double)>& discount,
+	const double kappa,
+	const double sigma,
+	const double step) {
+
+	return [discount, kappa, sigma, step](const double time) {
+
+		// Central differences require log(discount) at time - step.
+		const double t = std::max(time, step);
+
+		const double log_minus = std::log(discount(t - step));
+		const double log_center = std::log(discount(t));
+		const double log_plus = std::log(discount(t + step));
+
+		const double forward = -(log_plus - log_minus) / (2.0 * step);
+		const double dforward = -(log_plus - 2.0 * log_center + log_minus) / (step * step);
+
+		return forward + dforward / kappa
+			+ sigma * sigma * (1.0 - std::exp(-2.0 * kappa * time)) / (2.0 * kappa * kappa);
+
+	};
+
+}
+
+
+std::function<double(double)> vasicek::hull_white::theta(
+	const curve::ZeroCurve& curve,
+	const double kappa,
+	const double sigma,
+	const double step) {
+
+	return theta([curve](const double time) { return curve.df(time); }, kappa, sigma, step);
+
+}
+
+
+std::vector<std::vector<double>> vasicek::pde::generator::prefactor(
+	const double kappa,
+	const double theta,
+	const double sigma,
+	const std::vector<double>& spatial_grid) {
+
+	std::vector<double> inner(spatial_grid.size(), 0.0);
+	std::vector<std::vector<double>> prefactor(3, inner);
+
+	for (int i = 0; i != spatial_grid.size(); ++i) {
+		// Prefactor of identity operator.
+		prefactor[0][i] = -spatial_grid[i];
+		// Prefactor of 1st order derivative operator.
+		prefactor[1][i] = kappa * (theta - spatial_grid[i]);
+		// Prefactor of 2nd order derivative operator.
+		prefactor[2][i] = 0.5 * sigma * sigma;
+	}
+
+	return prefactor;
+
+}
+
+
+std::vector<double> vasicek::pde::generator::grid(
+	const double rate,
+	const double kappa,
+	const double theta,
+	const double sigma,
+	const double maturity,
+	const int n_points,
+	const double n_std) {
+
+	if (maturity <= 0.0) {
+		throw std::invalid_argument("Maturity should be positive.");
+	}
+
+	const double std_dev = std::sqrt(y_func(kappa, sigma, maturity));
+
+	return grid::uniform(
+		std::min(rate, theta) - n_std * std_dev,
+		std::max(rate, theta) + n_std * std_dev,
+		n_points);
+
+}
+
+
+std::vector<std::vector<double>> vasicek::pde::rollback(
+	const std::vector<double>& spatial_grid,
+	const std::vector<Claim>& claims,
+	const double kappa,
+	const std::function<double(double)>& theta,
+	const double sigma,
+	const double dt_max,
+	const double theta_scheme) {
+
+	NFS_SCOPE("vasicek::pde::rollback");
+
+	const std::vector<double> time_grid = grid::with_events(event_times(claims), dt_max, time_tolerance);
+	const int n_steps = (int)time_grid.size() - 1;
+
+	const Events events = schedule(claims, n_steps + 1, [&time_grid](const double time) {
+		return grid::find(time_grid, time, time_tolerance);
+	});
+
+	const std::vector<std::function<TriDiagonal(std::vector<double>)>>
+		deriv{ d1dx1::nonuniform::c2b2, d2dx2::nonuniform::c2b1 };
+
+	TriDiagonal identity = deriv[0](spatial_grid).identity();
+
+	std::vector<std::vector<double>> func(
+		claims.size(), std::vector<double>(spatial_grid.size(), 0.0));
+
+	std::vector<double> tmp(spatial_grid.size(), 0.0);
+
+	apply(claims, events, n_steps, func);
+
+	// Right-hand-side operator, evaluated at t + dt, and factorized
+	// left-hand-side operator, evaluated at t. Each is updated only if theta
+	// or the time step changes.
+	TriDiagonal rhs;
+	FactorizedBandDiagonal lhs;
+	double rhs_theta = 0.0;
+	double rhs_dt = 0.0;
+	double lhs_theta = 0.0;
+	double lhs_dt = 0.0;
+
+	for (int i = n_steps - 1; i >= 0; --i) {
+
+		const double dt = time_grid[i + 1] - time_grid[i];
+		const double theta_1 = theta(time_grid[i + 1]);
+		const double theta_0 = theta(time_grid[i]);
+
+		// Time steps between events are uniform up to rounding.
+		if (std::abs(dt - rhs_dt) > 1.0e-12 * dt || theta_1 != rhs_theta) {
+			rhs = generator::derivative_full<TriDiagonal>(kappa, theta_1, sigma, spatial_grid, deriv);
+			rhs *= (1.0 - theta_scheme) * dt;
+			rhs += identity;
+			rhs_theta = theta_1;
+			rhs_dt = dt;
+		}
+
+		if (std::abs(dt - lhs_dt) > 1.0e-12 * dt || theta_0 != lhs_theta) {
+			TriDiagonal tmp = generator::derivative_full<TriDiagonal>(kappa, theta_0, sigma, spatial_grid, deriv);
+			tmp *= -theta_scheme * dt;
+			tmp += identity;
+			lhs = FactorizedBandDiagonal(tmp);
+			lhs_theta = theta_0;
+			lhs_dt = dt;
+		}
+
+		for (std::vector<double>& f : func) {
+			std::fill(tmp.begin(), tmp.end(), 0.0);
+			matrix_multiply_vector<TriDiagonal>(rhs, f, tmp);
+			f.swap(tmp);
+			lhs.solve(f);
+		}
+
+		apply(claims, events, i, func);
+
+	}
+
+	return func;
+
+}
+
+
+std::vector<std::vector<double>> vasicek::pde::rollback(
+	const std::vector<double>& spatial_grid,
+	const std::vector<Claim>& claims,
+	const double kappa,
+	const double theta,
+	const double sigma,
+	const double dt_max,
+	const double theta_scheme) {
+
+	return rollback(spatial_grid, claims, kappa,
+		[theta](const double) { return theta; }, sigma, dt_max, theta_scheme);
+
+}
+
+
+std::vector<double> vasicek::pde::price(
+	const std::vector<Claim>& claims,
+	const double rate,
+	const double kappa,
+	const double theta,
+	const double sigma,
+	const int n_points,
+	const double dt_max) {
+
+	const std::vector<double> times = event_times(claims);
+	if (times.empty()) {
+		return std::vector<double>(claims.size(), 0.0);
+	}
+	const double maturity = *std::max_element(times.begin(), times.end());
+
+	const std::vector<double> spatial_grid =
+		generator::grid(rate, kappa, theta, sigma, maturity, n_points);
+
+	const std::vector<std::vector<double>> func =
+		rollback(spatial_grid, claims, kappa, theta, sigma, dt_max);
+
+	std::vector<double> prices(claims.size(), 0.0);
+	for (int c = 0; c != claims.size(); ++c) {
+		prices[c] = interpolate(spatial_grid, func[c], rate);
+	}
+
+	return prices;
+
+}
+
+
+vasicek::tree::Tree vasicek::tree::build(
+	const double kappa,
+	const double sigma,
+	const double maturity,
+	const int n_steps,
+	const std::function<double(double)>& discount) {
+
+	NFS_SCOPE("vasicek::tree::build");
+
+	if (kappa <= 0.0) {
+		throw std::invalid_argument("Mean reversion should be positive.");
+	}
+	if (maturity <= 0.0 || n_steps < 1) {
+		throw std::invalid_argument("Maturity and number of steps should be positive.");
+	}
+
+	Tree tree;
+	tree.n_steps = n_steps;
+	tree.dt = maturity / n_steps;
+
+	// Mean and variance of change of x over one time step.
+	const double m = std::exp(-kappa * tree.dt) - 1.0;
+	const double v = y_func(kappa, sigma, tree.dt);
+
+	tree.dx = std::sqrt(3.0 * v);
+	tree.j_max = (int)std::ceil(0.184 / -m);
+
+	const int n_nodes = 2 * tree.j_max + 1;
+
+	tree.p_up.resize(n_nodes);
+	tree.p_mid.resize(n_nodes);
+	tree.p_down.resize(n_nodes);
+	tree.k.resize(n_nodes);
+
+	for (int j = -tree.j_max; j <= tree.j_max; ++j) {
+
+		const int idx = j + tree.j_max;
+		const double jm = j * m;
+
+		if (j == tree.j_max) {
+			tree.k[idx] = j - 1;
+			tree.p_up[idx] = 1.0 / 6.0 + (jm * jm + jm) / 2.0;
+			tree.p_mid[idx] = -1.0 / 3.0 - jm * jm - 2.0 * jm;
+			tree.p_down[idx] = 7.0 / 6.0 + (jm * jm + 3.0 * jm) / 2.0;
+		}
+		else if (j == -tree.j_max) {
+			tree.k[idx] = j + 1;
+			tree.p_up[idx] = 7.0 / 6.0 + (jm * jm - 3.0 * jm) / 2.0;
+			tree.p_mid[idx] = -1.0 / 3.0 - jm * jm + 2.0 * jm;
+			tree.p_down[idx] = 1.0 / 6.0 + (jm * jm - jm) / 2.0;
+		}
+		else {
+			tree.k[idx] = j;
+			tree.p_up[idx] = 1.0 / 6.0 + (jm * jm + jm) / 2.0;
+			tree.p_mid[idx] = 2.0 / 3.0 - jm * jm;
+			tree.p_down[idx] = 1.0 / 6.0 + (jm * jm - jm) / 2.0;
+		}
+
+	}
+
+	// Forward induction of Arrow-Debreu prices q, fitting alpha at each
+	// time step to the discount factor at the next tree date.
+	std::vector<double> q(n_nodes, 0.0);
+	std::vector<double> q_next(n_nodes, 0.0);
+	q[tree.j_max] = 1.0;
+
+	tree.alpha.resize(n_steps);
+	tree.node_discount.assign(n_steps, std::vector<double>(n_nodes, 0.0));
+
+	for (int step = 0; step != n_steps; ++step) {
+
+		const int width = std::min(step, tree.j_max);
+
+		double sum = 0.0;
+		for (int j = -width; j <= width; ++j) {
+			sum += q[j + tree.j_max] * std::exp(-j * tree.dx * tree.dt);
+		}
+
+		tree.alpha[step] = (std::log(sum) - std::log(discount((step + 1) * tree.dt))) / tree.dt;
+
+		std::vector<double>& node_discount = tree.node_discount[step];
+		for (int j = -tree.j_max; j <= tree.j_max; ++j) {
+			node_discount[j + tree.j_max] = std::exp(-(tree.alpha[step] + j * tree.dx) * tree.dt);
+		}
+
+		std::fill(q_next.begin(), q_next.end(), 0.0);
+		for (int j = -width; j <= width; ++j) {
+			const int idx = j + tree.j_max;
+			const int k = tree.k[idx] + tree.j_max;
+			const double value = q[idx] * node_discount[idx];
+			q_next[k + 1] += tree.p_up[idx] * value;
+			q_next[k] += tree.p_mid[idx] * value;
+			q_next[k - 1] += tree.p_down[idx] * value;
+		}
+		q.swap(q_next);
+
+	}
+
+	return tree;
+
+}
+
+
+std::vector<double> vasicek::tree::price(
+	const Tree& tree,
+	const std::vector<Claim>& claims) {
+
+	NFS_SCOPE("vasicek::tree::price");
+
+	const Events events = schedule(claims, tree.n_steps + 1, [&tree](const double time) {
+		const int step = (int)std::lround(time / tree.dt);
+		if (step > tree.n_steps) {
+			throw std::invalid_argument("Event after tree maturity.");
+		}
+		return step;
+	});
+
+	const int n_nodes = 2 * tree.j_max + 1;
+
+	std::vector<std::vector<double>> func(claims.size(), std::vector<double>(n_nodes, 0.0));
+	std::vector<double> tmp(n_nodes, 0.0);
+
+	apply(claims, events, tree.n_steps, func);
+
+	for (int step = tree.n_steps - 1; step >= 0; --step) {
+
+		const std::vector<double>& node_discount = tree.node_discount[step];
+
+		for (std::vector<double>& f : func) {
+
+			for (int idx = 0; idx != n_nodes; ++idx) {
+				const int k = tree.k[idx] + tree.j_max;
+				tmp[idx] = node_discount[idx] * (tree.p_up[idx] * f[k + 1]
+					+ tree.p_mid[idx] * f[k] + tree.p_down[idx] * f[k - 1]);
+			}
+			f.swap(tmp);
+
+		}
+
+		apply(claims, events, step, func);
+
+	}
+
+	std::vector<double> prices(claims.size(), 0.0);
+	for (int c = 0; c != claims.size(); ++c) {
+		prices[c] = func[c][tree.j_max];
+	}
+
+	return prices;
+
+}
@@ -1,6 +1,26 @@
 #pragma once
 
+#include <functional>
+#include <vector>
 
+#include "curve.h"
+
+
+// Vasicek short rate model,
+//	dr = kappa * (theta - r) * dt + sigma * dW,
+// and its Hull-White extension with time-dependent mean reversion level
+// theta(t) fitted to a discount curve (e.g. a curve::ZeroCurve).
+//
+// Claims on fixed cash flows (bonds and European bond options) are priced
+// in batches sharing the model parameters ("curve"):
+//	- Closed form: Zero-coupon bond prices exp(A - B * r), and options on
+//	  coupon bonds by Jamshidian decomposition.
+//	- PDE: Theta scheme rollback over a time grid containing all event
+//	  dates. The operator is factorized once per time step size (and per
+//	  value of theta(t)) and shared by all claims.
+//	- Trinomial tree: Hull-White tree fitted to the discount curve; node
+//	  discount factors are computed once and shared by all claims.
+// Times are measured from the valuation date, time 0.
 namespace vasicek {
 
 	/**
@@ -37,4 +57,223 @@ namespace vasicek {
 		const double theta,
 		const double sigma);
 
+	// Fixed cash flows (coupon bond), or a European option to buy (call) or
+	// sell (put) the cash flows paid after expiry for strike.
+	struct Claim {
+		std::vector<double> times;
+		std::vector<double> cash_flows;
+		bool option = false;
+		bool call = true;
+		double expiry = 0.0;
+		double strike = 0.0;
+	};
+
+	// Zero-coupon bond with unit notional.
+	namespace zcb {
+
+		// Price at time_1 of bond maturing at time_2, exp(A - B * rate).
+		double price(
+			const double rate,
+			const double time_1,
+			const double time_2,
+			const double kappa,
+			const double theta,
+			const double sigma);
+
+		// Prices at time of bonds maturing at each of maturities.
+		std::vector<double> price(
+			const double rate,
+			const double time,
+			const std::vector<double>& maturities,
+			const double kappa,
+			const double theta,
+			const double sigma);
+
+		// European call at time on bond maturing at maturity > expiry.
+		double call(
+			const double rate,
+			const double time,
+			const double expiry,
+			const double maturity,
+			const double strike,
+			const double kappa,
+			const double theta,
+			const double sigma);
+
+		// European put at time on bond maturing at maturity > expiry.
+		double put(
+			const double rate,
+			const double time,
+			const double expiry,
+			const double maturity,
+			const double strike,
+			const double kappa,
+			const double theta,
+			const double sigma);
+
+	}
+
+	// Closed form prices of claims. Discount factors of distinct payment
+	// dates are evaluated once for all claims.
+	std::vector<double> price(
+		const std::vector<Claim>& claims,
+		const double rate,
+		const double kappa,
+		const double theta,
+		const double sigma);
+
+	namespace hull_white {
+
+		// Mean reversion level theta(t) fitting the discount curve,
+		//	theta(t) = f(t) + f'(t) / kappa + sigma^2 * (1 - exp(-2 * kappa * t)) / (2 * kappa^2),
+		// where the instantaneous forward rate f(t) is found by central
+		// differences of log(discount) with step size "step".
+		std::function<double(double)> theta(
+			const std::function<double(double)>& discount,
+			const double kappa,
+			const double sigma,
+			const double step = 1.0e-3);
+
+		std::function<double(double)> theta(
+			const curve::ZeroCurve& curve,
+			const double kappa,
+			const double sigma,
+			const double step = 1.0e-3);
+
+	}
+
+	namespace pde {
+
+		namespace generator {
+
+			std::vector<std::vector<double>> prefactor(
+				const double kappa,
+				const double theta,
+				const double sigma,
+				const std::vector<double>& spatial_grid);
+
+			template <class T>
+			T derivative_full(
+				const double kappa,
+				const double theta,
+				const double sigma,
+				const std::vector<double>& spatial_grid,
+				const std::vector<std::function<T(std::vector<double>)>>& deriv) {
+
+				std::vector<std::vector<double>> prefactor_
+					= prefactor(kappa, theta, sigma, spatial_grid);
+
+				// Identity operator.
+				T identity = deriv[0](spatial_grid).identity();
+				T derivative = identity.pre_vector(prefactor_[0]);
+				// First order derivative operator.
+				derivative += deriv[0](spatial_grid).pre_vector(prefactor_[1]);
+				// Second order derivative operator.
+				derivative += deriv[1](spatial_grid).pre_vector(prefactor_[2]);
+
+				return derivative;
+
+			}
+
+			template <class T>
+			std::function<T(const std::vector<double>&)> derivative(
+				const double kappa,
+				const double theta,
+				const double sigma,
+				const std::vector<std::function<T(std::vector<double>)>>& deriv) {
+
+				return [kappa, theta, sigma, deriv](
+					const std::vector<double>& spatial_grid) {
+						return derivative_full<T>(kappa, theta, sigma, spatial_grid, deriv);
+					};
+
+			}
+
+			// Uniform short rate grid covering rate, theta, and n_std standard
+			// deviations of the short rate at maturity around these.
+			std::vector<double> grid(
+				const double rate,
+				const double kappa,
+				const double theta,
+				const double sigma,
+				const double maturity,
+				const int n_points,
+				const double n_std = 5.0);
+
+		}
+
+		// Solutions at time 0 of claims on spatial_grid. The time grid contains
+		// every payment date and expiry, with time steps no longer than dt_max.
+		// Cash flows are added at their payment dates; options are exercised at
+		// expiry.
+		std::vector<std::vector<double>> rollback(
+			const std::vector<double>& spatial_grid,
+			const std::vector<Claim>& claims,
+			const double kappa,
+			const std::function<double(double)>& theta,
+			const double sigma,
+			const double dt_max = 0.01,
+			const double theta_scheme = 0.5);
+
+		std::vector<std::vector<double>> rollback(
+			const std::vector<double>& spatial_grid,
+			const std::vector<Claim>& claims,
+			const double kappa,
+			const double theta,
+			const double sigma,
+			const double dt_max = 0.01,
+			const double theta_scheme = 0.5);
+
+		// Prices of claims at rate, see generator::grid and rollback.
+		std::vector<double> price(
+			const std::vector<Claim>& claims,
+			const double rate,
+			const double kappa,
+			const double theta,
+			const double sigma,
+			const int n_points = 201,
+			const double dt_max = 0.01);
+
+	}
+
+	// Trinomial tree of Hull and White (1994) for the short rate,
+	//	r = alpha(t) + x, dx = -kappa * x * dt + sigma * dW,
+	// with alpha fitted to discount factors at the tree dates.
+	namespace tree {
+
+		struct Tree {
+			int n_steps;
+			double dt;
+			double dx;
+			// Nodes j = -j_max, ..., j_max, index j + j_max.
+			int j_max;
+			// Fitted shift at each time step.
+			std::vector<double> alpha;
+			// Branching probabilities to nodes k + 1, k and k - 1 from node j,
+			// where k = j (interior), j - 1 (top) and j + 1 (bottom).
+			std::vector<double> p_up;
+			std::vector<double> p_mid;
+			std::vector<double> p_down;
+			std::vector<int> k;
+			// exp(-r * dt) at node (step, j), order (step, j).
+			std::vector<std::vector<double>> node_discount;
+		};
+
+		// Tree with n_steps uniform time steps up to maturity, fitted to
+		// discount(t), the price of a zero-coupon bond maturing at t.
+		Tree build(
+			const double kappa,
+			const double sigma,
+			const double maturity,
+			const int n_steps,
+			const std::function<double(double)>& discount);
+
+		// Prices of claims. Payment dates and expiries are moved to the
+		// nearest tree date, and should not exceed the tree maturity.
+		std::vector<double> price(
+			const Tree& tree,
+			const std::vector<Claim>& claims);
+
+	}
+
 }
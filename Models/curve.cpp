@@ -0,0 +1,515 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "curve.h"
+#include "instrumentation.h"
+
+
+namespace {
+
+	// Monotone convex interpolation: Types of g(x), the forward rate minus
+	// the discrete forward rate on an interval, see Hagan and West (2006).
+	// Intervals where g vanishes at one node are interpolated as type (i).
+	enum Type { type_zero = 0, type_i = 1, type_ii = 2, type_iii = 3, type_iv = 4 };
+
+	int classify(const double g0, const double g1) {
+
+		if (g0 == 0.0 && g1 == 0.0) {
+			return type_zero;
+		}
+		if (g0 == 0.0 || g1 == 0.0) {
+			return type_i;
+		}
+		if ((g0 < 0.0 && -0.5 * g0 <= g1 && g1 <= -2.0 * g0)
+			|| (g0 > 0.0 && -0.5 * g0 >= g1 && g1 >= -2.0 * g0)) {
+			return type_i;
+		}
+		if ((g0 < 0.0 && g1 > -2.0 * g0) || (g0 > 0.0 && g1 < -2.0 * g0)) {
+			return type_ii;
+		}
+		if ((g0 > 0.0 && 0.0 > g1 && g1 > -0.5 * g0)
+			|| (g0 < 0.0 && 0.0 < g1 && g1 < -0.5 * g0)) {
+			return type_iii;
+		}
+		return type_iv;
+
+	}
+
+	// Payment dates of fixed leg, backwards from maturity.
+	std::vector<double> schedule(const curve::Quote& quote) {
+
+		if (quote.tenor <= 0.0) {
+			throw std::invalid_argument("Tenor should be positive.");
+		}
+
+		std::vector<double> dates;
+		for (double t = quote.maturity; t > 1.0e-8; t -= quote.tenor) {
+			dates.push_back(t);
+		}
+		std::reverse(dates.begin(), dates.end());
+
+		return dates;
+
+	}
+
+}
+
+
+curve::ZeroCurve::ZeroCurve(
+	const std::vector<double>& times,
+	const std::vector<double>& zero_rates,
+	const Interpolation interpolation) :
+	interpolation_(interpolation),
+	f_end_(0.0) {
+
+	if (times.empty() || times.size() != zero_rates.size()) {
+		throw std::invalid_argument("Number of node times and zero rates differ.");
+	}
+
+	times_.push_back(0.0);
+	zero_.push_back(zero_rates[0]);
+	for (int i = 0; i != times.size(); ++i) {
+		if (times[i] <= times_.back()) {
+			throw std::invalid_argument("Node times should be positive and ascending.");
+		}
+		times_.push_back(times[i]);
+		zero_.push_back(zero_rates[i]);
+	}
+
+	const int n = n_nodes();
+
+	y_.assign(n + 1, 0.0);
+	fd_.assign(n + 1, 0.0);
+	type_.assign(n + 1, type_zero);
+	g0_.assign(n + 1, 0.0);
+	g1_.assign(n + 1, 0.0);
+	eta_.assign(n + 1, 0.0);
+	a_.assign(n + 1, 0.0);
+	fn_.assign(n + 1, 0.0);
+
+	update(1, n);
+
+}
+
+
+void curve::ZeroCurve::update(const int i_first, const int i_last) {
+
+	const int n = n_nodes();
+
+	// Linear interpolation: Flat zero rate before first node.
+	zero_[0] = zero_[1];
+
+	for (int i = i_first; i <= i_last; ++i) {
+		y_[i] = zero_[i] * times_[i];
+	}
+
+	for (int i = i_first; i <= std::min(n, i_last + 1); ++i) {
+		fd_[i] = (y_[i] - y_[i - 1]) / (times_[i] - times_[i - 1]);
+	}
+
+	if (interpolation_ == Interpolation::linear) {
+		const double slope = (zero_[n] - zero_[n - 1]) / (times_[n] - times_[n - 1]);
+		f_end_ = zero_[n] + times_[n] * slope;
+		return;
+	}
+
+	// Forward rates at interior nodes, weighted by interval lengths.
+	for (int i = std::max(1, i_first - 1); i <= std::min(n - 1, i_last + 1); ++i) {
+		const double dt_left = times_[i] - times_[i - 1];
+		const double dt_right = times_[i + 1] - times_[i];
+		fn_[i] = (dt_left * fd_[i + 1] + dt_right * fd_[i]) / (dt_left + dt_right);
+	}
+
+	// Forward rates at end points.
+	if (n == 1) {
+		fn_[0] = fd_[1];
+		fn_[1] = fd_[1];
+	}
+	else {
+		fn_[0] = fd_[1] - 0.5 * (fn_[1] - fd_[1]);
+		fn_[n] = fd_[n] - 0.5 * (fn_[n - 1] - fd_[n]);
+	}
+
+	for (int i = std::max(1, i_first - 1); i <= std::min(n, i_last + 2); ++i) {
+
+		const double g0 = fn_[i - 1] - fd_[i];
+		const double g1 = fn_[i] - fd_[i];
+
+		g0_[i] = g0;
+		g1_[i] = g1;
+		type_[i] = classify(g0, g1);
+
+		if (type_[i] == type_ii) {
+			eta_[i] = (g1 + 2.0 * g0) / (g1 - g0);
+		}
+		else if (type_[i] == type_iii) {
+			eta_[i] = 3.0 * g1 / (g1 - g0);
+		}
+		else if (type_[i] == type_iv) {
+			eta_[i] = g1 / (g1 + g0);
+			a_[i] = -g0 * g1 / (g0 + g1);
+		}
+
+	}
+
+	f_end_ = fn_[n];
+
+}
+
+
+int curve::ZeroCurve::interval(const double t, const int hint) const {
+
+	const int n = n_nodes();
+
+	// Same, next or previous interval.
+	for (const int i : { hint, hint + 1, hint - 1 }) {
+		if (i < 1 || i > n + 1) {
+			continue;
+		}
+		const bool above = i == 1 || t > times_[i - 1];
+		const bool below = i == n + 1 || t <= times_[i];
+		if (above && below) {
+			return i;
+		}
+	}
+
+	return (int)(std::lower_bound(times_.begin() + 1, times_.end(), t) - times_.begin());
+
+}
+
+
+double curve::ZeroCurve::y(const double t, const int i) const {
+
+	const int n = n_nodes();
+
+	if (i == n + 1) {
+		return y_[n] + f_end_ * (t - times_[n]);
+	}
+
+	const double dt = times_[i] - times_[i - 1];
+	const double x = (t - times_[i - 1]) / dt;
+
+	if (interpolation_ == Interpolation::linear) {
+		return (zero_[i - 1] + (zero_[i] - zero_[i - 1]) * x) * t;
+	}
+
+	const double g0 = g0_[i];
+	const double g1 = g1_[i];
+	const double eta = eta_[i];
+
+	// Integral of g from 0 to x.
+	double integral = 0.0;
+
+	switch (type_[i]) {
+
+	case type_i:
+		integral = g0 * (x - 2.0 * x * x + x * x * x) + g1 * (-x * x + x * x * x);
+		break;
+
+	case type_ii:
+		integral = g0 * x;
+		if (x > eta) {
+			integral += (g1 - g0) * std::pow(x - eta, 3) / (3.0 * (1.0 - eta) * (1.0 - eta));
+		}
+		break;
+
+	case type_iii:
+		integral = g1 * x;
+		if (x < eta) {
+			integral += (g0 - g1) * (std::pow(eta, 3) - std::pow(eta - x, 3)) / (3.0 * eta * eta);
+		}
+		else {
+			integral += (g0 - g1) * eta / 3.0;
+		}
+		break;
+
+	case type_iv: {
+		const double a = a_[i];
+		integral = a * x;
+		if (x < eta) {
+			integral += (g0 - a) * (std::pow(eta, 3) - std::pow(eta - x, 3)) / (3.0 * eta * eta);
+		}
+		else {
+			integral += (g0 - a) * eta / 3.0
+				+ (g1 - a) * std::pow(x - eta, 3) / (3.0 * (1.0 - eta) * (1.0 - eta));
+		}
+		break;
+	}
+
+	default:
+		break;
+
+	}
+
+	return y_[i - 1] + dt * (fd_[i] * x + integral);
+
+}
+
+
+double curve::ZeroCurve::forward(const double t, const int i) const {
+
+	const int n = n_nodes();
+
+	if (i == n + 1) {
+		return f_end_;
+	}
+
+	const double dt = times_[i] - times_[i - 1];
+	const double x = (t - times_[i - 1]) / dt;
+
+	if (interpolation_ == Interpolation::linear) {
+		const double slope = (zero_[i] - zero_[i - 1]) / dt;
+		return zero_[i - 1] + slope * (t - times_[i - 1]) + slope * t;
+	}
+
+	const double g0 = g0_[i];
+	const double g1 = g1_[i];
+	const double eta = eta_[i];
+
+	double g = 0.0;
+
+	switch (type_[i]) {
+
+	case type_i:
+		g = g0 * (1.0 - 4.0 * x + 3.0 * x * x) + g1 * (-2.0 * x + 3.0 * x * x);
+		break;
+
+	case type_ii:
+		g = x <= eta ? g0 : g0 + (g1 - g0) * std::pow((x - eta) / (1.0 - eta), 2);
+		break;
+
+	case type_iii:
+		g = x < eta ? g1 + (g0 - g1) * std::pow((eta - x) / eta, 2) : g1;
+		break;
+
+	case type_iv:
+		g = x < eta
+			? a_[i] + (g0 - a_[i]) * std::pow((eta - x) / eta, 2)
+			: a_[i] + (g1 - a_[i]) * std::pow((x - eta) / (1.0 - eta), 2);
+		break;
+
+	default:
+		break;
+
+	}
+
+	return fd_[i] + g;
+
+}
+
+
+std::vector<double> curve::ZeroCurve::times() const {
+	return std::vector<double>(times_.begin() + 1, times_.end());
+}
+
+
+std::vector<double> curve::ZeroCurve::zero_rates() const {
+	return std::vector<double>(zero_.begin() + 1, zero_.end());
+}
+
+
+double curve::ZeroCurve::zero(const double t) const {
+
+	const int i = interval(t, 1);
+
+	if (t <= 0.0) {
+		return forward(0.0, i);
+	}
+
+	return y(t, i) / t;
+
+}
+
+
+double curve::ZeroCurve::df(const double t) const {
+
+	return std::exp(-y(t, interval(t, 1)));
+
+}
+
+
+double curve::ZeroCurve::fwd(const double t) const {
+
+	return forward(t, interval(t, 1));
+
+}
+
+
+double curve::ZeroCurve::fwd(const double t1, const double t2) const {
+
+	if (t1 == t2) {
+		return fwd(t1);
+	}
+
+	const int i1 = interval(t1, 1);
+	const int i2 = interval(t2, i1);
+
+	return (y(t2, i2) - y(t1, i1)) / (t2 - t1);
+
+}
+
+
+std::vector<double> curve::ZeroCurve::df(const std::vector<double>& times) const {
+
+	std::vector<double> result(times.size(), 0.0);
+
+	int i = 1;
+	for (int k = 0; k != times.size(); ++k) {
+		i = interval(times[k], i);
+		result[k] = std::exp(-y(times[k], i));
+	}
+
+	return result;
+
+}
+
+
+std::vector<double> curve::ZeroCurve::fwd(
+	const std::vector<double>& times_1,
+	const std::vector<double>& times_2) const {
+
+	if (times_1.size() != times_2.size()) {
+		throw std::invalid_argument("Number of start and end times differ.");
+	}
+
+	std::vector<double> result(times_1.size(), 0.0);
+
+	int i1 = 1;
+	int i2 = 1;
+	for (int k = 0; k != times_1.size(); ++k) {
+
+		const double t1 = times_1[k];
+		const double t2 = times_2[k];
+
+		i1 = interval(t1, i1);
+		if (t1 == t2) {
+			result[k] = forward(t1, i1);
+			continue;
+		}
+		i2 = interval(t2, i2);
+
+		result[k] = (y(t2, i2) - y(t1, i1)) / (t2 - t1);
+
+	}
+
+	return result;
+
+}
+
+
+void curve::ZeroCurve::shift(const double amount) {
+
+	for (int i = 0; i != times_.size(); ++i) {
+		zero_[i] += amount;
+		y_[i] += amount * times_[i];
+		fd_[i] += amount;
+		fn_[i] += amount;
+	}
+	f_end_ += amount;
+
+}
+
+
+void curve::ZeroCurve::shift(const int node, const double amount) {
+
+	if (node < 0 || node >= n_nodes()) {
+		throw std::invalid_argument("Node index out of range.");
+	}
+
+	zero_[node + 1] += amount;
+	update(node + 1, node + 1);
+
+}
+
+
+double curve::residual(
+	const ZeroCurve& curve,
+	const Quote& quote) {
+
+	if (quote.kind == QuoteKind::deposit) {
+		return curve.df(quote.maturity) * (1.0 + quote.rate * quote.maturity) - 1.0;
+	}
+
+	const std::vector<double> dates = schedule(quote);
+	const std::vector<double> df = curve.df(dates);
+
+	double annuity = 0.0;
+	double previous = 0.0;
+	for (int j = 0; j != dates.size(); ++j) {
+		annuity += (dates[j] - previous) * df[j];
+		previous = dates[j];
+	}
+
+	return quote.rate * annuity + df.back() - 1.0;
+
+}
+
+
+curve::ZeroCurve curve::bootstrap(
+	std::vector<Quote> quotes,
+	const Interpolation interpolation,
+	const double tolerance) {
+
+	NFS_SCOPE("curve::bootstrap");
+
+	if (quotes.empty()) {
+		throw std::invalid_argument("No quotes.");
+	}
+
+	std::stable_sort(quotes.begin(), quotes.end(), [](const Quote& a, const Quote& b) {
+		return a.maturity < b.maturity;
+	});
+
+	// Initial guess: Quote rates.
+	std::vector<double> times;
+	std::vector<double> zero_rates;
+	for (const Quote& quote : quotes) {
+		times.push_back(quote.maturity);
+		zero_rates.push_back(quote.rate);
+	}
+
+	ZeroCurve curve(times, zero_rates, interpolation);
+
+	const double step_size = 1.0e-6;
+
+	for (int sweep = 0; sweep != 100; ++sweep) {
+
+		double max_change = 0.0;
+
+		for (int k = 0; k != quotes.size(); ++k) {
+
+			double change = 0.0;
+
+			for (int iteration = 0; iteration != 50; ++iteration) {
+
+				const double value = residual(curve, quotes[k]);
+
+				// Secant derivative; shifts only update adjacent intervals.
+				curve.shift(k, step_size);
+				const double value_shifted = residual(curve, quotes[k]);
+				curve.shift(k, -step_size);
+
+				const double step = -value * step_size / (value_shifted - value);
+				curve.shift(k, step);
+				change += step;
+
+				if (std::abs(step) < tolerance) {
+					break;
+				}
+
+			}
+
+			max_change = std::max(max_change, std::abs(change));
+
+		}
+
+		if (max_change < tolerance) {
+			return curve;
+		}
+
+	}
+
+	throw std::runtime_error("Bootstrap did not converge.");
+
+}
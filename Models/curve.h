@@ -0,0 +1,140 @@
+#pragma once
+
+#include <vector>
+
+
+// Term structure of interest rates.
+//
+// A zero curve is given by zero rates (continuous compounding) at node
+// times. Between nodes the curve is interpolated either linearly in zero
+// rate, or by the monotone convex method of Hagan and West (2006), which
+// gives continuous instantaneous forward rates.
+// Beyond the last node the instantaneous forward rate is flat.
+//
+// Interpolation coefficients are stored per interval. Batch evaluation of
+// discount factors and forward rates reuses the interval of the previous
+// time as a starting guess, hence sorted times need no search. Shifts of
+// zero rates update only the intervals affected.
+//
+// References:
+// - Hagan and West (2006), Interpolation methods for curve construction.
+namespace curve {
+
+	enum class Interpolation { linear, monotone_convex };
+
+	class ZeroCurve {
+
+	private:
+
+		Interpolation interpolation_;
+
+		// Node times and zero rates. Index 0 is the origin, t = 0.
+		std::vector<double> times_;
+		std::vector<double> zero_;
+		// zero * time.
+		std::vector<double> y_;
+
+		// Per interval (t_{i - 1}, t_i], i = 1, ..., n:
+		// Discrete forward rate, and monotone convex coefficients.
+		std::vector<double> fd_;
+		std::vector<int> type_;
+		std::vector<double> g0_;
+		std::vector<double> g1_;
+		std::vector<double> eta_;
+		std::vector<double> a_;
+
+		// Instantaneous forward rates at nodes (monotone convex).
+		std::vector<double> fn_;
+
+		// Instantaneous forward rate beyond last node.
+		double f_end_;
+
+		int n_nodes() const {
+			return (int)times_.size() - 1;
+		}
+
+		// Update coefficients of intervals i_first, ..., i_last after change
+		// of zero rates.
+		void update(const int i_first, const int i_last);
+
+		// Interval index i such that t is in (t_{i - 1}, t_i]. Times beyond
+		// the last node have index n + 1. hint and its neighbours are checked
+		// first.
+		int interval(const double t, const int hint) const;
+
+		// zero * time, and instantaneous forward rate, at t in interval i.
+		double y(const double t, const int i) const;
+		double forward(const double t, const int i) const;
+
+	public:
+
+		// Node times in ascending order, positive.
+		ZeroCurve(
+			const std::vector<double>& times,
+			const std::vector<double>& zero_rates,
+			const Interpolation interpolation = Interpolation::linear);
+
+		Interpolation interpolation() const {
+			return interpolation_;
+		}
+
+		// Node times and zero rates, excluding origin.
+		std::vector<double> times() const;
+		std::vector<double> zero_rates() const;
+
+		double zero(const double t) const;
+
+		double df(const double t) const;
+
+		// Instantaneous forward rate.
+		double fwd(const double t) const;
+
+		// Forward rate between t1 and t2 (continuous compounding).
+		double fwd(const double t1, const double t2) const;
+
+		// Batch evaluation. Sorted times (ascending or descending) are
+		// evaluated without search.
+		std::vector<double> df(const std::vector<double>& times) const;
+
+		std::vector<double> fwd(
+			const std::vector<double>& times_1,
+			const std::vector<double>& times_2) const;
+
+		// Parallel shift of zero rates. Interpolation coefficients are
+		// invariant and are not recomputed.
+		void shift(const double amount);
+
+		// Shift of zero rate at node (key rate shift). Only the intervals
+		// adjacent to the node are updated.
+		void shift(const int node, const double amount);
+
+	};
+
+	enum class QuoteKind { deposit, swap };
+
+	// Market quote.
+	//	- Deposit: Simple rate, df(maturity) = 1 / (1 + rate * maturity).
+	//	- Swap: Par rate of fixed leg paying every tenor years, backwards from
+	//	  maturity (short first period), against a floating leg at par.
+	struct Quote {
+		QuoteKind kind = QuoteKind::deposit;
+		double maturity = 1.0;
+		double rate = 0.0;
+		double tenor = 1.0;
+	};
+
+	// Zero curve with a node at each quote maturity, repricing all quotes.
+	// Nodes are solved one by one by Newton iterations; since monotone
+	// convex intervals depend on neighbouring nodes, the sweep over nodes is
+	// repeated until the zero rates change less than tolerance.
+	ZeroCurve bootstrap(
+		std::vector<Quote> quotes,
+		const Interpolation interpolation = Interpolation::linear,
+		const double tolerance = 1.0e-12);
+
+	// Value of quote minus par (zero if the curve reprices the quote).
+	double residual(
+		const ZeroCurve& curve,
+		const Quote& quote);
+
+}
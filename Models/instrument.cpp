@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "band_diagonal_factorized.h"
+#include "derivatives.h"
+#include "grid.h"
+#include "instrument.h"
+#include "instrumentation.h"
+
+
+Bond::Bond(
+	const std::vector<double>& event_grid,
+	const std::vector<double>& cash_flows) :
+	event_grid(event_grid),
+	cash_flows(cash_flows),
+	maturity_idx((int)event_grid.size() - 1) {
+
+	if (event_grid.empty() || event_grid.size() != cash_flows.size()) {
+		throw std::invalid_argument("Number of event dates and cash flows differ.");
+	}
+	if (!std::is_sorted(event_grid.begin(), event_grid.end())) {
+		throw std::invalid_argument("Event dates should be in ascending order.");
+	}
+
+}
+
+
+double Bond::interpolate(
+	const std::vector<std::vector<double>>& solution,
+	const double spot,
+	const int event_idx) const {
+
+	if (solution.empty()) {
+		throw std::runtime_error("Bond has not been rolled back.");
+	}
+	if (event_idx < 0 || event_idx > maturity_idx) {
+		throw std::invalid_argument("Event index out of range.");
+	}
+
+	const std::vector<double>& func = solution[event_idx];
+
+	// Constant extrapolation.
+	if (spot <= spatial_grid.front()) {
+		return func.front();
+	}
+	if (spot >= spatial_grid.back()) {
+		return func.back();
+	}
+
+	const int i = (int)(std::upper_bound(spatial_grid.begin(), spatial_grid.end(), spot)
+		- spatial_grid.begin()) - 1;
+	const double weight = (spot - spatial_grid[i]) / (spatial_grid[i + 1] - spatial_grid[i]);
+
+	return (1.0 - weight) * func[i] + weight * func[i + 1];
+
+}
+
+
+double Bond::payoff(const double) const {
+
+	return cash_flows[maturity_idx];
+
+}
+
+
+double Bond::price(
+	const double spot,
+	const int event_idx) const {
+
+	return interpolate(prices, spot, event_idx);
+
+}
+
+
+double Bond::delta(
+	const double spot,
+	const int event_idx) const {
+
+	return interpolate(deltas, spot, event_idx);
+
+}
+
+
+double Bond::gamma(
+	const double spot,
+	const int event_idx) const {
+
+	return interpolate(gammas, spot, event_idx);
+
+}
+
+
+double Bond::theta(
+	const double spot,
+	const int event_idx) const {
+
+	return interpolate(thetas, spot, event_idx);
+
+}
+
+
+BondRollback::BondRollback(
+	const std::vector<Bond>& bonds,
+	const std::vector<double>& spatial_grid,
+	const double dt_max) :
+	bonds_(bonds),
+	spatial_grid_(spatial_grid),
+	kappa_(0.0),
+	sigma_(0.0),
+	base_valid_(false) {
+
+	NFS_SCOPE("BondRollback::BondRollback");
+
+	std::vector<double> events;
+	for (const Bond& bond : bonds_) {
+		events.insert(events.end(), bond.event_grid.begin(), bond.event_grid.end());
+	}
+
+	time_grid_ = grid::with_events(events, dt_max);
+
+	flows_.resize(time_grid_.size());
+	events_.resize(time_grid_.size());
+
+	for (int b = 0; b != bonds_.size(); ++b) {
+		const Bond& bond = bonds_[b];
+		for (int e = 0; e != bond.event_grid.size(); ++e) {
+			const int index = grid::find(time_grid_, bond.event_grid[e]);
+			if (bond.cash_flows[e] != 0.0) {
+				flows_[index].push_back({ b, bond.cash_flows[e] });
+			}
+			events_[index].push_back({ b, e });
+		}
+	}
+
+	d1_ = d1dx1::nonuniform::c2b2(spatial_grid_);
+	d2_ = d2dx2::nonuniform::c2b1(spatial_grid_);
+	identity_ = d1_.identity();
+
+}
+
+
+TriDiagonal BondRollback::derivative(const double theta) {
+
+	TriDiagonal result = d1_;
+	result *= kappa_ * theta;
+	result += base_;
+
+	return result;
+
+}
+
+
+void BondRollback::solve(
+	const double kappa,
+	const std::function<double(double)>& theta,
+	const double sigma,
+	const double theta_scheme) {
+
+	NFS_SCOPE("BondRollback::solve");
+
+	if (!base_valid_ || kappa != kappa_ || sigma != sigma_) {
+
+		std::vector<double> rate(spatial_grid_.size(), 0.0);
+		std::vector<double> drift(spatial_grid_.size(), 0.0);
+		for (int i = 0; i != spatial_grid_.size(); ++i) {
+			rate[i] = -spatial_grid_[i];
+			drift[i] = -kappa * spatial_grid_[i];
+		}
+
+		base_ = identity_.pre_vector(rate);
+		base_ += d1_.pre_vector(drift);
+		TriDiagonal tmp = d2_;
+		tmp *= 0.5 * sigma * sigma;
+		base_ += tmp;
+
+		kappa_ = kappa;
+		sigma_ = sigma;
+		base_valid_ = true;
+
+	}
+
+	const int n_points = (int)spatial_grid_.size();
+	const int n_steps = (int)time_grid_.size() - 1;
+
+	std::vector<std::vector<double>> func(bonds_.size(), std::vector<double>(n_points, 0.0));
+	std::vector<double> tmp(n_points, 0.0);
+
+	for (Bond& bond : bonds_) {
+		const int n_events = (int)bond.event_grid.size();
+		bond.spatial_grid = spatial_grid_;
+		bond.prices.assign(n_events, std::vector<double>());
+		bond.deltas.assign(n_events, std::vector<double>());
+		bond.gammas.assign(n_events, std::vector<double>());
+		bond.thetas.assign(n_events, std::vector<double>());
+	}
+
+	// Add cash flows at time grid index, and store prices and Greeks of
+	// bonds with events at index. derivative_t is L at the event date.
+	auto apply_events = [&](const int index, const TriDiagonal& derivative_t) {
+
+		for (const std::pair<int, double>& flow : flows_[index]) {
+			for (double& value : func[flow.first]) {
+				value += flow.second;
+			}
+		}
+
+		for (const std::pair<int, int>& event : events_[index]) {
+
+			Bond& bond = bonds_[event.first];
+			const std::vector<double>& f = func[event.first];
+
+			std::vector<double> result(n_points, 0.0);
+
+			bond.prices[event.second] = f;
+
+			matrix_multiply_vector<TriDiagonal>(d1_, f, result);
+			bond.deltas[event.second] = result;
+
+			std::fill(result.begin(), result.end(), 0.0);
+			matrix_multiply_vector<TriDiagonal>(d2_, f, result);
+			bond.gammas[event.second] = result;
+
+			// dV/dt = -L V.
+			std::fill(result.begin(), result.end(), 0.0);
+			matrix_multiply_vector<TriDiagonal>(derivative_t, f, result);
+			for (double& value : result) {
+				value = -value;
+			}
+			bond.thetas[event.second] = result;
+
+		}
+
+	};
+
+	apply_events(n_steps, derivative(theta(time_grid_[n_steps])));
+
+	// Right-hand-side operator, evaluated at t + dt, and factorized
+	// left-hand-side operator, evaluated at t. Each is updated only if theta
+	// or the time step changes.
+	TriDiagonal rhs;
+	TriDiagonal lhs_derivative;
+	FactorizedBandDiagonal lhs;
+	double rhs_theta = 0.0;
+	double rhs_dt = 0.0;
+	double lhs_theta = 0.0;
+	double lhs_dt = 0.0;
+
+	for (int i = n_steps - 1; i >= 0; --i) {
+
+		const double dt = time_grid_[i + 1] - time_grid_[i];
+		const double theta_1 = theta(time_grid_[i + 1]);
+		const double theta_0 = theta(time_grid_[i]);
+
+		// Time steps between events are uniform up to rounding.
+		if (std::abs(dt - rhs_dt) > 1.0e-12 * dt || theta_1 != rhs_theta) {
+			rhs = derivative(theta_1);
+			rhs *= (1.0 - theta_scheme) * dt;
+			rhs += identity_;
+			rhs_theta = theta_1;
+			rhs_dt = dt;
+		}
+
+		if (std::abs(dt - lhs_dt) > 1.0e-12 * dt || theta_0 != lhs_theta) {
+			lhs_derivative = derivative(theta_0);
+			TriDiagonal matrix = lhs_derivative;
+			matrix *= -theta_scheme * dt;
+			matrix += identity_;
+			lhs = FactorizedBandDiagonal(matrix);
+			lhs_theta = theta_0;
+			lhs_dt = dt;
+		}
+
+		for (std::vector<double>& f : func) {
+			std::fill(tmp.begin(), tmp.end(), 0.0);
+			matrix_multiply_vector<TriDiagonal>(rhs, f, tmp);
+			f.swap(tmp);
+			lhs.solve(f);
+		}
+
+		apply_events(i, lhs_derivative);
+
+	}
+
+}
+
+
+void BondRollback::solve(
+	const double kappa,
+	const double theta,
+	const double sigma,
+	const double theta_scheme) {
+
+	solve(kappa, [theta](const double) { return theta; }, sigma, theta_scheme);
+
+}
@@ -1,54 +1,174 @@
 #pragma once
 
+#include <functional>
+#include <utility>
 #include <vector>
 
+#include "band_diagonal_matrix.h"
+
+
+class BondRollback;
+
+
 /**
- * @brief 
+ * @brief Fixed cash flows paid at the dates of event_grid, valued under
+ * the Vasicek/Hull-White short rate model by BondRollback.
+ *
+ * Prices and Greeks are functions of the short rate ("spot") at an event
+ * date, and include the cash flow paid at that date. The valuation date is
+ * an event date if event_grid starts at 0 (with zero cash flow).
 */
 class Bond {
 
 private:
 
 	std::vector<double> event_grid;
+	std::vector<double> cash_flows;
 	int maturity_idx;
 
+	// Set by BondRollback: Short rate grid, and price, delta, gamma and theta
+	// on the grid at each event date.
+	std::vector<double> spatial_grid;
+	std::vector<std::vector<double>> prices;
+	std::vector<std::vector<double>> deltas;
+	std::vector<std::vector<double>> gammas;
+	std::vector<std::vector<double>> thetas;
+
+	friend class BondRollback;
+
+	// Linear interpolation of solution at event_idx.
+	double interpolate(
+		const std::vector<std::vector<double>>& solution,
+		const double spot,
+		const int event_idx) const;
+
 public:
 
-	Bond();
+	/**
+	 * @brief
+	 * @param event_grid Event dates in ascending order.
+	 * @param cash_flows Cash flow at each event date, including the notional.
+	*/
+	Bond(
+		const std::vector<double>& event_grid,
+		const std::vector<double>& cash_flows);
 
-	double maturity() {
+	double maturity() const {
 
 		return event_grid[maturity_idx];
 
 	}
 
+	const std::vector<double>& events() const {
+		return event_grid;
+	}
+
 	/**
-	 * @brief 
-	 * @param spot 
-	 * @return 
+	 * @brief Value at maturity.
+	 * @param spot
+	 * @return
 	*/
-	double payoff(const double spot);
+	double payoff(const double spot) const;
 
 	double price(
 		const double spot,
-		const int event_idx);
+		const int event_idx) const;
 
 	/**
-	 * @brief 
-	 * @param spot 
-	 * @param event_idx 
-	 * @return 
+	 * @brief Derivative of price with respect to short rate.
+	 * @param spot
+	 * @param event_idx
+	 * @return
 	*/
 	double delta(
 		const double spot,
-		const int event_idx);
+		const int event_idx) const;
 
 	double gamma(
 		const double spot,
-		const int event_idx);
+		const int event_idx) const;
 
+	// Derivative of price with respect to calendar time, just before the
+	// event date.
 	double theta(
 		const double spot,
-		const int event_idx);
+		const int event_idx) const;
+
+};
+
+
+// Event-driven theta scheme rollback of a ladder of bonds under the
+// Vasicek/Hull-White short rate model,
+//	dV/dt + kappa * (theta(t) - r) * dV/dr + 0.5 * sigma^2 * d2V/dr2 - r * V = 0.
+//
+// The time grid contains the event dates of all bonds. Time-invariant work
+// is carried out once, in the constructor: time grid, cash flows at each
+// time grid index, and finite difference operators on the short rate grid.
+// The operator is split as
+//	L(t) = L_0 + kappa * theta(t) * D1,  L_0 = -r - kappa * r * D1 + 0.5 * sigma^2 * D2,
+// where L_0 is cached for (kappa, sigma); repricing under a shifted curve
+// theta(t) only adds the drift term. Each time step is factorized once and
+// applied to all bonds.
+class BondRollback {
+
+private:
+
+	std::vector<Bond> bonds_;
+
+	std::vector<double> spatial_grid_;
+	std::vector<double> time_grid_;
+
+	// Cash flows, (bond index, amount), and events, (bond index, event
+	// index), at each time grid index.
+	std::vector<std::vector<std::pair<int, double>>> flows_;
+	std::vector<std::vector<std::pair<int, int>>> events_;
+
+	TriDiagonal identity_;
+	TriDiagonal d1_;
+	TriDiagonal d2_;
+
+	// L_0, valid for (kappa_, sigma_).
+	TriDiagonal base_;
+	double kappa_;
+	double sigma_;
+	bool base_valid_;
+
+	// L(t) for given theta(t).
+	TriDiagonal derivative(const double theta);
+
+public:
+
+	// Short rate grid, see vasicek::pde::generator::grid. Time steps between
+	// event dates are no longer than dt_max.
+	BondRollback(
+		const std::vector<Bond>& bonds,
+		const std::vector<double>& spatial_grid,
+		const double dt_max = 0.01);
+
+	const std::vector<Bond>& bonds() const {
+		return bonds_;
+	}
+
+	const Bond& bond(const int idx) const {
+		return bonds_[idx];
+	}
+
+	const std::vector<double>& time_grid() const {
+		return time_grid_;
+	}
+
+	// Roll back all bonds in one pass, and store prices and Greeks at the
+	// event dates of each bond.
+	void solve(
+		const double kappa,
+		const std::function<double(double)>& theta,
+		const double sigma,
+		const double theta_scheme = 0.5);
+
+	void solve(
+		const double kappa,
+		const double theta,
+		const double sigma,
+		const double theta_scheme = 0.5);
 
 };
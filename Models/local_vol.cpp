@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "local_vol.h"
+#include "SabrUtility.h"
+
+
+local_vol::Surface::Surface(
+	const std::vector<double>& times,
+	const std::vector<double>& spots,
+	const std::vector<double>& variance) :
+	times_(times), spots_(spots), variance_(variance) {
+
+	if (times_.empty() || spots_.empty()) {
+		throw std::invalid_argument("Surface should have at least one time and one spot.");
+	}
+
+	if (variance_.size() != times_.size() * spots_.size()) {
+		throw std::invalid_argument("Number of variances should be n_times * n_spots.");
+	}
+
+	for (int i = 1; i < (int)times_.size(); ++i) {
+		if (times_[i] <= times_[i - 1]) {
+			throw std::invalid_argument("Times should be in ascending order.");
+		}
+	}
+
+	for (int j = 1; j < (int)spots_.size(); ++j) {
+		if (spots_[j] <= spots_[j - 1]) {
+			throw std::invalid_argument("Spots should be in ascending order.");
+		}
+	}
+
+}
+
+
+std::pair<int, double> local_vol::Surface::locate(
+	const std::vector<double>& grid,
+	const double x) {
+
+	const int n = (int)grid.size();
+
+	if (n == 1 || x <= grid.front()) {
+		return { 0, 0.0 };
+	}
+
+	if (x >= grid.back()) {
+		return { n - 2, 1.0 };
+	}
+
+	const int i = (int)(std::upper_bound(grid.begin(), grid.end(), x) - grid.begin()) - 1;
+
+	return { i, (x - grid[i]) / (grid[i + 1] - grid[i]) };
+
+}
+
+
+double local_vol::Surface::variance(
+	const double time,
+	const double spot) const {
+
+	const std::pair<int, double> t = locate(times_, time);
+	const std::pair<int, double> s = locate(spots_, spot);
+
+	const int t_next = std::min(t.first + 1, n_times() - 1);
+	const int s_next = std::min(s.first + 1, n_spots() - 1);
+
+	const double* row_1 = row(t.first);
+	const double* row_2 = row(t_next);
+
+	const double v1 = (1.0 - s.second) * row_1[s.first] + s.second * row_1[s_next];
+	const double v2 = (1.0 - s.second) * row_2[s.first] + s.second * row_2[s_next];
+
+	return (1.0 - t.second) * v1 + t.second * v2;
+
+}
+
+
+double local_vol::Surface::vol(
+	const double time,
+	const double spot) const {
+
+	return std::sqrt(variance(time, spot));
+
+}
+
+
+void local_vol::Surface::variance(
+	const double time,
+	std::vector<double>& result) const {
+
+	const std::pair<int, double> t = locate(times_, time);
+
+	const double* row_1 = row(t.first);
+
+	if (t.second == 0.0) {
+		std::copy(row_1, row_1 + n_spots(), result.begin());
+		return;
+	}
+
+	const double* row_2 = row(t.first + 1);
+	const double w = t.second;
+
+	for (int j = 0; j != n_spots(); ++j) {
+		result[j] = (1.0 - w) * row_1[j] + w * row_2[j];
+	}
+
+}
+
+
+local_vol::Surface local_vol::dupire(
+	const ImpliedVol& implied_vol,
+	const double spot,
+	const curve::ZeroCurve& curve,
+	const std::vector<double>& times,
+	const std::vector<double>& spots,
+	const double step_t,
+	const double step_y,
+	const double vol_min,
+	const double vol_max) {
+
+	NFS_SCOPE("local_vol::dupire");
+
+	const int n_times = (int)times.size();
+	const int n_spots = (int)spots.size();
+
+	const double variance_min = vol_min * vol_min;
+	const double variance_max = vol_max * vol_max;
+
+	// Total implied variance at maturity and log-moneyness.
+	auto total_variance = [&](const double maturity, const double y) {
+		const double forward = spot / curve.df(maturity);
+		const double vol = implied_vol(maturity, forward * std::exp(y));
+		return vol * vol * maturity;
+	};
+
+	// Index of first positive spot.
+	const int j_first = (int)(std::upper_bound(spots.begin(), spots.end(), 0.0) - spots.begin());
+	if (j_first == n_spots) {
+		throw std::invalid_argument("Spot grid should contain positive spots.");
+	}
+
+	std::vector<double> variance(times.size() * spots.size(), 0.0);
+
+	for (int i = 0; i != n_times; ++i) {
+
+		const double maturity = std::max(times[i], 2.0 * step_t);
+		const double forward = spot / curve.df(maturity);
+
+		double* row = variance.data() + (size_t)i * n_spots;
+
+		for (int j = j_first; j != n_spots; ++j) {
+
+			const double y = std::log(spots[j] / forward);
+
+			const double w = total_variance(maturity, y);
+			const double w_up = total_variance(maturity, y + step_y);
+			const double w_down = total_variance(maturity, y - step_y);
+
+			const double dwdt = (total_variance(maturity + step_t, y)
+				- total_variance(maturity - step_t, y)) / (2.0 * step_t);
+			const double dwdy = (w_up - w_down) / (2.0 * step_y);
+			const double d2wdy2 = (w_up - 2.0 * w + w_down) / (step_y * step_y);
+
+			const double denominator = 1.0 - y / w * dwdy
+				+ 0.25 * (-0.25 - 1.0 / w + y * y / (w * w)) * dwdy * dwdy
+				+ 0.5 * d2wdy2;
+
+			double local = variance_min;
+			if (denominator > 0.0 && dwdt > 0.0) {
+				local = dwdt / denominator;
+			}
+			row[j] = std::min(std::max(local, variance_min), variance_max);
+
+		}
+
+		for (int j = 0; j != j_first; ++j) {
+			row[j] = row[j_first];
+		}
+
+	}
+
+	return Surface(times, spots, variance);
+
+}
+
+
+local_vol::Surface local_vol::dupire(
+	const ImpliedVol& implied_vol,
+	const double spot,
+	const double rate,
+	const std::vector<double>& times,
+	const std::vector<double>& spots,
+	const double step_t,
+	const double step_y,
+	const double vol_min,
+	const double vol_max) {
+
+	const curve::ZeroCurve flat({ 1.0 }, { rate });
+
+	return dupire(implied_vol, spot, flat, times, spots, step_t, step_y, vol_min, vol_max);
+
+}
+
+
+local_vol::ImpliedVol local_vol::sabr(
+	const double spot,
+	const curve::ZeroCurve& curve,
+	const double spot_vol,
+	const double alpha,
+	const double beta,
+	const double rho) {
+
+	return [spot, curve, spot_vol, alpha, beta, rho](const double maturity, const double strike) {
+
+		const double forward = spot / curve.df(maturity);
+
+		// Half-width of at-the-money region, in log-moneyness.
+		const double epsilon = 1.0e-6;
+
+		if (std::abs(std::log(strike / forward)) < epsilon) {
+			const double vol_up = sabr::implied_vol::black_scholes(
+				forward, spot_vol, alpha, beta, rho, forward * std::exp(epsilon), maturity);
+			const double vol_down = sabr::implied_vol::black_scholes(
+				forward, spot_vol, alpha, beta, rho, forward * std::exp(-epsilon), maturity);
+			return 0.5 * (vol_up + vol_down);
+		}
+
+		return sabr::implied_vol::black_scholes(
+			forward, spot_vol, alpha, beta, rho, strike, maturity);
+
+	};
+
+}
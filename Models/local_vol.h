@@ -0,0 +1,307 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "curve.h"
+#include "instrumentation.h"
+#include "matrix_equation_solver.h"
+
+
+// Local volatility model,
+//	dS = r(t) * S * dt + sigma_loc(t, S) * S * dW,
+// with sigma_loc found from an implied volatility surface by Dupire's
+// formula.
+//
+// The local variance sigma_loc^2 is tabulated once on a (time x spot) grid,
+// stored row by row (one contiguous row of spots per time). The spot grid
+// is the spatial grid of the PDE, hence a time step reads (or linearly
+// interpolates in time) whole rows, and updates the operator diagonals in
+// place, without allocations and without spot lookups.
+//
+// References:
+// - Dupire (1994), Pricing with a smile.
+// - Gatheral (2006), The volatility surface, Eq. (1.10).
+namespace local_vol {
+
+	// Implied volatility as function of (maturity, strike).
+	using ImpliedVol = std::function<double(double, double)>;
+
+	// Local variance on a (time x spot) grid. Between grid points the
+	// variance is interpolated bilinearly, and is flat beyond the grid.
+	class Surface {
+
+	private:
+
+		std::vector<double> times_;
+		std::vector<double> spots_;
+
+		// Local variance at (times_[i], spots_[j]), index i * n_spots + j.
+		std::vector<double> variance_;
+
+		// Index i such that grid[i] <= x < grid[i + 1], and interpolation
+		// weight of grid[i + 1].
+		static std::pair<int, double> locate(
+			const std::vector<double>& grid,
+			const double x);
+
+	public:
+
+		// Times and spots in ascending order; variance in row-major order.
+		Surface(
+			const std::vector<double>& times,
+			const std::vector<double>& spots,
+			const std::vector<double>& variance);
+
+		const std::vector<double>& times() const {
+			return times_;
+		}
+
+		const std::vector<double>& spots() const {
+			return spots_;
+		}
+
+		int n_times() const {
+			return (int)times_.size();
+		}
+
+		int n_spots() const {
+			return (int)spots_.size();
+		}
+
+		// Local variance at times()[idx], on the spot grid.
+		const double* row(const int idx) const {
+			return variance_.data() + (size_t)idx * spots_.size();
+		}
+
+		double variance(const double time, const double spot) const;
+
+		double vol(const double time, const double spot) const;
+
+		// Local variance at time on the spot grid, interpolated linearly
+		// between rows. result should have n_spots elements.
+		void variance(
+			const double time,
+			std::vector<double>& result) const;
+
+	};
+
+	// Local variance by Dupire's formula in terms of the total implied
+	// variance w(T, y) = sigma_imp^2 * T and log-moneyness y = log(K / F(T)),
+	// F(T) = spot / df(T):
+	//	sigma_loc^2 = dw/dT / (1 - y / w * dw/dy
+	//		+ (-1 / 4 - 1 / w + y^2 / w^2) * (dw/dy)^2 / 4 + d2w/dy2 / 2).
+	// Derivatives are found by central differences with steps step_t and
+	// step_y; times below 2 * step_t are evaluated at 2 * step_t.
+	// Arbitrage in the implied surface gives negative local variances; the
+	// result is limited to [vol_min^2, vol_max^2]. Local variances at
+	// non-positive spots (the lower boundary of the PDE grid) are copied
+	// from the nearest positive spot.
+	Surface dupire(
+		const ImpliedVol& implied_vol,
+		const double spot,
+		const curve::ZeroCurve& curve,
+		const std::vector<double>& times,
+		const std::vector<double>& spots,
+		const double step_t = 1.0e-3,
+		const double step_y = 1.0e-3,
+		const double vol_min = 0.01,
+		const double vol_max = 2.0);
+
+	Surface dupire(
+		const ImpliedVol& implied_vol,
+		const double spot,
+		const double rate,
+		const std::vector<double>& times,
+		const std::vector<double>& spots,
+		const double step_t = 1.0e-3,
+		const double step_y = 1.0e-3,
+		const double vol_min = 0.01,
+		const double vol_max = 2.0);
+
+	// Implied volatility of the SABR model (Hagan et al.) for forward
+	// spot / df(T), see sabr::implied_vol::black_scholes. The at-the-money
+	// singularity of the expansion is removed by symmetric averaging.
+	ImpliedVol sabr(
+		const double spot,
+		const curve::ZeroCurve& curve,
+		const double spot_vol,
+		const double alpha,
+		const double beta,
+		const double rho);
+
+	namespace pde {
+
+		// result = identity + scale_a * a + (scale_b * vector) * b, where the
+		// vector multiplies the rows of b. Matrices should have the same
+		// order and boundary layout; result is overwritten in place.
+		template <class T>
+		void combine(
+			const T& identity,
+			const double scale_a,
+			const T& a,
+			const double scale_b,
+			const std::vector<double>& vector,
+			const T& b,
+			T& result) {
+
+			const int n_rows = result.n_boundary_rows();
+			const int n_diagonals = result.n_diagonals();
+
+			// Interior rows.
+			for (int j = 0; j != n_diagonals; ++j) {
+
+				const double* id = identity.matrix[j].data();
+				const double* pa = a.matrix[j].data();
+				const double* pb = b.matrix[j].data();
+				double* out = result.matrix[j].data();
+
+				for (int i = n_rows; i != result.order() - n_rows; ++i) {
+					out[i] = id[i] + scale_a * pa[i] + scale_b * vector[i] * pb[i];
+				}
+
+			}
+
+			// Boundary rows, see row_multiply_matrix.
+			for (int i = 0; i != 2 * n_rows; ++i) {
+
+				const int row = i < n_rows ? i : (int)vector.size() - 2 * n_rows + i;
+				const double factor = scale_b * vector[row];
+
+				for (int j = 0; j != result.n_boundary_elements(); ++j) {
+					result.boundary_rows[i][j] = identity.boundary_rows[i][j]
+						+ scale_a * a.boundary_rows[i][j] + factor * b.boundary_rows[i][j];
+				}
+
+			}
+
+		}
+
+		// Local volatility PDE,
+		//	dV/dtau = r * (S * dV/dS - V) + 0.5 * sigma_loc^2 * S^2 * d2V/dS2,
+		// split as L = r * A + sigma_loc^2 * B, A = S * D1 - identity,
+		// B = 0.5 * S^2 * D2. The time grid is in time to maturity; over each
+		// time step the rate is the forward rate of the curve. The spatial
+		// grid should be the spot grid of the surface.
+		//
+		// A and B are set up once. Each time step reads the local variance
+		// rows at both ends of the step, combines the right- and
+		// left-hand-side operators in place, and solves without allocations.
+		// Returns the solution at the end of the time grid.
+		template <class T>
+		std::vector<double> solve(
+			const std::vector<double>& time_grid,
+			const std::vector<double>& spatial_grid,
+			const Surface& surface,
+			const curve::ZeroCurve& curve,
+			const std::function<double(double)>& payoff,
+			const std::vector<std::function<T(std::vector<double>)>>& deriv,
+			const double theta = 0.5) {
+
+			NFS_SCOPE("local_vol::pde::solve");
+
+			if (spatial_grid != surface.spots()) {
+				throw std::invalid_argument("Spatial grid should be the spot grid of the surface.");
+			}
+
+			const int n_points = (int)spatial_grid.size();
+			const int n_steps = (int)time_grid.size() - 1;
+			const double maturity = time_grid.back();
+
+			// Calendar time interval of each time step.
+			std::vector<double> time_1(n_steps, 0.0);
+			std::vector<double> time_2(n_steps, 0.0);
+			for (int i = 0; i != n_steps; ++i) {
+				time_1[i] = maturity - time_grid[i + 1];
+				time_2[i] = maturity - time_grid[i];
+			}
+			const std::vector<double> rates = curve.fwd(time_1, time_2);
+
+			std::vector<double> a_factor(n_points, 0.0);
+			std::vector<double> b_factor(n_points, 0.0);
+			for (int j = 0; j != n_points; ++j) {
+				a_factor[j] = spatial_grid[j];
+				b_factor[j] = 0.5 * spatial_grid[j] * spatial_grid[j];
+			}
+
+			T d1 = deriv[0](spatial_grid);
+			T identity = d1.identity();
+			T a = d1.pre_vector(a_factor);
+			a += identity * -1.0;
+			const T b = deriv[1](spatial_grid).pre_vector(b_factor);
+
+			T rhs = identity;
+			T lhs = identity;
+
+			// Local variance at the start (rhs) and end (lhs) of time step.
+			std::vector<double> variance_rhs(n_points, 0.0);
+			std::vector<double> variance_lhs(n_points, 0.0);
+			surface.variance(maturity - time_grid[0], variance_rhs);
+
+			std::vector<double> func(n_points, 0.0);
+			for (int j = 0; j != n_points; ++j) {
+				func[j] = payoff(spatial_grid[j]);
+			}
+
+			// Work space of solvers.
+			std::vector<double> tmp(n_points, 0.0);
+			std::vector<double> sub_tmp(n_points, 0.0);
+			std::vector<double> main_tmp(n_points, 0.0);
+			std::vector<double> super_tmp(n_points, 0.0);
+
+			for (int i = 0; i != n_steps; ++i) {
+
+				const double dt = time_grid[i + 1] - time_grid[i];
+				surface.variance(time_1[i], variance_lhs);
+
+				// Right-hand-side, operator at start of time step.
+				combine(identity, (1.0 - theta) * dt * rates[i], a,
+					(1.0 - theta) * dt, variance_rhs, b, rhs);
+				std::fill(tmp.begin(), tmp.end(), 0.0);
+				matrix_multiply_vector<T>(rhs, func, tmp);
+				func.swap(tmp);
+
+				// Left-hand-side, operator at end of time step.
+				combine(identity, -theta * dt * rates[i], a,
+					-theta * dt, variance_lhs, b, lhs);
+				lhs.adjust_boundary(func);
+				if (lhs.bandwidth() == 1) {
+					tridiagonal_matrix_solver(
+						lhs.matrix[0], lhs.matrix[1], lhs.matrix[2], func, tmp);
+				}
+				else {
+					pentadiagonal_matrix_solver(
+						lhs.matrix[0], lhs.matrix[1], lhs.matrix[2], lhs.matrix[3], lhs.matrix[4],
+						func, sub_tmp, main_tmp, super_tmp, tmp);
+				}
+
+				variance_rhs.swap(variance_lhs);
+
+			}
+
+			return func;
+
+		}
+
+		template <class T>
+		std::vector<double> solve(
+			const std::vector<double>& time_grid,
+			const std::vector<double>& spatial_grid,
+			const Surface& surface,
+			const double rate,
+			const std::function<double(double)>& payoff,
+			const std::vector<std::function<T(std::vector<double>)>>& deriv,
+			const double theta = 0.5) {
+
+			const curve::ZeroCurve flat({ 1.0 }, { rate });
+
+			return solve<T>(time_grid, spatial_grid, surface, flat, payoff, deriv, theta);
+
+		}
+
+	}
+
+}
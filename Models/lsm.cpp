@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include "instrumentation.h"
+#include "lsm.h"
+
+
+lsm::Paths::Paths(
+	const int n_assets,
+	const int n_paths,
+	const std::vector<double>& times) :
+	n_assets_(n_assets),
+	n_paths_(n_paths),
+	times_(times),
+	spots_((size_t)n_assets * n_paths * times.size(), 0.0) {
+
+	if (n_assets < 1 || n_paths < 1) {
+		throw std::invalid_argument("At least one asset and one path required.");
+	}
+
+	for (int i = 1; i < (int)times.size(); ++i) {
+		if (times[i] <= times[i - 1]) {
+			throw std::invalid_argument("Times should be increasing.");
+		}
+	}
+
+}
+
+
+lsm::Paths lsm::simulate(
+	const std::vector<double>& spot,
+	const double rate,
+	const std::vector<double>& dividend,
+	const std::vector<double>& sigma,
+	const std::vector<std::vector<double>>& correlation,
+	const std::vector<double>& times,
+	const int n_paths,
+	const unsigned long seed) {
+
+	NFS_SCOPE("lsm::simulate");
+
+	const int n_assets = (int)spot.size();
+	const int n_dates = (int)times.size();
+
+	if (dividend.size() != n_assets || sigma.size() != n_assets) {
+		throw std::invalid_argument("Number of dividends and volatilities should equal number of assets.");
+	}
+
+	if (n_paths % 2 != 0) {
+		throw std::invalid_argument("Number of paths should be even.");
+	}
+
+	// Cholesky factor of correlation matrix, lower triangular.
+	std::vector<std::vector<double>> factor(n_assets, std::vector<double>(n_assets, 0.0));
+	for (int i = 0; i != n_assets; ++i) {
+		for (int j = 0; j <= i; ++j) {
+			double sum = correlation.empty() ? (i == j ? 1.0 : 0.0) : correlation[i][j];
+			for (int k = 0; k != j; ++k) {
+				sum -= factor[i][k] * factor[j][k];
+			}
+			if (i == j) {
+				if (sum <= 0.0) {
+					throw std::invalid_argument("Correlation matrix should be positive definite.");
+				}
+				factor[i][i] = std::sqrt(sum);
+			}
+			else {
+				factor[i][j] = sum / factor[j][j];
+			}
+		}
+	}
+
+	Paths paths(n_assets, n_paths, times);
+
+	for (int a = 0; a != n_assets; ++a) {
+		std::fill(paths.spots(0, a), paths.spots(0, a) + n_paths, spot[a]);
+	}
+
+	std::mt19937_64 engine(seed);
+	std::normal_distribution<double> normal(0.0, 1.0);
+
+	std::vector<double> z(n_assets, 0.0);
+	std::vector<double> drift(n_assets, 0.0);
+	std::vector<double> diffusion(n_assets, 0.0);
+
+	const int half = n_paths / 2;
+
+	for (int d = 1; d != n_dates; ++d) {
+
+		const double dt = times[d] - times[d - 1];
+
+		for (int a = 0; a != n_assets; ++a) {
+			drift[a] = (rate - dividend[a] - 0.5 * sigma[a] * sigma[a]) * dt;
+			diffusion[a] = sigma[a] * std::sqrt(dt);
+		}
+
+		for (int p = 0; p != half; ++p) {
+
+			for (int a = 0; a != n_assets; ++a) {
+				z[a] = normal(engine);
+			}
+
+			for (int a = 0; a != n_assets; ++a) {
+
+				double w = 0.0;
+				for (int k = 0; k <= a; ++k) {
+					w += factor[a][k] * z[k];
+				}
+
+				const double* previous = paths.spots(d - 1, a);
+				double* current = paths.spots(d, a);
+
+				// Antithetic pair (p, p + half).
+				current[p] = previous[p] * std::exp(drift[a] + diffusion[a] * w);
+				current[p + half] = previous[p + half] * std::exp(drift[a] - diffusion[a] * w);
+
+			}
+
+		}
+
+	}
+
+	return paths;
+
+}
+
+
+lsm::Payoff lsm::put(const double strike) {
+
+	return [strike](const std::vector<const double*>& spots, const int n_paths, double* result) {
+		for (int p = 0; p != n_paths; ++p) {
+			result[p] = std::max(strike - spots[0][p], 0.0);
+		}
+	};
+
+}
+
+
+lsm::Payoff lsm::call(const double strike) {
+
+	return [strike](const std::vector<const double*>& spots, const int n_paths, double* result) {
+		for (int p = 0; p != n_paths; ++p) {
+			result[p] = std::max(spots[0][p] - strike, 0.0);
+		}
+	};
+
+}
+
+
+lsm::Payoff lsm::max_call(const double strike) {
+
+	return [strike](const std::vector<const double*>& spots, const int n_paths, double* result) {
+		std::copy(spots[0], spots[0] + n_paths, result);
+		for (int a = 1; a != spots.size(); ++a) {
+			for (int p = 0; p != n_paths; ++p) {
+				result[p] = std::max(result[p], spots[a][p]);
+			}
+		}
+		for (int p = 0; p != n_paths; ++p) {
+			result[p] = std::max(result[p] - strike, 0.0);
+		}
+	};
+
+}
+
+
+double lsm::price(
+	const Paths& paths,
+	const double rate,
+	const Payoff& payoff,
+	const Options& options) {
+
+	NFS_SCOPE("lsm::price");
+
+	const int n_paths = paths.n_paths();
+	const int n_dates = paths.n_dates();
+	const std::vector<double>& times = paths.times();
+
+	if (n_dates < 2) {
+		throw std::invalid_argument("Paths should have at least two dates.");
+	}
+
+	regression::LeastSquares regression(paths.n_assets(), options.degree, options.basis);
+
+	std::vector<const double*> spots(paths.n_assets(), nullptr);
+	auto set_spots = [&](const int date) {
+		for (int a = 0; a != paths.n_assets(); ++a) {
+			spots[a] = paths.spots(date, a);
+		}
+	};
+
+	// Cash flow of each path, discounted to the current date.
+	std::vector<double> cash(n_paths, 0.0);
+	std::vector<double> exercise(n_paths, 0.0);
+	std::vector<double> continuation(n_paths, 0.0);
+	std::vector<double> in_the_money(n_paths, 0.0);
+
+	set_spots(n_dates - 1);
+	payoff(spots, n_paths, cash.data());
+
+	for (int d = n_dates - 2; d != 0; --d) {
+
+		const double discount = std::exp(-rate * (times[d + 1] - times[d]));
+		for (int p = 0; p != n_paths; ++p) {
+			cash[p] *= discount;
+		}
+
+		set_spots(d);
+		payoff(spots, n_paths, exercise.data());
+
+		int n_in_the_money = 0;
+		for (int p = 0; p != n_paths; ++p) {
+			in_the_money[p] = exercise[p] > 0.0 ? 1.0 : 0.0;
+			n_in_the_money += exercise[p] > 0.0;
+		}
+
+		if (n_in_the_money < regression.n_terms()) {
+			continue;
+		}
+
+		regression.fit(spots, cash.data(), in_the_money.data(), n_paths, options.n_threads);
+		regression.predict(spots, n_paths, continuation.data());
+
+		for (int p = 0; p != n_paths; ++p) {
+			if (exercise[p] > 0.0 && exercise[p] > continuation[p]) {
+				cash[p] = exercise[p];
+			}
+		}
+
+	}
+
+	const double discount = std::exp(-rate * (times[1] - times[0]));
+
+	double sum = 0.0;
+	for (int p = 0; p != n_paths; ++p) {
+		sum += cash[p];
+	}
+
+	const double continuation_value = discount * sum / n_paths;
+
+	// Immediate exercise at the valuation date, where all paths share the
+	// same spots.
+	set_spots(0);
+	payoff(spots, n_paths, exercise.data());
+
+	return std::max(exercise[0], continuation_value);
+
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "regression.h"
+
+
+// Least-squares Monte Carlo (Longstaff and Schwartz, 2001) pricing of
+// Bermudan/American options on simulated paths.
+//
+// Paths are stored in structure-of-arrays form: For each date and asset,
+// the spots of all paths are contiguous. At each exercise date, the
+// discounted cash flows of paths in the money are regressed on basis
+// functions of the spots (regression::LeastSquares), and paths exercise
+// where the exercise value exceeds the fitted continuation value.
+//
+// References:
+// - Longstaff and Schwartz (2001), Valuing American options by simulation:
+//   A simple least-squares approach.
+namespace lsm {
+
+	// Spots of n_assets assets on n_paths paths at each date of times.
+	class Paths {
+
+	private:
+
+		int n_assets_;
+		int n_paths_;
+		std::vector<double> times_;
+
+		// Order (date, asset, path).
+		std::vector<double> spots_;
+
+	public:
+
+		Paths(
+			const int n_assets,
+			const int n_paths,
+			const std::vector<double>& times);
+
+		int n_assets() const {
+			return n_assets_;
+		}
+
+		int n_paths() const {
+			return n_paths_;
+		}
+
+		int n_dates() const {
+			return (int)times_.size();
+		}
+
+		const std::vector<double>& times() const {
+			return times_;
+		}
+
+		double* spots(const int date, const int asset) {
+			return spots_.data() + ((size_t)date * n_assets_ + asset) * n_paths_;
+		}
+
+		const double* spots(const int date, const int asset) const {
+			return spots_.data() + ((size_t)date * n_assets_ + asset) * n_paths_;
+		}
+
+	};
+
+	// Correlated geometric Brownian motions,
+	//	dS_i = (rate - dividend_i) * S_i * dt + sigma_i * S_i * dW_i,
+	// sampled exactly at times (the first time is the valuation date, with
+	// spot). correlation: Empty for independent assets. Paths come in
+	// antithetic pairs; n_paths should be even.
+	Paths simulate(
+		const std::vector<double>& spot,
+		const double rate,
+		const std::vector<double>& dividend,
+		const std::vector<double>& sigma,
+		const std::vector<std::vector<double>>& correlation,
+		const std::vector<double>& times,
+		const int n_paths,
+		const unsigned long seed = 1);
+
+	// Exercise values of paths, given the spots of each asset.
+	using Payoff = std::function<void(
+		const std::vector<const double*>& spots,
+		const int n_paths,
+		double* result)>;
+
+	Payoff put(const double strike);
+
+	Payoff call(const double strike);
+
+	// Call on the maximum of the assets.
+	Payoff max_call(const double strike);
+
+	struct Options {
+		int degree = 3;
+		regression::Basis basis = regression::Basis::laguerre;
+		// Threads accumulating the Gram matrix, 0: Hardware threads.
+		int n_threads = 0;
+	};
+
+	// Price at the first date of paths, with exercise at all dates: The
+	// maximum of immediate exercise and the discounted continuation value
+	// estimated from the paths. Spots at the first date should be equal on
+	// all paths. Dates with fewer paths in the money than basis functions are
+	// skipped.
+	double price(
+		const Paths& paths,
+		const double rate,
+		const Payoff& payoff,
+		const Options& options = Options());
+
+}
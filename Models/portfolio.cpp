@@ -0,0 +1,405 @@
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+#include "BlackScholesUtility.h"
+#include "HestonUtility.h"
+#include "derivatives.h"
+#include "grid.h"
+#include "instrumentation.h"
+#include "portfolio.h"
+
+
+namespace {
+
+	// Trades priced by one job.
+	struct Job {
+		// bs_pde: Batch of PDEs on common grids. Otherwise trades are priced
+		// one by one.
+		portfolio::Kind kind;
+		std::vector<int> trades;
+		double cost;
+	};
+
+	// Linear interpolation of func on grid at x, constant extrapolation.
+	double interpolate(
+		const std::vector<double>& grid,
+		const std::vector<double>& func,
+		const double x) {
+
+		if (x <= grid.front()) {
+			return func.front();
+		}
+		if (x >= grid.back()) {
+			return func.back();
+		}
+
+		const int i = (int)(std::upper_bound(grid.begin(), grid.end(), x) - grid.begin()) - 1;
+		const double weight = (x - grid[i]) / (grid[i + 1] - grid[i]);
+
+		return (1.0 - weight) * func[i] + weight * func[i + 1];
+
+	}
+
+	std::function<double(double)> payoff(const portfolio::Trade& trade) {
+		const double strike = trade.strike;
+		if (trade.call) {
+			return [strike](double spot) { return std::max(spot - strike, 0.0); };
+		}
+		return [strike](double spot) { return std::max(strike - spot, 0.0); };
+	}
+
+	double price_trade(const portfolio::Trade& t) {
+
+		switch (t.kind) {
+
+		case portfolio::Kind::bs_closed_form:
+			return t.call
+				? bs::call::price(t.spot, t.rate, t.sigma, t.strike, t.tau)
+				: bs::put::price(t.spot, t.rate, t.sigma, t.strike, t.tau);
+
+		case portfolio::Kind::heston_closed_form:
+			return t.call
+				? heston::call(t.spot, t.variance, t.rate, t.lambda, t.theta, t.eta, t.rho, t.strike, t.tau)
+				: heston::put(t.spot, t.variance, t.rate, t.lambda, t.theta, t.eta, t.rho, t.strike, t.tau);
+
+		case portfolio::Kind::heston_pde: {
+
+			const std::vector<double> time_grid = grid::uniform(0.0, t.tau, t.n_steps + 1);
+			const std::vector<std::vector<double>> spatial_grid = heston::pde::generator::grid(
+				t.s_max, t.n_points_s, t.strike, t.v_max, t.n_points_v, t.variance);
+
+			const std::vector<double> func = heston::pde::solve(
+				time_grid, spatial_grid, t.rate, t.lambda, t.theta, t.eta, t.rho, payoff(t), t.scheme);
+
+			return heston::pde::interpolate(spatial_grid, func, t.spot, t.variance);
+
+		}
+
+		default:
+			throw std::invalid_argument("Trade is priced in batch.");
+
+		}
+
+	}
+
+	// Black-Scholes PDEs on common grids.
+	void price_batch(
+		const std::vector<portfolio::Trade>& trades,
+		const Job& job,
+		const portfolio::Options& options,
+		std::vector<double>& prices) {
+
+		const portfolio::Trade& first = trades[job.trades[0]];
+
+		const std::vector<double> time_grid = grid::uniform(0.0, first.tau, first.n_steps + 1);
+		const std::vector<double> spatial_grid = grid::uniform(0.0, first.s_max, first.n_points_s);
+
+		const std::vector<std::function<TriDiagonal(std::vector<double>)>>
+			deriv{ d1dx1::uniform::c2b2, d2dx2::uniform::c2b1 };
+
+		std::vector<bs::pde::Parameters> parameters;
+		for (int i : job.trades) {
+			parameters.push_back({ trades[i].rate, trades[i].sigma, payoff(trades[i]) });
+		}
+
+		const std::vector<std::vector<double>> func = bs::pde::batch<TriDiagonal>(
+			time_grid, spatial_grid, parameters, deriv, 0.5, options.width);
+
+		for (int k = 0; k != job.trades.size(); ++k) {
+			prices[job.trades[k]] = interpolate(spatial_grid, func[k], trades[job.trades[k]].spot);
+		}
+
+	}
+
+	void run(
+		const std::vector<portfolio::Trade>& trades,
+		const Job& job,
+		const portfolio::Options& options,
+		std::vector<double>& prices) {
+
+		if (job.kind == portfolio::Kind::bs_pde) {
+			price_batch(trades, job, options, prices);
+		}
+		else {
+			for (int i : job.trades) {
+				prices[i] = price_trade(trades[i]);
+			}
+		}
+
+	}
+
+	// Group trades into jobs, in trade order.
+	std::vector<Job> make_jobs(
+		const std::vector<portfolio::Trade>& trades,
+		const portfolio::Options& options,
+		portfolio::Statistics& statistics) {
+
+		std::vector<Job> jobs;
+
+		Job closed_form{ portfolio::Kind::bs_closed_form, {}, 0.0 };
+
+		// Batches of Black-Scholes PDEs with common grids.
+		typedef std::tuple<int, int, double, double> Key;
+		std::map<Key, Job> batches;
+
+		for (int i = 0; i != trades.size(); ++i) {
+
+			const portfolio::Trade& t = trades[i];
+			const double c = portfolio::cost(t, options.model);
+
+			if (t.kind == portfolio::Kind::bs_closed_form || t.kind == portfolio::Kind::heston_closed_form) {
+
+				closed_form.trades.push_back(i);
+				closed_form.cost += c;
+
+				if (closed_form.cost >= options.grain) {
+					jobs.push_back(closed_form);
+					closed_form = Job{ portfolio::Kind::bs_closed_form, {}, 0.0 };
+				}
+
+			}
+			else if (t.kind == portfolio::Kind::bs_pde) {
+
+				const Key key(t.n_steps, t.n_points_s, t.s_max, t.tau);
+
+				Job& batch = batches.emplace(key, Job{ portfolio::Kind::bs_pde, {}, 0.0 }).first->second;
+				batch.trades.push_back(i);
+				batch.cost += c;
+
+				if (batch.trades.size() == options.max_batch) {
+					jobs.push_back(batch);
+					batch = Job{ portfolio::Kind::bs_pde, {}, 0.0 };
+				}
+
+			}
+			else {
+
+				jobs.push_back(Job{ t.kind, { i }, c });
+
+			}
+
+		}
+
+		if (!closed_form.trades.empty()) {
+			jobs.push_back(closed_form);
+		}
+		for (auto& batch : batches) {
+			if (!batch.second.trades.empty()) {
+				jobs.push_back(batch.second);
+			}
+		}
+
+		for (Job& job : jobs) {
+			if (job.kind == portfolio::Kind::bs_pde) {
+				if (job.trades.size() > 1) {
+					job.cost *= options.model.batch_factor;
+				}
+				++statistics.n_batches;
+			}
+			statistics.estimated_time += job.cost;
+		}
+
+		// Trade order.
+		std::stable_sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) {
+			return a.trades[0] < b.trades[0];
+		});
+
+		return jobs;
+
+	}
+
+}
+
+
+double portfolio::cost(
+	const Trade& trade,
+	const CostModel& model) {
+
+	switch (trade.kind) {
+
+	case Kind::bs_closed_form:
+		return model.bs_closed_form;
+
+	case Kind::heston_closed_form:
+		return model.heston_closed_form;
+
+	case Kind::bs_pde:
+		return model.bs_pde * trade.n_points_s * trade.n_steps;
+
+	case Kind::heston_pde: {
+
+		// Relative cost of ADI schemes.
+		double factor = 1.0;
+		if (trade.scheme == "DR") {
+			factor = 0.65;
+		}
+		else if (trade.scheme == "CS") {
+			factor = 0.85;
+		}
+		else if (trade.scheme == "MCS") {
+			factor = 0.95;
+		}
+		else if (trade.scheme != "HV") {
+			throw std::invalid_argument("Unknown scheme.");
+		}
+
+		return factor * model.heston_pde
+			* trade.n_points_s * trade.n_points_v * trade.n_steps;
+
+	}
+
+	default:
+		throw std::invalid_argument("Trade kind unknown.");
+
+	}
+
+}
+
+
+std::vector<double> portfolio::price(
+	const std::vector<Trade>& trades,
+	tasks::Scheduler& scheduler,
+	Statistics& statistics,
+	const Options& options) {
+
+	NFS_SCOPE("portfolio::price");
+
+	typedef std::chrono::steady_clock Clock;
+
+	statistics = Statistics();
+	statistics.n_trades = (int)trades.size();
+
+	std::vector<double> prices(trades.size(), 0.0);
+
+	std::vector<Job> jobs = make_jobs(trades, options, statistics);
+	statistics.n_jobs = (int)jobs.size();
+
+	const int n_threads = scheduler.n_threads();
+
+	// Jobs run by each scheduler task.
+	std::vector<std::vector<const Job*>> parts;
+
+	if (options.schedule == Schedule::longest_first) {
+
+		std::vector<const Job*> order;
+		for (const Job& job : jobs) {
+			order.push_back(&job);
+		}
+		std::stable_sort(order.begin(), order.end(), [](const Job* a, const Job* b) {
+			return a->cost > b->cost;
+		});
+
+		for (const Job* job : order) {
+			parts.push_back({ job });
+		}
+
+	}
+	else {
+
+		const int n_jobs = (int)jobs.size();
+		for (int p = 0; p != n_threads; ++p) {
+			std::vector<const Job*> part;
+			for (int j = p * n_jobs / n_threads; j != (p + 1) * n_jobs / n_threads; ++j) {
+				part.push_back(&jobs[j]);
+			}
+			parts.push_back(part);
+		}
+
+	}
+
+	// Busy time and end of last job, per worker. Each worker only writes
+	// its own element.
+	std::vector<double> busy_time(n_threads, 0.0);
+	std::vector<double> finish_time(n_threads, 0.0);
+
+	const Clock::time_point start = Clock::now();
+
+	std::vector<tasks::Future<int>> futures;
+	for (const std::vector<const Job*>& part : parts) {
+
+		futures.push_back(scheduler.submit([&, part]() {
+
+			const Clock::time_point job_start = Clock::now();
+
+			for (const Job* job : part) {
+				run(trades, *job, options, prices);
+			}
+
+			const Clock::time_point job_end = Clock::now();
+
+			const int worker = tasks::Scheduler::worker_index();
+			busy_time[worker] += std::chrono::duration<double>(job_end - job_start).count();
+			finish_time[worker] = std::chrono::duration<double>(job_end - start).count();
+
+			return 0;
+
+		}));
+
+	}
+
+	for (tasks::Future<int>& future : futures) {
+		future.get();
+	}
+
+	statistics.wall_time = std::chrono::duration<double>(Clock::now() - start).count();
+	statistics.busy_time = busy_time;
+
+	double busy_sum = 0.0;
+	double busy_max = 0.0;
+	for (int w = 0; w != n_threads; ++w) {
+		busy_sum += busy_time[w];
+		busy_max = std::max(busy_max, busy_time[w]);
+	}
+	const double busy_mean = busy_sum / n_threads;
+
+	statistics.imbalance = busy_mean > 0.0 ? busy_max / busy_mean - 1.0 : 0.0;
+	statistics.tail_time = statistics.wall_time
+		- *std::min_element(finish_time.begin(), finish_time.end());
+	statistics.utilization = statistics.wall_time > 0.0
+		? busy_sum / (n_threads * statistics.wall_time) : 0.0;
+
+	return prices;
+
+}
+
+
+std::vector<double> portfolio::price(
+	const std::vector<Trade>& trades,
+	tasks::Scheduler& scheduler,
+	const Options& options) {
+
+	Statistics statistics;
+	return price(trades, scheduler, statistics, options);
+
+}
+
+
+std::string portfolio::summary(const Statistics& statistics) {
+
+	std::ostringstream stream;
+
+	stream << std::fixed << std::setprecision(3)
+		<< "Trades: " << statistics.n_trades
+		<< ", jobs: " << statistics.n_jobs
+		<< ", batches: " << statistics.n_batches << "\n"
+		<< "Estimated [ms]: " << 1.0e3 * statistics.estimated_time
+		<< ", wall [ms]: " << 1.0e3 * statistics.wall_time
+		<< ", tail [ms]: " << 1.0e3 * statistics.tail_time << "\n"
+		<< "Imbalance: " << statistics.imbalance
+		<< ", utilization: " << statistics.utilization << "\n"
+		<< "Busy [ms]:";
+
+	for (double busy : statistics.busy_time) {
+		stream << " " << 1.0e3 * busy;
+	}
+	stream << "\n";
+
+	return stream.str();
+
+}
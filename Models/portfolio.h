@@ -0,0 +1,120 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "scheduler.h"
+
+
+// Pricing of portfolios of heterogeneous trades (closed form, 1-dimensional
+// and 2-dimensional PDEs) on a tasks::Scheduler.
+//
+// The cost of each trade is estimated from its pricer, grid size and number
+// of time steps. Trades are grouped into jobs:
+//	- Closed form trades are chunked, such that each job carries at least
+//	  Options::grain seconds of work.
+//	- Black-Scholes PDEs with the same grids (n_steps, n_points_s, s_max and
+//	  tau) are propagated together by bs::pde::batch, see Options::width.
+//	- Heston PDEs are priced one per job.
+// Jobs are submitted longest first; idle workers steal from busy ones,
+// hence expensive jobs start early and cheap jobs fill the tail.
+namespace portfolio {
+
+	enum class Kind { bs_closed_form, heston_closed_form, bs_pde, heston_pde };
+
+	// European option. Parameters not used by the pricer are ignored.
+	struct Trade {
+		Kind kind = Kind::bs_closed_form;
+		bool call = true;
+		double spot = 100.0;
+		double strike = 100.0;
+		double tau = 1.0;
+		double rate = 0.0;
+		// Black-Scholes.
+		double sigma = 0.2;
+		// Heston.
+		double variance = 0.04;
+		double lambda = 1.0;
+		double theta = 0.04;
+		double eta = 0.3;
+		double rho = 0.0;
+		// PDE pricers: Uniform time grid and spatial grid on [0, s_max] x [0, v_max].
+		int n_steps = 100;
+		int n_points_s = 201;
+		int n_points_v = 51;
+		double s_max = 400.0;
+		double v_max = 1.0;
+		std::string scheme = "HV";
+	};
+
+	// Estimated run time in seconds of pricers, single-threaded. Only the
+	// ratios matter for scheduling.
+	struct CostModel {
+		// Per price.
+		double bs_closed_form = 5.0e-8;
+		double heston_closed_form = 1.3e-4;
+		// Per space-time grid node.
+		double bs_pde = 4.0e-8;
+		double heston_pde = 1.3e-7;
+		// Cost per problem in bs::pde::batch relative to a single PDE.
+		double batch_factor = 0.1;
+	};
+
+	// Estimated cost of single trade.
+	double cost(
+		const Trade& trade,
+		const CostModel& model = CostModel());
+
+	enum class Schedule {
+		// Jobs sorted by decreasing cost, distributed by work stealing.
+		longest_first,
+		// Jobs in trade order, split into one contiguous part per thread.
+		static_partition
+	};
+
+	struct Options {
+		CostModel model;
+		Schedule schedule = Schedule::longest_first;
+		// Minimum estimated cost of a job of closed form trades (seconds).
+		double grain = 5.0e-5;
+		// SIMD lanes, and maximum problems per batch, of Black-Scholes PDEs.
+		int width = 8;
+		int max_batch = 32;
+	};
+
+	// Statistics of a portfolio run. Times in seconds.
+	struct Statistics {
+		int n_trades = 0;
+		int n_jobs = 0;
+		// Jobs of batched Black-Scholes PDEs.
+		int n_batches = 0;
+		// Sum of estimated cost of jobs.
+		double estimated_time = 0.0;
+		double wall_time = 0.0;
+		// Time spent in jobs, per worker.
+		std::vector<double> busy_time;
+		// Maximum over mean busy time, minus 1.
+		double imbalance = 0.0;
+		// Time between first worker running out of work and end of run.
+		double tail_time = 0.0;
+		// Sum of busy time over n_threads * wall_time.
+		double utilization = 0.0;
+	};
+
+	// Price of each trade at (spot, variance). Blocks until all jobs have
+	// finished, hence it should not be called from a job of scheduler.
+	std::vector<double> price(
+		const std::vector<Trade>& trades,
+		tasks::Scheduler& scheduler,
+		Statistics& statistics,
+		const Options& options = Options());
+
+	std::vector<double> price(
+		const std::vector<Trade>& trades,
+		tasks::Scheduler& scheduler,
+		const Options& options = Options());
+
+	// Statistics as text.
+	std::string summary(const Statistics& statistics);
+
+}
@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "band_diagonal_batch.h"
+#include "band_diagonal_matrix.h"
+
+
+BatchTriDiagonal::BatchTriDiagonal(const std::vector<TriDiagonal>& lanes) {
+
+	if (lanes.empty()) {
+		throw std::invalid_argument("Batch should contain at least one matrix.");
+	}
+
+	order_ = lanes[0].order();
+	width_ = (int)lanes.size();
+	n_boundary_elements_ = lanes[0].n_boundary_elements();
+	factorized_ = false;
+
+	const int n_corrections = n_boundary_elements_ - 2;
+
+	std::vector<double> inner(order_ * width_, 0.0);
+	matrix = std::vector<std::vector<double>>(3, inner);
+
+	std::vector<double> row(n_boundary_elements_ * width_, 0.0);
+	boundary_rows = std::vector<std::vector<double>>(2, row);
+
+	std::vector<double> corrections(width_, 0.0);
+	corrections_lower_ = std::vector<std::vector<double>>(n_corrections, corrections);
+	corrections_upper_ = std::vector<std::vector<double>>(n_corrections, corrections);
+
+	std::vector<double> column(order_, 0.0);
+
+	for (int l = 0; l != width_; ++l) {
+
+		if (lanes[l].order() != order_
+			|| lanes[l].n_boundary_elements() != n_boundary_elements_) {
+			throw std::invalid_argument("Matrices in batch should have identical shape.");
+		}
+
+		// Boundary rows are eliminated on a copy; interior rows are unchanged.
+		TriDiagonal lane = lanes[l];
+
+		// Gauss elimination of the boundary rows is linear in the column
+		// vector, and only the first and last elements are adjusted. The
+		// corrections are extracted using unit vectors.
+		for (int k = 0; k != n_corrections; ++k) {
+
+			std::fill(column.begin(), column.end(), 0.0);
+			column[k + 1] = 1.0;
+			column[(order_ - 2) - k] = 1.0;
+
+			lane.adjust_boundary(column);
+
+			corrections_lower_[k][l] = column[0];
+			corrections_upper_[k][l] = column[order_ - 1];
+
+		}
+
+		if (n_corrections == 0) {
+			lane.adjust_boundary(column);
+		}
+
+		for (int i = 0; i != order_; ++i) {
+			for (int j = 0; j != 3; ++j) {
+				matrix[j][i * width_ + l] = lane.matrix[j][i];
+			}
+		}
+
+		for (int i = 0; i != 2; ++i) {
+			for (int j = 0; j != n_boundary_elements_; ++j) {
+				boundary_rows[i][j * width_ + l] = lanes[l].boundary_rows[i][j];
+			}
+		}
+
+	}
+
+}
+
+
+// Lane-wise matrix-vector product.
+void BatchTriDiagonal::multiply(
+	const std::vector<double>& vector,
+	std::vector<double>& result) const {
+
+	const int w = width_;
+	const int n = order_;
+
+	const double* sub = matrix[0].data();
+	const double* main = matrix[1].data();
+	const double* super = matrix[2].data();
+	const double* v = vector.data();
+	double* r = result.data();
+
+	// Boundary rows.
+	const int offset = (n - n_boundary_elements_) * w;
+	for (int l = 0; l != w; ++l) {
+		r[l] = 0.0;
+		r[(n - 1) * w + l] = 0.0;
+	}
+	for (int j = 0; j != n_boundary_elements_; ++j) {
+		const double* lower = &boundary_rows[0][j * w];
+		const double* upper = &boundary_rows[1][j * w];
+		for (int l = 0; l != w; ++l) {
+			r[l] += lower[l] * v[j * w + l];
+			r[(n - 1) * w + l] += upper[l] * v[offset + j * w + l];
+		}
+	}
+
+	// Interior rows.
+	for (int i = 1; i != n - 1; ++i) {
+		const int idx = i * w;
+		for (int l = 0; l != w; ++l) {
+			r[idx + l] =
+				  sub[idx + l] * v[idx - w + l]
+				+ main[idx + l] * v[idx + l]
+				+ super[idx + l] * v[idx + w + l];
+		}
+	}
+
+}
+
+
+// Thomas factorization, carried out once for repeated solves.
+void BatchTriDiagonal::factorize() {
+
+	const int w = width_;
+	const int n = order_;
+
+	inverse_ = std::vector<double>(n * w, 0.0);
+	super_ = std::vector<double>(n * w, 0.0);
+
+	const std::vector<double>& sub = matrix[0];
+	const std::vector<double>& main = matrix[1];
+	const std::vector<double>& super = matrix[2];
+
+	for (int l = 0; l != w; ++l) {
+		inverse_[l] = 1.0 / main[l];
+		super_[l] = super[l] * inverse_[l];
+	}
+
+	for (int i = 1; i != n; ++i) {
+		const int idx = i * w;
+		for (int l = 0; l != w; ++l) {
+			inverse_[idx + l] = 1.0 / (main[idx + l] - sub[idx + l] * super_[idx - w + l]);
+			super_[idx + l] = super[idx + l] * inverse_[idx + l];
+		}
+	}
+
+	factorized_ = true;
+
+}
+
+
+// Lane-wise solution of matrix equations (requires factorize).
+void BatchTriDiagonal::solve(std::vector<double>& column) const {
+
+	if (!factorized_) {
+		throw std::invalid_argument("Batch matrix is not factorized.");
+	}
+
+	const int w = width_;
+	const int n = order_;
+
+	const double* sub = matrix[0].data();
+	const double* inverse = inverse_.data();
+	const double* super = super_.data();
+	double* c = column.data();
+
+	// Boundary rows after Gauss elimination.
+	for (int k = 0; k != (int)corrections_lower_.size(); ++k) {
+		const double* lower = corrections_lower_[k].data();
+		const double* upper = corrections_upper_[k].data();
+		for (int l = 0; l != w; ++l) {
+			c[l] += lower[l] * c[(k + 1) * w + l];
+			c[(n - 1) * w + l] += upper[l] * c[(n - 2 - k) * w + l];
+		}
+	}
+
+	// Forward sweep.
+	for (int l = 0; l != w; ++l) {
+		c[l] *= inverse[l];
+	}
+	for (int i = 1; i != n; ++i) {
+		const int idx = i * w;
+		for (int l = 0; l != w; ++l) {
+			c[idx + l] = (c[idx + l] - sub[idx + l] * c[idx - w + l]) * inverse[idx + l];
+		}
+	}
+
+	// Backward sweep (back substitution).
+	for (int i = n - 2; i != -1; --i) {
+		const int idx = i * w;
+		for (int l = 0; l != w; ++l) {
+			c[idx + l] -= super[idx + l] * c[idx + w + l];
+		}
+	}
+
+}
+
+
+// Interleave functions of identical size, one function per lane.
+std::vector<double> interleaved::pack(
+	const std::vector<std::vector<double>>& func,
+	const int lane_begin,
+	const int width) {
+
+	const int n_points = (int)func[lane_begin].size();
+
+	std::vector<double> func_packed(n_points * width, 0.0);
+
+	for (int l = 0; l != width; ++l) {
+		for (int i = 0; i != n_points; ++i) {
+			func_packed[i * width + l] = func[lane_begin + l][i];
+		}
+	}
+
+	return func_packed;
+
+}
+
+
+// Inverse of pack.
+void interleaved::unpack(
+	const std::vector<double>& func_packed,
+	const int lane_begin,
+	const int width,
+	std::vector<std::vector<double>>& func) {
+
+	const int n_points = (int)func_packed.size() / width;
+
+	for (int l = 0; l != width; ++l) {
+		for (int i = 0; i != n_points; ++i) {
+			func[lane_begin + l][i] = func_packed[i * width + l];
+		}
+	}
+
+}
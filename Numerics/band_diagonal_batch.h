@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+
+#include "band_diagonal_matrix.h"
+
+
+// Batch of tri-diagonal matrices of identical order stored in interleaved
+// ("lane-major") compact form: Element i of lane l is stored at index
+// i * width + l. Each row operation is thereby carried out for all lanes
+// using unit-stride memory access, which allows for SIMD vectorization
+// across independent problems.
+class BatchTriDiagonal {
+
+private:
+
+	// Matrix order: Number of elements along main diagonal.
+	int order_;
+	// Number of lanes, i.e. number of independent matrices.
+	int width_;
+	// Number of non-zero elements along each boundary row.
+	int n_boundary_elements_;
+	// Is Thomas factorization available?
+	bool factorized_;
+
+	// Column corrections from Gauss elimination of boundary rows.
+	std::vector<std::vector<double>> corrections_lower_;
+	std::vector<std::vector<double>> corrections_upper_;
+
+	// Thomas factorization: Inverse denominators and normalized super-diagonal.
+	std::vector<double> inverse_;
+	std::vector<double> super_;
+
+public:
+
+	// Tri-diagonal matrices in interleaved compact form. The first and last
+	// rows hold the boundary rows after Gauss elimination.
+	std::vector<std::vector<double>> matrix;
+
+	// Boundary rows in interleaved form (element j of lane l at j * width + l).
+	std::vector<std::vector<double>> boundary_rows;
+
+	BatchTriDiagonal(const std::vector<TriDiagonal>& lanes);
+
+	int order() const {
+		return order_;
+	}
+
+	int width() const {
+		return width_;
+	}
+
+	int n_boundary_elements() const {
+		return n_boundary_elements_;
+	}
+
+	// Lane-wise matrix-vector product.
+	void multiply(
+		const std::vector<double>& vector,
+		std::vector<double>& result) const;
+
+	// Thomas factorization, carried out once for repeated solves.
+	void factorize();
+
+	// Lane-wise solution of matrix equations (requires factorize).
+	void solve(std::vector<double>& column) const;
+
+};
+
+
+namespace interleaved {
+
+	// Interleave functions of identical size, one function per lane.
+	std::vector<double> pack(
+		const std::vector<std::vector<double>>& func,
+		const int lane_begin,
+		const int width);
+
+	// Inverse of pack.
+	void unpack(
+		const std::vector<double>& func_packed,
+		const int lane_begin,
+		const int width,
+		std::vector<std::vector<double>>& func);
+
+}
@@ -0,0 +1,355 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "band_diagonal_factorized.h"
+#include "band_diagonal_matrix.h"
+#include "instrumentation.h"
+
+
+template <class T>
+FactorizedBandDiagonalTemp<T>::FactorizedBandDiagonalTemp(const TriDiagonal& matrix) {
+
+	NFS_SCOPE_BYTES("FactorizedBandDiagonal::factorize", 8.0 * matrix.order() * 2 * 3);
+
+	// Boundary rows are eliminated on a copy.
+	TriDiagonal tmp = matrix;
+
+	boundary_corrections(tmp);
+
+	factorize_tri(tmp.matrix[0], tmp.matrix[1], tmp.matrix[2]);
+
+}
+
+
+template <class T>
+FactorizedBandDiagonalTemp<T>::FactorizedBandDiagonalTemp(const PentaDiagonal& matrix) {
+
+	NFS_SCOPE_BYTES("FactorizedBandDiagonal::factorize", 8.0 * matrix.order() * 2 * 5);
+
+	// Boundary rows are eliminated on a copy.
+	PentaDiagonal tmp = matrix;
+
+	boundary_corrections(tmp);
+
+	factorize_penta(tmp.matrix);
+
+}
+
+
+// Gauss elimination of boundary rows is linear in the column vector, and
+// only the boundary rows are adjusted. The corrections are extracted using
+// unit vectors at both boundaries simultaneously.
+template <class T>
+template <class M>
+void FactorizedBandDiagonalTemp<T>::boundary_corrections(M& matrix) {
+
+	order_ = matrix.order();
+	bandwidth_ = matrix.bandwidth();
+	n_boundary_rows_ = matrix.n_boundary_rows();
+	n_corrections_ = std::max(matrix.n_boundary_elements(), n_boundary_rows_);
+
+	if (n_boundary_rows_ > max_boundary_rows) {
+		throw std::invalid_argument("Too many boundary rows.");
+	}
+
+	if (2 * n_corrections_ > order_) {
+		throw std::invalid_argument("Matrix order too small compared to boundary rows.");
+	}
+
+	std::vector<double> row(n_corrections_, 0.0);
+	lower_ = std::vector<std::vector<double>>(n_boundary_rows_, row);
+	upper_ = std::vector<std::vector<double>>(n_boundary_rows_, row);
+
+	std::vector<double> column(order_, 0.0);
+
+	for (int k = 0; k != n_corrections_; ++k) {
+
+		std::fill(column.begin(), column.end(), 0.0);
+		column[k] = 1.0;
+		column[(order_ - 1) - k] = 1.0;
+
+		matrix.adjust_boundary(column);
+
+		for (int i = 0; i != n_boundary_rows_; ++i) {
+			lower_[i][k] = column[i];
+			upper_[i][k] = column[(order_ - 1) - i];
+		}
+
+	}
+
+}
+
+
+// Thomas factorization, see tridiagonal_matrix_solver.
+template <class T>
+void FactorizedBandDiagonalTemp<T>::factorize_tri(
+	const std::vector<double>& sub,
+	const std::vector<double>& main,
+	const std::vector<double>& super) {
+
+	std::vector<double> inverse(order_, 0.0);
+	std::vector<double> super_tmp(order_, 0.0);
+
+	double denominator = main[0];
+	inverse[0] = 1.0 / denominator;
+	super_tmp[0] = super[0] / denominator;
+
+	for (int i = 1; i != order_; ++i) {
+		denominator = main[i] - sub[i] * super_tmp[i - 1];
+		inverse[i] = 1.0 / denominator;
+		super_tmp[i] = super[i] / denominator;
+	}
+
+	sub_.assign(sub.begin(), sub.end());
+	inverse_.assign(inverse.begin(), inverse.end());
+	super_.assign(super_tmp.begin(), super_tmp.end());
+
+}
+
+
+// Matrix part of pentadiagonal_matrix_solver. The column operations are
+// recorded as (factor, inverse) pairs; rows not eliminated are given
+// factor 0 and inverse 1.
+template <class T>
+void FactorizedBandDiagonalTemp<T>::factorize_penta(
+	const std::vector<std::vector<double>>& matrix) {
+
+	const std::vector<double>& sub_2 = matrix[0];
+	const std::vector<double>& sub_1 = matrix[1];
+	const std::vector<double>& main = matrix[2];
+	const std::vector<double>& super_1 = matrix[3];
+	const std::vector<double>& super_2 = matrix[4];
+
+	const int n_elements = order_;
+
+	std::vector<double> sub_tmp(n_elements, 0.0);
+	std::vector<double> main_tmp(n_elements, 0.0);
+	std::vector<double> super_tmp(n_elements, 0.0);
+	std::vector<double> vec_tmp(n_elements, 0.0);
+
+	std::vector<double> forward_factor(n_elements, 0.0);
+	std::vector<double> forward_inverse(n_elements, 1.0);
+	std::vector<double> backward_factor(n_elements, 0.0);
+	std::vector<double> backward_inverse(n_elements, 1.0);
+
+	int idx_tmp = 0;
+
+	// #########################################################
+	// Forward sweep:
+	// Remove elements of 2nd sub-diagonal by Gauss elimination.
+	// #########################################################
+
+	double denominator = main[0];
+
+	main_tmp[0] = 1.0;
+	super_tmp[0] = super_1[0] / denominator;
+	vec_tmp[0] = super_2[0] / denominator;
+
+	forward_inverse[0] = 1.0 / denominator;
+
+	// Add 1st row to 2nd row.
+	sub_tmp[1] = sub_1[1] + main_tmp[0];
+	main_tmp[1] = main[1] + super_tmp[0];
+	super_tmp[1] = super_1[1] + vec_tmp[0];
+	vec_tmp[1] = super_2[1];
+
+	denominator = sub_tmp[1];
+
+	sub_tmp[1] = 1.0;
+	main_tmp[1] /= denominator;
+	super_tmp[1] /= denominator;
+	vec_tmp[1] /= denominator;
+
+	forward_factor[1] = -1.0;
+	forward_inverse[1] = 1.0 / denominator;
+
+	for (int i = 2; i != n_elements; ++i) {
+
+		idx_tmp = i - 1;
+
+		denominator = sub_1[i] - sub_2[i] * main_tmp[idx_tmp];
+
+		// Special treatment of the two upper boundary rows.
+		if (i < n_elements - 2 || std::abs(denominator) > 1.0e-8) {
+
+			sub_tmp[i] = 1.0;
+			main_tmp[i] = (main[i] - sub_2[i] * super_tmp[idx_tmp]) / denominator;
+			super_tmp[i] = (super_1[i] - sub_2[i] * vec_tmp[idx_tmp]) / denominator;
+			vec_tmp[i] = super_2[i] / denominator;
+
+			forward_factor[i] = sub_2[i];
+			forward_inverse[i] = 1.0 / denominator;
+
+		}
+		else {
+
+			sub_tmp[i] = sub_1[i];
+			main_tmp[i] = main[i];
+			super_tmp[i] = super_1[i];
+			vec_tmp[i] = super_2[i];
+
+		}
+	}
+
+	// ###########################################################
+	// Backward sweep:
+	// Remove elements of 2nd super-diagonal by Gauss elimination.
+	// ###########################################################
+
+	const int idx_last = n_elements - 1;
+	const int idx_2nd_last = n_elements - 2;
+
+	denominator = main_tmp[idx_last];
+
+	main_tmp[idx_last] = 1.0;
+	sub_tmp[idx_last] /= denominator;
+
+	backward_inverse[idx_last] = 1.0 / denominator;
+
+	// Add last row to 2nd last row.
+	main_tmp[idx_2nd_last] += sub_tmp[idx_last];
+	super_tmp[idx_2nd_last] += main_tmp[idx_last];
+
+	denominator = super_tmp[idx_2nd_last];
+
+	super_tmp[idx_2nd_last] = 1.0;
+	main_tmp[idx_2nd_last] /= denominator;
+	sub_tmp[idx_2nd_last] /= denominator;
+
+	backward_factor[idx_2nd_last] = -1.0;
+	backward_inverse[idx_2nd_last] = 1.0 / denominator;
+
+	for (int i = n_elements - 3; i != -1; --i) {
+
+		idx_tmp = i + 1;
+
+		denominator = super_tmp[i] - vec_tmp[i] * main_tmp[idx_tmp];
+
+		// Special treatment of the two lower boundary rows.
+		if (i > 1 || std::abs(denominator) > 1.0e-8) {
+
+			super_tmp[i] = 1.0;
+			main_tmp[i] = (main_tmp[i] - vec_tmp[i] * sub_tmp[idx_tmp]) / denominator;
+			sub_tmp[i] /= denominator;
+
+			backward_factor[i] = vec_tmp[i];
+			backward_inverse[i] = 1.0 / denominator;
+
+		}
+	}
+
+	forward_factor_.assign(forward_factor.begin(), forward_factor.end());
+	forward_inverse_.assign(forward_inverse.begin(), forward_inverse.end());
+	backward_factor_.assign(backward_factor.begin(), backward_factor.end());
+	backward_inverse_.assign(backward_inverse.begin(), backward_inverse.end());
+
+	// Factorize the remaining tri-diagonal matrix.
+	factorize_tri(sub_tmp, main_tmp, super_tmp);
+
+}
+
+
+// Solve matrix equation with boundary rows eliminated.
+template <class T>
+void FactorizedBandDiagonalTemp<T>::solve_band(std::vector<T>& column) const {
+
+	const int n = order_;
+
+	if (bandwidth_ == 2) {
+
+		// Forward sweep.
+		column[0] *= forward_inverse_[0];
+		for (int i = 1; i != n; ++i) {
+			column[i] = (column[i] - forward_factor_[i] * column[i - 1]) * forward_inverse_[i];
+		}
+
+		// Backward sweep.
+		column[n - 1] *= backward_inverse_[n - 1];
+		for (int i = n - 2; i != -1; --i) {
+			column[i] = (column[i] - backward_factor_[i] * column[i + 1]) * backward_inverse_[i];
+		}
+
+	}
+
+	// Thomas algorithm: Forward sweep.
+	column[0] *= inverse_[0];
+	for (int i = 1; i != n; ++i) {
+		column[i] = (column[i] - sub_[i] * column[i - 1]) * inverse_[i];
+	}
+
+	// Back substitution.
+	for (int i = n - 2; i != -1; --i) {
+		column[i] -= super_[i] * column[i + 1];
+	}
+
+}
+
+
+template class FactorizedBandDiagonalTemp<double>;
+template class FactorizedBandDiagonalTemp<float>;
+
+
+MixedPrecisionBandDiagonal::MixedPrecisionBandDiagonal(
+	const TriDiagonal& matrix,
+	const int n_refinements) : n_refinements_(n_refinements), factorized_(matrix) {
+
+	// Boundary rows are eliminated on a copy.
+	TriDiagonal tmp = matrix;
+	std::vector<double> column(tmp.order(), 0.0);
+	tmp.adjust_boundary(column);
+
+	matrix_ = BandDiagonalTemp<double>(tmp.matrix);
+
+}
+
+
+MixedPrecisionBandDiagonal::MixedPrecisionBandDiagonal(
+	const PentaDiagonal& matrix,
+	const int n_refinements) : n_refinements_(n_refinements), factorized_(matrix) {
+
+	// Boundary rows are eliminated on a copy.
+	PentaDiagonal tmp = matrix;
+	std::vector<double> column(tmp.order(), 0.0);
+	tmp.adjust_boundary(column);
+
+	matrix_ = BandDiagonalTemp<double>(tmp.matrix);
+
+}
+
+
+// Solve matrix equation, matrix * x = column.
+void MixedPrecisionBandDiagonal::solve(std::vector<double>& column) const {
+
+	const int n = factorized_.order();
+
+	// Boundary row corrections in double precision.
+	factorized_.solve_boundary(column);
+
+	// Initial solution in single precision.
+	std::vector<float> column_single(column.begin(), column.end());
+	factorized_.solve_band(column_single);
+
+	std::vector<double> solution(column_single.begin(), column_single.end());
+	std::vector<double> residual(n, 0.0);
+
+	for (int k = 0; k != n_refinements_; ++k) {
+
+		// Residual in double precision.
+		matrix_.multiply(solution, residual);
+		for (int i = 0; i != n; ++i) {
+			column_single[i] = (float)(column[i] - residual[i]);
+		}
+
+		// Correction in single precision.
+		factorized_.solve_band(column_single);
+		for (int i = 0; i != n; ++i) {
+			solution[i] += column_single[i];
+		}
+
+	}
+
+	column = solution;
+
+}
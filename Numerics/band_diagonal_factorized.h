@@ -0,0 +1,162 @@
+#pragma once
+
+#include <vector>
+
+#include "band_diagonal_matrix.h"
+
+
+// Band-diagonal matrix with boundary rows eliminated and the resulting
+// tri- or penta-diagonal matrix factorized once.
+//
+// The Gauss elimination of boundary rows (see adjust_boundary) is linear
+// in the column vector and only changes the boundary rows of the column.
+// It is stored as a small dense map applied to each right-hand-side.
+// The factorized object is immutable, hence solves are const and can be
+// carried out concurrently for different columns.
+//
+// The factorization is carried out in double precision, and stored (and
+// applied) using scalar type T.
+template <class T>
+class FactorizedBandDiagonalTemp {
+
+private:
+
+	// Maximum number of boundary rows (at each boundary).
+	static const int max_boundary_rows = 4;
+
+	// Matrix order: Number of elements along main diagonal.
+	int order_;
+	// Bandwidth: Number of sub-diagonals or super-diagonals.
+	int bandwidth_;
+	// Number of boundary rows (at each boundary).
+	int n_boundary_rows_;
+	// Number of column elements entering boundary row corrections.
+	int n_corrections_;
+
+	// Boundary row corrections:
+	//	column[i] = sum_k lower[i][k] * column[k],
+	//	column[order - 1 - i] = sum_k upper[i][k] * column[order - 1 - k].
+	std::vector<std::vector<double>> lower_;
+	std::vector<std::vector<double>> upper_;
+
+	// Penta-diagonal matrix: Elimination of 2nd sub-diagonal (forward) and
+	// 2nd super-diagonal (backward), see pentadiagonal_matrix_solver.
+	//	Forward:  column[i] = (column[i] - forward_factor[i] * column[i - 1]) * forward_inverse[i].
+	//	Backward: column[i] = (column[i] - backward_factor[i] * column[i + 1]) * backward_inverse[i].
+	std::vector<T> forward_factor_;
+	std::vector<T> forward_inverse_;
+	std::vector<T> backward_factor_;
+	std::vector<T> backward_inverse_;
+
+	// Thomas factorization of (remaining) tri-diagonal matrix: Sub-diagonal,
+	// inverse denominators and normalized super-diagonal.
+	std::vector<T> sub_;
+	std::vector<T> inverse_;
+	std::vector<T> super_;
+
+	template <class M>
+	void boundary_corrections(M& matrix);
+
+	void factorize_tri(
+		const std::vector<double>& sub,
+		const std::vector<double>& main,
+		const std::vector<double>& super);
+
+	void factorize_penta(const std::vector<std::vector<double>>& matrix);
+
+public:
+
+	// Empty factorization, order zero.
+	FactorizedBandDiagonalTemp() : order_(0), bandwidth_(0), n_boundary_rows_(0), n_corrections_(0) {}
+
+	FactorizedBandDiagonalTemp(const TriDiagonal& matrix);
+
+	FactorizedBandDiagonalTemp(const PentaDiagonal& matrix);
+
+	int order() const {
+		return order_;
+	}
+
+	int bandwidth() const {
+		return bandwidth_;
+	}
+
+	// Boundary row corrections of column, see adjust_boundary.
+	template <class U>
+	void solve_boundary(std::vector<U>& column) const {
+
+		const int n = order_;
+
+		U lower_tmp[max_boundary_rows];
+		U upper_tmp[max_boundary_rows];
+
+		for (int i = 0; i != n_boundary_rows_; ++i) {
+			double lower_sum = 0.0;
+			double upper_sum = 0.0;
+			for (int k = 0; k != n_corrections_; ++k) {
+				lower_sum += lower_[i][k] * column[k];
+				upper_sum += upper_[i][k] * column[(n - 1) - k];
+			}
+			lower_tmp[i] = (U)lower_sum;
+			upper_tmp[i] = (U)upper_sum;
+		}
+
+		for (int i = 0; i != n_boundary_rows_; ++i) {
+			column[i] = lower_tmp[i];
+			column[(n - 1) - i] = upper_tmp[i];
+		}
+
+	}
+
+	// Solve matrix equation with boundary rows eliminated, i.e. after
+	// solve_boundary. Column is overwritten by solution.
+	void solve_band(std::vector<T>& column) const;
+
+	// Solve matrix equation, matrix * x = column. Column is overwritten by x.
+	void solve(std::vector<T>& column) const {
+		solve_boundary(column);
+		solve_band(column);
+	}
+
+};
+
+
+typedef FactorizedBandDiagonalTemp<double> FactorizedBandDiagonal;
+
+
+// Band-diagonal matrix equation solved in single precision, followed by
+// iterative refinement steps in double precision,
+//	r = column - matrix * x, matrix * dx = r (single precision), x += dx.
+// The single precision sweeps move half the data of the double precision
+// solver. For well-conditioned matrices (e.g. theta-scheme left-hand-sides)
+// two refinement steps recover double precision accuracy.
+class MixedPrecisionBandDiagonal {
+
+private:
+
+	// Number of iterative refinement steps.
+	int n_refinements_;
+
+	// Matrix with boundary rows eliminated, for residuals.
+	BandDiagonalTemp<double> matrix_;
+
+	FactorizedBandDiagonalTemp<float> factorized_;
+
+public:
+
+	MixedPrecisionBandDiagonal(
+		const TriDiagonal& matrix,
+		const int n_refinements = 2);
+
+	MixedPrecisionBandDiagonal(
+		const PentaDiagonal& matrix,
+		const int n_refinements = 2);
+
+	int order() const {
+		return factorized_.order();
+	}
+
+	// Solve matrix equation, matrix * x = column. Column is overwritten by x.
+	void solve(std::vector<double>& column) const;
+
+};
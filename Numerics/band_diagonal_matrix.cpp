@@ -1,3 +1,4 @@
+#include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <stdexcept>
@@ -79,7 +80,7 @@ bool BandDiagonal::operator==(const BandDiagonal& m)
 
 		for (int i = n_boundary_rows_; i != order_ - n_boundary_rows_; ++i) {
 			for (int j = 0; j != n_diagonals_; ++j) {
-				if (abs(matrix[j][i] - m.matrix[j][i]) > eps) {
+				if (std::abs(matrix[j][i] - m.matrix[j][i]) > eps) {
 					return false;
 				}
 			}
@@ -87,7 +88,7 @@ bool BandDiagonal::operator==(const BandDiagonal& m)
 
 		for (int i = 0; i != 2 * n_boundary_rows_; ++i) {
 			for (int j = 0; j != n_boundary_elements_; ++j) {
-				if (abs(boundary_rows[i][j] - m.boundary_rows[i][j]) > eps) {
+				if (std::abs(boundary_rows[i][j] - m.boundary_rows[i][j]) > eps) {
 					return false;
 				}
 			}
@@ -280,9 +281,11 @@ PentaDiagonal PentaDiagonal::identity() {
 
 PentaDiagonal PentaDiagonal::pre_vector(const std::vector<double>& vector) {
 
-	row_multiply_matrix<PentaDiagonal>(*this, vector);
+	PentaDiagonal result(*this);
 
-	return *this;
+	row_multiply_matrix<PentaDiagonal>(result, vector);
+
+	return result;
 
 }
 
@@ -324,9 +327,15 @@ void BandDiagonal::gauss_elimination(
 
 	for (int i = 0; i != n_diagonals_; ++i) {
 
-		// Adjust lower boundary rows.
 		me_lower_idx_tmp = me_lower_idx - i;
 		be_lower_idx_tmp = be_lower_idx - i;
+
+		// Matrix row extends beyond first column of boundary row (zero element).
+		if (be_lower_idx_tmp < 0) {
+			break;
+		}
+
+		// Adjust lower boundary rows.
 		boundary_rows_tmp[br_lower_idx][be_lower_idx_tmp] -= lower * matrix[me_lower_idx_tmp][mr_lower_idx];
 
 		// Adjust upper boundary rows.
@@ -474,7 +483,13 @@ void PentaDiagonal::adjust_boundary(std::vector<double>& column) {
 	else if (n_boundary_elements_ == 7) {
 
 		boundary_rows_tmp = boundary_rows;
+		gauss_elimination(1, 6, 4, column);
+		gauss_elimination(1, 5, 3, column);
+		gauss_elimination(1, 4, 2, column);
 		overwrite_bounary_row(1);
+		gauss_elimination(0, 5, 3, column);
+		gauss_elimination(0, 4, 2, column);
+		gauss_elimination(0, 3, 1, column);
 		overwrite_bounary_row(0);
 
 	}
@@ -623,6 +638,17 @@ void matrix_multiply_vector(
 }
 
 
+template void matrix_multiply_vector<TriDiagonal>(
+	const TriDiagonal& matrix,
+	const std::vector<double>& vector,
+	std::vector<double>& result);
+
+template void matrix_multiply_vector<PentaDiagonal>(
+	const PentaDiagonal& matrix,
+	const std::vector<double>& vector,
+	std::vector<double>& result);
+
+
 template<class T>
 void matrix_add_matrix(
 	const T& matrix1, 
@@ -3,6 +3,8 @@
 #include <vector>
 
 
+// Band-diagonal matrix stored in compact form, templated on scalar type.
+// No boundary rows; used for matrices with boundary rows eliminated.
 template<typename T>
 class BandDiagonalTemp {
 
@@ -11,6 +13,64 @@ public:
 	// Band-diagonal matrix in compact form.
 	std::vector<std::vector<T>> matrix;
 
+	BandDiagonalTemp() {}
+
+	// Conversion from compact form with other scalar type.
+	template<typename U>
+	BandDiagonalTemp(const std::vector<std::vector<U>>& _matrix) {
+
+		matrix.reserve(_matrix.size());
+
+		for (int i = 0; i != _matrix.size(); ++i) {
+			matrix.push_back(std::vector<T>(_matrix[i].begin(), _matrix[i].end()));
+		}
+
+	}
+
+	int order() const {
+		return matrix.empty() ? 0 : (int)matrix[0].size();
+	}
+
+	int bandwidth() const {
+		return ((int)matrix.size() - 1) / 2;
+	}
+
+	// Matrix-vector product, result = matrix * vector.
+	template<typename U>
+	void multiply(
+		const std::vector<U>& vector,
+		std::vector<U>& result) const {
+
+		const int n_elements = order();
+		const int n_diagonals = (int)matrix.size();
+		const int bw = bandwidth();
+
+		for (int i = 0; i != n_elements; ++i) {
+
+			U sum = 0;
+
+			if (i >= bw && i < n_elements - bw) {
+				// Interior row.
+				for (int d = 0; d != n_diagonals; ++d) {
+					sum += matrix[d][i] * vector[i + d - bw];
+				}
+			}
+			else {
+				// Boundary row.
+				for (int d = 0; d != n_diagonals; ++d) {
+					const int j = i + d - bw;
+					if (j >= 0 && j < n_elements) {
+						sum += matrix[d][i] * vector[j];
+					}
+				}
+			}
+
+			result[i] = sum;
+
+		}
+
+	}
+
 };
 
 
@@ -0,0 +1,202 @@
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "coefficient_cache.h"
+
+
+namespace coefficient_cache {
+
+	struct Entry {
+		Coefficients coef;
+		int bandwidth;
+		std::vector<double> grid;
+		std::shared_ptr<const Diagonals> diagonals;
+	};
+
+	// Entries by key, see key. Entries with equal key are kept in insertion
+	// order; order holds the keys of all entries in insertion order.
+	static std::shared_mutex cache_mutex;
+	static std::unordered_map<std::size_t, std::vector<Entry>> cache;
+	static std::deque<std::size_t> order;
+	static int evaluations = 0;
+
+
+	// Hash of coefficient function, bandwidth, grid size and grid points.
+	static std::size_t key(
+		Coefficients coef,
+		const std::vector<double>& grid,
+		const int bandwidth) {
+
+		std::size_t seed = std::hash<Coefficients>()(coef);
+
+		auto combine = [&seed](const std::size_t value) {
+			seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+		};
+
+		combine(std::hash<int>()(bandwidth));
+		combine(std::hash<std::size_t>()(grid.size()));
+		for (const double point : grid) {
+			combine(std::hash<double>()(point));
+		}
+
+		return seed;
+
+	}
+
+
+	// Cached entry, nullptr if missing. The caller holds a lock.
+	static const Entry* find(
+		const std::size_t hash,
+		Coefficients coef,
+		const std::vector<double>& grid,
+		const int bandwidth) {
+
+		const auto bucket = cache.find(hash);
+
+		if (bucket == cache.end()) {
+			return nullptr;
+		}
+
+		for (const Entry& entry : bucket->second) {
+			if (entry.coef == coef && entry.bandwidth == bandwidth && entry.grid == grid) {
+				return &entry;
+			}
+		}
+
+		return nullptr;
+
+	}
+
+
+	// Evaluate coefficients of interior rows.
+	static Diagonals evaluate(
+		Coefficients coef,
+		const std::vector<double>& grid,
+		const int bandwidth) {
+
+		const int order = (int)grid.size();
+		const int n_diagonals = 2 * bandwidth + 1;
+
+		if (bandwidth != 1 && bandwidth != 2) {
+			throw std::invalid_argument("Unknown matrix.");
+		}
+
+		if (order < n_diagonals) {
+			throw std::invalid_argument("Too few grid points.");
+		}
+
+		std::vector<double> row(order, 0.0);
+		Diagonals result(n_diagonals, row);
+
+		// Step sizes: dx_m2, dx_m1, dx_p1, dx_p2. Only dx_m1 and dx_p1
+		// for tri-diagonal matrices.
+		std::vector<double> dx_vector(4, 0.0);
+		std::vector<double> coef_tmp;
+
+		for (int i = bandwidth; i != order - bandwidth; ++i) {
+
+			dx_vector[1] = grid[i] - grid[i - 1];
+			dx_vector[2] = grid[i + 1] - grid[i];
+
+			if (bandwidth == 2) {
+				dx_vector[0] = grid[i - 1] - grid[i - 2];
+				dx_vector[3] = grid[i + 2] - grid[i + 1];
+			}
+
+			coef_tmp = coef(dx_vector);
+
+			for (int j = 0; j != n_diagonals; ++j) {
+				result[j][i] = coef_tmp[j];
+			}
+
+		}
+
+		return result;
+
+	}
+
+
+	std::shared_ptr<const Diagonals> diagonals(
+		Coefficients coef,
+		const std::vector<double>& grid,
+		const int bandwidth) {
+
+		const std::size_t hash = key(coef, grid, bandwidth);
+
+		{
+			std::shared_lock<std::shared_mutex> lock(cache_mutex);
+
+			if (const Entry* entry = find(hash, coef, grid, bandwidth)) {
+				return entry->diagonals;
+			}
+		}
+
+		// Evaluated without lock. Concurrent misses on the same key may
+		// evaluate twice, the first inserted result is shared.
+		Entry entry;
+		entry.coef = coef;
+		entry.bandwidth = bandwidth;
+		entry.grid = grid;
+		entry.diagonals = std::make_shared<const Diagonals>(evaluate(coef, grid, bandwidth));
+
+		std::unique_lock<std::shared_mutex> lock(cache_mutex);
+
+		++evaluations;
+
+		if (const Entry* inserted = find(hash, coef, grid, bandwidth)) {
+			return inserted->diagonals;
+		}
+
+		if ((int)order.size() == max_size) {
+			std::vector<Entry>& oldest = cache[order.front()];
+			oldest.erase(oldest.begin());
+			if (oldest.empty()) {
+				cache.erase(order.front());
+			}
+			order.pop_front();
+		}
+
+		cache[hash].push_back(entry);
+		order.push_back(hash);
+
+		return entry.diagonals;
+
+	}
+
+
+	int size() {
+
+		std::shared_lock<std::shared_mutex> lock(cache_mutex);
+
+		return (int)order.size();
+
+	}
+
+
+	int n_evaluations() {
+
+		std::shared_lock<std::shared_mutex> lock(cache_mutex);
+
+		return evaluations;
+
+	}
+
+
+	void clear() {
+
+		std::unique_lock<std::shared_mutex> lock(cache_mutex);
+
+		cache.clear();
+		order.clear();
+		evaluations = 0;
+
+	}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+
+// Cache of finite difference coefficients on non-uniform grids.
+//
+// The coefficients of the interior rows depend on the grid only. They are
+// evaluated once per (coefficient function, grid, bandwidth) and shared by
+// all operators set up on the same grid, see setup.
+namespace coefficient_cache {
+
+	// Finite difference coefficients as function of step size vector,
+	// e.g. coef_x1::nonuniform::c2.
+	typedef std::vector<double>(*Coefficients)(const std::vector<double>&);
+
+	// Coefficients of interior rows, [diagonal][row]. Boundary rows are zero.
+	typedef std::vector<std::vector<double>> Diagonals;
+
+	// Maximum number of cached entries. The oldest entry is discarded first.
+	const int max_size = 64;
+
+	// Coefficients of interior rows of band-diagonal matrix. Thread-safe:
+	// Entries are looked up by hash under a shared lock, and missing
+	// coefficients are evaluated outside the lock.
+	std::shared_ptr<const Diagonals> diagonals(
+		Coefficients coef,
+		const std::vector<double>& grid,
+		const int bandwidth);
+
+	// Number of cached entries.
+	int size();
+
+	// Number of coefficient evaluations (cache misses) since last clear.
+	int n_evaluations();
+
+	void clear();
+
+}
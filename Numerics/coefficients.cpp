@@ -1,8 +1,27 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 #include <vector>
 
 #include "coefficients.h"
 
 
+// Grid points relative to x, from step sizes dx_p1, dx_p2, ... of dx_vector.
+static std::vector<double> forward_nodes(
+	const std::vector<double>& dx_vector,
+	const int n_steps) {
+
+	std::vector<double> nodes(n_steps + 1, 0.0);
+
+	for (int i = 0; i != n_steps; ++i) {
+		nodes[i + 1] = nodes[i] + dx_vector[2 + i];
+	}
+
+	return nodes;
+
+}
+
+
 // Finite difference coefficients for first order derivative operator.
 namespace coef_x1 {
 
@@ -131,6 +150,12 @@ namespace coef_x1 {
 		// [1] dx_m1 = x - x_m1     TODO: Correct sign?
 		// [2] dx_p1 = x_p1 - x  
 		// [3] dx_p2 = x_p2 - x_p1
+		// Higher order one-sided differences use additional elements:
+		// [4] dx_p3 = x_p3 - x_p2
+		// [5] dx_p4 = x_p4 - x_p3
+		// [6] dx_p5 = x_p5 - x_p4
+		// For backward differences, the step sizes are given from the
+		// boundary point and inwards, i.e. dx_p1 = x - x_m1, etc.
 
 		// Central difference; 2nd order accuracy.
 		std::vector<double> c2(const std::vector<double>& dx_vector) {
@@ -242,6 +267,13 @@ namespace coef_x1 {
 
 		}
 
+		// Forward difference; 4th order accuracy.
+		std::vector<double> f4(const std::vector<double>& dx_vector) {
+
+			return fornberg(forward_nodes(dx_vector, 4), 1);
+
+		}
+
 		// Backward difference; 2nd order accuracy.
 		std::vector<double> b2(const std::vector<double>& dx_vector) {
 
@@ -249,6 +281,13 @@ namespace coef_x1 {
 
 		}
 
+		// Backward difference; 4th order accuracy.
+		std::vector<double> b4(const std::vector<double>& dx_vector) {
+
+			return reverse_order(f4(dx_vector), -1.0);
+
+		}
+
 	}
 
 }
@@ -386,6 +425,12 @@ namespace coef_x2 {
 		// [1] dx_m1 = x - x_m1     TODO: Correct sign?
 		// [2] dx_p1 = x_p1 - x  
 		// [3] dx_p2 = x_p2 - x_p1
+		// Higher order one-sided differences use additional elements:
+		// [4] dx_p3 = x_p3 - x_p2
+		// [5] dx_p4 = x_p4 - x_p3
+		// [6] dx_p5 = x_p5 - x_p4
+		// For backward differences, the step sizes are given from the
+		// boundary point and inwards, i.e. dx_p1 = x - x_m1, etc.
 
 		// Central difference; ~2nd order accuracy.
 		std::vector<double> c2(const std::vector<double>& dx_vector) {
@@ -469,6 +514,20 @@ namespace coef_x2 {
 
 		}
 
+		// Forward difference; 2nd order accuracy.
+		std::vector<double> f2(const std::vector<double>& dx_vector) {
+
+			return fornberg(forward_nodes(dx_vector, 3), 2);
+
+		}
+
+		// Forward difference; 4th order accuracy.
+		std::vector<double> f4(const std::vector<double>& dx_vector) {
+
+			return fornberg(forward_nodes(dx_vector, 5), 2);
+
+		}
+
 		// Backward difference; 1st order accuracy.
 		std::vector<double> b1(const std::vector<double>& dx_vector) {
 
@@ -476,11 +535,85 @@ namespace coef_x2 {
 
 		}
 
+		// Backward difference; 2nd order accuracy.
+		std::vector<double> b2(const std::vector<double>& dx_vector) {
+
+			return reverse_order(f2(dx_vector));
+
+		}
+
+		// Backward difference; 4th order accuracy.
+		std::vector<double> b4(const std::vector<double>& dx_vector) {
+
+			return reverse_order(f4(dx_vector));
+
+		}
+
 	}
 
 }
 
 
+// Finite difference coefficients on arbitrary grid points, see Fornberg (1988).
+// Grid points are given relative to the point of evaluation.
+std::vector<double> fornberg(
+	const std::vector<double>& nodes,
+	const int derivative_order) {
+
+	const int n_nodes = (int)nodes.size();
+
+	if (derivative_order >= n_nodes) {
+		throw std::invalid_argument("Too few grid points for derivative order.");
+	}
+
+	// Coefficients of all derivatives up to derivative_order.
+	std::vector<double> row(n_nodes, 0.0);
+	std::vector<std::vector<double>> coef(derivative_order + 1, row);
+
+	double c1 = 1.0;
+	double c2 = 0.0;
+	double c3 = 0.0;
+	double c4 = nodes[0];
+	double c5 = 0.0;
+
+	coef[0][0] = 1.0;
+
+	for (int i = 1; i != n_nodes; ++i) {
+
+		const int n_derivatives = std::min(i, derivative_order);
+
+		c2 = 1.0;
+		c5 = c4;
+		c4 = nodes[i];
+
+		for (int j = 0; j != i; ++j) {
+
+			c3 = nodes[i] - nodes[j];
+			c2 *= c3;
+
+			if (j == i - 1) {
+				for (int k = n_derivatives; k != 0; --k) {
+					coef[k][i] = c1 * (k * coef[k - 1][i - 1] - c5 * coef[k][i - 1]) / c2;
+				}
+				coef[0][i] = -c1 * c5 * coef[0][i - 1] / c2;
+			}
+
+			for (int k = n_derivatives; k != 0; --k) {
+				coef[k][j] = (c4 * coef[k][j] - k * coef[k - 1][j]) / c3;
+			}
+			coef[0][j] = c4 * coef[0][j] / c3;
+
+		}
+
+		c1 = c2;
+
+	}
+
+	return coef[derivative_order];
+
+}
+
+
 // Reverse order of coefficients and multiply by scalar.
 std::vector<double> reverse_order(
 	std::vector<double> coefficients, 
@@ -56,12 +56,18 @@ namespace coef_x1 {
 		// Forward difference; 2nd order accuracy.
 		std::vector<double> f2(const std::vector<double>& dx_vector);
 
+		// Forward difference; 4th order accuracy.
+		std::vector<double> f4(const std::vector<double>& dx_vector);
+
 		// Backward difference; 1st order accuracy.
 		std::vector<double> b1(const std::vector<double>& dx_vector);
 
 		// Backward difference; 2nd order accuracy.
 		std::vector<double> b2(const std::vector<double>& dx_vector);
 
+		// Backward difference; 4th order accuracy.
+		std::vector<double> b4(const std::vector<double>& dx_vector);
+
 	}
 
 }
@@ -117,18 +123,33 @@ namespace coef_x2 {
 		// Forward difference; 1st order accuracy.
 		std::vector<double> f1(const std::vector<double>& dx_vector);
 
-		// TODO: Forward difference; ~2nd order accuracy.
+		// Forward difference; 2nd order accuracy.
+		std::vector<double> f2(const std::vector<double>& dx_vector);
+
+		// Forward difference; 4th order accuracy.
+		std::vector<double> f4(const std::vector<double>& dx_vector);
 
 		// Backward difference; 1st order accuracy.
 		std::vector<double> b1(const std::vector<double>& dx_vector);
 
-		// TODO: Backward difference; ~2nd order accuracy.
+		// Backward difference; 2nd order accuracy.
+		std::vector<double> b2(const std::vector<double>& dx_vector);
+
+		// Backward difference; 4th order accuracy.
+		std::vector<double> b4(const std::vector<double>& dx_vector);
 
 	}
 
 }
 
 
+// Finite difference coefficients on arbitrary grid points, see Fornberg (1988).
+// nodes: Grid points relative to the point of evaluation.
+std::vector<double> fornberg(
+	const std::vector<double>& nodes,
+	const int derivative_order);
+
+
 // Reverse order of coefficients and multiply by scalar.
 std::vector<double> reverse_order(
 	std::vector<double> coef, 
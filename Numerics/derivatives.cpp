@@ -6,6 +6,40 @@
 #include "utility.h"
 
 
+// Step size vector of forward difference at grid[index], see coef_x1::nonuniform.
+static std::vector<double> forward_steps(
+	const std::vector<double>& grid,
+	const int index,
+	const int n_steps) {
+
+	std::vector<double> dx_vector(2 + n_steps, 0.0);
+
+	for (int i = 0; i != n_steps; ++i) {
+		dx_vector[2 + i] = grid[index + i + 1] - grid[index + i];
+	}
+
+	return dx_vector;
+
+}
+
+
+// Step size vector of backward difference at grid[index], see coef_x1::nonuniform.
+static std::vector<double> backward_steps(
+	const std::vector<double>& grid,
+	const int index,
+	const int n_steps) {
+
+	std::vector<double> dx_vector(2 + n_steps, 0.0);
+
+	for (int i = 0; i != n_steps; ++i) {
+		dx_vector[2 + i] = grid[index - i] - grid[index - i - 1];
+	}
+
+	return dx_vector;
+
+}
+
+
 // First order derivative operator. 
 // Central difference; 2nd order accuracy. Boundary; 1st order accuracy.
 TriDiagonal d1dx1::uniform::c2b1(const std::vector<double>& grid) {
@@ -247,6 +281,23 @@ PentaDiagonal d1dx1::nonuniform::c4b2(const std::vector<double>& grid) {
 }
 
 
+// First order derivative operator.
+// Central difference; 4th order accuracy. Boundary; 4th order accuracy.
+PentaDiagonal d1dx1::nonuniform::c4b4(const std::vector<double>& grid) {
+
+	const int order = (int)grid.size();
+
+	PentaDiagonal matrix = setup<PentaDiagonal>(order, grid, coef_x1::nonuniform::c4, 2, 5);
+	boundary<PentaDiagonal>(0, coef_x1::nonuniform::f4(forward_steps(grid, 0, 4)), matrix);
+	boundary<PentaDiagonal>(1, coef_x1::nonuniform::f4(forward_steps(grid, 1, 4)), matrix);
+	boundary<PentaDiagonal>(2, coef_x1::nonuniform::b4(backward_steps(grid, order - 2, 4)), matrix);
+	boundary<PentaDiagonal>(3, coef_x1::nonuniform::b4(backward_steps(grid, order - 1, 4)), matrix);
+
+	return matrix;
+
+}
+
+
 // Second order derivative operator.
 // Central difference; 2nd order accuracy. Boundary; d2dx2 = 0.
 TriDiagonal d2dx2::nonuniform::c2b0(const std::vector<double>& grid) {
@@ -282,6 +333,21 @@ TriDiagonal d2dx2::nonuniform::c2b1(const std::vector<double>& grid) {
 }
 
 
+// Second order derivative operator.
+// Central difference; 2nd order accuracy. Boundary; 2nd order accuracy.
+TriDiagonal d2dx2::nonuniform::c2b2(const std::vector<double>& grid) {
+
+	const int order = (int)grid.size();
+
+	TriDiagonal matrix = setup<TriDiagonal>(order, grid, coef_x2::nonuniform::c2, 1, 4);
+	boundary<TriDiagonal>(0, coef_x2::nonuniform::f2(forward_steps(grid, 0, 3)), matrix);
+	boundary<TriDiagonal>(1, coef_x2::nonuniform::b2(backward_steps(grid, order - 1, 3)), matrix);
+
+	return matrix;
+
+}
+
+
 // Second order derivative operator.
 // Central difference; 4th order accuracy. Boundary; 2nd row c2, 1st row d2dx2 = 0.
 PentaDiagonal d2dx2::nonuniform::c4b0(const std::vector<double>& grid) {
@@ -312,3 +378,20 @@ PentaDiagonal d2dx2::nonuniform::c4b0(const std::vector<double>& grid) {
 	return matrix;
 
 }
+
+
+// Second order derivative operator.
+// Central difference; 4th order accuracy. Boundary; 4th order accuracy.
+PentaDiagonal d2dx2::nonuniform::c4b4(const std::vector<double>& grid) {
+
+	const int order = (int)grid.size();
+
+	PentaDiagonal matrix = setup<PentaDiagonal>(order, grid, coef_x2::nonuniform::c4, 2, 6);
+	boundary<PentaDiagonal>(0, coef_x2::nonuniform::f4(forward_steps(grid, 0, 5)), matrix);
+	boundary<PentaDiagonal>(1, coef_x2::nonuniform::f4(forward_steps(grid, 1, 5)), matrix);
+	boundary<PentaDiagonal>(2, coef_x2::nonuniform::b4(backward_steps(grid, order - 2, 5)), matrix);
+	boundary<PentaDiagonal>(3, coef_x2::nonuniform::b4(backward_steps(grid, order - 1, 5)), matrix);
+
+	return matrix;
+
+}
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <stdexcept>
 #include <vector>
 
 #include "band_diagonal_matrix.h"
+#include "instrumentation.h"
 #include "utility.h"
 
 
@@ -48,6 +50,11 @@ namespace d1dx1 {
 		// Boundary 2nd row: Central difference, 2nd order accurary.
 		PentaDiagonal c4b2(const std::vector<double>& grid);
 
+		// Interior: Central difference, 4th order accuracy.
+		// Boundary 1st row: Forward difference, 4th order accurary.
+		// Boundary 2nd row: Forward difference, 4th order accurary.
+		PentaDiagonal c4b4(const std::vector<double>& grid);
+
 	}
 
 }
@@ -99,17 +106,128 @@ namespace d2dx2 {
 		// Boundary 1st row: Forward difference, 1st order accurary.
 		TriDiagonal c2b1(const std::vector<double>& grid);
 
+		// Interior: Central difference, 2nd order accuracy.
+		// Boundary 1st row: Forward difference, 2nd order accurary.
+		TriDiagonal c2b2(const std::vector<double>& grid);
+
 		// Interior: Central difference, 4th order accuracy.
 		// Boundary 1st row: Neumann boundary condition, d2dx2 = 0.
 		// Boundary 2nd row: Central difference, 2nd order accurary.
 		PentaDiagonal c4b0(const std::vector<double>& grid);
 
+		// Interior: Central difference, 4th order accuracy.
+		// Boundary 1st row: Forward difference, 4th order accurary.
+		// Boundary 2nd row: Forward difference, 4th order accurary.
+		PentaDiagonal c4b4(const std::vector<double>& grid);
+
 	}
 
 }
 
 
-// TODO: Class method for evaluating second order mixed derivative operator.
+// Kronecker product of two band-diagonal operators, (A (x) B), with
+// separable prefactors folded into the rows of the factors,
+//	diag(coef_a (x) coef_b) * (A (x) B) = (diag(coef_a) * A) (x) (diag(coef_b) * B).
+// The operator is applied as two passes of the factors along their
+// respective coordinates. Neither the full operator nor the full grid of
+// prefactors is stored.
+template <class T1, class T2>
+class KroneckerProduct {
+
+private:
+
+	T1 a;
+	T2 b;
+
+public:
+
+	KroneckerProduct() {}
+
+	KroneckerProduct(
+		const T1& a_,
+		const T2& b_) {
+
+		a = a_;
+		b = b_;
+
+	}
+
+	KroneckerProduct(
+		const T1& a_,
+		const T2& b_,
+		const std::vector<double>& coef_a,
+		const std::vector<double>& coef_b) {
+
+		a = a_;
+		b = b_;
+
+		a = a.pre_vector(coef_a);
+		b = b.pre_vector(coef_b);
+
+	}
+
+	const T1& first() const {
+		return a;
+	}
+
+	const T2& second() const {
+		return b;
+	}
+
+	// Operator on 2-dimensional grid, order of func (x, y), with A acting
+	// along x and B along y. The result may alias func. Scratch memory is
+	// taken from workspace.
+	void apply(
+		const std::vector<double>& func,
+		std::vector<double>& result,
+		Workspace& workspace) {
+
+		const int n_x = a.order();
+		const int n_y = b.order();
+
+		Workspace::Frame frame(workspace);
+
+		std::vector<double>& func_tmp = workspace.vector((int)func.size());
+
+		action_2d(n_y, n_x, 2, false, b, func, func_tmp, workspace);
+		action_2d(n_x, n_y, 1, false, a, func_tmp, result, workspace);
+
+	}
+
+	// Operator on 2-dimensional grid, order of func (x, y), with A acting
+	// along x and B along y.
+	std::vector<double> apply(
+		std::vector<double> func) {
+
+		Workspace workspace;
+		apply(func, func, workspace);
+
+		return func;
+
+	}
+
+	// Operator wrt. coordinates "dimension_a" and "dimension_b" (zero-based)
+	// on N-dimensional grid, see action_nd.
+	std::vector<double> apply(
+		std::vector<double> func,
+		const std::vector<int>& n_points,
+		const int dimension_a,
+		const int dimension_b) {
+
+		func = action_nd(n_points, dimension_b, false, b, func);
+		func = action_nd(n_points, dimension_a, false, a, func);
+
+		return func;
+
+	}
+
+};
+
+
+// Second order mixed derivative operator, prefactor * d2/dxdy.
+// Separable prefactors (scalar or coef_x (x) coef_y) are kept factored, see
+// KroneckerProduct. Non-separable prefactors are stored on the full grid,
+// and multiplied after the derivative passes.
 template <class T1, class T2>
 class MixedDerivative {
 
@@ -117,66 +235,114 @@ private:
 
 	T1 d1dx1;
 	T2 d1dy1;
+
+	// Prefactors folded into first order derivative operators.
+	KroneckerProduct<T1, T2> kronecker;
+
+	// Non-separable prefactors on the full grid. Empty if separable.
 	std::vector<double> prefactors;
 
 public:
 
 	MixedDerivative(
-		T1& d1dx1_, 
-		T2& d1dy1_) {
+		const T1& d1dx1_, 
+		const T2& d1dy1_) {
 
 		d1dx1 = d1dx1_;
 		d1dy1 = d1dy1_;
 
-		std::vector<double> tmp(d1dx1.order() * d1dy1.order(), 1.0);
-		prefactors = tmp;
+		kronecker = KroneckerProduct<T1, T2>(d1dx1, d1dy1);
 
 	}
 
+	bool separable() const {
+		return prefactors.empty();
+	}
+
+	// Operator with separable prefactors folded in, or without prefactors
+	// if non-separable.
+	const KroneckerProduct<T1, T2>& kronecker_product() const {
+		return kronecker;
+	}
+
+	// Non-separable prefactors on the full grid.
+	const std::vector<double>& get_prefactors() const {
+		return prefactors;
+	}
+
 	void set_prefactors(const double scalar) {
-		for (int i = 0; i != prefactors.size(); ++i) {
-			prefactors[i] = scalar;
-		}
+		kronecker = KroneckerProduct<T1, T2>(d1dx1 * scalar, d1dy1);
+		prefactors.clear();
 	}
 
+	// Separable prefactors, coef_x[i] * coef_y[j].
 	void set_prefactors(
 		const std::vector<double>& coef_x,
 		const std::vector<double>& coef_y) {
-		int index = 0;
-		for (int i = 0; i != coef_x.size(); ++i) {
-			for (int j = 0; j != coef_y.size(); ++j) {
-				prefactors[i] = coef_x[i] * coef_y[j];
-				++index;
-			}
-		}
+		kronecker = KroneckerProduct<T1, T2>(d1dx1, d1dy1, coef_x, coef_y);
+		prefactors.clear();
 	}
 
+	// Prefactors on the full grid. On an N-dimensional grid, the size 
+	// differs from the order of d1dx1 times order of d1dy1.
 	void set_prefactors(
 		const std::vector<double>& factors) {
-		int index = 0;
-		for (int i = 0; i != factors.size(); ++i) {
-			prefactors[i] = factors[i];
-				++index;
+		kronecker = KroneckerProduct<T1, T2>(d1dx1, d1dy1);
+		prefactors = factors;
+	}
+
+	// Mixed derivative on 2-dimensional grid, order of func (x, y). The
+	// result may alias func. Scratch memory is taken from workspace.
+	void d2dxdy(
+		const std::vector<double>& func,
+		std::vector<double>& result,
+		Workspace& workspace) {
+
+		NFS_SCOPE_BYTES("MixedDerivative::d2dxdy", 32.0 * func.size());
+
+		kronecker.apply(func, result, workspace);
+
+		// Multiply non-separable prefactors.
+		for (int i = 0; i != prefactors.size(); ++i) {
+			result[i] *= prefactors[i];
 		}
+
 	}
 
 	std::vector<double> d2dxdy(
 		std::vector<double> func) {
 
-		const int n_x = d1dx1.order();
-		const int n_y = d1dy1.order();
+		NFS_SCOPE_BYTES("MixedDerivative::d2dxdy", 32.0 * func.size());
 
-		std::vector<double> vec_x(n_x, 0.0);
-		std::vector<double> vec_y(n_y, 0.0);
+		func = kronecker.apply(func);
 
-		// Evaluate first order partial derivative wrt y.
-		func = action_2d(n_y, n_x, 2, false, d1dy1, func);
+		// Multiply non-separable prefactors.
+		for (int i = 0; i != prefactors.size(); ++i) {
+			func[i] *= prefactors[i];
+		}
 
-		// Evaluate first order partial derivative wrt x.
-		func = action_2d(n_x, n_y, 1, false, d1dx1, func);
+		return func;
+
+	}
 
-		// Multiply prefactors.
-		for (int i = 0; i != n_x * n_y; ++i) {
+	// Mixed derivative wrt. coordinates "dimension_x" and "dimension_y" 
+	// (zero-based) on N-dimensional grid, see action_nd.
+	std::vector<double> d2dxdy(
+		std::vector<double> func,
+		const std::vector<int>& n_points,
+		const int dimension_x,
+		const int dimension_y) {
+
+		NFS_SCOPE_BYTES("MixedDerivative::d2dxdy", 32.0 * func.size());
+
+		if (!separable() && prefactors.size() != func.size()) {
+			throw std::invalid_argument("Prefactors should be set on the full grid.");
+		}
+
+		func = kronecker.apply(func, n_points, dimension_x, dimension_y);
+
+		// Multiply non-separable prefactors.
+		for (int i = 0; i != prefactors.size(); ++i) {
 			func[i] *= prefactors[i];
 		}
 
@@ -185,3 +351,43 @@ public:
 	}
 
 };
+
+
+// Sum of mixed derivative terms on N-dimensional grid. 
+// Order of mixed derivatives wrt. coordinate pairs:
+//	(0, 1), (0, 2), ..., (0, N - 1), (1, 2), ..., (N - 2, N - 1).
+// An empty vector corresponds to vanishing mixed derivative terms.
+template <class T>
+std::vector<double> d2dxdy_nd(
+	const std::vector<int>& n_points,
+	std::vector<MixedDerivative<T, T>>& mixed,
+	const std::vector<double>& func) {
+
+	const int n_dimensions = (int)n_points.size();
+
+	std::vector<double> result(func.size(), 0.0);
+
+	if (mixed.empty()) {
+		return result;
+	}
+
+	if (mixed.size() != n_dimensions * (n_dimensions - 1) / 2) {
+		throw std::invalid_argument("Wrong number of mixed derivative terms.");
+	}
+
+	std::vector<double> func_tmp;
+
+	int index = 0;
+	for (int i = 0; i != n_dimensions; ++i) {
+		for (int j = i + 1; j != n_dimensions; ++j) {
+			func_tmp = mixed[index].d2dxdy(func, n_points, i, j);
+			for (int k = 0; k != func.size(); ++k) {
+				result[k] += func_tmp[k];
+			}
+			++index;
+		}
+	}
+
+	return result;
+
+}
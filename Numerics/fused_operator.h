@@ -0,0 +1,331 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "band_diagonal_factorized.h"
+#include "instrumentation.h"
+#include "matrix_equation_solver.h"
+#include "workspace.h"
+
+
+// Differential operator along one dimension of a 2-dimensional grid,
+// with the prefactors folded into ready-to-use band coefficients.
+// For each function strip ("line") along the dimension in question, the
+// operator reads
+//		D_line = C1 * f1(x) * g1(y) * d1dx1 + C2 * f2(x) * g2(y) * d2dx2
+//			+ C3 * f3(x) * g3(y) * identity,
+// see action_2d. For constant prefactors, a single operator is shared by
+// all lines.
+//
+// The ADI factors enter as adi_factors[0] * identity + adi_factors[1] * D_line.
+// Explicit actions use D_line directly, whereas the left-hand-side operators
+// are assembled and factorized once and reused until the ADI factors change,
+// i.e. once overall for a constant time step.
+template <class T>
+class FusedOperator {
+
+private:
+
+	int n_points_1_;
+	int n_points_2_;
+	int filter_;
+
+	// Distance in func between neighbouring elements of a strip (factor_j)
+	// and between neighbouring strips (factor_i), see action_2d.
+	int factor_i_;
+	int factor_j_;
+
+	T identity_;
+
+	// Spatial operator, one per line or one shared by all lines.
+	std::vector<T> operators_;
+
+	// Factorized left-hand-side operators,
+	// adi_factors_[0] * identity + adi_factors_[1] * D_line.
+	std::vector<FactorizedBandDiagonal> lhs_;
+	std::vector<double> adi_factors_;
+
+	void set_layout() {
+
+		if (filter_ == 1) {
+			// Function strip along x-dimension. Order (x, y).
+			factor_i_ = 1;
+			factor_j_ = n_points_2_;
+		}
+		else if (filter_ == 2) {
+			// Function strip along y-dimension. Order (y, x).
+			factor_i_ = n_points_1_;
+			factor_j_ = 1;
+		}
+		else {
+			throw std::invalid_argument("Unknown filter.");
+		}
+
+	}
+
+public:
+
+	// Constant prefactors: D = prefactors[0] * d1dx1 + prefactors[1] * d2dx2.
+	// derivatives: {identity, d1dx1, d2dx2}.
+	FusedOperator(
+		const int n_points_1,
+		const int n_points_2,
+		const int filter,
+		const std::vector<double>& prefactors,
+		std::vector<T>& derivatives) {
+
+		NFS_SCOPE("FusedOperator::FusedOperator");
+
+		n_points_1_ = n_points_1;
+		n_points_2_ = n_points_2;
+		filter_ = filter;
+		set_layout();
+
+		identity_ = derivatives[0];
+
+		T derivative = prefactors[0] * derivatives[1];
+		derivative += prefactors[1] * derivatives[2];
+
+		operators_.push_back(derivative);
+
+	}
+
+	// Prefactors of the form [C, f(grid_1)..., g(grid_2)...] for 1st order
+	// derivative, 2nd order derivative and inhomogeneous term, see action_2d.
+	// derivatives: {identity, d1dx1, d2dx2}.
+	FusedOperator(
+		const int n_points_1,
+		const int n_points_2,
+		const int filter,
+		const std::vector<std::vector<double>>& prefactors,
+		std::vector<T>& derivatives) {
+
+		NFS_SCOPE("FusedOperator::FusedOperator");
+
+		n_points_1_ = n_points_1;
+		n_points_2_ = n_points_2;
+		filter_ = filter;
+		set_layout();
+
+		identity_ = derivatives[0];
+
+		int n_start = 0;
+		int n_index = 0;
+
+		if (filter_ == 1) {
+			n_start = 1;
+			n_index = 1 + n_points_1_;
+		}
+		else {
+			n_start = 1 + n_points_2_;
+			n_index = 1;
+		}
+
+		std::vector<double> vec1(n_points_1_, 0.0);
+		std::vector<double> vec2(n_points_1_, 0.0);
+		std::vector<double> vec3(n_points_1_, 0.0);
+
+		operators_.reserve(n_points_2_);
+
+		for (int i = 0; i != n_points_2_; ++i) {
+
+			// C * f(line coordinate) * g(other coordinate).
+			for (int j = 0; j != n_points_1_; ++j) {
+				vec1[j] = prefactors[0][0] * prefactors[0][n_start + j] * prefactors[0][n_index + i];
+				vec2[j] = prefactors[1][0] * prefactors[1][n_start + j] * prefactors[1][n_index + i];
+				vec3[j] = prefactors[2][0] * prefactors[2][n_start + j] * prefactors[2][n_index + i];
+			}
+
+			T derivative = derivatives[1].pre_vector(vec1);
+			derivative += derivatives[2].pre_vector(vec2);
+			derivative += derivatives[0].pre_vector(vec3);
+
+			operators_.push_back(derivative);
+
+		}
+
+	}
+
+	int n_lines() const {
+		return n_points_2_;
+	}
+
+	// x = (adi_factors[0] * identity + adi_factors[1] * D) * func.
+	// The result may alias func. Function strips are taken from workspace.
+	void apply(
+		const std::vector<double>& adi_factors,
+		const std::vector<double>& func,
+		std::vector<double>& result,
+		Workspace& workspace) {
+
+		NFS_SCOPE_BYTES("FusedOperator::apply", 8.0 * func.size() * (operators_[0].matrix.size() + 4));
+
+		Workspace::Frame frame(workspace);
+
+		std::vector<double>& func_strip = workspace.vector(n_points_1_);
+		std::vector<double>& strip_tmp = workspace.vector(n_points_1_);
+
+		result.resize(func.size());
+
+		int index = 0;
+
+		for (int i = 0; i != n_points_2_; ++i) {
+
+			// Function strip along 1st dimension.
+			for (int j = 0; j != n_points_1_; ++j) {
+				index = factor_i_ * i + factor_j_ * j;
+				func_strip[j] = func[index];
+			}
+
+			const T& derivative = operators_.size() == 1 ? operators_[0] : operators_[i];
+			std::fill(strip_tmp.begin(), strip_tmp.end(), 0.0);
+			matrix_multiply_vector<T>(derivative, func_strip, strip_tmp);
+
+			// Save result.
+			for (int j = 0; j != n_points_1_; ++j) {
+				index = factor_i_ * i + factor_j_ * j;
+				result[index] = adi_factors[0] * func_strip[j] + adi_factors[1] * strip_tmp[j];
+			}
+
+		}
+
+	}
+
+	// x = (adi_factors[0] * identity + adi_factors[1] * D) * func.
+	std::vector<double> apply(
+		const std::vector<double>& adi_factors,
+		const std::vector<double>& func) {
+
+		std::vector<double> func_return(func.size(), 0.0);
+
+		Workspace workspace;
+		apply(adi_factors, func, func_return, workspace);
+
+		return func_return;
+
+	}
+
+	// Assemble and factorize left-hand-side operators, unless already available.
+	void assemble(const std::vector<double>& adi_factors) {
+
+		if (!lhs_.empty() && adi_factors == adi_factors_) {
+			return;
+		}
+
+		NFS_SCOPE("FusedOperator::assemble");
+
+		adi_factors_ = adi_factors;
+
+		lhs_.clear();
+		lhs_.reserve(operators_.size());
+
+		for (int i = 0; i != operators_.size(); ++i) {
+			T derivative = adi_factors[0] * identity_;
+			derivative += adi_factors[1] * operators_[i];
+			lhs_.push_back(FactorizedBandDiagonal(derivative));
+		}
+
+	}
+
+	// Solve (adi_factors[0] * identity + adi_factors[1] * D) * x = func.
+	// The result may alias func. Function strips are taken from workspace.
+	void solve(
+		const std::vector<double>& adi_factors,
+		const std::vector<double>& func,
+		std::vector<double>& result,
+		Workspace& workspace) {
+
+		NFS_SCOPE_BYTES("FusedOperator::solve", 8.0 * func.size() * (operators_[0].matrix.size() + 4));
+
+		assemble(adi_factors);
+
+		Workspace::Frame frame(workspace);
+
+		std::vector<double>& func_strip = workspace.vector(n_points_1_);
+
+		result.resize(func.size());
+
+		int index = 0;
+
+		for (int i = 0; i != n_points_2_; ++i) {
+
+			// Function strip along 1st dimension.
+			for (int j = 0; j != n_points_1_; ++j) {
+				index = factor_i_ * i + factor_j_ * j;
+				func_strip[j] = func[index];
+			}
+
+			const FactorizedBandDiagonal& lhs = lhs_.size() == 1 ? lhs_[0] : lhs_[i];
+			lhs.solve(func_strip);
+
+			// Save result.
+			for (int j = 0; j != n_points_1_; ++j) {
+				index = factor_i_ * i + factor_j_ * j;
+				result[index] = func_strip[j];
+			}
+
+		}
+
+	}
+
+	// Solve (adi_factors[0] * identity + adi_factors[1] * D) * x = func.
+	std::vector<double> solve(
+		const std::vector<double>& adi_factors,
+		const std::vector<double>& func) {
+
+		std::vector<double> func_return(func.size(), 0.0);
+
+		Workspace workspace;
+		solve(adi_factors, func, func_return, workspace);
+
+		return func_return;
+
+	}
+
+};
+
+
+// Evaulation of differential operator expression, 2-dimensional, using
+// pre-assembled operators and scratch memory from workspace, see below.
+// The result may alias func.
+template <class T>
+void action_2d(
+	const bool solve_equation,
+	const std::vector<double>& adi_factors,
+	FusedOperator<T>& derivative,
+	const std::vector<double>& func,
+	std::vector<double>& result,
+	Workspace& workspace) {
+
+	if (solve_equation) {
+		derivative.solve(adi_factors, func, result, workspace);
+	}
+	else {
+		derivative.apply(adi_factors, func, result, workspace);
+	}
+
+}
+
+
+// Evaulation of differential operator expression, 2-dimensional, using
+// pre-assembled operators.
+// solve_equation
+//	- true: (adi_factors[0] * identity + adi_factors[1] * D) * x = func
+//  - false: x = (adi_factors[0] * identity + adi_factors[1] * D) * func
+template <class T>
+std::vector<double> action_2d(
+	const bool solve_equation,
+	const std::vector<double>& adi_factors,
+	FusedOperator<T>& derivative,
+	const std::vector<double>& func) {
+
+	if (solve_equation) {
+		return derivative.solve(adi_factors, func);
+	}
+	else {
+		return derivative.apply(adi_factors, func);
+	}
+
+}
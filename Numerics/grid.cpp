@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <cmath>
+#include <stdexcept>
 #include <vector>
 
 #include <Eigen/Dense>
@@ -106,19 +108,392 @@ std::vector<double> grid::hyperbolic(
 }
 
 
+// Remove every second grid point.
+std::vector<double> grid::coarsen(const std::vector<double>& grid) {
+
+	const int n_points = (int)grid.size();
+
+	if (n_points < 3 || n_points % 2 == 0) {
+		throw std::invalid_argument("Number of grid points should be odd.");
+	}
+
+	std::vector<double> coarse((n_points + 1) / 2, 0.0);
+
+	for (int i = 0; i != coarse.size(); ++i) {
+		coarse[i] = grid[2 * i];
+	}
+
+	return coarse;
+
+}
+
+
+std::vector<double> grid::with_events(
+	std::vector<double> events,
+	const double dt_max,
+	const double tolerance) {
+
+	if (dt_max <= 0.0) {
+		throw std::invalid_argument("Maximum time step should be positive.");
+	}
+
+	events.push_back(0.0);
+	std::sort(events.begin(), events.end());
+
+	if (events.front() < 0.0) {
+		throw std::invalid_argument("Event times should be non-negative.");
+	}
+
+	std::vector<double> grid{ 0.0 };
+
+	for (int i = 1; i != events.size(); ++i) {
+
+		const double start = grid.back();
+		const double interval = events[i] - start;
+		if (interval <= tolerance) {
+			continue;
+		}
+
+		const int n_steps = (int)std::ceil(interval / dt_max - tolerance);
+		for (int j = 1; j != n_steps; ++j) {
+			grid.push_back(start + j * interval / n_steps);
+		}
+		grid.push_back(events[i]);
+
+	}
+
+	return grid;
+
+}
+
+
+int grid::find(
+	const std::vector<double>& grid,
+	const double x,
+	const double tolerance) {
+
+	const int i = (int)(std::lower_bound(grid.begin(), grid.end(), x - tolerance) - grid.begin());
+
+	if (i == grid.size() || grid[i] > x + tolerance) {
+		throw std::invalid_argument("Grid point not found.");
+	}
+
+	return i;
+
+}
+
+
+grid::Builder::Builder(
+	const double x_min,
+	const double x_max,
+	const double uniform_weight) {
+
+	if (x_max <= x_min) {
+		throw std::invalid_argument("x_max should be larger than x_min.");
+	}
+
+	if (uniform_weight < 0.0) {
+		throw std::invalid_argument("Weight should be non-negative.");
+	}
+
+	x_min_ = x_min;
+	x_max_ = x_max;
+	uniform_weight_ = uniform_weight;
+
+}
+
+
+grid::Builder& grid::Builder::concentrate(
+	const double x_center,
+	const double scaling,
+	const double weight) {
+
+	if (scaling <= 0.0 || weight <= 0.0) {
+		throw std::invalid_argument("Scaling and weight should be positive.");
+	}
+
+	const double beta = scaling * (x_max_ - x_min_);
+	const double offset = std::asinh((x_min_ - x_center) / beta);
+	const double range = std::asinh((x_max_ - x_center) / beta) - offset;
+
+	centers_.push_back(x_center);
+	betas_.push_back(beta);
+	weights_.push_back(weight);
+	offsets_.push_back(offset);
+	ranges_.push_back(range);
+
+	return *this;
+
+}
+
+
+grid::Builder& grid::Builder::align(const double x) {
+
+	if (x <= x_min_ || x >= x_max_) {
+		throw std::invalid_argument("Aligned point should be interior.");
+	}
+
+	aligned_.insert(std::upper_bound(aligned_.begin(), aligned_.end(), x), x);
+
+	return *this;
+
+}
+
+
+// Cumulative grid point density, Phi(x).
+double grid::Builder::density_cumulative(const double x) const {
+
+	double weight_sum = uniform_weight_;
+	double result = uniform_weight_ * (x - x_min_) / (x_max_ - x_min_);
+
+	for (int k = 0; k != centers_.size(); ++k) {
+		weight_sum += weights_[k];
+		result += weights_[k]
+			* (std::asinh((x - centers_[k]) / betas_[k]) - offsets_[k]) / ranges_[k];
+	}
+
+	if (weight_sum == 0.0) {
+		return (x - x_min_) / (x_max_ - x_min_);
+	}
+
+	return result / weight_sum;
+
+}
+
+
+// Grid point density, dPhi/dx.
+double grid::Builder::density(const double x) const {
+
+	double weight_sum = uniform_weight_;
+	double result = uniform_weight_ / (x_max_ - x_min_);
+
+	double tmp = 0.0;
+
+	for (int k = 0; k != centers_.size(); ++k) {
+		weight_sum += weights_[k];
+		tmp = (x - centers_[k]) / betas_[k];
+		result += weights_[k] / (ranges_[k] * betas_[k] * std::sqrt(1.0 + tmp * tmp));
+	}
+
+	if (weight_sum == 0.0) {
+		return 1.0 / (x_max_ - x_min_);
+	}
+
+	return result / weight_sum;
+
+}
+
+
+// Newton iteration, safeguarded by bisection (Phi is strictly increasing).
+double grid::Builder::density_inverse(const double z, const double x_guess) const {
+
+	const double tolerance = 1.0e-14 * (x_max_ - x_min_);
+	const int max_iterations = 100;
+
+	double lower = x_min_;
+	double upper = x_max_;
+	double x = x_guess;
+
+	for (int i = 0; i != max_iterations; ++i) {
+
+		const double f = density_cumulative(x) - z;
+
+		if (f > 0.0) {
+			upper = x;
+		}
+		else {
+			lower = x;
+		}
+
+		double x_new = x - f / density(x);
+
+		if (x_new <= lower || x_new >= upper) {
+			x_new = 0.5 * (lower + upper);
+		}
+
+		if (std::abs(x_new - x) < tolerance) {
+			return x_new;
+		}
+
+		x = x_new;
+
+	}
+
+	return x;
+
+}
+
+
+// Aligned points are mapped onto grid points by a piecewise linear map
+// from the uniform coordinate xi to z = Phi(x). The nodes of the map are
+// (0, 0), (xi_k, Phi(x_k)) and (1, 1), where xi_k is closest to Phi(x_k) on
+// the uniform grid.
+void grid::Builder::anchors(
+	const int n_points,
+	std::vector<double>& xi,
+	std::vector<double>& z,
+	std::vector<int>& index) const {
+
+	const int n_intervals = n_points - 1;
+
+	xi = { 0.0 };
+	z = { 0.0 };
+	index = { 0 };
+
+	for (int k = 0; k != aligned_.size(); ++k) {
+
+		const double z_aligned = density_cumulative(aligned_[k]);
+		const int i = (int)std::lround(z_aligned * n_intervals);
+
+		if (i <= index.back() || i >= n_intervals) {
+			throw std::invalid_argument("Too few grid points to align all points.");
+		}
+
+		xi.push_back((double)i / (double)n_intervals);
+		z.push_back(z_aligned);
+		index.push_back(i);
+
+	}
+
+	xi.push_back(1.0);
+	z.push_back(1.0);
+	index.push_back(n_intervals);
+
+}
+
+
+void grid::Builder::evaluate(
+	const int n_intervals,
+	const std::vector<double>& xi,
+	const std::vector<double>& z,
+	const std::vector<int>& indices,
+	std::vector<double>& grid) const {
+
+	int segment = 0;
+	double x_guess = x_min_;
+
+	for (int i : indices) {
+
+		const double xi_tmp = (double)i / (double)n_intervals;
+
+		while (xi_tmp > xi[segment + 1]) {
+			++segment;
+		}
+
+		const double z_tmp = z[segment]
+			+ (xi_tmp - xi[segment]) * (z[segment + 1] - z[segment]) / (xi[segment + 1] - xi[segment]);
+
+		grid[i] = density_inverse(z_tmp, x_guess);
+		x_guess = grid[i];
+
+	}
+
+}
+
+
+std::vector<double> grid::Builder::build(const int n_points) const {
+
+	return hierarchy(n_points, 1)[0];
+
+}
+
+
+std::vector<std::vector<double>> grid::Builder::hierarchy(
+	const int n_points,
+	const int n_levels) const {
+
+	if (n_points < 2 || n_levels < 1) {
+		throw std::invalid_argument("Too few grid points or levels.");
+	}
+
+	std::vector<double> xi;
+	std::vector<double> z;
+	std::vector<int> index;
+
+	// The alignment map is determined on the coarsest grid, and shared by all levels.
+	anchors(n_points, xi, z, index);
+
+	std::vector<std::vector<double>> levels;
+
+	std::vector<int> indices;
+
+	for (int level = 0; level != n_levels; ++level) {
+
+		const int n_intervals = (n_points - 1) << level;
+
+		std::vector<double> grid(n_intervals + 1, 0.0);
+
+		indices.clear();
+
+		if (level == 0) {
+			for (int i = 1; i != n_intervals; ++i) {
+				indices.push_back(i);
+			}
+		}
+		else {
+			// Grid points of parent level are reused.
+			const std::vector<double>& parent = levels.back();
+			for (int i = 0; i != parent.size(); ++i) {
+				grid[2 * i] = parent[i];
+			}
+			for (int i = 1; i < n_intervals; i += 2) {
+				indices.push_back(i);
+			}
+		}
+
+		evaluate(n_intervals, xi, z, indices, grid);
+
+		grid[0] = x_min_;
+		grid[n_intervals] = x_max_;
+
+		// Exact alignment.
+		if (level == 0) {
+			for (int k = 0; k != aligned_.size(); ++k) {
+				grid[index[k + 1]] = aligned_[k];
+			}
+		}
+
+		levels.push_back(grid);
+
+	}
+
+	return levels;
+
+}
+
+
+Eigen::VectorXd grid::eigen::convert(const std::vector<double>& grid) {
+
+	return Eigen::Map<const Eigen::VectorXd>(grid.data(), grid.size());
+
+}
+
+
 Eigen::VectorXd grid::eigen::uniform(
 	const double x_min, 
 	const double x_max, 
 	const int n_points) {
 
-	const double dx = (x_max - x_min) / (n_points - 1);
+	return convert(grid::uniform(x_min, x_max, n_points));
 
-	Eigen::VectorXd grid(n_points);
+}
 
-	for (int i = 0; i != n_points; ++i) {
-		grid(i) = dx * i + x_min;
-	}
 
-	return grid;
+Eigen::VectorXd grid::eigen::exponential(
+	const double x_min,
+	const double x_max,
+	const int n_points) {
+
+	return convert(grid::exponential(x_min, x_max, n_points));
+
+}
+
+
+Eigen::VectorXd grid::eigen::hyperbolic(
+	const double x_min,
+	const double x_max,
+	const int n_points) {
+
+	return convert(grid::hyperbolic(x_min, x_max, n_points));
 
 }
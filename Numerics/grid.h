@@ -44,13 +44,126 @@ namespace grid {
 		const double x_max,
 		const int n_points);
 
+	// Remove every second grid point. The number of grid points should be odd.
+	std::vector<double> coarsen(const std::vector<double>& grid);
+
+	// Time grid on [0, last event] containing every event time (coupon
+	// dates, expiries, etc.), with uniform time steps no longer than dt_max
+	// between consecutive events. Events closer than tolerance are merged.
+	std::vector<double> with_events(
+		std::vector<double> events,
+		const double dt_max,
+		const double tolerance = 1.0e-10);
+
+	// Index of grid point equal to x within tolerance.
+	int find(
+		const std::vector<double>& grid,
+		const double x,
+		const double tolerance = 1.0e-10);
+
+	// Non-uniform grid with grid points concentrated around several
+	// critical points (spot, strikes, barriers), and with grid points
+	// aligned exactly with selected points.
+	//
+	// The grid is given by the inverse of the cumulative grid point density
+	//	Phi(x) = (w_0 * (x - x_min) / (x_max - x_min) + sum_k w_k * A_k(x)) / W,
+	// where A_k(x) is asinh((x - x_k) / beta_k), normalized to [0, 1] on
+	// [x_min, x_max], beta_k = scaling_k * (x_max - x_min) and W is the sum of
+	// weights. A single concentration point without uniform weight
+	// reproduces hyperbolic_full.
+	//
+	// Grid points are aligned by a piecewise linear reparametrization of
+	// the uniform coordinate, such that a grid point maps onto each aligned
+	// point. Grid hierarchies nest: Grid points at level l are reused as
+	// every second grid point at level l + 1.
+	class Builder {
+
+	private:
+
+		double x_min_;
+		double x_max_;
+		double uniform_weight_;
+
+		// Concentration points, scaling (beta_k) and weights.
+		std::vector<double> centers_;
+		std::vector<double> betas_;
+		std::vector<double> weights_;
+
+		// Normalization of A_k.
+		std::vector<double> offsets_;
+		std::vector<double> ranges_;
+
+		// Aligned points, in ascending order.
+		std::vector<double> aligned_;
+
+		// Cumulative grid point density and its derivative.
+		double density_cumulative(const double x) const;
+		double density(const double x) const;
+
+		// Inverse of cumulative grid point density, initial guess x_guess.
+		double density_inverse(const double z, const double x_guess) const;
+
+		// Uniform coordinates of aligned points, for n_points grid points.
+		void anchors(
+			const int n_points,
+			std::vector<double>& xi,
+			std::vector<double>& z,
+			std::vector<int>& index) const;
+
+		// Grid points with uniform coordinate i / n_intervals for i in indices.
+		void evaluate(
+			const int n_intervals,
+			const std::vector<double>& xi,
+			const std::vector<double>& z,
+			const std::vector<int>& indices,
+			std::vector<double>& grid) const;
+
+	public:
+
+		Builder(
+			const double x_min,
+			const double x_max,
+			const double uniform_weight = 0.0);
+
+		// Concentrate grid points around x_center, see hyperbolic_full.
+		Builder& concentrate(
+			const double x_center,
+			const double scaling = 0.1,
+			const double weight = 1.0);
+
+		// Align a grid point exactly with x (strike, barrier, etc.).
+		Builder& align(const double x);
+
+		std::vector<double> build(const int n_points) const;
+
+		// Nested grids, n_levels in total. The coarsest grid has n_points
+		// grid points, level l has (n_points - 1) * 2^l + 1 grid points.
+		std::vector<std::vector<double>> hierarchy(
+			const int n_points,
+			const int n_levels) const;
+
+	};
+
+	// Eigen representation of grid functions above.
 	namespace eigen {
 
+		Eigen::VectorXd convert(const std::vector<double>& grid);
+
 		Eigen::VectorXd uniform(
 			const double x_min,
 			const double x_max,
 			const int n_points);
 
+		Eigen::VectorXd exponential(
+			const double x_min,
+			const double x_max,
+			const int n_points);
+
+		Eigen::VectorXd hyperbolic(
+			const double x_min,
+			const double x_max,
+			const int n_points);
+
 	}
 
 }
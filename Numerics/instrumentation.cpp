@@ -0,0 +1,313 @@
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "instrumentation.h"
+
+
+namespace {
+
+	// Statistics of a phase. Times in nanoseconds.
+	struct Phase {
+		long long n_calls = 0;
+		long long wall_time = 0;
+		long long child_time = 0;
+		long long bytes = 0;
+		long long n_allocations = 0;
+	};
+
+	// Complete event of Chrome trace. Times in nanoseconds since origin.
+	struct TraceEvent {
+		int phase;
+		int thread;
+		long long start;
+		long long duration;
+	};
+
+	// Fixed capacity: Registered phases are accessed without lock.
+	const int max_phases = 256;
+	std::string phase_names[max_phases];
+	std::atomic<int> n_phases{ 0 };
+	std::unordered_map<std::string, int> phase_index;
+	std::mutex phase_mutex;
+
+	std::atomic<bool> trace_enabled{ false };
+
+	// Statistics and trace events of one thread. Only the owning thread
+	// updates the table, hence the mutex is contended only while the
+	// tables are merged (report, write_chrome_trace) or cleared (reset).
+	struct ThreadStatistics {
+		int thread;
+		std::mutex mutex;
+		Phase phases[max_phases];
+		std::vector<TraceEvent> trace_events;
+	};
+
+	// Tables of all threads that have entered a scope. Tables outlive their
+	// threads, hence statistics of finished threads are kept.
+	std::vector<std::unique_ptr<ThreadStatistics>> thread_statistics;
+	std::mutex thread_mutex;
+
+	const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+	// Innermost active scope of calling thread.
+	thread_local instrumentation::ScopedTimer* current_scope = nullptr;
+
+	// Table of calling thread, registered on first use.
+	ThreadStatistics& local_statistics() {
+		thread_local ThreadStatistics* const statistics = [] {
+			std::lock_guard<std::mutex> lock(thread_mutex);
+			thread_statistics.push_back(std::make_unique<ThreadStatistics>());
+			thread_statistics.back()->thread = (int)thread_statistics.size() - 1;
+			return thread_statistics.back().get();
+		}();
+		return *statistics;
+	}
+
+	// Sum of per-thread statistics, [phase].
+	std::vector<Phase> merge_statistics() {
+
+		std::vector<Phase> result(n_phases);
+
+		std::lock_guard<std::mutex> lock(thread_mutex);
+
+		for (const std::unique_ptr<ThreadStatistics>& statistics : thread_statistics) {
+			std::lock_guard<std::mutex> thread_lock(statistics->mutex);
+			for (int i = 0; i != result.size(); ++i) {
+				const Phase& phase = statistics->phases[i];
+				result[i].n_calls += phase.n_calls;
+				result[i].wall_time += phase.wall_time;
+				result[i].child_time += phase.child_time;
+				result[i].bytes += phase.bytes;
+				result[i].n_allocations += phase.n_allocations;
+			}
+		}
+
+		return result;
+
+	}
+
+}
+
+
+int instrumentation::register_phase(const char* name) {
+
+	std::lock_guard<std::mutex> lock(phase_mutex);
+
+	auto it = phase_index.find(name);
+	if (it != phase_index.end()) {
+		return it->second;
+	}
+
+	const int index = n_phases;
+	if (index == max_phases) {
+		throw std::invalid_argument("Too many instrumentation phases.");
+	}
+
+	phase_names[index] = name;
+	phase_index[name] = index;
+	++n_phases;
+
+	return index;
+
+}
+
+
+void instrumentation::count_allocations(const int n_allocations) {
+
+	if (current_scope) {
+		ThreadStatistics& statistics = local_statistics();
+		std::lock_guard<std::mutex> lock(statistics.mutex);
+		statistics.phases[current_scope->phase()].n_allocations += n_allocations;
+	}
+
+}
+
+
+std::vector<instrumentation::PhaseStatistics> instrumentation::report() {
+
+	const std::vector<Phase> phases = merge_statistics();
+
+	std::vector<PhaseStatistics> result;
+
+	for (int i = 0; i != phases.size(); ++i) {
+
+		const Phase& phase = phases[i];
+
+		if (phase.n_calls == 0) {
+			continue;
+		}
+
+		result.push_back({
+			phase_names[i],
+			phase.n_calls,
+			1.0e-9 * phase.wall_time,
+			1.0e-9 * (phase.wall_time - phase.child_time),
+			phase.bytes,
+			phase.n_allocations });
+
+	}
+
+	return result;
+
+}
+
+
+std::string instrumentation::summary() {
+
+	std::vector<PhaseStatistics> statistics = report();
+
+	std::sort(statistics.begin(), statistics.end(),
+		[](const PhaseStatistics& a, const PhaseStatistics& b) {
+			return a.self_time > b.self_time;
+		});
+
+	std::ostringstream stream;
+
+	stream << std::left << std::setw(40) << "Phase" << std::right
+		<< std::setw(12) << "Calls"
+		<< std::setw(14) << "Wall [ms]"
+		<< std::setw(14) << "Self [ms]"
+		<< std::setw(12) << "GB/s"
+		<< std::setw(12) << "Allocs" << "\n";
+
+	stream << std::fixed;
+
+	for (const PhaseStatistics& s : statistics) {
+
+		const double bandwidth = s.wall_time > 0.0 ? 1.0e-9 * s.bytes / s.wall_time : 0.0;
+
+		stream << std::left << std::setw(40) << s.name << std::right
+			<< std::setw(12) << s.n_calls
+			<< std::setw(14) << std::setprecision(3) << 1.0e3 * s.wall_time
+			<< std::setw(14) << std::setprecision(3) << 1.0e3 * s.self_time
+			<< std::setw(12) << std::setprecision(2) << bandwidth
+			<< std::setw(12) << s.n_allocations << "\n";
+
+	}
+
+	return stream.str();
+
+}
+
+
+void instrumentation::reset() {
+
+	std::lock_guard<std::mutex> lock(thread_mutex);
+
+	for (const std::unique_ptr<ThreadStatistics>& statistics : thread_statistics) {
+		std::lock_guard<std::mutex> thread_lock(statistics->mutex);
+		std::fill(std::begin(statistics->phases), std::end(statistics->phases), Phase());
+		statistics->trace_events.clear();
+	}
+
+}
+
+
+void instrumentation::set_tracing(const bool enable) {
+	trace_enabled = enable;
+}
+
+
+bool instrumentation::tracing() {
+	return trace_enabled;
+}
+
+
+void instrumentation::write_chrome_trace(const std::string& file_name) {
+
+	std::ofstream file(file_name);
+	if (!file) {
+		throw std::invalid_argument("Trace file could not be opened.");
+	}
+
+	// Trace events of all threads, ordered by start time.
+	std::vector<TraceEvent> trace_events;
+	{
+		std::lock_guard<std::mutex> lock(thread_mutex);
+		for (const std::unique_ptr<ThreadStatistics>& statistics : thread_statistics) {
+			std::lock_guard<std::mutex> thread_lock(statistics->mutex);
+			trace_events.insert(trace_events.end(),
+				statistics->trace_events.begin(), statistics->trace_events.end());
+		}
+	}
+
+	std::sort(trace_events.begin(), trace_events.end(),
+		[](const TraceEvent& a, const TraceEvent& b) {
+			return a.start < b.start;
+		});
+
+	// Times in microseconds.
+	file << "{\"traceEvents\":[\n";
+	file << std::fixed << std::setprecision(3);
+	for (int i = 0; i != trace_events.size(); ++i) {
+		const TraceEvent& event = trace_events[i];
+		file << "{\"name\":\"" << phase_names[event.phase]
+			<< "\",\"cat\":\"nfs\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread
+			<< ",\"ts\":" << 1.0e-3 * event.start
+			<< ",\"dur\":" << 1.0e-3 * event.duration << "}";
+		if (i != trace_events.size() - 1) {
+			file << ",";
+		}
+		file << "\n";
+	}
+	file << "],\"displayTimeUnit\":\"ns\"}\n";
+
+}
+
+
+instrumentation::ScopedTimer::ScopedTimer(
+	const int phase,
+	const long long bytes) :
+	phase_(phase),
+	bytes_(bytes),
+	child_time_(0),
+	parent_(current_scope),
+	start_(std::chrono::steady_clock::now()) {
+
+	current_scope = this;
+
+}
+
+
+instrumentation::ScopedTimer::~ScopedTimer() {
+
+	const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	const long long duration =
+		std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_).count();
+
+	if (parent_) {
+		parent_->child_time_ += duration;
+	}
+	current_scope = parent_;
+
+	ThreadStatistics& statistics = local_statistics();
+
+	std::lock_guard<std::mutex> lock(statistics.mutex);
+
+	Phase& phase = statistics.phases[phase_];
+	++phase.n_calls;
+	phase.wall_time += duration;
+	phase.child_time += child_time_;
+	phase.bytes += bytes_;
+
+	if (trace_enabled && statistics.trace_events.size() < max_trace_events) {
+
+		const long long start =
+			std::chrono::duration_cast<std::chrono::nanoseconds>(start_ - origin).count();
+
+		statistics.trace_events.push_back({ phase_, statistics.thread, start, duration });
+
+	}
+
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+
+// Phase timers and counters of propagators, sweeps, solvers and operator
+// assembly.
+//
+// A phase is a named scope, e.g. "action_2d". Each time a scope is left its
+// wall time, nested (child) time, bytes touched and workspace allocations
+// are added to the phase. Each thread accumulates its own statistics, which
+// are merged over all threads when reported or exported.
+// Optionally, each scope is recorded as a Chrome trace event (see
+// chrome://tracing or ui.perfetto.dev).
+//
+// Scopes are declared with the NFS_SCOPE macros below, which expand to
+// nothing unless NFS_INSTRUMENTATION is defined (see CMake option of the
+// same name). The functions are always available; without instrumentation
+// the report is empty.
+namespace instrumentation {
+
+	// Aggregated statistics of a phase. Times in seconds.
+	struct PhaseStatistics {
+		std::string name;
+		long long n_calls;
+		// Inclusive wall time.
+		double wall_time;
+		// Wall time excluding nested phases.
+		double self_time;
+		// Nominal bytes read and written, as given by the scope.
+		long long bytes;
+		// Workspace buffer allocations within the scope, excluding nested phases.
+		long long n_allocations;
+	};
+
+	// Identifier of phase. Phases with the same name share identifier.
+	int register_phase(const char* name);
+
+	// Attribute allocations to the innermost active phase of calling thread.
+	void count_allocations(const int n_allocations);
+
+	// Statistics of all phases that have been entered at least once.
+	std::vector<PhaseStatistics> report();
+
+	// Report as text table, sorted by self time.
+	std::string summary();
+
+	// Clear statistics and trace events. Phases stay registered.
+	void reset();
+
+	// Record trace events (default off). At most max_trace_events are kept
+	// per thread.
+	void set_tracing(const bool enable);
+
+	bool tracing();
+
+	const int max_trace_events = 1 << 20;
+
+	// Write recorded trace events in Chrome trace event format (JSON).
+	void write_chrome_trace(const std::string& file_name);
+
+	// Scope of phase, see NFS_SCOPE.
+	class ScopedTimer {
+
+	private:
+
+		int phase_;
+		long long bytes_;
+		long long child_time_;
+		ScopedTimer* parent_;
+		std::chrono::steady_clock::time_point start_;
+
+	public:
+
+		ScopedTimer(
+			const int phase,
+			const long long bytes = 0);
+
+		~ScopedTimer();
+
+		ScopedTimer(const ScopedTimer&) = delete;
+		ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+		int phase() const {
+			return phase_;
+		}
+
+	};
+
+}
+
+
+#define NFS_CONCAT_IMPL(a, b) a##b
+#define NFS_CONCAT(a, b) NFS_CONCAT_IMPL(a, b)
+
+#ifdef NFS_INSTRUMENTATION
+
+// Time enclosing scope as phase "name" (string literal).
+#define NFS_SCOPE(name) NFS_SCOPE_BYTES(name, 0)
+
+// Time enclosing scope as phase "name" touching "bytes" bytes.
+#define NFS_SCOPE_BYTES(name, bytes) \
+	static const int NFS_CONCAT(nfs_phase_, __LINE__) = \
+		instrumentation::register_phase(name); \
+	instrumentation::ScopedTimer NFS_CONCAT(nfs_timer_, __LINE__)( \
+		NFS_CONCAT(nfs_phase_, __LINE__), (long long)(bytes))
+
+#define NFS_COUNT_ALLOCATIONS(n) instrumentation::count_allocations(n)
+
+#else
+
+#define NFS_SCOPE(name)
+#define NFS_SCOPE_BYTES(name, bytes)
+#define NFS_COUNT_ALLOCATIONS(n)
+
+#endif
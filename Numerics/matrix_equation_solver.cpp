@@ -1,9 +1,14 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <stdexcept>
 #include <typeinfo>
 #include <vector>
 
 #include "band_diagonal_matrix.h"
+#include "instrumentation.h"
 #include "matrix_equation_solver.h"
+#include "parallel.h"
 
 
 // Band-diagonal matrix equation solver.
@@ -11,6 +16,8 @@ void solver::band(
 	BandDiagonal& matrix,
 	std::vector<double>& column) {
 
+	NFS_SCOPE_BYTES("solver::band", 8.0 * column.size() * (matrix.matrix.size() + 2));
+
 	// Solve matrix equation.
 	if (typeid(matrix) == typeid(TriDiagonal)) {
 		solver::tri(matrix, column);
@@ -32,6 +39,13 @@ void solver::tri(
 
 	matrix.adjust_boundary(column);
 
+	const int n_partitions = solver::n_partitions(matrix.order());
+
+	if (n_partitions > 1) {
+		partition_matrix_solver(matrix.matrix, column, n_partitions);
+		return;
+	}
+
 	std::vector<double> vec_tmp(matrix.order(), 0.0);
 
 	tridiagonal_matrix_solver(
@@ -51,6 +65,13 @@ void solver::penta(
 
 	matrix.adjust_boundary(column);
 
+	const int n_partitions = solver::n_partitions(matrix.order());
+
+	if (n_partitions > 1) {
+		partition_matrix_solver(matrix.matrix, column, n_partitions);
+		return;
+	}
+
 	std::vector<double> sub_tmp(matrix.order(), 0.0);
 	std::vector<double> main_tmp(matrix.order(), 0.0);
 	std::vector<double> super_tmp(matrix.order(), 0.0);
@@ -71,6 +92,53 @@ void solver::penta(
 }
 
 
+
+// Band-diagonal matrix equation solver, block cyclic reduction.
+void solver::cyclic_reduction(
+	BandDiagonal& matrix,
+	std::vector<double>& column) {
+
+	matrix.adjust_boundary(column);
+
+	cyclic_reduction_matrix_solver(matrix.matrix, column);
+
+}
+
+
+// Band-diagonal matrix equation solver, partition (SPIKE) algorithm.
+void solver::partition(
+	BandDiagonal& matrix,
+	std::vector<double>& column,
+	const int n_partitions) {
+
+	matrix.adjust_boundary(column);
+
+	if (n_partitions == 0) {
+		partition_matrix_solver(matrix.matrix, column, solver::n_partitions(matrix.order()));
+	}
+	else {
+		partition_matrix_solver(matrix.matrix, column, n_partitions);
+	}
+
+}
+
+
+// Number of partitions used for a system of given order.
+int solver::n_partitions(const int order) {
+
+	return parallel::n_threads(order, solver::partition_threshold, solver::partition_size_min);
+
+}
+
+
+// Number of threads used for a level of cyclic reduction.
+int solver::n_cyclic_reduction_threads(const int n_equations) {
+
+	return parallel::n_threads(
+		n_equations, solver::cyclic_reduction_threshold, solver::cyclic_reduction_size_min);
+
+}
+
 void tridiagonal_matrix_solver(
 	const std::vector<double>& sub,
 	const std::vector<double>& main,
@@ -219,7 +287,7 @@ void pentadiagonal_matrix_solver(
 		// Denominator for normalization of (i + 1)'th element of 1st sub-diagonal.
 		denominator = sub_1[i] - sub_2[i] * main_tmp[idx_tmp];
 
-		if (abs(denominator) > 1.0e-8) {
+		if (std::abs(denominator) > 1.0e-8) {
 
 			// (i + 1)'th element of 1st sub-diagonal after Gauss elimination.
 			sub_tmp[i] = 1.0;
@@ -315,7 +383,7 @@ void pentadiagonal_matrix_solver(
 		// Denominator for normalization of (i + 1)'th element of 1st super-diagonal.
 		denominator = super_tmp[i] - vec_tmp[i] * main_tmp[idx_tmp];
 
-		if (abs(denominator) > 1.0e-8) {
+		if (std::abs(denominator) > 1.0e-8) {
 
 			// (i + 1)'th element of 1st super-diagonal after Gauss elimination.
 			super_tmp[i] = 1.0;
@@ -336,3 +404,571 @@ void pentadiagonal_matrix_solver(
 	tridiagonal_matrix_solver(sub_tmp, main_tmp, super_tmp, column, vec_tmp);
 
 }
+
+
+// ####################################################################
+// Block cyclic reduction.
+// The matrix is block tri-diagonal with blocks of size B x B,
+//	lower[i] * x[i - 1] + diag[i] * x[i] + upper[i] * x[i + 1] = rhs[i].
+// ####################################################################
+
+template <int B>
+using Block = std::array<double, B * B>;
+
+template <int B>
+using BlockVector = std::array<double, B>;
+
+
+template <int B>
+Block<B> block_multiply(const Block<B>& lhs, const Block<B>& rhs) {
+
+	Block<B> result{};
+
+	for (int i = 0; i != B; ++i) {
+		for (int j = 0; j != B; ++j) {
+			for (int k = 0; k != B; ++k) {
+				result[i * B + j] += lhs[i * B + k] * rhs[k * B + j];
+			}
+		}
+	}
+
+	return result;
+
+}
+
+
+template <int B>
+BlockVector<B> block_multiply_vector(const Block<B>& lhs, const BlockVector<B>& rhs) {
+
+	BlockVector<B> result{};
+
+	for (int i = 0; i != B; ++i) {
+		for (int k = 0; k != B; ++k) {
+			result[i] += lhs[i * B + k] * rhs[k];
+		}
+	}
+
+	return result;
+
+}
+
+
+// Inverse of 1x1 or 2x2 block. Cyclic reduction does not pivot, hence the
+// diagonal blocks should remain non-singular (e.g. diagonally dominant matrix).
+template <int B>
+Block<B> block_inverse(const Block<B>& block) {
+
+	Block<B> result{};
+
+	const double det = B == 1 ? block[0] : block[0] * block[3] - block[1] * block[2];
+
+	if (det == 0.0) {
+		throw std::invalid_argument("Cyclic reduction: Singular diagonal block.");
+	}
+
+	if (B == 1) {
+		result[0] = 1.0 / block[0];
+	}
+	else if (B == 2) {
+		const double inv_det = 1.0 / det;
+		result[0] = block[3] * inv_det;
+		result[1] = -block[1] * inv_det;
+		result[2] = -block[2] * inv_det;
+		result[3] = block[0] * inv_det;
+	}
+	else {
+		throw std::invalid_argument("Block size should be 1 or 2.");
+	}
+
+	return result;
+
+}
+
+
+// Reduce equation i of block cyclic reduction with neighbours i +- stride.
+template <int B>
+void block_reduce(
+	const int i,
+	const int stride,
+	std::vector<Block<B>>& lower,
+	std::vector<Block<B>>& diag,
+	std::vector<Block<B>>& upper,
+	std::vector<BlockVector<B>>& rhs) {
+
+	const int n_blocks = (int)diag.size();
+
+	const int idx_lower = i - stride;
+	const int idx_upper = i + stride;
+
+	// alpha = -lower[i] * diag[i - stride]^-1.
+	Block<B> alpha = block_multiply<B>(lower[i], block_inverse<B>(diag[idx_lower]));
+
+	Block<B> d_lower = block_multiply<B>(alpha, upper[idx_lower]);
+	BlockVector<B> f_lower = block_multiply_vector<B>(alpha, rhs[idx_lower]);
+	Block<B> l_new = block_multiply<B>(alpha, lower[idx_lower]);
+
+	for (int k = 0; k != B * B; ++k) {
+		diag[i][k] -= d_lower[k];
+		lower[i][k] = -l_new[k];
+	}
+	for (int k = 0; k != B; ++k) {
+		rhs[i][k] -= f_lower[k];
+	}
+
+	if (idx_upper < n_blocks) {
+
+		// gamma = -upper[i] * diag[i + stride]^-1.
+		Block<B> gamma = block_multiply<B>(upper[i], block_inverse<B>(diag[idx_upper]));
+
+		Block<B> d_upper = block_multiply<B>(gamma, lower[idx_upper]);
+		BlockVector<B> f_upper = block_multiply_vector<B>(gamma, rhs[idx_upper]);
+		Block<B> u_new = block_multiply<B>(gamma, upper[idx_upper]);
+
+		for (int k = 0; k != B * B; ++k) {
+			diag[i][k] -= d_upper[k];
+			upper[i][k] = -u_new[k];
+		}
+		for (int k = 0; k != B; ++k) {
+			rhs[i][k] -= f_upper[k];
+		}
+
+	}
+	else {
+		upper[i] = Block<B>{};
+	}
+
+}
+
+
+// Solve equation i of block cyclic reduction, given the solution at
+// neighbours i +- stride.
+template <int B>
+void block_substitute(
+	const int i,
+	const int stride,
+	const std::vector<Block<B>>& lower,
+	const std::vector<Block<B>>& diag,
+	const std::vector<Block<B>>& upper,
+	std::vector<BlockVector<B>>& rhs) {
+
+	const int n_blocks = (int)diag.size();
+
+	BlockVector<B> f = rhs[i];
+
+	if (i - stride >= 0) {
+		BlockVector<B> tmp = block_multiply_vector<B>(lower[i], rhs[i - stride]);
+		for (int k = 0; k != B; ++k) {
+			f[k] -= tmp[k];
+		}
+	}
+
+	if (i + stride < n_blocks) {
+		BlockVector<B> tmp = block_multiply_vector<B>(upper[i], rhs[i + stride]);
+		for (int k = 0; k != B; ++k) {
+			f[k] -= tmp[k];
+		}
+	}
+
+	// The solution overwrites the right-hand-side.
+	rhs[i] = block_multiply_vector<B>(block_inverse<B>(diag[i]), f);
+
+}
+
+
+template <int B>
+void block_cyclic_reduction(
+	std::vector<Block<B>>& lower,
+	std::vector<Block<B>>& diag,
+	std::vector<Block<B>>& upper,
+	std::vector<BlockVector<B>>& rhs) {
+
+	const int n_blocks = (int)diag.size();
+
+	int stride = 1;
+
+	// Reduction: Equations i = 2 * stride - 1 (mod 2 * stride) are decoupled
+	// from neighbours i +- stride. Updates at one level are independent, and
+	// are run concurrently for large levels.
+	for (; 2 * stride <= n_blocks; stride *= 2) {
+
+		// Equation i = 2 * stride * m + 2 * stride - 1.
+		const int n_equations = n_blocks / (2 * stride);
+
+		parallel::for_ranges(n_equations, solver::n_cyclic_reduction_threads(n_equations), 1,
+			[&](const int, const int begin, const int end) {
+				for (int m = begin; m != end; ++m) {
+					block_reduce<B>(2 * stride * m + 2 * stride - 1, stride, lower, diag, upper, rhs);
+				}
+			});
+
+	}
+
+	// Back substitution, starting from the single remaining equation.
+	for (; stride != 0; stride /= 2) {
+
+		// Equation i = 2 * stride * m + stride - 1.
+		const int n_equations = (n_blocks + stride) / (2 * stride);
+
+		parallel::for_ranges(n_equations, solver::n_cyclic_reduction_threads(n_equations), 1,
+			[&](const int, const int begin, const int end) {
+				for (int m = begin; m != end; ++m) {
+					block_substitute<B>(2 * stride * m + stride - 1, stride, lower, diag, upper, rhs);
+				}
+			});
+
+	}
+
+}
+
+
+void cyclic_reduction_matrix_solver(
+	const std::vector<std::vector<double>>& diagonals,
+	std::vector<double>& column) {
+
+	const int n_elements = (int)column.size();
+
+	if (diagonals.size() == 3) {
+
+		std::vector<Block<1>> lower(n_elements);
+		std::vector<Block<1>> diag(n_elements);
+		std::vector<Block<1>> upper(n_elements);
+		std::vector<BlockVector<1>> rhs(n_elements);
+
+		for (int i = 0; i != n_elements; ++i) {
+			lower[i][0] = diagonals[0][i];
+			diag[i][0] = diagonals[1][i];
+			upper[i][0] = diagonals[2][i];
+			rhs[i][0] = column[i];
+		}
+
+		// Elements outside the matrix.
+		lower[0] = Block<1>{};
+		upper[n_elements - 1] = Block<1>{};
+
+		block_cyclic_reduction<1>(lower, diag, upper, rhs);
+
+		for (int i = 0; i != n_elements; ++i) {
+			column[i] = rhs[i][0];
+		}
+
+	}
+	else if (diagonals.size() == 5) {
+
+		// Rows (2i, 2i + 1) constitute block i. An odd order is padded by
+		// a decoupled identity row.
+		const int n_blocks = (n_elements + 1) / 2;
+
+		std::vector<Block<2>> lower(n_blocks, Block<2>{});
+		std::vector<Block<2>> diag(n_blocks, Block<2>{});
+		std::vector<Block<2>> upper(n_blocks, Block<2>{});
+		std::vector<BlockVector<2>> rhs(n_blocks, BlockVector<2>{});
+
+		for (int i = 0; i != n_blocks; ++i) {
+
+			const int row_0 = 2 * i;
+			const int row_1 = 2 * i + 1;
+
+			// 1st row of block: Columns 2i - 2, ..., 2i + 2.
+			lower[i][0] = diagonals[0][row_0];
+			lower[i][1] = diagonals[1][row_0];
+			diag[i][0] = diagonals[2][row_0];
+			diag[i][1] = diagonals[3][row_0];
+			upper[i][0] = diagonals[4][row_0];
+			rhs[i][0] = column[row_0];
+
+			if (row_1 < n_elements) {
+
+				// 2nd row of block: Columns 2i - 1, ..., 2i + 3.
+				lower[i][3] = diagonals[0][row_1];
+				diag[i][2] = diagonals[1][row_1];
+				diag[i][3] = diagonals[2][row_1];
+				upper[i][2] = diagonals[3][row_1];
+				upper[i][3] = diagonals[4][row_1];
+				rhs[i][1] = column[row_1];
+
+			}
+			else {
+
+				diag[i][1] = 0.0;
+				diag[i][3] = 1.0;
+
+			}
+
+		}
+
+		// Elements outside the matrix.
+		lower[0] = Block<2>{};
+		upper[n_blocks - 1] = Block<2>{};
+
+		block_cyclic_reduction<2>(lower, diag, upper, rhs);
+
+		for (int i = 0; i != n_elements; ++i) {
+			column[i] = rhs[i / 2][i % 2];
+		}
+
+	}
+	else {
+		throw std::invalid_argument("Cyclic reduction: Matrix should be tri- or penta-diagonal.");
+	}
+
+}
+
+
+// ####################################################################
+// Partition (SPIKE) algorithm.
+// The matrix is split into partitions A_j along the diagonal, coupled by
+// the band elements outside A_j. For each partition,
+//	A_j * g_j = f_j, A_j * V_j = coupling to next partition,
+//	A_j * W_j = coupling to previous partition,
+// such that x_j = g_j - V_j * x_{j+1}(top) - W_j * x_{j-1}(bottom).
+// The top and bottom bandwidth elements of all partitions constitute a
+// small reduced system.
+// ####################################################################
+
+// LU factorization, without pivoting, of band matrix. Compact storage.
+void band_lu_factorize(std::vector<std::vector<double>>& band) {
+
+	const int bandwidth = (int)(band.size() - 1) / 2;
+	const int n_elements = (int)band[0].size();
+
+	for (int i = 0; i != n_elements; ++i) {
+
+		const double pivot = band[bandwidth][i];
+
+		if (pivot == 0.0) {
+			throw std::invalid_argument("Partition solver: Zero pivot.");
+		}
+		const int idx_max = std::min(i + bandwidth, n_elements - 1);
+
+		for (int r = i + 1; r <= idx_max; ++r) {
+
+			const double factor = band[i - r + bandwidth][r] / pivot;
+			band[i - r + bandwidth][r] = factor;
+
+			for (int c = i + 1; c <= idx_max; ++c) {
+				band[c - r + bandwidth][r] -= factor * band[c - i + bandwidth][i];
+			}
+
+		}
+
+	}
+
+}
+
+
+// Forward and backward substitution using LU factorized band matrix.
+// The forward substitution starts at row idx_start (zero above).
+void band_lu_solve(
+	const std::vector<std::vector<double>>& band,
+	std::vector<double>& column,
+	const int idx_start = 0) {
+
+	const int bandwidth = (int)(band.size() - 1) / 2;
+	const int n_elements = (int)band[0].size();
+
+	for (int r = idx_start; r != n_elements; ++r) {
+		for (int c = std::max(r - bandwidth, idx_start); c != r; ++c) {
+			column[r] -= band[c - r + bandwidth][r] * column[c];
+		}
+	}
+
+	for (int r = n_elements - 1; r != -1; --r) {
+		const int idx_max = std::min(r + bandwidth, n_elements - 1);
+		for (int c = r + 1; c <= idx_max; ++c) {
+			column[r] -= band[c - r + bandwidth][r] * column[c];
+		}
+		column[r] /= band[bandwidth][r];
+	}
+
+}
+
+
+// Gauss elimination with partial pivoting, dense matrix (row-major).
+void dense_matrix_solver(
+	std::vector<double>& matrix,
+	std::vector<double>& column) {
+
+	const int n = (int)column.size();
+
+	for (int i = 0; i != n; ++i) {
+
+		int idx_pivot = i;
+		for (int r = i + 1; r != n; ++r) {
+			if (std::abs(matrix[r * n + i]) > std::abs(matrix[idx_pivot * n + i])) {
+				idx_pivot = r;
+			}
+		}
+
+		if (idx_pivot != i) {
+			for (int c = 0; c != n; ++c) {
+				std::swap(matrix[i * n + c], matrix[idx_pivot * n + c]);
+			}
+			std::swap(column[i], column[idx_pivot]);
+		}
+
+		for (int r = i + 1; r != n; ++r) {
+			const double factor = matrix[r * n + i] / matrix[i * n + i];
+			if (factor != 0.0) {
+				for (int c = i; c != n; ++c) {
+					matrix[r * n + c] -= factor * matrix[i * n + c];
+				}
+				column[r] -= factor * column[i];
+			}
+		}
+
+	}
+
+	for (int i = n - 1; i != -1; --i) {
+		for (int c = i + 1; c != n; ++c) {
+			column[i] -= matrix[i * n + c] * column[c];
+		}
+		column[i] /= matrix[i * n + i];
+	}
+
+}
+
+
+void partition_matrix_solver(
+	const std::vector<std::vector<double>>& diagonals,
+	std::vector<double>& column,
+	const int n_partitions) {
+
+	const int n_diagonals = (int)diagonals.size();
+	const int bandwidth = (n_diagonals - 1) / 2;
+	const int n_elements = (int)column.size();
+
+	if (n_partitions < 1 || n_elements < 2 * bandwidth * n_partitions) {
+		throw std::invalid_argument("Partition solver: Too many partitions.");
+	}
+
+	// First row of each partition.
+	std::vector<int> start(n_partitions + 1, 0);
+	for (int j = 0; j != n_partitions + 1; ++j) {
+		start[j] = (int)(((long long)n_elements * j) / n_partitions);
+	}
+
+	// Per partition: Solution g_j, and spikes V_j and W_j (one vector per 
+	// coupling element).
+	std::vector<std::vector<double>> g(n_partitions);
+	std::vector<std::vector<std::vector<double>>> v(n_partitions);
+	std::vector<std::vector<std::vector<double>>> w(n_partitions);
+
+	auto solve_partition = [&](const int j) {
+
+		const int idx_start = start[j];
+		const int n_rows = start[j + 1] - idx_start;
+
+		std::vector<std::vector<double>> band(n_diagonals, std::vector<double>(n_rows, 0.0));
+		for (int d = 0; d != n_diagonals; ++d) {
+			std::copy(
+				diagonals[d].begin() + idx_start, 
+				diagonals[d].begin() + idx_start + n_rows, 
+				band[d].begin());
+		}
+
+		band_lu_factorize(band);
+
+		g[j] = std::vector<double>(column.begin() + idx_start, column.begin() + idx_start + n_rows);
+		band_lu_solve(band, g[j]);
+
+		// Coupling to x[idx_start + n_rows + c], from the last rows.
+		if (j != n_partitions - 1) {
+			v[j] = std::vector<std::vector<double>>(bandwidth, std::vector<double>(n_rows, 0.0));
+			for (int c = 0; c != bandwidth; ++c) {
+				for (int r = n_rows - bandwidth + c; r != n_rows; ++r) {
+					v[j][c][r] = diagonals[n_rows + c - r + bandwidth][idx_start + r];
+				}
+				band_lu_solve(band, v[j][c], n_rows - bandwidth + c);
+			}
+		}
+
+		// Coupling to x[idx_start - bandwidth + c], from the first rows.
+		if (j != 0) {
+			w[j] = std::vector<std::vector<double>>(bandwidth, std::vector<double>(n_rows, 0.0));
+			for (int c = 0; c != bandwidth; ++c) {
+				for (int r = 0; r != c + 1; ++r) {
+					w[j][c][r] = diagonals[c - r][idx_start + r];
+				}
+				band_lu_solve(band, w[j][c]);
+			}
+		}
+
+	};
+
+	// One partition per range, on the shared pool (serial on scheduler workers).
+	parallel::for_ranges(n_partitions, n_partitions, 1,
+		[&](const int, const int begin, const int end) {
+			for (int j = begin; j != end; ++j) {
+				solve_partition(j);
+			}
+		});
+
+	// Reduced system. Unknowns: Top and bottom bandwidth elements of each
+	// partition, index (2 * j) * bandwidth + c and (2 * j + 1) * bandwidth + c.
+	const int n_reduced = 2 * bandwidth * n_partitions;
+	std::vector<double> reduced(n_reduced * n_reduced, 0.0);
+	std::vector<double> reduced_column(n_reduced, 0.0);
+
+	for (int j = 0; j != n_partitions; ++j) {
+
+		const int n_rows = start[j + 1] - start[j];
+
+		for (int e = 0; e != 2 * bandwidth; ++e) {
+
+			// Local row of partition.
+			const int r = e < bandwidth ? e : n_rows - 2 * bandwidth + e;
+			const int row = 2 * j * bandwidth + e;
+
+			reduced[row * n_reduced + row] = 1.0;
+			reduced_column[row] = g[j][r];
+
+			for (int c = 0; c != bandwidth; ++c) {
+				if (j != n_partitions - 1) {
+					// Top elements of next partition.
+					reduced[row * n_reduced + 2 * (j + 1) * bandwidth + c] += v[j][c][r];
+				}
+				if (j != 0) {
+					// Bottom elements of previous partition.
+					reduced[row * n_reduced + (2 * j - 1) * bandwidth + c] += w[j][c][r];
+				}
+			}
+
+		}
+
+	}
+
+	dense_matrix_solver(reduced, reduced_column);
+
+	// Recover solution within each partition.
+	auto recover_partition = [&](const int j) {
+
+		const int idx_start = start[j];
+		const int n_rows = start[j + 1] - idx_start;
+
+		for (int r = 0; r != n_rows; ++r) {
+
+			double value = g[j][r];
+
+			for (int c = 0; c != bandwidth; ++c) {
+				if (j != n_partitions - 1) {
+					value -= v[j][c][r] * reduced_column[2 * (j + 1) * bandwidth + c];
+				}
+				if (j != 0) {
+					value -= w[j][c][r] * reduced_column[(2 * j - 1) * bandwidth + c];
+				}
+			}
+
+			column[idx_start + r] = value;
+
+		}
+
+	};
+
+	parallel::for_ranges(n_partitions, n_partitions, 1,
+		[&](const int, const int begin, const int end) {
+			for (int j = begin; j != end; ++j) {
+				recover_partition(j);
+			}
+		});
+
+}
@@ -22,6 +22,41 @@ namespace solver {
 		BandDiagonal& matrix,
 		std::vector<double>& column);
 
+	// Band-diagonal matrix equation solver, block cyclic reduction. Large
+	// levels of the reduction are solved concurrently.
+	void cyclic_reduction(
+		BandDiagonal& matrix,
+		std::vector<double>& column);
+
+	// Band-diagonal matrix equation solver, partition (SPIKE) algorithm.
+	// Partitions are solved concurrently on the parallel::pool scheduler.
+	// n_partitions = 0: see n_partitions.
+	void partition(
+		BandDiagonal& matrix,
+		std::vector<double>& column,
+		const int n_partitions = 0);
+
+	// Systems with at least this order are solved by the partition algorithm
+	// if more than one hardware thread is available, and the solver is not
+	// called from a scheduler worker (see parallel::n_threads).
+	const int partition_threshold = 1 << 15;
+
+	// Minimum number of rows per partition.
+	const int partition_size_min = 1 << 12;
+
+	// Number of partitions used for a system of given order.
+	int n_partitions(const int order);
+
+	// Levels of cyclic reduction with at least this many equations are
+	// reduced concurrently.
+	const int cyclic_reduction_threshold = 1 << 14;
+
+	// Minimum number of equations per thread in cyclic reduction.
+	const int cyclic_reduction_size_min = 1 << 12;
+
+	// Number of threads used for a level of cyclic reduction.
+	int n_cyclic_reduction_threads(const int n_equations);
+
 }
 
 
@@ -44,3 +79,23 @@ void pentadiagonal_matrix_solver(
 	std::vector<double>& main_tmp,
 	std::vector<double>& super_tmp,
 	std::vector<double>& vec_tmp);
+
+
+// Block cyclic reduction. Tri-diagonal (3 diagonals) or penta-diagonal 
+// (5 diagonals) matrix, with the latter treated as block tri-diagonal with
+// 2x2 blocks. diagonals: Compact storage, see BandDiagonal::matrix.
+// At each level, all reductions are independent of each other, and are
+// run concurrently if solver::n_cyclic_reduction_threads > 1.
+void cyclic_reduction_matrix_solver(
+	const std::vector<std::vector<double>>& diagonals,
+	std::vector<double>& column);
+
+
+// Partition (SPIKE) algorithm for band-diagonal matrix. Each partition is
+// LU factorized and solved independently, the coupling between partitions
+// is resolved by a small reduced system. diagonals: Compact storage, see
+// BandDiagonal::matrix.
+void partition_matrix_solver(
+	const std::vector<std::vector<double>>& diagonals,
+	std::vector<double>& column,
+	const int n_partitions);
@@ -0,0 +1,713 @@
+#pragma once
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "band_diagonal_factorized.h"
+#include "derivatives.h"
+#include "grid.h"
+#include "instrumentation.h"
+#include "sparse_matrix.h"
+#include "utility.h"
+
+
+// Main diagonal of band-diagonal matrix, including boundary rows.
+template <class T>
+std::vector<double> main_diagonal(const T& matrix) {
+
+	const int order = matrix.order();
+	const int n_br = matrix.n_boundary_rows();
+	const int n_be = matrix.n_boundary_elements();
+
+	std::vector<double> diagonal(order, 0.0);
+
+	for (int i = n_br; i != order - n_br; ++i) {
+		diagonal[i] = matrix.matrix[matrix.bandwidth()][i];
+	}
+
+	for (int i = 0; i != n_br; ++i) {
+		diagonal[i] = matrix.boundary_rows[i][i];
+		diagonal[(order - 1) - i] = matrix.boundary_rows[(2 * n_br - 1) - i][(n_be - 1) - i];
+	}
+
+	return diagonal;
+
+}
+
+
+// Add scalar to main diagonal of band-diagonal matrix, including boundary rows.
+template <class T>
+void add_to_diagonal(const double scalar, T& matrix) {
+
+	const int order = matrix.order();
+	const int n_br = matrix.n_boundary_rows();
+	const int n_be = matrix.n_boundary_elements();
+
+	for (int i = n_br; i != order - n_br; ++i) {
+		matrix.matrix[matrix.bandwidth()][i] += scalar;
+	}
+
+	for (int i = 0; i != n_br; ++i) {
+		matrix.boundary_rows[i][i] += scalar;
+		matrix.boundary_rows[(2 * n_br - 1) - i][(n_be - 1) - i] += scalar;
+	}
+
+}
+
+
+// Fully implicit theta scheme on N-dimensional grid, solved by geometric
+// multigrid,
+//	(identity - factor * F) * x = func,
+//	F = sum_j D_j + sum_{i < j} D_ij,
+// where D_j is a band-diagonal derivative operator along coordinate j and
+// D_ij are mixed derivative terms, as in propagator::adi::cs_nd. Typically
+// factor = theta * dt. Unlike the ADI schemes, there is no splitting error,
+// and large time steps are possible for strong correlation.
+//
+// Levels are added from finest to coarsest. The operators of each level are
+// discretized on the grids of that level, and each grid is the grid of the
+// previous level with every second grid point removed, see grid::coarsen.
+//
+// - Smoother: Alternating zebra line Gauss-Seidel. Lines along coordinate j
+//   are solved exactly using the band solvers, with the diagonal of D_k,
+//   k != j, included.
+// - Grid transfer: Linear interpolation and its (normalized) transpose.
+// - Coarsest level: Dense LU decomposition.
+// - Residuals: The generator F of each level is assembled once in CSR
+//   format, see sparse::generator, and applied by a single SpMV.
+//
+// The V-cycle can be used as solver, see solve, or as preconditioner of
+// BiCGSTAB, see solve_bicgstab.
+//
+// The coupling between lines is treated explicitly by the smoother. Hence,
+// the boundary rows of D_k should not be dominated by off-diagonal elements,
+// e.g. d2dx2 c2b0 (vanishing second order derivative at the boundary) and
+// convection and mixed derivative terms vanishing at (or upwinded towards)
+// the boundary. Otherwise the smoother, and thereby the V-cycle, diverges.
+// Assume order of func to be (x1, x2, ..., xN), see action_nd.
+template <class T>
+class Multigrid {
+
+private:
+
+	// Number of grid points, [level][dimension].
+	std::vector<std::vector<int>> n_points_;
+	// Grids, [level][dimension][grid point].
+	std::vector<std::vector<std::vector<double>>> grids_;
+
+	// Derivative operators, [level][dimension].
+	std::vector<std::vector<T>> derivatives_;
+	// Assembled generator F, [level], see sparse::generator.
+	std::vector<SparseMatrix> generators_;
+
+	double factor_;
+	bool assembled_;
+
+	// Line solvers, [level][dimension][line], and zebra colour of each line.
+	std::vector<std::vector<std::vector<FactorizedBandDiagonal>>> lines_;
+	std::vector<std::vector<std::vector<int>>> colours_;
+
+	// LU decomposition of coarsest level.
+	Eigen::PartialPivLU<Eigen::MatrixXd> coarse_;
+
+	int n_pre_smoothing_;
+	int n_post_smoothing_;
+	double tolerance_;
+	int max_iterations_;
+
+	int n_iterations_;
+	double relative_residual_;
+
+	int n_total(const int level) const {
+		int n = 1;
+		for (int n_d : n_points_[level]) {
+			n *= n_d;
+		}
+		return n;
+	}
+
+	// Distance between neighbouring elements along dimension.
+	int stride(const int level, const int dimension) const {
+		int n = 1;
+		for (int i = dimension + 1; i != n_points_[level].size(); ++i) {
+			n *= n_points_[level][i];
+		}
+		return n;
+	}
+
+	// Index of first element of line along dimension.
+	int line_start(const int level, const int dimension, const int line) const {
+		const int s = stride(level, dimension);
+		return (line / s) * n_points_[level][dimension] * s + line % s;
+	}
+
+	// Line solvers of all levels, (identity - factor * D_j) plus diagonal of
+	// -factor * D_k, k != j.
+	void assemble_lines() {
+
+		lines_.assign(n_levels(), std::vector<std::vector<FactorizedBandDiagonal>>());
+		colours_.assign(n_levels(), std::vector<std::vector<int>>());
+
+		for (int level = 0; level != n_levels(); ++level) {
+
+			const int n_dimensions = (int)n_points_[level].size();
+			const int n = n_total(level);
+
+			std::vector<std::vector<double>> diagonals(n_dimensions);
+			for (int k = 0; k != n_dimensions; ++k) {
+				diagonals[k] = main_diagonal(derivatives_[level][k]);
+			}
+
+			lines_[level].resize(n_dimensions);
+			colours_[level].resize(n_dimensions);
+
+			for (int j = 0; j != n_dimensions; ++j) {
+
+				T lhs = derivatives_[level][j];
+				lhs *= -factor_;
+				lhs += lhs.identity();
+
+				const int n_lines = n / n_points_[level][j];
+
+				lines_[level][j].clear();
+				lines_[level][j].reserve(n_lines);
+				colours_[level][j].resize(n_lines);
+
+				for (int l = 0; l != n_lines; ++l) {
+
+					const int start = line_start(level, j, l);
+
+					double shift = 0.0;
+					int parity = 0;
+
+					for (int k = 0; k != n_dimensions; ++k) {
+						if (k != j) {
+							const int index = (start / stride(level, k)) % n_points_[level][k];
+							shift -= factor_ * diagonals[k][index];
+							parity += index;
+						}
+					}
+
+					T line = lhs;
+					add_to_diagonal(shift, line);
+
+					lines_[level][j].push_back(FactorizedBandDiagonal(line));
+					colours_[level][j][l] = parity % 2;
+
+				}
+
+			}
+
+		}
+
+	}
+
+	// LU decomposition of coarsest level operator.
+	void assemble_coarse() {
+
+		const int level = n_levels() - 1;
+		const int n = n_total(level);
+
+		Eigen::MatrixXd matrix(n, n);
+		std::vector<double> unit(n, 0.0);
+
+		for (int k = 0; k != n; ++k) {
+			unit[k] = 1.0;
+			const std::vector<double> column = apply(unit, level);
+			for (int i = 0; i != n; ++i) {
+				matrix(i, k) = column[i];
+			}
+			unit[k] = 0.0;
+		}
+
+		coarse_.compute(matrix);
+
+	}
+
+	// Zebra line Gauss-Seidel, alternating over dimensions.
+	void smooth(
+		const int level,
+		const std::vector<double>& func,
+		std::vector<double>& x) {
+
+		const int n_dimensions = (int)n_points_[level].size();
+
+		for (int j = 0; j != n_dimensions; ++j) {
+
+			const int n_line = n_points_[level][j];
+			const int s = stride(level, j);
+
+			std::vector<double> line(n_line, 0.0);
+
+			for (int colour = 0; colour != 2; ++colour) {
+
+				const std::vector<double> r = residual(func, x, level);
+
+				for (int l = 0; l != lines_[level][j].size(); ++l) {
+
+					if (colours_[level][j][l] != colour) {
+						continue;
+					}
+
+					const int start = line_start(level, j, l);
+
+					for (int k = 0; k != n_line; ++k) {
+						line[k] = r[start + k * s];
+					}
+
+					lines_[level][j][l].solve(line);
+
+					for (int k = 0; k != n_line; ++k) {
+						x[start + k * s] += line[k];
+					}
+
+				}
+
+			}
+
+		}
+
+	}
+
+	// Linear interpolation from level + 1 to level, along one dimension.
+	// n_points: Current shape of func, updated.
+	std::vector<double> prolongate_1d(
+		const int level,
+		const int dimension,
+		std::vector<int>& n_points,
+		const std::vector<double>& func) {
+
+		const std::vector<double>& grid = grids_[level][dimension];
+
+		const int n_coarse = n_points[dimension];
+		const int n_fine = (int)grid.size();
+
+		int n_outer = 1;
+		for (int i = 0; i != dimension; ++i) {
+			n_outer *= n_points[i];
+		}
+		int s = 1;
+		for (int i = dimension + 1; i != n_points.size(); ++i) {
+			s *= n_points[i];
+		}
+
+		std::vector<double> result(n_outer * n_fine * s, 0.0);
+
+		for (int o = 0; o != n_outer; ++o) {
+			for (int j = 0; j != s; ++j) {
+				for (int i = 0; i != n_coarse; ++i) {
+					result[(o * n_fine + 2 * i) * s + j] = func[(o * n_coarse + i) * s + j];
+				}
+				for (int i = 1; i < n_fine; i += 2) {
+					const double weight = (grid[i + 1] - grid[i]) / (grid[i + 1] - grid[i - 1]);
+					result[(o * n_fine + i) * s + j] =
+						weight * result[(o * n_fine + i - 1) * s + j]
+						+ (1.0 - weight) * result[(o * n_fine + i + 1) * s + j];
+				}
+			}
+		}
+
+		n_points[dimension] = n_fine;
+
+		return result;
+
+	}
+
+	// Transpose of linear interpolation, normalized to unit row sums, from
+	// level to level + 1, along one dimension. Injection at boundary points.
+	// n_points: Current shape of func, updated.
+	std::vector<double> restrict_1d(
+		const int level,
+		const int dimension,
+		std::vector<int>& n_points,
+		const std::vector<double>& func) {
+
+		const std::vector<double>& grid = grids_[level][dimension];
+
+		const int n_fine = n_points[dimension];
+		const int n_coarse = (n_fine + 1) / 2;
+
+		int n_outer = 1;
+		for (int i = 0; i != dimension; ++i) {
+			n_outer *= n_points[i];
+		}
+		int s = 1;
+		for (int i = dimension + 1; i != n_points.size(); ++i) {
+			s *= n_points[i];
+		}
+
+		std::vector<double> result(n_outer * n_coarse * s, 0.0);
+
+		for (int o = 0; o != n_outer; ++o) {
+			for (int j = 0; j != s; ++j) {
+				for (int i = 0; i != n_coarse; ++i) {
+
+					const int i_fine = 2 * i;
+					const int index = (o * n_fine + i_fine) * s + j;
+
+					// Injection at boundary points, which are typically
+					// governed by boundary conditions rather than the PDE.
+					if (i_fine == 0 || i_fine == n_fine - 1) {
+						result[(o * n_coarse + i) * s + j] = func[index];
+						continue;
+					}
+
+					const double weight_left = (grid[i_fine - 1] - grid[i_fine - 2]) / (grid[i_fine] - grid[i_fine - 2]);
+					const double weight_right = (grid[i_fine + 2] - grid[i_fine + 1]) / (grid[i_fine + 2] - grid[i_fine]);
+
+					result[(o * n_coarse + i) * s + j] =
+						(func[index] + weight_left * func[index - s] + weight_right * func[index + s])
+						/ (1.0 + weight_left + weight_right);
+
+				}
+			}
+		}
+
+		n_points[dimension] = n_coarse;
+
+		return result;
+
+	}
+
+	double norm(const std::vector<double>& vector) const {
+		double sum = 0.0;
+		for (double element : vector) {
+			sum += element * element;
+		}
+		return std::sqrt(sum);
+	}
+
+	double inner_product(
+		const std::vector<double>& vector_1,
+		const std::vector<double>& vector_2) const {
+		double sum = 0.0;
+		for (int i = 0; i != vector_1.size(); ++i) {
+			sum += vector_1[i] * vector_2[i];
+		}
+		return sum;
+	}
+
+public:
+
+	Multigrid(
+		const int n_pre_smoothing = 1,
+		const int n_post_smoothing = 1,
+		const double tolerance = 1.0e-10,
+		const int max_iterations = 100) :
+		factor_(0.0),
+		assembled_(false),
+		n_pre_smoothing_(n_pre_smoothing),
+		n_post_smoothing_(n_post_smoothing),
+		tolerance_(tolerance),
+		max_iterations_(max_iterations),
+		n_iterations_(0),
+		relative_residual_(0.0) {}
+
+	// Add level, finest level first.
+	// grids: Grid of each dimension.
+	// derivatives: Derivative operator of each dimension, D_j.
+	// mixed: Mixed derivative terms, D_ij, ordered as in d2dxdy_nd. Prefactors
+	//	should be set on the full grid.
+	void add_level(
+		const std::vector<std::vector<double>>& grids,
+		const std::vector<T>& derivatives,
+		const std::vector<MixedDerivative<T, T>>& mixed) {
+
+		const int n_dimensions = (int)grids.size();
+
+		if (derivatives.size() != n_dimensions) {
+			throw std::invalid_argument("One derivative operator per dimension.");
+		}
+
+		std::vector<int> n_points(n_dimensions, 0);
+		for (int i = 0; i != n_dimensions; ++i) {
+			n_points[i] = (int)grids[i].size();
+			if (derivatives[i].order() != n_points[i]) {
+				throw std::invalid_argument("Derivative operator and grid do not match.");
+			}
+		}
+
+		if (!grids_.empty()) {
+			if (grids_.back().size() != n_dimensions) {
+				throw std::invalid_argument("Wrong number of dimensions.");
+			}
+			for (int i = 0; i != n_dimensions; ++i) {
+				if (grid::coarsen(grids_.back()[i]) != grids[i]) {
+					throw std::invalid_argument("Grid should be coarsened grid of previous level.");
+				}
+			}
+		}
+
+		n_points_.push_back(n_points);
+		grids_.push_back(grids);
+		derivatives_.push_back(derivatives);
+		generators_.push_back(sparse::generator(n_points, derivatives, mixed));
+
+		assembled_ = false;
+
+	}
+
+	int n_levels() const {
+		return (int)grids_.size();
+	}
+
+	// Number of iterations of latest solve.
+	int n_iterations() const {
+		return n_iterations_;
+	}
+
+	// Relative residual norm of latest solve.
+	double relative_residual() const {
+		return relative_residual_;
+	}
+
+	// Set up line solvers and coarsest level, unless already available.
+	void assemble(const double factor) {
+
+		if (assembled_ && factor == factor_) {
+			return;
+		}
+
+		NFS_SCOPE("Multigrid::assemble");
+
+		if (grids_.empty()) {
+			throw std::invalid_argument("No levels added.");
+		}
+
+		factor_ = factor;
+
+		assemble_lines();
+		assemble_coarse();
+
+		assembled_ = true;
+
+	}
+
+	// F * func.
+	std::vector<double> derivative(
+		const std::vector<double>& func,
+		const int level = 0) const {
+
+		return generators_[level] * func;
+
+	}
+
+	// (identity - factor * F) * func.
+	std::vector<double> apply(
+		const std::vector<double>& func,
+		const int level = 0) const {
+
+		std::vector<double> result = derivative(func, level);
+
+		for (int i = 0; i != result.size(); ++i) {
+			result[i] = func[i] - factor_ * result[i];
+		}
+
+		return result;
+
+	}
+
+	// func - (identity - factor * F) * x.
+	std::vector<double> residual(
+		const std::vector<double>& func,
+		const std::vector<double>& x,
+		const int level = 0) const {
+
+		std::vector<double> result = apply(x, level);
+
+		for (int i = 0; i != result.size(); ++i) {
+			result[i] = func[i] - result[i];
+		}
+
+		return result;
+
+	}
+
+	// Multigrid V-cycle, x is updated.
+	void v_cycle(
+		const std::vector<double>& func,
+		std::vector<double>& x,
+		const int level = 0) {
+
+		if (level == n_levels() - 1) {
+			const Eigen::VectorXd solution =
+				coarse_.solve(Eigen::Map<const Eigen::VectorXd>(func.data(), func.size()));
+			for (int i = 0; i != x.size(); ++i) {
+				x[i] = solution(i);
+			}
+			return;
+		}
+
+		for (int i = 0; i != n_pre_smoothing_; ++i) {
+			smooth(level, func, x);
+		}
+
+		// Coarse grid correction.
+		std::vector<int> n_points = n_points_[level];
+		std::vector<double> r = residual(func, x, level);
+		for (int j = 0; j != n_points.size(); ++j) {
+			r = restrict_1d(level, j, n_points, r);
+		}
+
+		std::vector<double> correction(r.size(), 0.0);
+		v_cycle(r, correction, level + 1);
+
+		for (int j = 0; j != n_points.size(); ++j) {
+			correction = prolongate_1d(level, j, n_points, correction);
+		}
+
+		for (int i = 0; i != x.size(); ++i) {
+			x[i] += correction[i];
+		}
+
+		for (int i = 0; i != n_post_smoothing_; ++i) {
+			smooth(level, func, x);
+		}
+
+	}
+
+	// Preconditioner: One V-cycle with zero initial guess.
+	std::vector<double> precondition(const std::vector<double>& r) {
+
+		std::vector<double> z(r.size(), 0.0);
+		v_cycle(r, z);
+
+		return z;
+
+	}
+
+	// Solve by repeated V-cycles, x is initial guess and solution.
+	// Returns number of iterations.
+	int solve(
+		const std::vector<double>& func,
+		std::vector<double>& x) {
+
+		NFS_SCOPE("Multigrid::solve");
+
+		const double norm_func = norm(func);
+
+		n_iterations_ = 0;
+		relative_residual_ = norm(residual(func, x)) / norm_func;
+
+		while (relative_residual_ > tolerance_ && n_iterations_ != max_iterations_) {
+			v_cycle(func, x);
+			relative_residual_ = norm(residual(func, x)) / norm_func;
+			++n_iterations_;
+		}
+
+		return n_iterations_;
+
+	}
+
+	// Solve by BiCGSTAB, preconditioned by V-cycle (right preconditioning).
+	// x is initial guess and solution. Returns number of iterations.
+	// Reference: van der Vorst (1992).
+	int solve_bicgstab(
+		const std::vector<double>& func,
+		std::vector<double>& x) {
+
+		NFS_SCOPE("Multigrid::solve_bicgstab");
+
+		const int n = (int)func.size();
+		const double norm_func = norm(func);
+
+		std::vector<double> r = residual(func, x);
+		const std::vector<double> r_hat = r;
+
+		std::vector<double> p(n, 0.0);
+		std::vector<double> v(n, 0.0);
+		std::vector<double> s(n, 0.0);
+
+		double rho = 1.0;
+		double alpha = 1.0;
+		double omega = 1.0;
+
+		n_iterations_ = 0;
+		relative_residual_ = norm(r) / norm_func;
+
+		while (relative_residual_ > tolerance_ && n_iterations_ != max_iterations_) {
+
+			++n_iterations_;
+
+			const double rho_new = inner_product(r_hat, r);
+			const double beta = (rho_new / rho) * (alpha / omega);
+			rho = rho_new;
+
+			for (int i = 0; i != n; ++i) {
+				p[i] = r[i] + beta * (p[i] - omega * v[i]);
+			}
+
+			const std::vector<double> y = precondition(p);
+			v = apply(y);
+			alpha = rho / inner_product(r_hat, v);
+
+			for (int i = 0; i != n; ++i) {
+				x[i] += alpha * y[i];
+				s[i] = r[i] - alpha * v[i];
+			}
+
+			relative_residual_ = norm(s) / norm_func;
+			if (relative_residual_ <= tolerance_) {
+				break;
+			}
+
+			const std::vector<double> z = precondition(s);
+			const std::vector<double> t = apply(z);
+			omega = inner_product(t, s) / inner_product(t, t);
+
+			for (int i = 0; i != n; ++i) {
+				x[i] += omega * z[i];
+				r[i] = s[i] - omega * t[i];
+			}
+
+			relative_residual_ = norm(r) / norm_func;
+
+		}
+
+		return n_iterations_;
+
+	}
+
+};
+
+
+namespace propagator {
+
+	// Fully implicit schemes.
+	namespace implicit {
+
+		// Theta scheme, N-dimensional, including mixed derivative terms,
+		//	(I - theta * dt * F) U(t + dt) = (I + (1 - theta) * dt * F) U(t),
+		// solved by multigrid, see Multigrid. The solution at the beginning
+		// of the time step is used as initial guess.
+		// Returns number of iterations.
+		template <class T>
+		int theta_nd(
+			const double dt,
+			Multigrid<T>& solver,
+			std::vector<double>& func,
+			const double theta = 0.5,
+			const bool bicgstab = true) {
+
+			solver.assemble(theta * dt);
+
+			std::vector<double> rhs = solver.derivative(func);
+			for (int i = 0; i != rhs.size(); ++i) {
+				rhs[i] = func[i] + (1.0 - theta) * dt * rhs[i];
+			}
+
+			if (bicgstab) {
+				return solver.solve_bicgstab(rhs, func);
+			}
+			else {
+				return solver.solve(rhs, func);
+			}
+
+		}
+
+	}
+
+}
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cmath>
 #include <numeric>
 
 #include "norm.h"
@@ -44,8 +45,8 @@ double norm::vector::infinity(const std::vector<double>& vec) {
 	double norm = 0.0;
 
 	for (int i = 0; i != vec.size(); ++i) {
-		if (norm < abs(vec[i])) {
-			norm = abs(vec[i]);
+		if (norm < std::abs(vec[i])) {
+			norm = std::abs(vec[i]);
 		}
 	}
 
@@ -60,7 +61,7 @@ double norm::vector::l1(const std::vector<double>& vec) {
 	double norm = 0.0;
 
 	for (int i = 0; i != vec.size(); ++i) {
-		norm += abs(vec[i]);
+		norm += std::abs(vec[i]);
 	}
 
 	return norm;
@@ -119,7 +120,7 @@ double norm::function::l1(
 
 	// Trapzoidal integration.
 	for (int i = 0; i != func.size() - 1; ++i) {
-		norm += dx * abs(average[i]);
+		norm += dx * std::abs(average[i]);
 	}
 
 	return norm;
@@ -140,7 +141,7 @@ double norm::function::l1(
 	// Trapzoidal integration.
 	for (int i = 0; i != func.size() - 1; ++i) {
 		dx = grid[i + 1] - grid[i];
-		norm += dx * abs(average[i]);
+		norm += dx * std::abs(average[i]);
 	}
 
 	return norm;
@@ -161,7 +162,7 @@ double norm::function::l1(
 	// Trapzoidal integration.
 	for (int i = 0; i != func.size() - 1; ++i) {
 		for (int j = 0; j != func[0].size() - 1; ++j) {
-			norm += dx * dy * abs(average[i][j]);
+			norm += dx * dy * std::abs(average[i][j]);
 		}
 	}
 
@@ -187,7 +188,7 @@ double norm::function::l1(
 		for (int j = 0; j != func[0].size() - 1; ++j) {
 			dx = grid_x[i + 1] - grid_x[i];
 			dy = grid_y[j + 1] - grid_y[j];
-			norm += dx * dy * abs(average[i][j]);
+			norm += dx * dy * std::abs(average[i][j]);
 		}
 	}
 
@@ -212,7 +213,7 @@ double norm::function::l1(
 		for (int j = 0; j != grid_y.size() - 1; ++j) {
 			dx = grid_x[i + 1] - grid_x[i];
 			dy = grid_y[j + 1] - grid_y[j];
-			norm += dx * dy * abs(func[index]);
+			norm += dx * dy * std::abs(func[index]);
 			++index;
 		}
 	}
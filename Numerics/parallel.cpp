@@ -0,0 +1,36 @@
+#include <algorithm>
+#include <thread>
+
+#include "parallel.h"
+
+
+tasks::Scheduler& parallel::pool() {
+
+	static tasks::Scheduler scheduler;
+
+	return scheduler;
+
+}
+
+
+bool parallel::nested() {
+	return tasks::Scheduler::worker_index() >= 0;
+}
+
+
+int parallel::n_threads(
+	const int n_items,
+	const int threshold,
+	const int items_per_thread_min,
+	const int n_threads) {
+
+	if (n_items < threshold || nested()) {
+		return 1;
+	}
+
+	const int n_hardware = n_threads > 0
+		? n_threads : std::max((int)std::thread::hardware_concurrency(), 1);
+
+	return std::max(std::min(n_hardware, n_items / items_per_thread_min), 1);
+
+}
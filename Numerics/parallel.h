@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <vector>
+
+#include "scheduler.h"
+
+
+// Data parallel loops of the Numerics library (SpMV, regression, band
+// solvers), run on one process-wide tasks::Scheduler instead of threads
+// created per call.
+//
+// Loops called from a worker of any scheduler (e.g. portfolio pricing jobs)
+// run on the calling thread only: The cores are already busy with other
+// jobs, and waiting for nested jobs on a worker could deadlock the pool.
+namespace parallel {
+
+	// Scheduler shared by all parallel loops, one worker per hardware thread.
+	tasks::Scheduler& pool();
+
+	// True if the calling thread is a worker of a scheduler.
+	bool nested();
+
+	// Number of threads used for a loop over n_items items: 1 below
+	// threshold and on scheduler workers, otherwise n_threads (0: Number of
+	// hardware threads), with at least items_per_thread_min items per thread.
+	int n_threads(
+		const int n_items,
+		const int threshold,
+		const int items_per_thread_min,
+		const int n_threads = 0);
+
+	// Evaluate function(thread, begin, end) for n_threads contiguous ranges
+	// of [0, n), concurrently. Range boundaries are multiples of alignment
+	// (e.g. a cache block size). Range 0 runs on the calling thread, the
+	// others as jobs on pool(); exceptions are rethrown once all ranges have
+	// finished.
+	template <class F>
+	void for_ranges(
+		const int n,
+		const int n_threads,
+		const int alignment,
+		F function) {
+
+		if (n_threads <= 1 || nested()) {
+			function(0, 0, n);
+			return;
+		}
+
+		const int n_blocks = (n + alignment - 1) / alignment;
+		const int range = ((n_blocks + n_threads - 1) / n_threads) * alignment;
+
+		std::vector<tasks::Future<void>> futures;
+		futures.reserve(n_threads - 1);
+
+		for (int t = 1; t != n_threads; ++t) {
+			const int begin = std::min(t * range, n);
+			const int end = std::min((t + 1) * range, n);
+			futures.push_back(pool().submit([&function, t, begin, end]() {
+				function(t, begin, end);
+			}, tasks::Priority::high));
+		}
+
+		std::exception_ptr error;
+		try {
+			function(0, 0, std::min(range, n));
+		}
+		catch (...) {
+			error = std::current_exception();
+		}
+
+		// The jobs reference function, hence all are waited for.
+		for (tasks::Future<void>& future : futures) {
+			future.wait();
+		}
+
+		if (error) {
+			std::rethrow_exception(error);
+		}
+		for (tasks::Future<void>& future : futures) {
+			future.get();
+		}
+
+	}
+
+}
@@ -1,11 +1,16 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
 #include <stdexcept>
 #include <vector>
 
+#include "band_diagonal_batch.h"
 #include "grid.h"
+#include "instrumentation.h"
 #include "propagator.h"
+#include "workspace.h"
 
 namespace propagation {
 
@@ -18,6 +23,8 @@ namespace propagation {
 			std::vector<double>& func,
 			const double theta=0.5) {
 
+			NFS_SCOPE("propagation::theta_1d::full");
+
 			T identity = derivative.identity();
 
 			for (int i = 0; i != time_grid.size() - 1; ++i) {
@@ -30,6 +37,114 @@ namespace propagation {
 
 		}
 
+		// The operators are assembled and factorized once per time step size,
+		// and scratch memory is taken from workspace, hence the time steps do
+		// not allocate (after the first one).
+		template <class T>
+		void full(
+			const std::vector<double>& time_grid,
+			T& derivative,
+			std::vector<double>& func,
+			Workspace& workspace,
+			const double theta = 0.5) {
+
+			NFS_SCOPE("propagation::theta_1d::full");
+
+			if (time_grid.size() < 2) {
+				return;
+			}
+
+			const T identity = derivative.identity();
+
+			T rhs = derivative;
+			FactorizedBandDiagonal lhs;
+
+			// See propagator::theta_1d::step_1 and step_2.
+			auto assemble = [&](const double dt) {
+				rhs = derivative;
+				rhs *= (1.0 - theta) * dt;
+				rhs += identity;
+				T lhs_tmp = derivative;
+				lhs_tmp *= -theta * dt;
+				lhs_tmp += identity;
+				lhs = FactorizedBandDiagonal(lhs_tmp);
+			};
+
+			double dt = time_grid[1] - time_grid[0];
+			assemble(dt);
+
+			for (int i = 0; i != time_grid.size() - 1; ++i) {
+
+				const double dt_step = time_grid[i + 1] - time_grid[i];
+
+				// Operators are only updated if the time step changes.
+				if (std::abs(dt_step - dt) > 1.0e-12 * std::abs(dt)) {
+					dt = dt_step;
+					assemble(dt);
+				}
+
+				propagator::theta_1d::full(rhs, lhs, func, workspace);
+
+			}
+
+		}
+
+	}
+
+	namespace batch {
+
+		// Theta scheme for a batch of independent 1-dimensional problems on a
+		// common spatial grid. The problems are propagated in groups of 
+		// "width" interleaved lanes, e.g. 8 doubles for an AVX-512 register.
+		template <class T>
+		void theta_1d(
+			const std::vector<double>& time_grid,
+			std::vector<T>& derivatives,
+			std::vector<std::vector<double>>& func,
+			const double theta = 0.5,
+			const int width = 8) {
+
+			NFS_SCOPE("propagation::batch::theta_1d");
+
+			const int n_problems = (int)derivatives.size();
+
+			T identity = derivatives[0].identity();
+
+			for (int b = 0; b < n_problems; b += width) {
+
+				const int w = std::min(width, n_problems - b);
+
+				std::vector<double> func_packed = interleaved::pack(func, b, w);
+				std::vector<double> func_tmp(func_packed.size(), 0.0);
+
+				double dt = time_grid[1] - time_grid[0];
+
+				BatchTriDiagonal rhs = 
+					propagator::batch::rhs(dt, identity, derivatives, b, w, theta);
+				BatchTriDiagonal lhs = 
+					propagator::batch::lhs(dt, identity, derivatives, b, w, theta);
+
+				for (int i = 0; i != time_grid.size() - 1; ++i) {
+
+					const double dt_step = time_grid[i + 1] - time_grid[i];
+
+					// Operators are only updated if the time step changes.
+					if (std::abs(dt_step - dt) > 1.0e-12 * std::abs(dt)) {
+						dt = dt_step;
+						rhs = propagator::batch::rhs(dt, identity, derivatives, b, w, theta);
+						lhs = propagator::batch::lhs(dt, identity, derivatives, b, w, theta);
+					}
+
+					propagator::batch::theta_1d(rhs, lhs, func_packed, func_tmp);
+
+				}
+
+				interleaved::unpack(func_packed, b, w, func);
+
+			}
+
+		}
+
 	}
 
 	namespace adi {
@@ -42,6 +157,8 @@ namespace propagation {
 			std::vector<double>& func,
 			const double theta = 0.5) {
 
+			NFS_SCOPE("propagation::adi::dr_2d");
+
 			T1 identity_1 = derivative_1.identity();
 			T2 identity_2 = derivative_2.identity();
 
@@ -60,6 +177,8 @@ namespace propagation {
 
 		}
 
+		// Scratch memory is taken from workspace, hence the time steps do not
+		// allocate (after the first one).
 		template <class T1, class T2>
 		void dr_2d(
 			const std::vector<double>& time_grid,
@@ -68,23 +187,50 @@ namespace propagation {
 			std::vector<T1>& derivatives_1,
 			std::vector<T2>& derivatives_2,
 			std::vector<double>& func,
+			Workspace& workspace,
 			const double theta = 0.5) {
 
+			NFS_SCOPE("propagation::adi::dr_2d");
+
+			const int n_p_1 = derivatives_1[0].order();
+			const int n_p_2 = derivatives_2[0].order();
+
+			// Operators are assembled once, see FusedOperator.
+			FusedOperator<T1> operator_1(n_p_1, n_p_2, 1, prefactors_1, derivatives_1);
+			FusedOperator<T2> operator_2(n_p_2, n_p_1, 2, prefactors_2, derivatives_2);
+
 			for (int i = 0; i != time_grid.size() - 1; ++i) {
 
 				double dt = time_grid[i + 1] - time_grid[i];
 
 				propagator::adi::dr_2d(
 					dt,
-					prefactors_1, prefactors_2,
-					derivatives_1, derivatives_2,
+					operator_1, operator_2,
 					func,
+					workspace,
 					theta);
 
 			}
 
 		}
 
+		template <class T1, class T2>
+		void dr_2d(
+			const std::vector<double>& time_grid,
+			const std::vector<double>& prefactors_1,
+			const std::vector<double>& prefactors_2,
+			std::vector<T1>& derivatives_1,
+			std::vector<T2>& derivatives_2,
+			std::vector<double>& func,
+			const double theta = 0.5) {
+
+			Workspace workspace;
+			dr_2d(time_grid, prefactors_1, prefactors_2, derivatives_1, derivatives_2, func, workspace, theta);
+
+		}
+
+		// Scratch memory is taken from workspace, hence the time steps do not
+		// allocate (after the first one).
 		template <class T1, class T2>
 		void dr_2d(
 			const std::vector<double>& time_grid,
@@ -93,23 +239,48 @@ namespace propagation {
 			std::vector<T1>& derivatives_1,
 			std::vector<T2>& derivatives_2,
 			std::vector<double>& func,
+			Workspace& workspace,
 			const double theta = 0.5) {
 
+			NFS_SCOPE("propagation::adi::dr_2d");
+
+			const int n_p_1 = derivatives_1[0].order();
+			const int n_p_2 = derivatives_2[0].order();
+
+			// Operators are assembled once, see FusedOperator.
+			FusedOperator<T1> operator_1(n_p_1, n_p_2, 1, prefactors_1, derivatives_1);
+			FusedOperator<T2> operator_2(n_p_2, n_p_1, 2, prefactors_2, derivatives_2);
+
 			for (int i = 0; i != time_grid.size() - 1; ++i) {
 
 				double dt = time_grid[i + 1] - time_grid[i];
 
 				propagator::adi::dr_2d(
 					dt,
-					prefactors_1, prefactors_2,
-					derivatives_1, derivatives_2,
+					operator_1, operator_2,
 					func,
+					workspace,
 					theta);
 
 			}
 
 		}
 
+		template <class T1, class T2>
+		void dr_2d(
+			const std::vector<double>& time_grid,
+			const std::vector<std::vector<double>>& prefactors_1,
+			const std::vector<std::vector<double>>& prefactors_2,
+			std::vector<T1>& derivatives_1,
+			std::vector<T2>& derivatives_2,
+			std::vector<double>& func,
+			const double theta = 0.5) {
+
+			Workspace workspace;
+			dr_2d(time_grid, prefactors_1, prefactors_2, derivatives_1, derivatives_2, func, workspace, theta);
+
+		}
+
 		template <class T1, class T2>
 		void cs_2d(
 			const std::vector<double>& time_grid,
@@ -121,6 +292,8 @@ namespace propagation {
 			const double lambda = 0.5, 
 			const int n_iterations = 1) {
 
+			NFS_SCOPE("propagation::adi::cs_2d");
+
 			T1 identity_1 = derivative_1.identity();
 			T2 identity_2 = derivative_2.identity();
 
@@ -140,6 +313,8 @@ namespace propagation {
 
 		}
 
+		// Scratch memory is taken from workspace, hence the time steps do not
+		// allocate (after the first one).
 		template <class T1, class T2>
 		void cs_2d(
 			const std::vector<double>& time_grid,
@@ -149,26 +324,56 @@ namespace propagation {
 			std::vector<T2>& derivatives_2,
 			MixedDerivative<T1, T2>& mixed,
 			std::vector<double>& func,
+			Workspace& workspace,
 			const double theta = 0.5,
 			const double lambda = 0.5,
 			const int n_iterations = 1) {
 
+			NFS_SCOPE("propagation::adi::cs_2d");
+
+			const int n_p_1 = derivatives_1[0].order();
+			const int n_p_2 = derivatives_2[0].order();
+
+			// Operators are assembled once, see FusedOperator.
+			FusedOperator<T1> operator_1(n_p_1, n_p_2, 1, prefactors_1, derivatives_1);
+			FusedOperator<T2> operator_2(n_p_2, n_p_1, 2, prefactors_2, derivatives_2);
+
 			for (int i = 0; i != time_grid.size() - 1; ++i) {
 
 				double dt = time_grid[i + 1] - time_grid[i];
 
 				propagator::adi::cs_2d(
 					dt,
-					prefactors_1, prefactors_2,
-					derivatives_1, derivatives_2,
+					operator_1, operator_2,
 					mixed,
 					func,
+					workspace,
 					theta, lambda, n_iterations);
 
 			}
 
 		}
 
+		template <class T1, class T2>
+		void cs_2d(
+			const std::vector<double>& time_grid,
+			const std::vector<double>& prefactors_1,
+			const std::vector<double>& prefactors_2,
+			std::vector<T1>& derivatives_1,
+			std::vector<T2>& derivatives_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 0.5,
+			const double lambda = 0.5,
+			const int n_iterations = 1) {
+
+			Workspace workspace;
+			cs_2d(time_grid, prefactors_1, prefactors_2, derivatives_1, derivatives_2, mixed, func, workspace, theta, lambda, n_iterations);
+
+		}
+
+		// Scratch memory is taken from workspace, hence the time steps do not
+		// allocate (after the first one).
 		template <class T1, class T2>
 		void cs_2d(
 			const std::vector<double>& time_grid,
@@ -178,26 +383,374 @@ namespace propagation {
 			std::vector<T2>& derivatives_2,
 			MixedDerivative<T1, T2>& mixed,
 			std::vector<double>& func,
+			Workspace& workspace,
 			const double theta = 0.5,
 			const double lambda = 0.5,
 			const int n_iterations = 1) {
 
+			NFS_SCOPE("propagation::adi::cs_2d");
+
+			const int n_p_1 = derivatives_1[0].order();
+			const int n_p_2 = derivatives_2[0].order();
+
+			// Operators are assembled once, see FusedOperator.
+			FusedOperator<T1> operator_1(n_p_1, n_p_2, 1, prefactors_1, derivatives_1);
+			FusedOperator<T2> operator_2(n_p_2, n_p_1, 2, prefactors_2, derivatives_2);
+
 			for (int i = 0; i != time_grid.size() - 1; ++i) {
 
 				double dt = time_grid[i + 1] - time_grid[i];
 
 				propagator::adi::cs_2d(
 					dt,
-					prefactors_1, prefactors_2,
-					derivatives_1, derivatives_2,
+					operator_1, operator_2,
 					mixed,
 					func,
+					workspace,
 					theta, lambda, n_iterations);
 
 			}
 
 		}
 
+		template <class T1, class T2>
+		void cs_2d(
+			const std::vector<double>& time_grid,
+			const std::vector<std::vector<double>>& prefactors_1,
+			const std::vector<std::vector<double>>& prefactors_2,
+			std::vector<T1>& derivatives_1,
+			std::vector<T2>& derivatives_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 0.5,
+			const double lambda = 0.5,
+			const int n_iterations = 1) {
+
+			Workspace workspace;
+			cs_2d(time_grid, prefactors_1, prefactors_2, derivatives_1, derivatives_2, mixed, func, workspace, theta, lambda, n_iterations);
+
+		}
+
+		template <class T1, class T2>
+		void dr_2d(
+			const std::vector<double>& time_grid,
+			const std::vector<std::vector<double>>& prefactors_1,
+			const std::vector<std::vector<double>>& prefactors_2,
+			std::vector<T1>& derivatives_1,
+			std::vector<T2>& derivatives_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 0.5) {
+
+			NFS_SCOPE("propagation::adi::dr_2d");
+
+			const int n_p_1 = derivatives_1[0].order();
+			const int n_p_2 = derivatives_2[0].order();
+
+			// Operators are assembled once, see FusedOperator.
+			FusedOperator<T1> operator_1(n_p_1, n_p_2, 1, prefactors_1, derivatives_1);
+			FusedOperator<T2> operator_2(n_p_2, n_p_1, 2, prefactors_2, derivatives_2);
+
+			for (int i = 0; i != time_grid.size() - 1; ++i) {
+
+				double dt = time_grid[i + 1] - time_grid[i];
+
+				propagator::adi::dr_2d(
+					dt,
+					operator_1, operator_2,
+					mixed,
+					func,
+					theta);
+
+			}
+
+		}
+
+		template <class T1, class T2>
+		void mcs_2d(
+			const std::vector<double>& time_grid,
+			T1& derivative_1,
+			T2& derivative_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 1.0 / 3.0) {
+
+			NFS_SCOPE("propagation::adi::mcs_2d");
+
+			T1 identity_1 = derivative_1.identity();
+			T2 identity_2 = derivative_2.identity();
+
+			for (int i = 0; i != time_grid.size() - 1; ++i) {
+
+				double dt = time_grid[i + 1] - time_grid[i];
+
+				propagator::adi::mcs_2d(
+					dt,
+					identity_1, identity_2,
+					derivative_1, derivative_2,
+					mixed,
+					func,
+					theta);
+
+			}
+
+		}
+
+		// Scratch memory is taken from workspace, hence the time steps do not
+		// allocate (after the first one).
+		template <class T1, class T2>
+		void mcs_2d(
+			const std::vector<double>& time_grid,
+			const std::vector<double>& prefactors_1,
+			const std::vector<double>& prefactors_2,
+			std::vector<T1>& derivatives_1,
+			std::vector<T2>& derivatives_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			Workspace& workspace,
+			const double theta = 1.0 / 3.0) {
+
+			NFS_SCOPE("propagation::adi::mcs_2d");
+
+			const int n_p_1 = derivatives_1[0].order();
+			const int n_p_2 = derivatives_2[0].order();
+
+			// Operators are assembled once, see FusedOperator.
+			FusedOperator<T1> operator_1(n_p_1, n_p_2, 1, prefactors_1, derivatives_1);
+			FusedOperator<T2> operator_2(n_p_2, n_p_1, 2, prefactors_2, derivatives_2);
+
+			for (int i = 0; i != time_grid.size() - 1; ++i) {
+
+				double dt = time_grid[i + 1] - time_grid[i];
+
+				propagator::adi::mcs_2d(
+					dt,
+					operator_1, operator_2,
+					mixed,
+					func,
+					workspace,
+					theta);
+
+			}
+
+		}
+
+		template <class T1, class T2>
+		void mcs_2d(
+			const std::vector<double>& time_grid,
+			const std::vector<double>& prefactors_1,
+			const std::vector<double>& prefactors_2,
+			std::vector<T1>& derivatives_1,
+			std::vector<T2>& derivatives_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 1.0 / 3.0) {
+
+			Workspace workspace;
+			mcs_2d(time_grid, prefactors_1, prefactors_2, derivatives_1, derivatives_2, mixed, func, workspace, theta);
+
+		}
+
+		// Scratch memory is taken from workspace, hence the time steps do not
+		// allocate (after the first one).
+		template <class T1, class T2>
+		void mcs_2d(
+			const std::vector<double>& time_grid,
+			const std::vector<std::vector<double>>& prefactors_1,
+			const std::vector<std::vector<double>>& prefactors_2,
+			std::vector<T1>& derivatives_1,
+			std::vector<T2>& derivatives_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			Workspace& workspace,
+			const double theta = 1.0 / 3.0) {
+
+			NFS_SCOPE("propagation::adi::mcs_2d");
+
+			const int n_p_1 = derivatives_1[0].order();
+			const int n_p_2 = derivatives_2[0].order();
+
+			// Operators are assembled once, see FusedOperator.
+			FusedOperator<T1> operator_1(n_p_1, n_p_2, 1, prefactors_1, derivatives_1);
+			FusedOperator<T2> operator_2(n_p_2, n_p_1, 2, prefactors_2, derivatives_2);
+
+			for (int i = 0; i != time_grid.size() - 1; ++i) {
+
+				double dt = time_grid[i + 1] - time_grid[i];
+
+				propagator::adi::mcs_2d(
+					dt,
+					operator_1, operator_2,
+					mixed,
+					func,
+					workspace,
+					theta);
+
+			}
+
+		}
+
+		template <class T1, class T2>
+		void mcs_2d(
+			const std::vector<double>& time_grid,
+			const std::vector<std::vector<double>>& prefactors_1,
+			const std::vector<std::vector<double>>& prefactors_2,
+			std::vector<T1>& derivatives_1,
+			std::vector<T2>& derivatives_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 1.0 / 3.0) {
+
+			Workspace workspace;
+			mcs_2d(time_grid, prefactors_1, prefactors_2, derivatives_1, derivatives_2, mixed, func, workspace, theta);
+
+		}
+
+		template <class T1, class T2>
+		void hv_2d(
+			const std::vector<double>& time_grid,
+			T1& derivative_1,
+			T2& derivative_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 0.5 + std::sqrt(3.0) / 6.0,
+			const double mu = 0.5) {
+
+			NFS_SCOPE("propagation::adi::hv_2d");
+
+			T1 identity_1 = derivative_1.identity();
+			T2 identity_2 = derivative_2.identity();
+
+			for (int i = 0; i != time_grid.size() - 1; ++i) {
+
+				double dt = time_grid[i + 1] - time_grid[i];
+
+				propagator::adi::hv_2d(
+					dt,
+					identity_1, identity_2,
+					derivative_1, derivative_2,
+					mixed,
+					func,
+					theta, mu);
+
+			}
+
+		}
+
+		// Scratch memory is taken from workspace, hence the time steps do not
+		// allocate (after the first one).
+		template <class T1, class T2>
+		void hv_2d(
+			const std::vector<double>& time_grid,
+			const std::vector<double>& prefactors_1,
+			const std::vector<double>& prefactors_2,
+			std::vector<T1>& derivatives_1,
+			std::vector<T2>& derivatives_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			Workspace& workspace,
+			const double theta = 0.5 + std::sqrt(3.0) / 6.0,
+			const double mu = 0.5) {
+
+			NFS_SCOPE("propagation::adi::hv_2d");
+
+			const int n_p_1 = derivatives_1[0].order();
+			const int n_p_2 = derivatives_2[0].order();
+
+			// Operators are assembled once, see FusedOperator.
+			FusedOperator<T1> operator_1(n_p_1, n_p_2, 1, prefactors_1, derivatives_1);
+			FusedOperator<T2> operator_2(n_p_2, n_p_1, 2, prefactors_2, derivatives_2);
+
+			for (int i = 0; i != time_grid.size() - 1; ++i) {
+
+				double dt = time_grid[i + 1] - time_grid[i];
+
+				propagator::adi::hv_2d(
+					dt,
+					operator_1, operator_2,
+					mixed,
+					func,
+					workspace,
+					theta, mu);
+
+			}
+
+		}
+
+		template <class T1, class T2>
+		void hv_2d(
+			const std::vector<double>& time_grid,
+			const std::vector<double>& prefactors_1,
+			const std::vector<double>& prefactors_2,
+			std::vector<T1>& derivatives_1,
+			std::vector<T2>& derivatives_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 0.5 + std::sqrt(3.0) / 6.0,
+			const double mu = 0.5) {
+
+			Workspace workspace;
+			hv_2d(time_grid, prefactors_1, prefactors_2, derivatives_1, derivatives_2, mixed, func, workspace, theta, mu);
+
+		}
+
+		// Scratch memory is taken from workspace, hence the time steps do not
+		// allocate (after the first one).
+		template <class T1, class T2>
+		void hv_2d(
+			const std::vector<double>& time_grid,
+			const std::vector<std::vector<double>>& prefactors_1,
+			const std::vector<std::vector<double>>& prefactors_2,
+			std::vector<T1>& derivatives_1,
+			std::vector<T2>& derivatives_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			Workspace& workspace,
+			const double theta = 0.5 + std::sqrt(3.0) / 6.0,
+			const double mu = 0.5) {
+
+			NFS_SCOPE("propagation::adi::hv_2d");
+
+			const int n_p_1 = derivatives_1[0].order();
+			const int n_p_2 = derivatives_2[0].order();
+
+			// Operators are assembled once, see FusedOperator.
+			FusedOperator<T1> operator_1(n_p_1, n_p_2, 1, prefactors_1, derivatives_1);
+			FusedOperator<T2> operator_2(n_p_2, n_p_1, 2, prefactors_2, derivatives_2);
+
+			for (int i = 0; i != time_grid.size() - 1; ++i) {
+
+				double dt = time_grid[i + 1] - time_grid[i];
+
+				propagator::adi::hv_2d(
+					dt,
+					operator_1, operator_2,
+					mixed,
+					func,
+					workspace,
+					theta, mu);
+
+			}
+
+		}
+
+		template <class T1, class T2>
+		void hv_2d(
+			const std::vector<double>& time_grid,
+			const std::vector<std::vector<double>>& prefactors_1,
+			const std::vector<std::vector<double>>& prefactors_2,
+			std::vector<T1>& derivatives_1,
+			std::vector<T2>& derivatives_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 0.5 + std::sqrt(3.0) / 6.0,
+			const double mu = 0.5) {
+
+			Workspace workspace;
+			hv_2d(time_grid, prefactors_1, prefactors_2, derivatives_1, derivatives_2, mixed, func, workspace, theta, mu);
+
+		}
+
 		template <class T1, class T2, class T3>
 		void dr_3d(
 			const std::vector<double>& time_grid,
@@ -207,6 +760,8 @@ namespace propagation {
 			std::vector<double>& func,
 			const double theta = 0.5) {
 
+			NFS_SCOPE("propagation::adi::dr_3d");
+
 			T1 identity_1 = derivative_1.identity();
 			T2 identity_2 = derivative_2.identity();
 			T3 identity_3 = derivative_3.identity();
@@ -233,9 +788,11 @@ namespace propagation {
 			std::vector<double>& func,
 			const double theta = 0.5) {
 
-			std::vector<T> identity = { derivative[0].identity() };
+			NFS_SCOPE("propagation::adi::dr_nd");
 
-			for (int i = 1; i != identity.size(); ++i) {
+			std::vector<T> identity;
+
+			for (int i = 0; i != derivative.size(); ++i) {
 
 				identity.push_back(derivative[i].identity());
 
@@ -251,6 +808,94 @@ namespace propagation {
 
 		}
 
+		template <class T>
+		void cs_nd(
+			const std::vector<double>& time_grid,
+			std::vector<T>& derivative,
+			std::vector<MixedDerivative<T, T>>& mixed,
+			std::vector<double>& func,
+			const double theta = 0.5,
+			const double lambda = 0.5,
+			const int n_iterations = 1) {
+
+			NFS_SCOPE("propagation::adi::cs_nd");
+
+			std::vector<T> identity;
+
+			for (int i = 0; i != derivative.size(); ++i) {
+
+				identity.push_back(derivative[i].identity());
+
+			}
+
+			for (int i = 0; i != time_grid.size() - 1; ++i) {
+
+				double dt = time_grid[i + 1] - time_grid[i];
+
+				propagator::adi::cs_nd(
+					dt, identity, derivative, mixed, func, theta, lambda, n_iterations);
+
+			}
+
+		}
+
+		template <class T>
+		void mcs_nd(
+			const std::vector<double>& time_grid,
+			std::vector<T>& derivative,
+			std::vector<MixedDerivative<T, T>>& mixed,
+			std::vector<double>& func,
+			const double theta = 1.0 / 3.0) {
+
+			NFS_SCOPE("propagation::adi::mcs_nd");
+
+			std::vector<T> identity;
+
+			for (int i = 0; i != derivative.size(); ++i) {
+
+				identity.push_back(derivative[i].identity());
+
+			}
+
+			for (int i = 0; i != time_grid.size() - 1; ++i) {
+
+				double dt = time_grid[i + 1] - time_grid[i];
+
+				propagator::adi::mcs_nd(dt, identity, derivative, mixed, func, theta);
+
+			}
+
+		}
+
+		template <class T>
+		void hv_nd(
+			const std::vector<double>& time_grid,
+			std::vector<T>& derivative,
+			std::vector<MixedDerivative<T, T>>& mixed,
+			std::vector<double>& func,
+			const double theta = 0.5 + std::sqrt(3.0) / 6.0,
+			const double mu = 0.5) {
+
+			NFS_SCOPE("propagation::adi::hv_nd");
+
+			std::vector<T> identity;
+
+			for (int i = 0; i != derivative.size(); ++i) {
+
+				identity.push_back(derivative[i].identity());
+
+			}
+
+			for (int i = 0; i != time_grid.size() - 1; ++i) {
+
+				double dt = time_grid[i + 1] - time_grid[i];
+
+				propagator::adi::hv_nd(dt, identity, derivative, mixed, func, theta, mu);
+
+			}
+
+		}
+
 	}
 
 }
@@ -1,14 +1,20 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
 #include <stdexcept>
 #include <typeinfo>
 #include <vector>
 
+#include "band_diagonal_batch.h"
 #include "band_diagonal_matrix.h"
 #include "derivatives.h"
+#include "fused_operator.h"
+#include "instrumentation.h"
 #include "matrix_equation_solver.h"
 #include "utility.h"
+#include "workspace.h"
 
 
 // Time propagation schemes.
@@ -28,6 +34,8 @@ namespace propagator {
 			std::vector<double>& func,
 			const double theta = 0.5) {
 
+			NFS_SCOPE("propagator::theta_1d::step_1");
+
 			// Operator evaluated at time t + dt (see AP Remarks 2.2.4).
 			T rhs = derivative;
 			rhs *= (1.0 - theta) * dt;
@@ -46,6 +54,8 @@ namespace propagator {
 			std::vector<double>& func,
 			const double theta = 0.5) {
 
+			NFS_SCOPE("propagator::theta_1d::step_2");
+
 			// Operator evaluated at time t (see AP Remarks 2.2.4).
 			T lhs = derivative;
 			lhs *= -theta * dt;
@@ -72,6 +82,109 @@ namespace propagator {
 
 		}
 
+		// AP Eq. (2.18), with right-hand-side operator and factorized
+		// left-hand-side operator assembled by the caller, see step_1 and
+		// step_2. Scratch memory is taken from workspace, hence repeated
+		// steps do not allocate.
+		template <class T>
+		void full(
+			const T& rhs,
+			const FactorizedBandDiagonal& lhs,
+			std::vector<double>& func,
+			Workspace& workspace) {
+
+			NFS_SCOPE("propagator::theta_1d::full");
+
+			Workspace::Frame frame(workspace);
+
+			std::vector<double>& func_tmp = workspace.vector((int)func.size());
+
+			// Step one is carried out at time t + dt.
+			matrix_multiply_vector<T>(rhs, func, func_tmp);
+			std::copy(func_tmp.begin(), func_tmp.end(), func.begin());
+
+			// Step two is carried out at time t.
+			lhs.solve(func);
+
+		}
+
+	}
+
+	// Theta scheme for a batch of independent 1-dimensional problems.
+	// Functions are stored in interleaved form, see band_diagonal_batch.h.
+	namespace batch {
+
+		// AP Eq. (2.18), right-hand-side operator of lanes 
+		// [lane_begin, lane_begin + width).
+		template <class T>
+		BatchTriDiagonal rhs(
+			const double dt,
+			const T& identity,
+			const std::vector<T>& derivatives,
+			const int lane_begin,
+			const int width,
+			const double theta = 0.5) {
+
+			NFS_SCOPE("propagator::batch::rhs");
+
+			std::vector<T> lanes(width);
+
+			for (int l = 0; l != width; ++l) {
+				lanes[l] = derivatives[lane_begin + l];
+				lanes[l] *= (1.0 - theta) * dt;
+				lanes[l] += identity;
+			}
+
+			return BatchTriDiagonal(lanes);
+
+		}
+
+		// AP Eq. (2.18), left-hand-side operator of lanes 
+		// [lane_begin, lane_begin + width), factorized.
+		template <class T>
+		BatchTriDiagonal lhs(
+			const double dt,
+			const T& identity,
+			const std::vector<T>& derivatives,
+			const int lane_begin,
+			const int width,
+			const double theta = 0.5) {
+
+			NFS_SCOPE("propagator::batch::lhs");
+
+			std::vector<T> lanes(width);
+
+			for (int l = 0; l != width; ++l) {
+				lanes[l] = derivatives[lane_begin + l];
+				lanes[l] *= -theta * dt;
+				lanes[l] += identity;
+			}
+
+			BatchTriDiagonal matrix(lanes);
+			matrix.factorize();
+
+			return matrix;
+
+		}
+
+		// AP Eq. (2.18).
+		template <class T>
+		void theta_1d(
+			const T& rhs,
+			const T& lhs,
+			std::vector<double>& func,
+			std::vector<double>& func_tmp) {
+
+			NFS_SCOPE("propagator::batch::theta_1d");
+
+			rhs.multiply(func, func_tmp);
+
+			lhs.solve(func_tmp);
+
+			func.swap(func_tmp);
+
+		}
+
 	}
 
 	// Alternating direction implicit schemes.
@@ -90,6 +203,8 @@ namespace propagator {
 			std::vector<double>& func,
 			const double theta = 0.5) {
 
+			NFS_SCOPE("propagator::adi::dr_2d");
+
 			const int n_p_1 = identity_1.order();
 			const int n_p_2 = identity_2.order();
 			const int n_points = n_p_1 * n_p_2;
@@ -158,25 +273,51 @@ namespace propagator {
 
 			const int n_p_1 = derivatives_1[0].order();
 			const int n_p_2 = derivatives_2[0].order();
-			const int n_points = n_p_1 * n_p_2;
 
-			std::vector<double> func_tmp_1(n_points, 0.0);
-			std::vector<double> func_tmp_2(n_points, 0.0);
+			FusedOperator<T1> operator_1(n_p_1, n_p_2, 1, prefactors_1, derivatives_1);
+			FusedOperator<T2> operator_2(n_p_2, n_p_1, 2, prefactors_2, derivatives_2);
+
+			dr_2d(dt, operator_1, operator_2, func, theta);
+
+		}
+
+		// Douglas-Rachford scheme, 2-dimensional.
+		// References
+		// - AP: Andersen and Piterbarg (2010).
+		// Operators are pre-assembled, see FusedOperator. Scratch memory is
+		// taken from workspace, hence repeated steps do not allocate.
+		template <class T1, class T2>
+		void dr_2d(
+			const double dt,
+			FusedOperator<T1>& operator_1,
+			FusedOperator<T2>& operator_2,
+			std::vector<double>& func,
+			Workspace& workspace,
+			const double theta = 0.5) {
+
+			NFS_SCOPE("propagator::adi::dr_2d");
+
+			const int n_points = (int)func.size();
+
+			Workspace::Frame frame(workspace);
+
+			std::vector<double>& func_tmp_1 = workspace.vector(n_points);
+			std::vector<double>& func_tmp_2 = workspace.vector(n_points);
 
 			// ############
 			// Propagation.
 			// ############
 
-			std::vector<double> adi_factor(2, 0.0);
+			std::vector<double>& adi_factor = workspace.vector(2);
 
 			// AP Eq. (2.68), right-hand-side.
 			adi_factor[0] = 1.0;
 			adi_factor[1] = (1.0 - theta) * dt;
-			func_tmp_1 = action_2d(n_p_1, n_p_2, 1, false, adi_factor, prefactors_1, derivatives_1, func);
+			action_2d(false, adi_factor, operator_1, func, func_tmp_1, workspace);
 
 			adi_factor[0] = 0.0;
 			adi_factor[1] = dt;
-			func_tmp_2 = action_2d(n_p_2, n_p_1, 2, false, adi_factor, prefactors_2, derivatives_2, func);
+			action_2d(false, adi_factor, operator_2, func, func_tmp_2, workspace);
 
 			for (int i = 0; i != n_points; ++i) {
 				func[i] = func_tmp_1[i] + func_tmp_2[i];
@@ -185,7 +326,7 @@ namespace propagator {
 			// AP Eq. (2.68), left-hand-side.
 			adi_factor[0] = 1.0;
 			adi_factor[1] = -theta * dt;
-			func = action_2d(n_p_1, n_p_2, 1, true, adi_factor, prefactors_1, derivatives_1, func);
+			action_2d(true, adi_factor, operator_1, func, func, workspace);
 
 			// AP Eq. (2.69), right-hand-side.
 			for (int i = 0; i != n_points; ++i) {
@@ -195,7 +336,24 @@ namespace propagator {
 			// AP Eq. (2.69), left-hand-side.
 			adi_factor[0] = 1.0;
 			adi_factor[1] = -theta * dt;
-			func = action_2d(n_p_2, n_p_1, 2, true, adi_factor, prefactors_2, derivatives_2, func);
+			action_2d(true, adi_factor, operator_2, func, func, workspace);
+
+		}
+
+		// Douglas-Rachford scheme, 2-dimensional.
+		// References
+		// - AP: Andersen and Piterbarg (2010).
+		// Operators are pre-assembled, see FusedOperator.
+		template <class T1, class T2>
+		void dr_2d(
+			const double dt,
+			FusedOperator<T1>& operator_1,
+			FusedOperator<T2>& operator_2,
+			std::vector<double>& func,
+			const double theta = 0.5) {
+
+			Workspace workspace;
+			dr_2d(dt, operator_1, operator_2, func, workspace, theta);
 
 		}
 
@@ -214,44 +372,11 @@ namespace propagator {
 
 			const int n_p_1 = derivatives_1[0].order();
 			const int n_p_2 = derivatives_2[0].order();
-			const int n_points = n_p_1 * n_p_2;
-
-			std::vector<double> func_tmp_1(n_points, 0.0);
-			std::vector<double> func_tmp_2(n_points, 0.0);
-
-			// ############
-			// Propagation.
-			// ############
-
-			std::vector<double> adi_factor(2, 0.0);
 
-			// AP Eq. (2.68), right-hand-side.
-			adi_factor[0] = 1.0;
-			adi_factor[1] = (1.0 - theta) * dt;
-			func_tmp_1 = action_2d(n_p_1, n_p_2, 1, false, adi_factor, prefactors_1, derivatives_1, func);
-
-			adi_factor[0] = 0.0;
-			adi_factor[1] = dt;
-			func_tmp_2 = action_2d(n_p_2, n_p_1, 2, false, adi_factor, prefactors_2, derivatives_2, func);
-
-			for (int i = 0; i != n_points; ++i) {
-				func[i] = func_tmp_1[i] + func_tmp_2[i];
-			}
-
-			// AP Eq. (2.68), left-hand-side.
-			adi_factor[0] = 1.0;
-			adi_factor[1] = -theta * dt;
-			func = action_2d(n_p_1, n_p_2, 1, true, adi_factor, prefactors_1, derivatives_1, func);
-
-			// AP Eq. (2.69), right-hand-side.
-			for (int i = 0; i != n_points; ++i) {
-				func[i] -= theta * func_tmp_2[i];
-			}
+			FusedOperator<T1> operator_1(n_p_1, n_p_2, 1, prefactors_1, derivatives_1);
+			FusedOperator<T2> operator_2(n_p_2, n_p_1, 2, prefactors_2, derivatives_2);
 
-			// AP Eq. (2.69), left-hand-side.
-			adi_factor[0] = 1.0;
-			adi_factor[1] = -theta * dt;
-			func = action_2d(n_p_2, n_p_1, 2, true, adi_factor, prefactors_2, derivatives_2, func);
+			dr_2d(dt, operator_1, operator_2, func, theta);
 
 		}
 
@@ -271,6 +396,8 @@ namespace propagator {
 			const double lambda = 0.5,
 			const int n_iterations = 1) {
 
+			NFS_SCOPE("propagator::adi::cs_2d");
+
 			const int n_p_1 = identity_1.order();
 			const int n_p_2 = identity_2.order();
 
@@ -378,11 +505,43 @@ namespace propagator {
 
 			const int n_p_1 = derivatives_1[0].order();
 			const int n_p_2 = derivatives_2[0].order();
-			const int n_points = n_p_1 * n_p_2;
 
-			std::vector<double> func_tmp_1(n_points, 0.0);
-			std::vector<double> func_tmp_2(n_points, 0.0);
-			std::vector<double> func_tmp_3(n_points, 0.0);
+			FusedOperator<T1> operator_1(n_p_1, n_p_2, 1, prefactors_1, derivatives_1);
+			FusedOperator<T2> operator_2(n_p_2, n_p_1, 2, prefactors_2, derivatives_2);
+
+			cs_2d(dt, operator_1, operator_2, mixed, func, theta, lambda, n_iterations);
+
+		}
+
+
+		// Craig-Sneyd scheme, 2-dimensional.
+		// References
+		// - AP: Andersen and Piterbarg (2010).
+		// Operators are pre-assembled, see FusedOperator. Scratch memory is
+		// taken from workspace, hence repeated steps do not allocate.
+		template <class T1, class T2>
+		void cs_2d(
+			const double dt,
+			FusedOperator<T1>& operator_1,
+			FusedOperator<T2>& operator_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			Workspace& workspace,
+			const double theta = 0.5,
+			const double lambda = 0.5,
+			const int n_iterations = 1) {
+
+			NFS_SCOPE("propagator::adi::cs_2d");
+
+			const int n_points = (int)func.size();
+
+			Workspace::Frame frame(workspace);
+
+			std::vector<double>& func_tmp_1 = workspace.vector(n_points);
+			std::vector<double>& func_tmp_2 = workspace.vector(n_points);
+			std::vector<double>& func_tmp_3 = workspace.vector(n_points);
+
+			std::vector<double>& adi_factor = workspace.vector(2);
 
 			// ############
 			// Propagation.
@@ -394,18 +553,16 @@ namespace propagator {
 				// Predictor step.
 				// ###############
 
-				std::vector<double> adi_factor(2, 0.0);
-
 				// AP Eq. (2.88), right-hand-side.
 				adi_factor[0] = 1.0;
 				adi_factor[1] = (1.0 - theta) * dt;
-				func_tmp_1 = action_2d(n_p_1, n_p_2, 1, false, adi_factor, prefactors_1, derivatives_1, func);
+				action_2d(false, adi_factor, operator_1, func, func_tmp_1, workspace);
 
 				adi_factor[0] = 0.0;
 				adi_factor[1] = dt;
-				func_tmp_2 = action_2d(n_p_2, n_p_1, 2, false, adi_factor, prefactors_2, derivatives_2, func);
+				action_2d(false, adi_factor, operator_2, func, func_tmp_2, workspace);
 
-				func_tmp_3 = mixed.d2dxdy(func);
+				mixed.d2dxdy(func, func_tmp_3, workspace);
 
 				for (int i = 0; i != n_points; ++i) {
 					func[i] = func_tmp_1[i] + func_tmp_2[i] + dt * func_tmp_3[i];
@@ -414,7 +571,7 @@ namespace propagator {
 				// AP Eq. (2.88), left-hand-side.
 				adi_factor[0] = 1.0;
 				adi_factor[1] = -theta * dt;
-				func = action_2d(n_p_1, n_p_2, 1, true, adi_factor, prefactors_1, derivatives_1, func);
+				action_2d(true, adi_factor, operator_1, func, func, workspace);
 
 				// AP Eq. (2.89), right-hand-side.
 				for (int i = 0; i != n_points; ++i) {
@@ -424,14 +581,14 @@ namespace propagator {
 				// AP Eq. (2.89), left-hand-side.
 				adi_factor[0] = 1.0;
 				adi_factor[1] = -theta * dt;
-				func = action_2d(n_p_2, n_p_1, 2, true, adi_factor, prefactors_2, derivatives_2, func);
+				action_2d(true, adi_factor, operator_2, func, func, workspace);
 
 				// ###############
 				// Corrector step.
 				// ###############
 
 				// AP Eq. (2.90), right-hand-side.
-				func = mixed.d2dxdy(func);
+				mixed.d2dxdy(func, func, workspace);
 
 				for (int i = 0; i != n_points; ++i) {
 					func[i] *= lambda * dt;
@@ -442,7 +599,7 @@ namespace propagator {
 				// AP Eq. (2.90), left-hand-side.
 				adi_factor[0] = 1.0;
 				adi_factor[1] = -theta * dt;
-				func = action_2d(n_p_1, n_p_2, 1, true, adi_factor, prefactors_1, derivatives_1, func);
+				action_2d(true, adi_factor, operator_1, func, func, workspace);
 
 				// AP Eq. (2.91), right-hand-side.
 				for (int i = 0; i != n_points; ++i) {
@@ -452,12 +609,31 @@ namespace propagator {
 				// AP Eq. (2.91), left-hand-side.
 				adi_factor[0] = 1.0;
 				adi_factor[1] = -theta * dt;
-				func = action_2d(n_p_2, n_p_1, 2, true, adi_factor, prefactors_2, derivatives_2, func);
+				action_2d(true, adi_factor, operator_2, func, func, workspace);
 
 			}
 
 		}
 
+		// Craig-Sneyd scheme, 2-dimensional.
+		// References
+		// - AP: Andersen and Piterbarg (2010).
+		// Operators are pre-assembled, see FusedOperator.
+		template <class T1, class T2>
+		void cs_2d(
+			const double dt,
+			FusedOperator<T1>& operator_1,
+			FusedOperator<T2>& operator_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 0.5,
+			const double lambda = 0.5,
+			const int n_iterations = 1) {
+
+			Workspace workspace;
+			cs_2d(dt, operator_1, operator_2, mixed, func, workspace, theta, lambda, n_iterations);
+
+		}
 
 		// Craig-Sneyd scheme, 2-dimensional.
 		// References
@@ -477,7 +653,31 @@ namespace propagator {
 
 			const int n_p_1 = derivatives_1[0].order();
 			const int n_p_2 = derivatives_2[0].order();
-			const int n_points = n_p_1 * n_p_2;
+
+			FusedOperator<T1> operator_1(n_p_1, n_p_2, 1, prefactors_1, derivatives_1);
+			FusedOperator<T2> operator_2(n_p_2, n_p_1, 2, prefactors_2, derivatives_2);
+
+			cs_2d(dt, operator_1, operator_2, mixed, func, theta, lambda, n_iterations);
+
+		}
+
+
+		// Douglas-Rachford scheme, 2-dimensional, with explicit mixed derivative term.
+		// References
+		// - AP: Andersen and Piterbarg (2010).
+		// Operators are pre-assembled, see FusedOperator.
+		template <class T1, class T2>
+		void dr_2d(
+			const double dt,
+			FusedOperator<T1>& operator_1,
+			FusedOperator<T2>& operator_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 0.5) {
+
+			NFS_SCOPE("propagator::adi::dr_2d");
+
+			const int n_points = (int)func.size();
 
 			std::vector<double> func_tmp_1(n_points, 0.0);
 			std::vector<double> func_tmp_2(n_points, 0.0);
@@ -487,79 +687,611 @@ namespace propagator {
 			// Propagation.
 			// ############
 
-			for (int n = 0; n != n_iterations; ++n) {
-
-				// ###############
-				// Predictor step.
-				// ###############
-
-				std::vector<double> adi_factor(2, 0.0);
-
-				// AP Eq. (2.88), right-hand-side.
-				adi_factor[0] = 1.0;
-				adi_factor[1] = (1.0 - theta) * dt;
-				func_tmp_1 = action_2d(n_p_1, n_p_2, 1, false, adi_factor, prefactors_1, derivatives_1, func);
-
-				adi_factor[0] = 0.0;
-				adi_factor[1] = dt;
-				func_tmp_2 = action_2d(n_p_2, n_p_1, 2, false, adi_factor, prefactors_2, derivatives_2, func);
+			std::vector<double> adi_factor(2, 0.0);
 
-				func_tmp_3 = mixed.d2dxdy(func);
+			// AP Eq. (2.88), right-hand-side.
+			adi_factor[0] = 1.0;
+			adi_factor[1] = (1.0 - theta) * dt;
+			func_tmp_1 = action_2d(false, adi_factor, operator_1, func);
 
-				for (int i = 0; i != n_points; ++i) {
-					func[i] = func_tmp_1[i] + func_tmp_2[i] + dt * func_tmp_3[i];
-				}
+			adi_factor[0] = 0.0;
+			adi_factor[1] = dt;
+			func_tmp_2 = action_2d(false, adi_factor, operator_2, func);
 
-				// AP Eq. (2.88), left-hand-side.
-				adi_factor[0] = 1.0;
-				adi_factor[1] = -theta * dt;
-				func = action_2d(n_p_1, n_p_2, 1, true, adi_factor, prefactors_1, derivatives_1, func);
+			func_tmp_3 = mixed.d2dxdy(func);
 
-				// AP Eq. (2.89), right-hand-side.
-				for (int i = 0; i != n_points; ++i) {
-					func[i] -= theta * func_tmp_2[i];
-				}
+			for (int i = 0; i != n_points; ++i) {
+				func[i] = func_tmp_1[i] + func_tmp_2[i] + dt * func_tmp_3[i];
+			}
 
-				// AP Eq. (2.89), left-hand-side.
-				adi_factor[0] = 1.0;
-				adi_factor[1] = -theta * dt;
-				func = action_2d(n_p_2, n_p_1, 2, true, adi_factor, prefactors_2, derivatives_2, func);
+			// AP Eq. (2.88), left-hand-side.
+			adi_factor[0] = 1.0;
+			adi_factor[1] = -theta * dt;
+			func = action_2d(true, adi_factor, operator_1, func);
 
-				// ###############
-				// Corrector step.
-				// ###############
+			// AP Eq. (2.89), right-hand-side.
+			for (int i = 0; i != n_points; ++i) {
+				func[i] -= theta * func_tmp_2[i];
+			}
 
-				// AP Eq. (2.90), right-hand-side.
-				func = mixed.d2dxdy(func);
+			// AP Eq. (2.89), left-hand-side.
+			func = action_2d(true, adi_factor, operator_2, func);
 
-				for (int i = 0; i != n_points; ++i) {
-					func[i] *= lambda * dt;
-					func[i] += func_tmp_1[i] + func_tmp_2[i]
-						+ (1.0 - lambda) * dt * func_tmp_3[i];
-				}
+		}
 
-				// AP Eq. (2.90), left-hand-side.
-				adi_factor[0] = 1.0;
-				adi_factor[1] = -theta * dt;
-				func = action_2d(n_p_1, n_p_2, 1, true, adi_factor, prefactors_1, derivatives_1, func);
+		// Douglas-Rachford scheme, 2-dimensional, with explicit mixed derivative term.
+		// References
+		// - AP: Andersen and Piterbarg (2010).
+		template <class T1, class T2>
+		void dr_2d(
+			const double dt,
+			const std::vector<std::vector<double>>& prefactors_1,
+			const std::vector<std::vector<double>>& prefactors_2,
+			std::vector<T1>& derivatives_1,
+			std::vector<T2>& derivatives_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 0.5) {
 
-				// AP Eq. (2.91), right-hand-side.
-				for (int i = 0; i != n_points; ++i) {
-					func[i] -= theta * func_tmp_2[i];
-				}
+			const int n_p_1 = derivatives_1[0].order();
+			const int n_p_2 = derivatives_2[0].order();
 
-				// AP Eq. (2.91), left-hand-side.
-				adi_factor[0] = 1.0;
-				adi_factor[1] = -theta * dt;
-				func = action_2d(n_p_2, n_p_1, 2, true, adi_factor, prefactors_2, derivatives_2, func);
+			FusedOperator<T1> operator_1(n_p_1, n_p_2, 1, prefactors_1, derivatives_1);
+			FusedOperator<T2> operator_2(n_p_2, n_p_1, 2, prefactors_2, derivatives_2);
 
-			}
+			dr_2d(dt, operator_1, operator_2, mixed, func, theta);
 
 		}
 
-
-		// Douglas-Rachford scheme, 3-dimensional.
-		template <class T1, class T2, class T3>
+		// Modified Craig-Sneyd scheme, 2-dimensional.
+		// The mixed derivative term is treated explicitly. Second order 
+		// accurate for any theta; theta = 1/3 is recommended in IW.
+		// References
+		// - IW: In 't Hout and Welfert (2009).
+		// - HF: In 't Hout and Foulon (2010).
+		template <class T1, class T2>
+		void mcs_2d(
+			const double dt,
+			const T1& identity_1,
+			const T2& identity_2,
+			const T1& derivative_1,
+			const T2& derivative_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 1.0 / 3.0) {
+
+			NFS_SCOPE("propagator::adi::mcs_2d");
+
+			const int n_p_1 = identity_1.order();
+			const int n_p_2 = identity_2.order();
+			const int n_points = n_p_1 * n_p_2;
+
+			// Action of operators on function at beginning of time step.
+			std::vector<double> func_0(n_points, 0.0);
+			std::vector<double> func_1(n_points, 0.0);
+			std::vector<double> func_2(n_points, 0.0);
+
+			// Action of operators on predicted function.
+			std::vector<double> pred_0(n_points, 0.0);
+			std::vector<double> pred_1(n_points, 0.0);
+			std::vector<double> pred_2(n_points, 0.0);
+
+			std::vector<double> y_0(n_points, 0.0);
+
+			// ##########
+			// Operators.
+			// ##########
+
+			T1 deriv_1 = derivative_1;
+			T2 deriv_2 = derivative_2;
+
+			T1 lhs_1 = derivative_1;
+			lhs_1 *= -theta * dt;
+			lhs_1 += identity_1;
+
+			T2 lhs_2 = derivative_2;
+			lhs_2 *= -theta * dt;
+			lhs_2 += identity_2;
+
+			// ###############
+			// Predictor step.
+			// ###############
+
+			// HF Eq. (2.11), Y0 = U + dt * F(U).
+			func_1 = action_2d(n_p_1, n_p_2, 1, false, deriv_1, func);
+			func_2 = action_2d(n_p_2, n_p_1, 2, false, deriv_2, func);
+			func_0 = mixed.d2dxdy(func);
+
+			for (int i = 0; i != n_points; ++i) {
+				y_0[i] = func[i] + dt * (func_0[i] + func_1[i] + func_2[i]);
+				func[i] = y_0[i] - theta * dt * func_1[i];
+			}
+
+			// HF Eq. (2.11), (I - theta * dt * F1) Y1 = Y0 - theta * dt * F1(U).
+			func = action_2d(n_p_1, n_p_2, 1, true, lhs_1, func);
+
+			// HF Eq. (2.11), (I - theta * dt * F2) Y2 = Y1 - theta * dt * F2(U).
+			for (int i = 0; i != n_points; ++i) {
+				func[i] -= theta * dt * func_2[i];
+			}
+			func = action_2d(n_p_2, n_p_1, 2, true, lhs_2, func);
+
+			// ###############
+			// Corrector step.
+			// ###############
+
+			// HF Eq. (2.11), Y0^ = Y0 + theta * dt * (F0(Y2) - F0(U)),
+			// Y0~ = Y0^ + (1/2 - theta) * dt * (F(Y2) - F(U)).
+			pred_1 = action_2d(n_p_1, n_p_2, 1, false, deriv_1, func);
+			pred_2 = action_2d(n_p_2, n_p_1, 2, false, deriv_2, func);
+			pred_0 = mixed.d2dxdy(func);
+
+			for (int i = 0; i != n_points; ++i) {
+				y_0[i] += theta * dt * (pred_0[i] - func_0[i])
+					+ (0.5 - theta) * dt * (pred_0[i] - func_0[i]
+						+ pred_1[i] - func_1[i] + pred_2[i] - func_2[i]);
+				func[i] = y_0[i] - theta * dt * func_1[i];
+			}
+
+			// HF Eq. (2.11), (I - theta * dt * F1) Y1~ = Y0~ - theta * dt * F1(U).
+			func = action_2d(n_p_1, n_p_2, 1, true, lhs_1, func);
+
+			// HF Eq. (2.11), (I - theta * dt * F2) Y2~ = Y1~ - theta * dt * F2(U).
+			for (int i = 0; i != n_points; ++i) {
+				func[i] -= theta * dt * func_2[i];
+			}
+			func = action_2d(n_p_2, n_p_1, 2, true, lhs_2, func);
+
+		}
+
+
+		// Modified Craig-Sneyd scheme, 2-dimensional.
+		// The mixed derivative term is treated explicitly. Second order 
+		// accurate for any theta; theta = 1/3 is recommended in IW.
+		// References
+		// - IW: In 't Hout and Welfert (2009).
+		// - HF: In 't Hout and Foulon (2010).
+		template <class T1, class T2>
+		void mcs_2d(
+			const double dt,
+			const std::vector<double>& prefactors_1,
+			const std::vector<double>& prefactors_2,
+			std::vector<T1>& derivatives_1,
+			std::vector<T2>& derivatives_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 1.0 / 3.0) {
+
+			const int n_p_1 = derivatives_1[0].order();
+			const int n_p_2 = derivatives_2[0].order();
+
+			FusedOperator<T1> operator_1(n_p_1, n_p_2, 1, prefactors_1, derivatives_1);
+			FusedOperator<T2> operator_2(n_p_2, n_p_1, 2, prefactors_2, derivatives_2);
+
+			mcs_2d(dt, operator_1, operator_2, mixed, func, theta);
+
+		}
+
+
+		// Modified Craig-Sneyd scheme, 2-dimensional.
+		// The mixed derivative term is treated explicitly. Second order 
+		// accurate for any theta; theta = 1/3 is recommended in IW.
+		// References
+		// - IW: In 't Hout and Welfert (2009).
+		// - HF: In 't Hout and Foulon (2010).
+		// Operators are pre-assembled, see FusedOperator. Scratch memory is
+		// taken from workspace, hence repeated steps do not allocate.
+		template <class T1, class T2>
+		void mcs_2d(
+			const double dt,
+			FusedOperator<T1>& operator_1,
+			FusedOperator<T2>& operator_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			Workspace& workspace,
+			const double theta = 1.0 / 3.0) {
+
+			NFS_SCOPE("propagator::adi::mcs_2d");
+
+			const int n_points = (int)func.size();
+
+			Workspace::Frame frame(workspace);
+
+			// Action of operators on function at beginning of time step.
+			std::vector<double>& func_0 = workspace.vector(n_points);
+			std::vector<double>& func_1 = workspace.vector(n_points);
+			std::vector<double>& func_2 = workspace.vector(n_points);
+
+			// Action of operators on predicted function.
+			std::vector<double>& pred_0 = workspace.vector(n_points);
+			std::vector<double>& pred_1 = workspace.vector(n_points);
+			std::vector<double>& pred_2 = workspace.vector(n_points);
+
+			std::vector<double>& y_0 = workspace.vector(n_points);
+
+			// Operator F_i: adi_explicit. Operator I - theta * dt * F_i: adi_implicit.
+			std::vector<double>& adi_explicit = workspace.vector(2);
+			std::vector<double>& adi_implicit = workspace.vector(2);
+			adi_explicit[1] = 1.0;
+			adi_implicit[0] = 1.0;
+			adi_implicit[1] = -theta * dt;
+
+			// ###############
+			// Predictor step.
+			// ###############
+
+			// HF Eq. (2.11), Y0 = U + dt * F(U).
+			action_2d(false, adi_explicit, operator_1, func, func_1, workspace);
+			action_2d(false, adi_explicit, operator_2, func, func_2, workspace);
+			mixed.d2dxdy(func, func_0, workspace);
+
+			for (int i = 0; i != n_points; ++i) {
+				y_0[i] = func[i] + dt * (func_0[i] + func_1[i] + func_2[i]);
+				func[i] = y_0[i] - theta * dt * func_1[i];
+			}
+
+			// HF Eq. (2.11), (I - theta * dt * F1) Y1 = Y0 - theta * dt * F1(U).
+			action_2d(true, adi_implicit, operator_1, func, func, workspace);
+
+			// HF Eq. (2.11), (I - theta * dt * F2) Y2 = Y1 - theta * dt * F2(U).
+			for (int i = 0; i != n_points; ++i) {
+				func[i] -= theta * dt * func_2[i];
+			}
+			action_2d(true, adi_implicit, operator_2, func, func, workspace);
+
+			// ###############
+			// Corrector step.
+			// ###############
+
+			// HF Eq. (2.11), Y0^ = Y0 + theta * dt * (F0(Y2) - F0(U)),
+			// Y0~ = Y0^ + (1/2 - theta) * dt * (F(Y2) - F(U)).
+			action_2d(false, adi_explicit, operator_1, func, pred_1, workspace);
+			action_2d(false, adi_explicit, operator_2, func, pred_2, workspace);
+			mixed.d2dxdy(func, pred_0, workspace);
+
+			for (int i = 0; i != n_points; ++i) {
+				y_0[i] += theta * dt * (pred_0[i] - func_0[i])
+					+ (0.5 - theta) * dt * (pred_0[i] - func_0[i]
+						+ pred_1[i] - func_1[i] + pred_2[i] - func_2[i]);
+				func[i] = y_0[i] - theta * dt * func_1[i];
+			}
+
+			// HF Eq. (2.11), (I - theta * dt * F1) Y1~ = Y0~ - theta * dt * F1(U).
+			action_2d(true, adi_implicit, operator_1, func, func, workspace);
+
+			// HF Eq. (2.11), (I - theta * dt * F2) Y2~ = Y1~ - theta * dt * F2(U).
+			for (int i = 0; i != n_points; ++i) {
+				func[i] -= theta * dt * func_2[i];
+			}
+			action_2d(true, adi_implicit, operator_2, func, func, workspace);
+
+		}
+
+		// Modified Craig-Sneyd scheme, 2-dimensional.
+		// The mixed derivative term is treated explicitly. Second order 
+		// accurate for any theta; theta = 1/3 is recommended in IW.
+		// References
+		// - IW: In 't Hout and Welfert (2009).
+		// - HF: In 't Hout and Foulon (2010).
+		// Operators are pre-assembled, see FusedOperator.
+		template <class T1, class T2>
+		void mcs_2d(
+			const double dt,
+			FusedOperator<T1>& operator_1,
+			FusedOperator<T2>& operator_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 1.0 / 3.0) {
+
+			Workspace workspace;
+			mcs_2d(dt, operator_1, operator_2, mixed, func, workspace, theta);
+
+		}
+
+		// Modified Craig-Sneyd scheme, 2-dimensional.
+		// The mixed derivative term is treated explicitly. Second order 
+		// accurate for any theta; theta = 1/3 is recommended in IW.
+		// References
+		// - IW: In 't Hout and Welfert (2009).
+		// - HF: In 't Hout and Foulon (2010).
+		template <class T1, class T2>
+		void mcs_2d(
+			const double dt,
+			const std::vector<std::vector<double>>& prefactors_1,
+			const std::vector<std::vector<double>>& prefactors_2,
+			std::vector<T1>& derivatives_1,
+			std::vector<T2>& derivatives_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 1.0 / 3.0) {
+
+			const int n_p_1 = derivatives_1[0].order();
+			const int n_p_2 = derivatives_2[0].order();
+
+			FusedOperator<T1> operator_1(n_p_1, n_p_2, 1, prefactors_1, derivatives_1);
+			FusedOperator<T2> operator_2(n_p_2, n_p_1, 2, prefactors_2, derivatives_2);
+
+			mcs_2d(dt, operator_1, operator_2, mixed, func, theta);
+
+		}
+
+
+		// Hundsdorfer-Verwer scheme, 2-dimensional.
+		// The mixed derivative term is treated explicitly in both the predictor 
+		// and the corrector step. Second order accurate for any theta.
+		// References
+		// - HV: Hundsdorfer and Verwer (2003).
+		// - HF: In 't Hout and Foulon (2010).
+		template <class T1, class T2>
+		void hv_2d(
+			const double dt,
+			const T1& identity_1,
+			const T2& identity_2,
+			const T1& derivative_1,
+			const T2& derivative_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 0.5 + std::sqrt(3.0) / 6.0,
+			const double mu = 0.5) {
+
+			NFS_SCOPE("propagator::adi::hv_2d");
+
+			const int n_p_1 = identity_1.order();
+			const int n_p_2 = identity_2.order();
+			const int n_points = n_p_1 * n_p_2;
+
+			// Action of operators on function at beginning of time step.
+			std::vector<double> func_0(n_points, 0.0);
+			std::vector<double> func_1(n_points, 0.0);
+			std::vector<double> func_2(n_points, 0.0);
+
+			// Action of operators on predicted function.
+			std::vector<double> pred_0(n_points, 0.0);
+			std::vector<double> pred_1(n_points, 0.0);
+			std::vector<double> pred_2(n_points, 0.0);
+
+			std::vector<double> y_0(n_points, 0.0);
+
+			// ##########
+			// Operators.
+			// ##########
+
+			T1 deriv_1 = derivative_1;
+			T2 deriv_2 = derivative_2;
+
+			T1 lhs_1 = derivative_1;
+			lhs_1 *= -theta * dt;
+			lhs_1 += identity_1;
+
+			T2 lhs_2 = derivative_2;
+			lhs_2 *= -theta * dt;
+			lhs_2 += identity_2;
+
+			// ###############
+			// Predictor step.
+			// ###############
+
+			// HF Eq. (2.12), Y0 = U + dt * F(U).
+			func_1 = action_2d(n_p_1, n_p_2, 1, false, deriv_1, func);
+			func_2 = action_2d(n_p_2, n_p_1, 2, false, deriv_2, func);
+			func_0 = mixed.d2dxdy(func);
+
+			for (int i = 0; i != n_points; ++i) {
+				y_0[i] = func[i] + dt * (func_0[i] + func_1[i] + func_2[i]);
+				func[i] = y_0[i] - theta * dt * func_1[i];
+			}
+
+			// HF Eq. (2.12), (I - theta * dt * F1) Y1 = Y0 - theta * dt * F1(U).
+			func = action_2d(n_p_1, n_p_2, 1, true, lhs_1, func);
+
+			// HF Eq. (2.12), (I - theta * dt * F2) Y2 = Y1 - theta * dt * F2(U).
+			for (int i = 0; i != n_points; ++i) {
+				func[i] -= theta * dt * func_2[i];
+			}
+			func = action_2d(n_p_2, n_p_1, 2, true, lhs_2, func);
+
+			// ###############
+			// Corrector step.
+			// ###############
+
+			// HF Eq. (2.12), Y0~ = Y0 + mu * dt * (F(Y2) - F(U)).
+			pred_1 = action_2d(n_p_1, n_p_2, 1, false, deriv_1, func);
+			pred_2 = action_2d(n_p_2, n_p_1, 2, false, deriv_2, func);
+			pred_0 = mixed.d2dxdy(func);
+
+			for (int i = 0; i != n_points; ++i) {
+				y_0[i] += mu * dt * (pred_0[i] - func_0[i]
+					+ pred_1[i] - func_1[i] + pred_2[i] - func_2[i]);
+				func[i] = y_0[i] - theta * dt * pred_1[i];
+			}
+
+			// HF Eq. (2.12), (I - theta * dt * F1) Y1~ = Y0~ - theta * dt * F1(Y2).
+			func = action_2d(n_p_1, n_p_2, 1, true, lhs_1, func);
+
+			// HF Eq. (2.12), (I - theta * dt * F2) Y2~ = Y1~ - theta * dt * F2(Y2).
+			for (int i = 0; i != n_points; ++i) {
+				func[i] -= theta * dt * pred_2[i];
+			}
+			func = action_2d(n_p_2, n_p_1, 2, true, lhs_2, func);
+
+		}
+
+
+		// Hundsdorfer-Verwer scheme, 2-dimensional.
+		// The mixed derivative term is treated explicitly in both the predictor 
+		// and the corrector step. Second order accurate for any theta.
+		// References
+		// - HV: Hundsdorfer and Verwer (2003).
+		// - HF: In 't Hout and Foulon (2010).
+		template <class T1, class T2>
+		void hv_2d(
+			const double dt,
+			const std::vector<double>& prefactors_1,
+			const std::vector<double>& prefactors_2,
+			std::vector<T1>& derivatives_1,
+			std::vector<T2>& derivatives_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 0.5 + std::sqrt(3.0) / 6.0,
+			const double mu = 0.5) {
+
+			const int n_p_1 = derivatives_1[0].order();
+			const int n_p_2 = derivatives_2[0].order();
+
+			FusedOperator<T1> operator_1(n_p_1, n_p_2, 1, prefactors_1, derivatives_1);
+			FusedOperator<T2> operator_2(n_p_2, n_p_1, 2, prefactors_2, derivatives_2);
+
+			hv_2d(dt, operator_1, operator_2, mixed, func, theta, mu);
+
+		}
+
+
+		// Hundsdorfer-Verwer scheme, 2-dimensional.
+		// The mixed derivative term is treated explicitly in both the predictor 
+		// and the corrector step. Second order accurate for any theta.
+		// References
+		// - HV: Hundsdorfer and Verwer (2003).
+		// - HF: In 't Hout and Foulon (2010).
+		// Operators are pre-assembled, see FusedOperator. Scratch memory is
+		// taken from workspace, hence repeated steps do not allocate.
+		template <class T1, class T2>
+		void hv_2d(
+			const double dt,
+			FusedOperator<T1>& operator_1,
+			FusedOperator<T2>& operator_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			Workspace& workspace,
+			const double theta = 0.5 + std::sqrt(3.0) / 6.0,
+			const double mu = 0.5) {
+
+			NFS_SCOPE("propagator::adi::hv_2d");
+
+			const int n_points = (int)func.size();
+
+			Workspace::Frame frame(workspace);
+
+			// Action of operators on function at beginning of time step.
+			std::vector<double>& func_0 = workspace.vector(n_points);
+			std::vector<double>& func_1 = workspace.vector(n_points);
+			std::vector<double>& func_2 = workspace.vector(n_points);
+
+			// Action of operators on predicted function.
+			std::vector<double>& pred_0 = workspace.vector(n_points);
+			std::vector<double>& pred_1 = workspace.vector(n_points);
+			std::vector<double>& pred_2 = workspace.vector(n_points);
+
+			std::vector<double>& y_0 = workspace.vector(n_points);
+
+			// Operator F_i: adi_explicit. Operator I - theta * dt * F_i: adi_implicit.
+			std::vector<double>& adi_explicit = workspace.vector(2);
+			std::vector<double>& adi_implicit = workspace.vector(2);
+			adi_explicit[1] = 1.0;
+			adi_implicit[0] = 1.0;
+			adi_implicit[1] = -theta * dt;
+
+			// ###############
+			// Predictor step.
+			// ###############
+
+			// HF Eq. (2.12), Y0 = U + dt * F(U).
+			action_2d(false, adi_explicit, operator_1, func, func_1, workspace);
+			action_2d(false, adi_explicit, operator_2, func, func_2, workspace);
+			mixed.d2dxdy(func, func_0, workspace);
+
+			for (int i = 0; i != n_points; ++i) {
+				y_0[i] = func[i] + dt * (func_0[i] + func_1[i] + func_2[i]);
+				func[i] = y_0[i] - theta * dt * func_1[i];
+			}
+
+			// HF Eq. (2.12), (I - theta * dt * F1) Y1 = Y0 - theta * dt * F1(U).
+			action_2d(true, adi_implicit, operator_1, func, func, workspace);
+
+			// HF Eq. (2.12), (I - theta * dt * F2) Y2 = Y1 - theta * dt * F2(U).
+			for (int i = 0; i != n_points; ++i) {
+				func[i] -= theta * dt * func_2[i];
+			}
+			action_2d(true, adi_implicit, operator_2, func, func, workspace);
+
+			// ###############
+			// Corrector step.
+			// ###############
+
+			// HF Eq. (2.12), Y0~ = Y0 + mu * dt * (F(Y2) - F(U)).
+			action_2d(false, adi_explicit, operator_1, func, pred_1, workspace);
+			action_2d(false, adi_explicit, operator_2, func, pred_2, workspace);
+			mixed.d2dxdy(func, pred_0, workspace);
+
+			for (int i = 0; i != n_points; ++i) {
+				y_0[i] += mu * dt * (pred_0[i] - func_0[i]
+					+ pred_1[i] - func_1[i] + pred_2[i] - func_2[i]);
+				func[i] = y_0[i] - theta * dt * pred_1[i];
+			}
+
+			// HF Eq. (2.12), (I - theta * dt * F1) Y1~ = Y0~ - theta * dt * F1(Y2).
+			action_2d(true, adi_implicit, operator_1, func, func, workspace);
+
+			// HF Eq. (2.12), (I - theta * dt * F2) Y2~ = Y1~ - theta * dt * F2(Y2).
+			for (int i = 0; i != n_points; ++i) {
+				func[i] -= theta * dt * pred_2[i];
+			}
+			action_2d(true, adi_implicit, operator_2, func, func, workspace);
+
+		}
+
+		// Hundsdorfer-Verwer scheme, 2-dimensional.
+		// The mixed derivative term is treated explicitly in both the predictor 
+		// and the corrector step. Second order accurate for any theta.
+		// References
+		// - HV: Hundsdorfer and Verwer (2003).
+		// - HF: In 't Hout and Foulon (2010).
+		// Operators are pre-assembled, see FusedOperator.
+		template <class T1, class T2>
+		void hv_2d(
+			const double dt,
+			FusedOperator<T1>& operator_1,
+			FusedOperator<T2>& operator_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 0.5 + std::sqrt(3.0) / 6.0,
+			const double mu = 0.5) {
+
+			Workspace workspace;
+			hv_2d(dt, operator_1, operator_2, mixed, func, workspace, theta, mu);
+
+		}
+
+		// Hundsdorfer-Verwer scheme, 2-dimensional.
+		// The mixed derivative term is treated explicitly in both the predictor 
+		// and the corrector step. Second order accurate for any theta.
+		// References
+		// - HV: Hundsdorfer and Verwer (2003).
+		// - HF: In 't Hout and Foulon (2010).
+		template <class T1, class T2>
+		void hv_2d(
+			const double dt,
+			const std::vector<std::vector<double>>& prefactors_1,
+			const std::vector<std::vector<double>>& prefactors_2,
+			std::vector<T1>& derivatives_1,
+			std::vector<T2>& derivatives_2,
+			MixedDerivative<T1, T2>& mixed,
+			std::vector<double>& func,
+			const double theta = 0.5 + std::sqrt(3.0) / 6.0,
+			const double mu = 0.5) {
+
+			const int n_p_1 = derivatives_1[0].order();
+			const int n_p_2 = derivatives_2[0].order();
+
+			FusedOperator<T1> operator_1(n_p_1, n_p_2, 1, prefactors_1, derivatives_1);
+			FusedOperator<T2> operator_2(n_p_2, n_p_1, 2, prefactors_2, derivatives_2);
+
+			hv_2d(dt, operator_1, operator_2, mixed, func, theta, mu);
+
+		}
+
+
+		// Douglas-Rachford scheme, 3-dimensional.
+		template <class T1, class T2, class T3>
 		void dr_3d(
 			const double dt,
 			const T1& identity_1,
@@ -594,6 +1326,9 @@ namespace propagator {
 		}
 
 		// Douglas-Rachford scheme, N-dimensional.
+		// Assume order of func to be (x1, x2, ..., xN), see action_nd.
+		// References
+		// - AP: Andersen and Piterbarg (2010).
 		template <class T>
 		void dr_nd(
 			const double dt,
@@ -602,16 +1337,57 @@ namespace propagator {
 			std::vector<double>& func,
 			const double theta = 0.5) {
 
+			NFS_SCOPE("propagator::adi::dr_nd");
+
 			const int n_dimensions = (int)identity.size();
-			
+
 			std::vector<int> n_points(n_dimensions, 0);
+			int n_points_total = 1;
 			for (int i = 0; i != n_dimensions; ++i) {
 				n_points[i] = identity[i].order();
+				n_points_total *= n_points[i];
+			}
+
+			// ##########
+			// Operators.
+			// ##########
+
+			std::vector<T> deriv = derivative;
+
+			std::vector<T> lhs = derivative;
+			for (int i = 0; i != n_dimensions; ++i) {
+				lhs[i] *= -theta * dt;
+				lhs[i] += identity[i];
+			}
+
+			// Action of operators on function at beginning of time step.
+			std::vector<std::vector<double>> func_j(n_dimensions);
+			for (int j = 0; j != n_dimensions; ++j) {
+				func_j[j] = action_nd(n_points, j, false, deriv[j], func);
+			}
+
+			// Y0 = U + dt * F(U).
+			for (int i = 0; i != n_points_total; ++i) {
+				for (int j = 0; j != n_dimensions; ++j) {
+					func[i] += dt * func_j[j][i];
+				}
+			}
+
+			// (I - theta * dt * Fj) Yj = Y(j-1) - theta * dt * Fj(U), j = 1, ..., N.
+			for (int j = 0; j != n_dimensions; ++j) {
+				for (int i = 0; i != n_points_total; ++i) {
+					func[i] -= theta * dt * func_j[j][i];
+				}
+				func = action_nd(n_points, j, true, lhs[j], func);
 			}
 
 		}
 
 		// Craig-Sneyd scheme, N-dimensional.
+		// Mixed derivative terms ordered as in d2dxdy_nd. The corrector step 
+		// is repeated n_iterations times.
+		// References
+		// - AP: Andersen and Piterbarg (2010).
 		template <class T>
 		void cs_nd(
 			const double dt,
@@ -623,11 +1399,270 @@ namespace propagator {
 			const double lambda = 0.5,
 			const int n_iterations = 1) {
 
+			NFS_SCOPE("propagator::adi::cs_nd");
+
 			const int n_dimensions = (int)identity.size();
 
 			std::vector<int> n_points(n_dimensions, 0);
+			int n_points_total = 1;
 			for (int i = 0; i != n_dimensions; ++i) {
 				n_points[i] = identity[i].order();
+				n_points_total *= n_points[i];
+			}
+
+			// ##########
+			// Operators.
+			// ##########
+
+			std::vector<T> deriv = derivative;
+
+			std::vector<T> lhs = derivative;
+			for (int i = 0; i != n_dimensions; ++i) {
+				lhs[i] *= -theta * dt;
+				lhs[i] += identity[i];
+			}
+
+			// Action of operators on function at beginning of time step.
+			std::vector<std::vector<double>> func_j(n_dimensions);
+			for (int j = 0; j != n_dimensions; ++j) {
+				func_j[j] = action_nd(n_points, j, false, deriv[j], func);
+			}
+
+			// ###############
+			// Predictor step.
+			// ###############
+
+			std::vector<double> func_0 = d2dxdy_nd(n_points, mixed, func);
+
+			// Y0 = U + dt * F(U).
+			std::vector<double> y_0 = func;
+			for (int i = 0; i != n_points_total; ++i) {
+				y_0[i] += dt * func_0[i];
+				for (int j = 0; j != n_dimensions; ++j) {
+					y_0[i] += dt * func_j[j][i];
+				}
+			}
+			func = y_0;
+
+			// (I - theta * dt * Fj) Yj = Y(j-1) - theta * dt * Fj(U), j = 1, ..., N.
+			for (int j = 0; j != n_dimensions; ++j) {
+				for (int i = 0; i != n_points_total; ++i) {
+					func[i] -= theta * dt * func_j[j][i];
+				}
+				func = action_nd(n_points, j, true, lhs[j], func);
+			}
+
+			// ###############
+			// Corrector step.
+			// ###############
+
+			std::vector<double> pred_0;
+
+			for (int n = 0; n != n_iterations; ++n) {
+
+				// Y0~ = Y0 + lambda * dt * (F0(YN) - F0(U)).
+				pred_0 = d2dxdy_nd(n_points, mixed, func);
+				for (int i = 0; i != n_points_total; ++i) {
+					func[i] = y_0[i] + lambda * dt * (pred_0[i] - func_0[i]);
+				}
+
+				// (I - theta * dt * Fj) Yj~ = Y(j-1)~ - theta * dt * Fj(U), j = 1, ..., N.
+				for (int j = 0; j != n_dimensions; ++j) {
+					for (int i = 0; i != n_points_total; ++i) {
+						func[i] -= theta * dt * func_j[j][i];
+					}
+					func = action_nd(n_points, j, true, lhs[j], func);
+				}
+
+			}
+
+		}
+
+		// Modified Craig-Sneyd scheme, N-dimensional.
+		// Mixed derivative terms ordered as in d2dxdy_nd.
+		// References
+		// - IW: In 't Hout and Welfert (2009).
+		template <class T>
+		void mcs_nd(
+			const double dt,
+			const std::vector<T>& identity,
+			const std::vector<T>& derivative,
+			std::vector<MixedDerivative<T, T>>& mixed,
+			std::vector<double>& func,
+			const double theta = 1.0 / 3.0) {
+
+			NFS_SCOPE("propagator::adi::mcs_nd");
+
+			const int n_dimensions = (int)identity.size();
+
+			std::vector<int> n_points(n_dimensions, 0);
+			int n_points_total = 1;
+			for (int i = 0; i != n_dimensions; ++i) {
+				n_points[i] = identity[i].order();
+				n_points_total *= n_points[i];
+			}
+
+			// ##########
+			// Operators.
+			// ##########
+
+			std::vector<T> deriv = derivative;
+
+			std::vector<T> lhs = derivative;
+			for (int i = 0; i != n_dimensions; ++i) {
+				lhs[i] *= -theta * dt;
+				lhs[i] += identity[i];
+			}
+
+			// Action of operators on function at beginning of time step.
+			std::vector<std::vector<double>> func_j(n_dimensions);
+			for (int j = 0; j != n_dimensions; ++j) {
+				func_j[j] = action_nd(n_points, j, false, deriv[j], func);
+			}
+
+			// ###############
+			// Predictor step.
+			// ###############
+
+			std::vector<double> func_0 = d2dxdy_nd(n_points, mixed, func);
+
+			// Y0 = U + dt * F(U).
+			std::vector<double> y_0 = func;
+			for (int i = 0; i != n_points_total; ++i) {
+				y_0[i] += dt * func_0[i];
+				for (int j = 0; j != n_dimensions; ++j) {
+					y_0[i] += dt * func_j[j][i];
+				}
+			}
+			func = y_0;
+
+			// (I - theta * dt * Fj) Yj = Y(j-1) - theta * dt * Fj(U), j = 1, ..., N.
+			for (int j = 0; j != n_dimensions; ++j) {
+				for (int i = 0; i != n_points_total; ++i) {
+					func[i] -= theta * dt * func_j[j][i];
+				}
+				func = action_nd(n_points, j, true, lhs[j], func);
+			}
+
+			// ###############
+			// Corrector step.
+			// ###############
+
+			// Y0^ = Y0 + theta * dt * (F0(YN) - F0(U)),
+			// Y0~ = Y0^ + (1/2 - theta) * dt * (F(YN) - F(U)).
+			std::vector<double> pred_0 = d2dxdy_nd(n_points, mixed, func);
+			for (int i = 0; i != n_points_total; ++i) {
+				y_0[i] += 0.5 * dt * (pred_0[i] - func_0[i]);
+			}
+			for (int j = 0; j != n_dimensions; ++j) {
+				std::vector<double> pred_j = action_nd(n_points, j, false, deriv[j], func);
+				for (int i = 0; i != n_points_total; ++i) {
+					y_0[i] += (0.5 - theta) * dt * (pred_j[i] - func_j[j][i]);
+				}
+			}
+			func = y_0;
+
+			// (I - theta * dt * Fj) Yj~ = Y(j-1)~ - theta * dt * Fj(U), j = 1, ..., N.
+			for (int j = 0; j != n_dimensions; ++j) {
+				for (int i = 0; i != n_points_total; ++i) {
+					func[i] -= theta * dt * func_j[j][i];
+				}
+				func = action_nd(n_points, j, true, lhs[j], func);
+			}
+
+		}
+
+		// Hundsdorfer-Verwer scheme, N-dimensional.
+		// Mixed derivative terms ordered as in d2dxdy_nd.
+		// References
+		// - HV: Hundsdorfer and Verwer (2003).
+		template <class T>
+		void hv_nd(
+			const double dt,
+			const std::vector<T>& identity,
+			const std::vector<T>& derivative,
+			std::vector<MixedDerivative<T, T>>& mixed,
+			std::vector<double>& func,
+			const double theta = 0.5 + std::sqrt(3.0) / 6.0,
+			const double mu = 0.5) {
+
+			NFS_SCOPE("propagator::adi::hv_nd");
+
+			const int n_dimensions = (int)identity.size();
+
+			std::vector<int> n_points(n_dimensions, 0);
+			int n_points_total = 1;
+			for (int i = 0; i != n_dimensions; ++i) {
+				n_points[i] = identity[i].order();
+				n_points_total *= n_points[i];
+			}
+
+			// ##########
+			// Operators.
+			// ##########
+
+			std::vector<T> deriv = derivative;
+
+			std::vector<T> lhs = derivative;
+			for (int i = 0; i != n_dimensions; ++i) {
+				lhs[i] *= -theta * dt;
+				lhs[i] += identity[i];
+			}
+
+			// Action of operators on function at beginning of time step.
+			std::vector<std::vector<double>> func_j(n_dimensions);
+			for (int j = 0; j != n_dimensions; ++j) {
+				func_j[j] = action_nd(n_points, j, false, deriv[j], func);
+			}
+
+			// ###############
+			// Predictor step.
+			// ###############
+
+			std::vector<double> func_0 = d2dxdy_nd(n_points, mixed, func);
+
+			// Y0 = U + dt * F(U).
+			std::vector<double> y_0 = func;
+			for (int i = 0; i != n_points_total; ++i) {
+				y_0[i] += dt * func_0[i];
+				for (int j = 0; j != n_dimensions; ++j) {
+					y_0[i] += dt * func_j[j][i];
+				}
+			}
+			func = y_0;
+
+			// (I - theta * dt * Fj) Yj = Y(j-1) - theta * dt * Fj(U), j = 1, ..., N.
+			for (int j = 0; j != n_dimensions; ++j) {
+				for (int i = 0; i != n_points_total; ++i) {
+					func[i] -= theta * dt * func_j[j][i];
+				}
+				func = action_nd(n_points, j, true, lhs[j], func);
+			}
+
+			// ###############
+			// Corrector step.
+			// ###############
+
+			// Y0~ = Y0 + mu * dt * (F(YN) - F(U)).
+			std::vector<std::vector<double>> pred_j(n_dimensions);
+			std::vector<double> pred_0 = d2dxdy_nd(n_points, mixed, func);
+			for (int i = 0; i != n_points_total; ++i) {
+				y_0[i] += mu * dt * (pred_0[i] - func_0[i]);
+			}
+			for (int j = 0; j != n_dimensions; ++j) {
+				pred_j[j] = action_nd(n_points, j, false, deriv[j], func);
+				for (int i = 0; i != n_points_total; ++i) {
+					y_0[i] += mu * dt * (pred_j[j][i] - func_j[j][i]);
+				}
+			}
+			func = y_0;
+
+			// (I - theta * dt * Fj) Yj~ = Y(j-1)~ - theta * dt * Fj(YN), j = 1, ..., N.
+			for (int j = 0; j != n_dimensions; ++j) {
+				for (int i = 0; i != n_points_total; ++i) {
+					func[i] -= theta * dt * pred_j[j][i];
+				}
+				func = action_nd(n_points, j, true, lhs[j], func);
 			}
 
 		}
@@ -1,5 +1,12 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 #include <vector>
 
+#include <Eigen/Dense>
+
+#include "instrumentation.h"
+#include "parallel.h"
 #include "regression.h"
 
 
@@ -39,3 +46,353 @@ std::vector<double> regression::slr(
 	return result;
 
 }
+
+
+int regression::n_threads(
+	const int n_observations,
+	const int n_threads) {
+
+	return parallel::n_threads(n_observations, regression::thread_threshold,
+		regression::observations_per_thread_min, n_threads);
+
+}
+
+
+regression::LeastSquares::LeastSquares(
+	const int n_regressors,
+	const int degree,
+	const Basis basis) :
+	n_regressors_(n_regressors),
+	degree_(degree),
+	basis_(basis),
+	shift_(n_regressors, 0.0),
+	scale_(n_regressors, 1.0) {
+
+	if (n_regressors < 1 || degree < 0) {
+		throw std::invalid_argument("At least one regressor and non-negative degree required.");
+	}
+
+	// Terms ordered by total degree; within a degree, by decreasing power of
+	// the first regressor, then the second, etc.
+	std::vector<int> powers(n_regressors, 0);
+
+	for (int total = 0; total <= degree; ++total) {
+
+		std::fill(powers.begin(), powers.end(), 0);
+		powers[0] = total;
+
+		while (true) {
+
+			powers_.push_back(powers);
+
+			// Next composition of total: Move one unit from the last non-zero
+			// power (except the last regressor) one regressor to the right,
+			// and collect the powers behind it.
+			int r = n_regressors - 2;
+			while (r >= 0 && powers[r] == 0) {
+				--r;
+			}
+			if (r < 0) {
+				break;
+			}
+			const int tail = powers[n_regressors - 1];
+			powers[n_regressors - 1] = 0;
+			--powers[r];
+			powers[r + 1] = tail + 1;
+
+		}
+
+	}
+
+	coefficients_.assign(powers_.size(), 0.0);
+
+}
+
+
+void regression::LeastSquares::univariate(
+	const double x,
+	double* result) const {
+
+	result[0] = 1.0;
+
+	if (basis_ == Basis::monomial) {
+		for (int k = 1; k <= degree_; ++k) {
+			result[k] = result[k - 1] * x;
+		}
+	}
+	else {
+		// (k + 1) * L_{k + 1} = (2 * k + 1 - x) * L_k - k * L_{k - 1}.
+		if (degree_ > 0) {
+			result[1] = 1.0 - x;
+		}
+		for (int k = 1; k < degree_; ++k) {
+			result[k + 1] = ((2 * k + 1 - x) * result[k] - k * result[k - 1]) / (k + 1);
+		}
+	}
+
+}
+
+
+void regression::LeastSquares::evaluate(
+	const std::vector<const double*>& x,
+	const int begin,
+	const int end,
+	double* univariate_tmp,
+	double* result) const {
+
+	const int m = end - begin;
+	const int n_degrees = degree_ + 1;
+
+	std::vector<double> u(n_degrees, 0.0);
+
+	// Univariate basis functions, order (regressor, degree, observation).
+	for (int r = 0; r != n_regressors_; ++r) {
+
+		double* tmp = univariate_tmp + (size_t)r * n_degrees * block_size;
+
+		for (int p = 0; p != m; ++p) {
+			univariate((x[r][begin + p] - shift_[r]) / scale_[r], u.data());
+			for (int d = 0; d != n_degrees; ++d) {
+				tmp[d * block_size + p] = u[d];
+			}
+		}
+
+	}
+
+	// Products, order (term, observation).
+	for (int k = 0; k != n_terms(); ++k) {
+
+		double* row = result + (size_t)k * block_size;
+		std::fill(row, row + m, 1.0);
+
+		for (int r = 0; r != n_regressors_; ++r) {
+
+			const int d = powers_[k][r];
+			if (d == 0) {
+				continue;
+			}
+
+			const double* tmp = univariate_tmp + ((size_t)r * n_degrees + d) * block_size;
+			for (int p = 0; p != m; ++p) {
+				row[p] *= tmp[p];
+			}
+
+		}
+
+	}
+
+}
+
+
+void regression::LeastSquares::fit(
+	const std::vector<const double*>& x,
+	const double* y,
+	const double* weights,
+	const int n_observations,
+	const int n_threads) {
+
+	NFS_SCOPE("regression::LeastSquares::fit");
+
+	if ((int)x.size() != n_regressors_) {
+		throw std::invalid_argument("Number of regressors does not match.");
+	}
+
+	const int n = n_terms();
+	const int n_used_threads = regression::n_threads(n_observations, n_threads);
+
+	// Weighted moments of regressors, for standardization:
+	// (sum of weights, number of observations used), then sum w * x and
+	// sum w * x^2 per regressor.
+	std::vector<std::vector<double>> moments(
+		n_used_threads, std::vector<double>(2 + 2 * n_regressors_, 0.0));
+
+	parallel::for_ranges(n_observations, n_used_threads, block_size,
+		[&](const int thread, const int begin, const int end) {
+
+			std::vector<double>& m = moments[thread];
+
+			for (int p = begin; p != end; ++p) {
+				const double w = weights ? weights[p] : 1.0;
+				if (w == 0.0) {
+					continue;
+				}
+				m[0] += w;
+				m[1] += 1.0;
+				for (int r = 0; r != n_regressors_; ++r) {
+					m[2 + 2 * r] += w * x[r][p];
+					m[3 + 2 * r] += w * x[r][p] * x[r][p];
+				}
+			}
+
+		});
+
+	for (int t = 1; t != n_used_threads; ++t) {
+		for (int i = 0; i != moments[0].size(); ++i) {
+			moments[0][i] += moments[t][i];
+		}
+	}
+
+	if (moments[0][1] < n) {
+		throw std::invalid_argument("Fewer observations than basis functions.");
+	}
+
+	const double weight_sum = moments[0][0];
+
+	for (int r = 0; r != n_regressors_; ++r) {
+
+		const double mean = moments[0][2 + 2 * r] / weight_sum;
+		const double variance = moments[0][3 + 2 * r] / weight_sum - mean * mean;
+
+		if (basis_ == Basis::monomial) {
+			shift_[r] = mean;
+			scale_[r] = variance > 0.0 ? std::sqrt(variance) : 1.0;
+		}
+		else {
+			shift_[r] = 0.0;
+			scale_[r] = mean > 0.0 ? mean : 1.0;
+		}
+
+	}
+
+	// Gram matrix (upper triangle) and right-hand-side per thread.
+	std::vector<std::vector<double>> gram(
+		n_used_threads, std::vector<double>((size_t)n * n + n, 0.0));
+
+	parallel::for_ranges(n_observations, n_used_threads, block_size,
+		[&](const int thread, const int begin, const int end) {
+
+			double* g = gram[thread].data();
+			double* b = g + (size_t)n * n;
+
+			std::vector<double> univariate_tmp((size_t)(degree_ + 1) * n_regressors_ * block_size, 0.0);
+			std::vector<double> values((size_t)n * block_size, 0.0);
+			std::vector<double> weighted(block_size, 0.0);
+
+			for (int block_begin = begin; block_begin < end; block_begin += block_size) {
+
+				const int block_end = std::min(block_begin + block_size, end);
+				const int m = block_end - block_begin;
+
+				evaluate(x, block_begin, block_end, univariate_tmp.data(), values.data());
+
+				for (int k = 0; k != n; ++k) {
+
+					const double* v_k = values.data() + (size_t)k * block_size;
+
+					double sum_y = 0.0;
+					for (int p = 0; p != m; ++p) {
+						weighted[p] = (weights ? weights[block_begin + p] : 1.0) * v_k[p];
+						sum_y += weighted[p] * y[block_begin + p];
+					}
+					b[k] += sum_y;
+
+					for (int l = k; l != n; ++l) {
+						const double* v_l = values.data() + (size_t)l * block_size;
+						double sum = 0.0;
+						for (int p = 0; p != m; ++p) {
+							sum += weighted[p] * v_l[p];
+						}
+						g[(size_t)k * n + l] += sum;
+					}
+
+				}
+
+			}
+
+		});
+
+	Eigen::MatrixXd a(n, n);
+	Eigen::VectorXd rhs(n);
+
+	for (int k = 0; k != n; ++k) {
+		for (int l = k; l != n; ++l) {
+			double sum = 0.0;
+			for (int t = 0; t != n_used_threads; ++t) {
+				sum += gram[t][(size_t)k * n + l];
+			}
+			a(k, l) = sum;
+			a(l, k) = sum;
+		}
+		double sum = 0.0;
+		for (int t = 0; t != n_used_threads; ++t) {
+			sum += gram[t][(size_t)n * n + k];
+		}
+		rhs(k) = sum;
+	}
+
+	const Eigen::VectorXd solution = a.ldlt().solve(rhs);
+
+	for (int k = 0; k != n; ++k) {
+		coefficients_[k] = solution(k);
+	}
+
+}
+
+
+void regression::LeastSquares::fit(
+	const std::vector<std::vector<double>>& x,
+	const std::vector<double>& y,
+	const std::vector<double>& weights,
+	const int n_threads) {
+
+	std::vector<const double*> columns;
+	for (const std::vector<double>& column : x) {
+		columns.push_back(column.data());
+	}
+
+	fit(columns, y.data(), weights.empty() ? nullptr : weights.data(), (int)y.size(), n_threads);
+
+}
+
+
+void regression::LeastSquares::predict(
+	const std::vector<const double*>& x,
+	const int n_observations,
+	double* result) const {
+
+	NFS_SCOPE("regression::LeastSquares::predict");
+
+	const int n = n_terms();
+
+	std::vector<double> univariate_tmp((size_t)(degree_ + 1) * n_regressors_ * block_size, 0.0);
+	std::vector<double> values((size_t)n * block_size, 0.0);
+
+	for (int block_begin = 0; block_begin < n_observations; block_begin += block_size) {
+
+		const int block_end = std::min(block_begin + block_size, n_observations);
+		const int m = block_end - block_begin;
+
+		evaluate(x, block_begin, block_end, univariate_tmp.data(), values.data());
+
+		double* out = result + block_begin;
+		std::fill(out, out + m, 0.0);
+
+		for (int k = 0; k != n; ++k) {
+			const double c = coefficients_[k];
+			const double* v_k = values.data() + (size_t)k * block_size;
+			for (int p = 0; p != m; ++p) {
+				out[p] += c * v_k[p];
+			}
+		}
+
+	}
+
+}
+
+
+std::vector<double> regression::LeastSquares::predict(
+	const std::vector<std::vector<double>>& x) const {
+
+	std::vector<const double*> columns;
+	for (const std::vector<double>& column : x) {
+		columns.push_back(column.data());
+	}
+
+	const int n_observations = x.empty() ? 0 : (int)x[0].size();
+	std::vector<double> result(n_observations, 0.0);
+
+	predict(columns, n_observations, result.data());
+
+	return result;
+
+}
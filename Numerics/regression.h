@@ -10,4 +10,118 @@ namespace regression {
 		const std::vector<double>& x, 
 		const std::vector<double>& y);
 
-}
\ No newline at end of file
+	// Univariate basis functions of degree 0, 1, ...:
+	//	- monomial: x^k, of the standardized regressor (x - mean) / stddev.
+	//	- laguerre: Laguerre polynomials L_k(x), of the regressor divided by
+	//	  its mean (regressors should be positive, e.g. spot prices).
+	enum class Basis { monomial, laguerre };
+
+	// Number of paths per cache block.
+	const int block_size = 256;
+
+	// Data sets with at least this many observations are accumulated by
+	// several threads.
+	const int thread_threshold = 1 << 14;
+
+	// Minimum number of observations per thread.
+	const int observations_per_thread_min = 1 << 13;
+
+	// Number of threads used for n_observations, see parallel::n_threads.
+	// n_threads = 0: Number of hardware threads.
+	int n_threads(
+		const int n_observations,
+		const int n_threads = 0);
+
+	// Weighted least-squares regression of y on products of univariate basis
+	// functions of several regressors, with total degree up to degree.
+	//
+	// Data is given in structure-of-arrays form, one contiguous array of
+	// observations (paths) per regressor. Observations are processed in
+	// blocks of block_size: The basis functions of a block are evaluated into
+	// a small array, one row per basis function, from which the Gram matrix
+	// X^T W X and X^T W y are accumulated by stride-one loops. Ranges of
+	// blocks are accumulated concurrently (parallel::for_ranges), each into
+	// its own Gram matrix; the sums are reduced, and the normal equations are
+	// solved by an LDL^T factorization.
+	class LeastSquares {
+
+	private:
+
+		int n_regressors_;
+		int degree_;
+		Basis basis_;
+
+		// Degree of each regressor in each term, order (term, regressor).
+		std::vector<std::vector<int>> powers_;
+
+		// Regressor transformation, (x - shift) / scale.
+		std::vector<double> shift_;
+		std::vector<double> scale_;
+
+		std::vector<double> coefficients_;
+
+		// Univariate basis functions of degree 0, ..., degree at (transformed) x.
+		void univariate(
+			const double x,
+			double* result) const;
+
+		// Basis functions of observations [begin, end), order (term, observation).
+		// univariate_tmp: Work space of (degree + 1) * n_regressors * block_size.
+		void evaluate(
+			const std::vector<const double*>& x,
+			const int begin,
+			const int end,
+			double* univariate_tmp,
+			double* result) const;
+
+	public:
+
+		LeastSquares(
+			const int n_regressors,
+			const int degree,
+			const Basis basis = Basis::monomial);
+
+		int n_regressors() const {
+			return n_regressors_;
+		}
+
+		int n_terms() const {
+			return (int)powers_.size();
+		}
+
+		const std::vector<std::vector<int>>& powers() const {
+			return powers_;
+		}
+
+		// Coefficients of basis functions, in the order of powers().
+		const std::vector<double>& coefficients() const {
+			return coefficients_;
+		}
+
+		// Fit to n_observations observations. weights: Weight of each
+		// observation, nullptr for unit weights; zero weights exclude
+		// observations (e.g. paths out of the money).
+		void fit(
+			const std::vector<const double*>& x,
+			const double* y,
+			const double* weights,
+			const int n_observations,
+			const int n_threads = 0);
+
+		void fit(
+			const std::vector<std::vector<double>>& x,
+			const std::vector<double>& y,
+			const std::vector<double>& weights = std::vector<double>(),
+			const int n_threads = 0);
+
+		// Fitted values of n_observations observations.
+		void predict(
+			const std::vector<const double*>& x,
+			const int n_observations,
+			double* result) const;
+
+		std::vector<double> predict(const std::vector<std::vector<double>>& x) const;
+
+	};
+
+}
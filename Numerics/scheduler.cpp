@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <utility>
+
+#include "instrumentation.h"
+#include "scheduler.h"
+
+
+namespace {
+
+	// Scheduler and worker index of calling thread, if it is a worker.
+	thread_local const tasks::Scheduler* current_scheduler = nullptr;
+	thread_local int current_worker = -1;
+
+	// Job running on calling thread.
+	thread_local tasks::JobState* current_job = nullptr;
+
+}
+
+
+tasks::Status tasks::JobState::status() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return status_;
+}
+
+
+bool tasks::JobState::done() {
+	const Status s = status();
+	return s == Status::done || s == Status::cancelled || s == Status::failed;
+}
+
+
+bool tasks::JobState::start() {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	if (status_ != Status::pending) {
+		return false;
+	}
+	status_ = Status::running;
+
+	return true;
+
+}
+
+
+void tasks::JobState::finish(const Status status, std::exception_ptr error) {
+
+	std::vector<std::function<void()>> callbacks;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		status_ = status;
+		error_ = error;
+		callbacks.swap(callbacks_);
+	}
+	finished_.notify_all();
+
+	for (std::function<void()>& callback : callbacks) {
+		callback();
+	}
+
+}
+
+
+void tasks::JobState::wait() {
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	finished_.wait(lock, [this]() {
+		return status_ == Status::done || status_ == Status::cancelled || status_ == Status::failed;
+	});
+
+}
+
+
+bool tasks::JobState::cancel() {
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		cancel_requested_ = true;
+		if (status_ != Status::pending) {
+			return false;
+		}
+	}
+
+	// The job stays queued and is skipped by the worker, see start.
+	finish(Status::cancelled);
+
+	return true;
+
+}
+
+
+void tasks::JobState::then(std::function<void()> callback) {
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (status_ == Status::pending || status_ == Status::running) {
+			callbacks_.push_back(std::move(callback));
+			return;
+		}
+	}
+
+	callback();
+
+}
+
+
+void tasks::JobState::rethrow() {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	if (status_ == Status::cancelled) {
+		throw Cancelled();
+	}
+	if (error_) {
+		std::rethrow_exception(error_);
+	}
+
+}
+
+
+tasks::Scheduler::Scheduler(
+	const int n_threads,
+	const int capacity) :
+	capacity_(capacity),
+	n_queued_(0),
+	n_running_(0),
+	stop_(false),
+	next_worker_(0) {
+
+	if (capacity < 1) {
+		throw std::invalid_argument("Capacity should be positive.");
+	}
+
+	int n = n_threads;
+	if (n == 0) {
+		n = std::max((int)std::thread::hardware_concurrency(), 1);
+	}
+	if (n < 1) {
+		throw std::invalid_argument("Number of threads should be positive.");
+	}
+
+	for (int i = 0; i != n; ++i) {
+		workers_.push_back(std::unique_ptr<Worker>(new Worker));
+	}
+	for (int i = 0; i != n; ++i) {
+		threads_.emplace_back(&Scheduler::run_worker, this, i);
+	}
+
+}
+
+
+tasks::Scheduler::~Scheduler() {
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	work_available_.notify_all();
+	space_available_.notify_all();
+
+	for (std::thread& thread : threads_) {
+		thread.join();
+	}
+
+}
+
+
+int tasks::Scheduler::n_queued() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return n_queued_;
+}
+
+
+void tasks::Scheduler::wait_idle() {
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	idle_.wait(lock, [this]() {
+		return n_queued_ == 0 && n_running_ == 0;
+	});
+
+}
+
+
+bool tasks::Scheduler::cancellation_requested() {
+	return current_job && current_job->cancel_requested();
+}
+
+
+int tasks::Scheduler::worker_index() {
+	return current_worker;
+}
+
+
+void tasks::Scheduler::push(Job job, const Priority priority) {
+
+	const bool nested = current_scheduler == this;
+
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+
+		if (!nested) {
+			space_available_.wait(lock, [this]() {
+				return n_queued_ < capacity_ || stop_;
+			});
+		}
+
+		const int worker = nested
+			? current_worker : (int)(next_worker_++ % workers_.size());
+
+		{
+			std::lock_guard<std::mutex> worker_lock(workers_[worker]->mutex);
+			workers_[worker]->queues[(int)priority].push_back(std::move(job));
+		}
+
+		++n_queued_;
+	}
+
+	work_available_.notify_one();
+
+}
+
+
+bool tasks::Scheduler::pop(const int worker, Job& job) {
+
+	const int n_workers = (int)workers_.size();
+
+	for (int p = 0; p != n_priorities; ++p) {
+
+		// Own queue first, then steal.
+		for (int k = 0; k != n_workers; ++k) {
+
+			Worker& victim = *workers_[(worker + k) % n_workers];
+
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			std::deque<Job>& queue = victim.queues[p];
+
+			if (!queue.empty()) {
+				job = std::move(queue.front());
+				queue.pop_front();
+				return true;
+			}
+
+		}
+
+	}
+
+	return false;
+
+}
+
+
+void tasks::Scheduler::run_worker(const int worker) {
+
+	current_scheduler = this;
+	current_worker = worker;
+
+	while (true) {
+
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			work_available_.wait(lock, [this]() {
+				return n_queued_ > 0 || stop_;
+			});
+			if (n_queued_ == 0 && stop_) {
+				return;
+			}
+		}
+
+		// Another worker may have taken the job in the meantime.
+		Job job;
+		if (!pop(worker, job)) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			--n_queued_;
+			++n_running_;
+		}
+		space_available_.notify_one();
+
+		if (job.state->start()) {
+
+			Status status = Status::done;
+			std::exception_ptr error;
+
+			current_job = job.state.get();
+			try {
+				NFS_SCOPE("tasks::job");
+				job.run();
+			}
+			catch (const Cancelled&) {
+				status = Status::cancelled;
+			}
+			catch (...) {
+				status = Status::failed;
+				error = std::current_exception();
+			}
+			current_job = nullptr;
+
+			job.state->finish(status, error);
+
+		}
+
+		// Release captured state before reporting idle.
+		job = Job();
+
+		bool idle = false;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			--n_running_;
+			idle = n_queued_ == 0 && n_running_ == 0;
+		}
+		if (idle) {
+			idle_.notify_all();
+		}
+
+	}
+
+}
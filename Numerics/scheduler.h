@@ -0,0 +1,263 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+// Task-based execution of pricing jobs (PDE solves, closed form strips,
+// etc.) on a fixed set of worker threads.
+//
+// Each worker has a queue per priority. A worker serves its own queues
+// first-in first-out, and steals from the other workers when these are
+// empty; higher priority jobs, on any worker, are taken before lower ones.
+// The number of queued jobs is bounded: submit blocks while the scheduler
+// is full (jobs submitted by running jobs are exempt to avoid deadlock).
+//
+// submit returns a Future. Pending jobs can be cancelled; running jobs are
+// cancelled cooperatively by polling Scheduler::cancellation_requested.
+namespace tasks {
+
+	enum class Priority { high = 0, normal = 1, low = 2 };
+
+	const int n_priorities = 3;
+
+	enum class Status { pending, running, done, cancelled, failed };
+
+	// Thrown by Future::get if the job was cancelled. A running job may
+	// throw it to acknowledge cancellation.
+	class Cancelled : public std::runtime_error {
+	public:
+		Cancelled() : std::runtime_error("Job cancelled.") {}
+	};
+
+	// State shared by job and futures, independent of result type.
+	class JobState {
+
+	private:
+
+		std::mutex mutex_;
+		std::condition_variable finished_;
+		Status status_;
+		std::exception_ptr error_;
+		std::vector<std::function<void()>> callbacks_;
+		std::atomic<bool> cancel_requested_;
+
+	public:
+
+		JobState() : status_(Status::pending), cancel_requested_(false) {}
+
+		Status status();
+
+		bool done();
+
+		// Mark as running, false if cancellation has been requested.
+		bool start();
+
+		// Set final status and run callbacks on calling thread.
+		void finish(const Status status, std::exception_ptr error = nullptr);
+
+		void wait();
+
+		// Request cancellation. True if the job had not started; it is then
+		// finished as cancelled without being run.
+		bool cancel();
+
+		bool cancel_requested() const {
+			return cancel_requested_;
+		}
+
+		// Call callback once the job has finished, immediately if it has.
+		// Callbacks run on the worker thread finishing the job.
+		void then(std::function<void()> callback);
+
+		// Rethrow error, or throw Cancelled.
+		void rethrow();
+
+	};
+
+	// State of job returning T, holding the result.
+	template <class T>
+	struct ResultState : JobState {
+
+		T value;
+
+		template <class F>
+		void run(F& func) {
+			value = func();
+		}
+
+		T& result() {
+			return value;
+		}
+
+	};
+
+	// State of job returning void.
+	template <>
+	struct ResultState<void> : JobState {
+
+		template <class F>
+		void run(F& func) {
+			func();
+		}
+
+		void result() {}
+
+	};
+
+	template <class T>
+	class Future {
+
+	public:
+
+		typedef ResultState<T> State;
+
+	private:
+
+		std::shared_ptr<State> state_;
+
+	public:
+
+		Future() {}
+
+		Future(std::shared_ptr<State> state) : state_(state) {}
+
+		bool valid() const {
+			return (bool)state_;
+		}
+
+		Status status() const {
+			return state_->status();
+		}
+
+		bool done() const {
+			return state_->done();
+		}
+
+		void wait() const {
+			state_->wait();
+		}
+
+		bool cancel() const {
+			return state_->cancel();
+		}
+
+		void then(std::function<void()> callback) const {
+			state_->then(std::move(callback));
+		}
+
+		// Result, blocks until the job has finished. Throws Cancelled or the
+		// exception thrown by the job. The result may be moved from.
+		typename std::add_lvalue_reference<T>::type get() const {
+			state_->wait();
+			state_->rethrow();
+			return state_->result();
+		}
+
+	};
+
+	class Scheduler {
+
+	private:
+
+		struct Job {
+			std::shared_ptr<JobState> state;
+			std::function<void()> run;
+		};
+
+		struct Worker {
+			std::mutex mutex;
+			std::deque<Job> queues[n_priorities];
+		};
+
+		std::vector<std::unique_ptr<Worker>> workers_;
+		std::vector<std::thread> threads_;
+
+		int capacity_;
+
+		std::mutex mutex_;
+		std::condition_variable work_available_;
+		std::condition_variable space_available_;
+		std::condition_variable idle_;
+		int n_queued_;
+		int n_running_;
+		bool stop_;
+
+		std::atomic<unsigned> next_worker_;
+
+		// Enqueue job on worker of calling thread, or round-robin.
+		void push(Job job, const Priority priority);
+
+		// Take job from own queues or steal, false if all queues are empty.
+		bool pop(const int worker, Job& job);
+
+		void run_worker(const int worker);
+
+	public:
+
+		// n_threads = 0: Number of hardware threads.
+		Scheduler(
+			const int n_threads = 0,
+			const int capacity = 1024);
+
+		// Queued jobs are completed before the workers are joined.
+		~Scheduler();
+
+		Scheduler(const Scheduler&) = delete;
+		Scheduler& operator=(const Scheduler&) = delete;
+
+		int n_threads() const {
+			return (int)threads_.size();
+		}
+
+		int capacity() const {
+			return capacity_;
+		}
+
+		// Number of jobs queued, not yet started.
+		int n_queued();
+
+		// Block until no job is queued or running.
+		void wait_idle();
+
+		// Submit job func() returning T, or void.
+		template <class F>
+		auto submit(F func, const Priority priority = Priority::normal)
+			-> Future<decltype(func())> {
+
+			typedef decltype(func()) T;
+			typedef typename Future<T>::State State;
+
+			std::shared_ptr<State> state = std::make_shared<State>();
+
+			Job job;
+			job.state = state;
+			job.run = [state, func]() mutable {
+				state->run(func);
+			};
+
+			push(std::move(job), priority);
+
+			return Future<T>(state);
+
+		}
+
+		// True if cancellation of the job running on calling thread has been
+		// requested. False outside of jobs.
+		static bool cancellation_requested();
+
+		// Index of worker running calling thread, -1 outside of workers.
+		static int worker_index();
+
+	};
+
+}
@@ -0,0 +1,439 @@
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "parallel.h"
+#include "sparse_matrix.h"
+
+
+// Sort row elements by column index and merge duplicates. Zeros are dropped.
+static void append_row(
+	std::vector<std::pair<int, double>>& row,
+	std::vector<int>& columns,
+	std::vector<double>& values) {
+
+	std::sort(row.begin(), row.end(),
+		[](const std::pair<int, double>& a, const std::pair<int, double>& b) {
+			return a.first < b.first;
+		});
+
+	int i = 0;
+	while (i != row.size()) {
+
+		const int column = row[i].first;
+		double value = 0.0;
+
+		for (; i != row.size() && row[i].first == column; ++i) {
+			value += row[i].second;
+		}
+
+		if (value != 0.0) {
+			columns.push_back(column);
+			values.push_back(value);
+		}
+
+	}
+
+	row.clear();
+
+}
+
+
+SparseMatrix::SparseMatrix(
+	const int n_rows,
+	const int n_columns) :
+	n_rows_(n_rows),
+	n_columns_(n_columns),
+	row_start_(n_rows + 1, 0) {}
+
+
+SparseMatrix::SparseMatrix(
+	const int n_rows,
+	const int n_columns,
+	const std::vector<int>& row_start,
+	const std::vector<int>& columns,
+	const std::vector<double>& values) :
+	n_rows_(n_rows),
+	n_columns_(n_columns),
+	row_start_(row_start),
+	columns_(columns),
+	values_(values) {
+
+	if (row_start_.size() != n_rows_ + 1 || columns_.size() != values_.size()
+		|| row_start_.back() != values_.size()) {
+		throw std::invalid_argument("Inconsistent CSR arrays.");
+	}
+
+}
+
+
+SparseMatrix::SparseMatrix(const BandDiagonal& matrix) {
+
+	const int order = matrix.order();
+	const int n_br = matrix.n_boundary_rows();
+	const int n_be = matrix.n_boundary_elements();
+
+	n_rows_ = order;
+	n_columns_ = order;
+	row_start_.assign(1, 0);
+
+	std::vector<std::pair<int, double>> row;
+
+	for (int i = 0; i != order; ++i) {
+
+		if (i < n_br) {
+			// Lower boundary row.
+			for (int j = i; j != n_be; ++j) {
+				row.push_back({ j, matrix.boundary_rows[i][j] });
+			}
+		}
+		else if (i >= order - n_br) {
+			// Upper boundary row.
+			const int br_lower_idx = (order - 1) - i;
+			const int br_upper_idx = (2 * n_br - 1) - br_lower_idx;
+			for (int j = br_lower_idx; j != n_be; ++j) {
+				row.push_back({ (order - 1) - j, matrix.boundary_rows[br_upper_idx][(n_be - 1) - j] });
+			}
+		}
+		else {
+			// Interior row.
+			for (int j = 0; j != matrix.n_diagonals(); ++j) {
+				row.push_back({ (i - n_br) + j, matrix.matrix[j][i] });
+			}
+		}
+
+		append_row(row, columns_, values_);
+		row_start_.push_back((int)values_.size());
+
+	}
+
+}
+
+
+SparseMatrix SparseMatrix::operator*=(const double scalar) {
+
+	for (double& value : values_) {
+		value *= scalar;
+	}
+
+	return *this;
+
+}
+
+
+SparseMatrix SparseMatrix::operator+=(const SparseMatrix& rhs) {
+
+	if (n_rows_ != rhs.n_rows_ || n_columns_ != rhs.n_columns_) {
+		throw std::invalid_argument("Matrix dimensions do not match.");
+	}
+
+	std::vector<int> row_start(1, 0);
+	std::vector<int> columns;
+	std::vector<double> values;
+
+	columns.reserve(values_.size() + rhs.values_.size());
+	values.reserve(values_.size() + rhs.values_.size());
+
+	std::vector<std::pair<int, double>> row;
+
+	for (int i = 0; i != n_rows_; ++i) {
+		for (int k = row_start_[i]; k != row_start_[i + 1]; ++k) {
+			row.push_back({ columns_[k], values_[k] });
+		}
+		for (int k = rhs.row_start_[i]; k != rhs.row_start_[i + 1]; ++k) {
+			row.push_back({ rhs.columns_[k], rhs.values_[k] });
+		}
+		append_row(row, columns, values);
+		row_start.push_back((int)values.size());
+	}
+
+	row_start_ = row_start;
+	columns_ = columns;
+	values_ = values;
+
+	return *this;
+
+}
+
+
+SparseMatrix SparseMatrix::pre_vector(const std::vector<double>& vector) const {
+
+	if (vector.size() != n_rows_) {
+		throw std::invalid_argument("Vector size should equal number of rows.");
+	}
+
+	SparseMatrix result = *this;
+
+	for (int i = 0; i != n_rows_; ++i) {
+		for (int k = row_start_[i]; k != row_start_[i + 1]; ++k) {
+			result.values_[k] *= vector[i];
+		}
+	}
+
+	return result;
+
+}
+
+
+void SparseMatrix::multiply(
+	const std::vector<double>& vector,
+	std::vector<double>& result,
+	const int n_threads) const {
+
+	result.resize(n_rows_);
+
+	auto multiply_rows = [&](const int, const int begin, const int end) {
+		for (int i = begin; i < end; ++i) {
+			double sum = 0.0;
+			for (int k = row_start_[i]; k != row_start_[i + 1]; ++k) {
+				sum += values_[k] * vector[columns_[k]];
+			}
+			result[i] = sum;
+		}
+	};
+
+	parallel::for_ranges(n_rows_, n_threads == 0 ? sparse::n_threads(n_rows_) : n_threads, 1, multiply_rows);
+
+}
+
+
+std::vector<double> SparseMatrix::operator*(const std::vector<double>& vector) const {
+
+	std::vector<double> result(n_rows_, 0.0);
+	multiply(vector, result);
+
+	return result;
+
+}
+
+
+SlicedEllpack::SlicedEllpack(
+	const SparseMatrix& matrix,
+	const int chunk,
+	const int sigma) :
+	n_rows_(matrix.n_rows()),
+	n_columns_(matrix.n_columns()),
+	chunk_(chunk),
+	sigma_(sigma) {
+
+	if (chunk_ < 1 || sigma_ < 1) {
+		throw std::invalid_argument("Chunk size and sorting scope should be positive.");
+	}
+
+	const std::vector<int>& row_start = matrix.row_start();
+
+	// Sort rows by length (descending) within each window of sigma rows.
+	permutation_.resize(n_rows_);
+	for (int i = 0; i != n_rows_; ++i) {
+		permutation_[i] = i;
+	}
+
+	auto row_length = [&](const int i) {
+		return row_start[i + 1] - row_start[i];
+	};
+
+	if (sigma_ > 1) {
+		for (int begin = 0; begin < n_rows_; begin += sigma_) {
+			const int end = std::min(begin + sigma_, n_rows_);
+			std::stable_sort(permutation_.begin() + begin, permutation_.begin() + end,
+				[&](const int a, const int b) {
+					return row_length(a) > row_length(b);
+				});
+		}
+	}
+
+	const int n_slices = (n_rows_ + chunk_ - 1) / chunk_;
+
+	slice_start_.resize(n_slices + 1);
+	slice_width_.resize(n_slices);
+
+	slice_start_[0] = 0;
+	for (int s = 0; s != n_slices; ++s) {
+		int width = 0;
+		for (int r = 0; r != chunk_ && s * chunk_ + r < n_rows_; ++r) {
+			width = std::max(width, row_length(permutation_[s * chunk_ + r]));
+		}
+		slice_width_[s] = width;
+		slice_start_[s + 1] = slice_start_[s] + width * chunk_;
+	}
+
+	values_.assign(slice_start_[n_slices], 0.0);
+	columns_.assign(slice_start_[n_slices], 0);
+
+	for (int s = 0; s != n_slices; ++s) {
+		for (int r = 0; r != chunk_; ++r) {
+
+			const int slot = s * chunk_ + r;
+			const int row = slot < n_rows_ ? permutation_[slot] : 0;
+
+			for (int k = 0; k != slice_width_[s]; ++k) {
+
+				const int index = slice_start_[s] + k * chunk_ + r;
+
+				if (slot < n_rows_ && k < row_length(row)) {
+					columns_[index] = matrix.columns()[row_start[row] + k];
+					values_[index] = matrix.values()[row_start[row] + k];
+				}
+				else {
+					columns_[index] = std::min(row, n_columns_ - 1);
+				}
+
+			}
+
+		}
+	}
+
+}
+
+
+void SlicedEllpack::multiply_slices(
+	const int slice_begin,
+	const int slice_end,
+	const std::vector<double>& vector,
+	std::vector<double>& result) const {
+
+	std::vector<double> sum(chunk_, 0.0);
+
+	for (int s = slice_begin; s < slice_end; ++s) {
+
+		std::fill(sum.begin(), sum.end(), 0.0);
+
+		const double* values = values_.data() + slice_start_[s];
+		const int* columns = columns_.data() + slice_start_[s];
+
+		// The chunk rows are independent, i.e. vectorizable.
+		for (int k = 0; k != slice_width_[s]; ++k) {
+			for (int r = 0; r != chunk_; ++r) {
+				sum[r] += values[k * chunk_ + r] * vector[columns[k * chunk_ + r]];
+			}
+		}
+
+		for (int r = 0; r != chunk_ && s * chunk_ + r < n_rows_; ++r) {
+			result[permutation_[s * chunk_ + r]] = sum[r];
+		}
+
+	}
+
+}
+
+
+void SlicedEllpack::multiply(
+	const std::vector<double>& vector,
+	std::vector<double>& result,
+	const int n_threads) const {
+
+	result.resize(n_rows_);
+
+	auto multiply_block = [&](const int, const int begin, const int end) {
+		multiply_slices(begin, end, vector, result);
+	};
+
+	parallel::for_ranges((int)slice_width_.size(), n_threads == 0 ? sparse::n_threads(n_rows_) : n_threads, 1,
+		multiply_block);
+
+}
+
+
+std::vector<double> SlicedEllpack::operator*(const std::vector<double>& vector) const {
+
+	std::vector<double> result(n_rows_, 0.0);
+	multiply(vector, result);
+
+	return result;
+
+}
+
+
+// Number of threads used for matrix with given number of rows.
+int sparse::n_threads(const int n_rows) {
+	return parallel::n_threads(n_rows, sparse::thread_threshold, sparse::rows_per_thread_min);
+}
+
+
+SparseMatrix sparse::identity(const int order) {
+
+	std::vector<int> row_start(order + 1, 0);
+	std::vector<int> columns(order, 0);
+	std::vector<double> values(order, 1.0);
+
+	for (int i = 0; i != order; ++i) {
+		row_start[i + 1] = i + 1;
+		columns[i] = i;
+	}
+
+	return SparseMatrix(order, order, row_start, columns, values);
+
+}
+
+
+// Row (i_a, i_b) of a (x) b, i.e. row i_a * n_rows(b) + i_b, is the outer
+// product of row i_a of a and row i_b of b. Column order is preserved.
+SparseMatrix sparse::kronecker(
+	const SparseMatrix& a,
+	const SparseMatrix& b) {
+
+	const int n_rows = a.n_rows() * b.n_rows();
+	const int n_columns = a.n_columns() * b.n_columns();
+
+	std::vector<int> row_start(1, 0);
+	std::vector<int> columns;
+	std::vector<double> values;
+
+	columns.reserve(a.n_nonzeros() * b.n_nonzeros());
+	values.reserve(a.n_nonzeros() * b.n_nonzeros());
+
+	for (int i_a = 0; i_a != a.n_rows(); ++i_a) {
+		for (int i_b = 0; i_b != b.n_rows(); ++i_b) {
+			for (int k_a = a.row_start()[i_a]; k_a != a.row_start()[i_a + 1]; ++k_a) {
+				for (int k_b = b.row_start()[i_b]; k_b != b.row_start()[i_b + 1]; ++k_b) {
+					columns.push_back(a.columns()[k_a] * b.n_columns() + b.columns()[k_b]);
+					values.push_back(a.values()[k_a] * b.values()[k_b]);
+				}
+			}
+			row_start.push_back((int)values.size());
+		}
+	}
+
+	return SparseMatrix(n_rows, n_columns, row_start, columns, values);
+
+}
+
+
+SparseMatrix sparse::kronecker(const std::vector<SparseMatrix>& factors) {
+
+	if (factors.empty()) {
+		throw std::invalid_argument("No factors.");
+	}
+
+	SparseMatrix result = factors[0];
+	for (int i = 1; i != factors.size(); ++i) {
+		result = kronecker(result, factors[i]);
+	}
+
+	return result;
+
+}
+
+
+SparseMatrix sparse::expand(
+	const std::vector<int>& n_points,
+	const int dimension,
+	const SparseMatrix& matrix) {
+
+	if (dimension < 0 || dimension >= (int)n_points.size()) {
+		throw std::invalid_argument("Unknown dimension.");
+	}
+
+	if (matrix.n_rows() != n_points[dimension]) {
+		throw std::invalid_argument("Matrix order and number of grid points do not match.");
+	}
+
+	std::vector<SparseMatrix> factors;
+	for (int i = 0; i != n_points.size(); ++i) {
+		factors.push_back(i == dimension ? matrix : identity(n_points[i]));
+	}
+
+	return kronecker(factors);
+
+}
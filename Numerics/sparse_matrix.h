@@ -0,0 +1,297 @@
+#pragma once
+
+#include <stdexcept>
+#include <vector>
+
+#include "band_diagonal_matrix.h"
+#include "derivatives.h"
+#include "instrumentation.h"
+#include "workspace.h"
+
+
+// Sparse matrix in compressed sparse row (CSR) format.
+// Rows are stored consecutively: The non-zero elements of row i are
+//	values[k], columns[k], k = row_start[i], ..., row_start[i + 1] - 1,
+// with increasing column index.
+class SparseMatrix {
+
+private:
+
+	int n_rows_;
+	int n_columns_;
+
+	std::vector<int> row_start_;
+	std::vector<int> columns_;
+	std::vector<double> values_;
+
+public:
+
+	// Empty matrix, zero rows.
+	SparseMatrix() : n_rows_(0), n_columns_(0), row_start_(1, 0) {}
+
+	// Zero matrix.
+	SparseMatrix(
+		const int n_rows,
+		const int n_columns);
+
+	SparseMatrix(
+		const int n_rows,
+		const int n_columns,
+		const std::vector<int>& row_start,
+		const std::vector<int>& columns,
+		const std::vector<double>& values);
+
+	// Band-diagonal matrix, including boundary rows (see
+	// matrix_multiply_vector).
+	SparseMatrix(const BandDiagonal& matrix);
+
+	int n_rows() const {
+		return n_rows_;
+	}
+
+	int n_columns() const {
+		return n_columns_;
+	}
+
+	int n_nonzeros() const {
+		return (int)values_.size();
+	}
+
+	const std::vector<int>& row_start() const {
+		return row_start_;
+	}
+
+	const std::vector<int>& columns() const {
+		return columns_;
+	}
+
+	const std::vector<double>& values() const {
+		return values_;
+	}
+
+	SparseMatrix operator*=(const double scalar);
+
+	// Matrix sum, rows are merged.
+	SparseMatrix operator+=(const SparseMatrix& rhs);
+
+	// Multiply each row by corresponding vector element, diag(vector) * matrix.
+	SparseMatrix pre_vector(const std::vector<double>& vector) const;
+
+	// Sparse matrix-vector multiplication, result = matrix * vector.
+	// Rows are split in contiguous blocks evaluated concurrently, see
+	// parallel::for_ranges. n_threads = 0: see sparse::n_threads.
+	void multiply(
+		const std::vector<double>& vector,
+		std::vector<double>& result,
+		const int n_threads = 0) const;
+
+	std::vector<double> operator*(const std::vector<double>& vector) const;
+
+};
+
+
+// Sparse matrix in sliced ELLPACK format, SELL-C-sigma.
+// Rows are sorted by number of non-zero elements within windows of sigma
+// rows and grouped in slices of C (chunk) consecutive rows. Each slice is
+// padded to its longest row and stored column-major, hence the C rows of
+// a slice are processed in lockstep with unit-stride access. Sorting
+// reduces the padding. chunk = n_rows and sigma = 1 corresponds to ELLPACK.
+class SlicedEllpack {
+
+private:
+
+	int n_rows_;
+	int n_columns_;
+	int chunk_;
+	int sigma_;
+
+	// Row of each (sorted) slot.
+	std::vector<int> permutation_;
+
+	// First element and width of each slice.
+	std::vector<int> slice_start_;
+	std::vector<int> slice_width_;
+
+	// Slice s, element k of slot r: index slice_start[s] + k * chunk + r.
+	// Padding elements have value zero and refer to the row itself.
+	std::vector<int> columns_;
+	std::vector<double> values_;
+
+	void multiply_slices(
+		const int slice_begin,
+		const int slice_end,
+		const std::vector<double>& vector,
+		std::vector<double>& result) const;
+
+public:
+
+	SlicedEllpack(
+		const SparseMatrix& matrix,
+		const int chunk = 8,
+		const int sigma = 256);
+
+	int n_rows() const {
+		return n_rows_;
+	}
+
+	int n_columns() const {
+		return n_columns_;
+	}
+
+	// Number of stored elements, including padding.
+	int n_elements() const {
+		return (int)values_.size();
+	}
+
+	// Sparse matrix-vector multiplication, result = matrix * vector.
+	// Slices are evaluated concurrently. n_threads = 0: see sparse::n_threads.
+	void multiply(
+		const std::vector<double>& vector,
+		std::vector<double>& result,
+		const int n_threads = 0) const;
+
+	std::vector<double> operator*(const std::vector<double>& vector) const;
+
+};
+
+
+namespace sparse {
+
+	// Matrices with at least this number of rows are multiplied concurrently.
+	const int thread_threshold = 1 << 14;
+
+	// Minimum number of rows per thread.
+	const int rows_per_thread_min = 1 << 12;
+
+	// Number of threads used for matrix with given number of rows, see
+	// parallel::n_threads.
+	int n_threads(const int n_rows);
+
+	SparseMatrix identity(const int order);
+
+	// Kronecker product, a (x) b.
+	SparseMatrix kronecker(
+		const SparseMatrix& a,
+		const SparseMatrix& b);
+
+	// Kronecker product of N factors, factors[0] (x) ... (x) factors[N - 1].
+	SparseMatrix kronecker(const std::vector<SparseMatrix>& factors);
+
+	// Operator acting along coordinate "dimension" of N-dimensional grid,
+	// I (x) ... (x) matrix (x) ... (x) I, see action_nd.
+	SparseMatrix expand(
+		const std::vector<int>& n_points,
+		const int dimension,
+		const SparseMatrix& matrix);
+
+	// Generator on N-dimensional grid, sum_j D_j + sum_{i < j} D_ij, where
+	// D_j acts along coordinate j and the mixed derivative terms D_ij are
+	// ordered as in d2dxdy_nd. Assume order of func to be (x1, x2, ..., xN).
+	template <class T>
+	SparseMatrix generator(
+		const std::vector<int>& n_points,
+		const std::vector<T>& derivatives,
+		const std::vector<MixedDerivative<T, T>>& mixed) {
+
+		NFS_SCOPE("sparse::generator");
+
+		const int n_dimensions = (int)n_points.size();
+
+		int n_total = 1;
+		for (int n : n_points) {
+			n_total *= n;
+		}
+
+		SparseMatrix result(n_total, n_total);
+
+		for (int j = 0; j != n_dimensions; ++j) {
+			result += expand(n_points, j, SparseMatrix(derivatives[j]));
+		}
+
+		if (mixed.empty()) {
+			return result;
+		}
+
+		if (mixed.size() != n_dimensions * (n_dimensions - 1) / 2) {
+			throw std::invalid_argument("Wrong number of mixed derivative terms.");
+		}
+
+		int index = 0;
+		for (int i = 0; i != n_dimensions; ++i) {
+			for (int j = i + 1; j != n_dimensions; ++j) {
+
+				const KroneckerProduct<T, T>& product = mixed[index].kronecker_product();
+
+				std::vector<SparseMatrix> factors;
+				for (int k = 0; k != n_dimensions; ++k) {
+					if (k == i) {
+						factors.push_back(SparseMatrix(product.first()));
+					}
+					else if (k == j) {
+						factors.push_back(SparseMatrix(product.second()));
+					}
+					else {
+						factors.push_back(identity(n_points[k]));
+					}
+				}
+
+				if (mixed[index].separable()) {
+					result += kronecker(factors);
+				}
+				else if (mixed[index].get_prefactors().size() != n_total) {
+					throw std::invalid_argument("Prefactors should be set on the full grid.");
+				}
+				else {
+					result += kronecker(factors).pre_vector(mixed[index].get_prefactors());
+				}
+
+				++index;
+
+			}
+		}
+
+		return result;
+
+	}
+
+}
+
+
+namespace propagator {
+
+	// Schemes with generator assembled in sparse format, see
+	// sparse::generator.
+	namespace assembled {
+
+		// Explicit Euler scheme, N-dimensional, including mixed derivative
+		// terms, U(t + dt) = (I + dt * F) U(t).
+		// The generator F is a SparseMatrix or a SlicedEllpack, hence a time
+		// step is a single SpMV. Scratch memory is taken from workspace.
+		template <class M>
+		void euler_nd(
+			const double dt,
+			const M& generator,
+			std::vector<double>& func,
+			Workspace& workspace) {
+
+			NFS_SCOPE("propagator::assembled::euler_nd");
+
+			if (generator.n_rows() != func.size() || generator.n_columns() != func.size()) {
+				throw std::invalid_argument("Generator and function have different sizes.");
+			}
+
+			Workspace::Frame frame(workspace);
+
+			std::vector<double>& func_tmp = workspace.vector((int)func.size());
+
+			generator.multiply(func, func_tmp);
+
+			for (int i = 0; i != func.size(); ++i) {
+				func[i] += dt * func_tmp[i];
+			}
+
+		}
+
+	}
+
+}
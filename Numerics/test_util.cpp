@@ -121,7 +121,7 @@ void test_util::print_test_results(
 			<< std::setw(14) << func[i]
 			<< std::setw(14) << deriv[i]
 			<< std::setw(14) << fd_result[i]
-			<< std::setw(14) << abs(deriv[i] - fd_result[i])
+			<< std::setw(14) << std::abs(deriv[i] - fd_result[i])
 			<< std::endl;
 
 	}
@@ -1,10 +1,15 @@
 #pragma once
 
-#include <functional>
+#include <algorithm>
+#include <memory>
 #include <stdexcept>
 #include <vector>
 
+#include "band_diagonal_factorized.h"
+#include "coefficient_cache.h"
+#include "instrumentation.h"
 #include "matrix_equation_solver.h"
+#include "workspace.h"
 
 
 // Setting up finite difference representation of derivative operator on uniform grid.
@@ -29,54 +34,24 @@ T setup(
 
 
 // Setting up finite difference representation of derivative operator on non-uniform grid.
+// The coefficients of the interior rows are cached per grid, see coefficient_cache.
 template <class T>
 T setup(
 	const int order,
-	const std::vector<double> grid,
-	std::function<std::vector<double>(std::vector<double>)> coef,
+	const std::vector<double>& grid,
+	coefficient_cache::Coefficients coef,
 	const int n_boundary_rows,
 	const int n_boundary_elements) {
 
 	T matrix(order, n_boundary_rows, (n_boundary_rows - 1) + n_boundary_elements);
 
-	std::vector<double> coef_tmp;
+	const std::shared_ptr<const coefficient_cache::Diagonals> diagonals = 
+		coefficient_cache::diagonals(coef, grid, matrix.bandwidth());
 
-	for (int i = n_boundary_rows; i != order - n_boundary_rows; ++i) {
-
-		if (std::is_same<T, TriDiagonal>::value) {
-
-			int idx_m1 = i - 1;
-			int idx_p1 = i + 1;
-
-			double dx_m1 = grid[i] - grid[idx_m1];
-			double dx_p1 = grid[idx_p1] - grid[i];
-
-			coef_tmp = coef({ 0.0, dx_m1, dx_p1, 0.0 });
-
-		}
-		else if (std::is_same<T, PentaDiagonal>::value) {
-
-			int idx_m2 = i - 2;
-			int idx_m1 = i - 1;
-			int idx_p1 = i + 1;
-			int idx_p2 = i + 2;
-
-			double dx_m2 = grid[idx_m1] - grid[idx_m2];
-			double dx_m1 = grid[i] - grid[idx_m1];
-			double dx_p1 = grid[idx_p1] - grid[i];
-			double dx_p2 = grid[idx_p2] - grid[idx_p1];
-
-			coef_tmp = coef({ dx_m2, dx_m1, dx_p1, dx_p2 });
-
-		}
-		else {
-			throw std::invalid_argument("Unknown matrix.");
-		}
-
-		for (int j = 0; j != matrix.n_diagonals(); ++j) {
-			matrix.matrix[j][i] = coef_tmp[j];
+	for (int j = 0; j != matrix.n_diagonals(); ++j) {
+		for (int i = n_boundary_rows; i != order - n_boundary_rows; ++i) {
+			matrix.matrix[j][i] = (*diagonals)[j][i];
 		}
-
 	}
 
 	return matrix;
@@ -100,20 +75,22 @@ void boundary(const int row_index, const std::vector<double>& coef, T& matrix) {
 }
 
 
-// Evaulation of differential operator expression, 2-dimensional.
-// Differential operator is wrt. first coordinate ("n_points_1").
-// solve_equation
-//	- true: differential * x = func
-//  - false: x = differential * func
-// Assume order of func to be (x, y).
+// Evaulation of differential operator expression, 2-dimensional, see
+// action_2d below. The result is written to "result", which may alias func,
+// and function strips are taken from workspace. Only the solve path
+// allocates (factorization of the matrix).
 template <class T>
-std::vector<double> action_2d(
+void action_2d(
 	const int n_points_1,
 	const int n_points_2,
 	const int filter,
 	const bool solve_equation,
 	T& derivative,
-	const std::vector<double>& func) {
+	const std::vector<double>& func,
+	std::vector<double>& result,
+	Workspace& workspace) {
+
+	NFS_SCOPE_BYTES("action_2d", 32.0 * func.size());
 
 	int factor_i = 1;
 	int factor_j = 1;
@@ -132,14 +109,20 @@ std::vector<double> action_2d(
 		throw std::invalid_argument("Unknown filter.");
 	}
 
-	std::vector<double> func_strip(n_points_1, 0.0);
+	Workspace::Frame frame(workspace);
 
-	const int n_points = n_points_1 * n_points_2;
+	std::vector<double>& func_strip = workspace.vector(n_points_1);
+	std::vector<double>& strip_tmp = workspace.vector(n_points_1);
 
-	std::vector<double> func_return(n_points, 0.0);
+	result.resize(n_points_1 * n_points_2);
 
 	int index = 0;
 
+	// Boundary rows are eliminated and the matrix is factorized once for
+	// all function strips.
+	const FactorizedBandDiagonal factorized = solve_equation
+		? FactorizedBandDiagonal(derivative) : FactorizedBandDiagonal();
+
 	for (int i = 0; i != n_points_2; ++i) {
 
 		// Function strip along 1st dimension.
@@ -150,20 +133,45 @@ std::vector<double> action_2d(
 
 		// Evaluate differential operator expression.
 		if (solve_equation) {
-			solver::band(derivative, func_strip);
+			factorized.solve(func_strip);
 		}
 		else {
-			func_strip = derivative * func_strip;
+			std::fill(strip_tmp.begin(), strip_tmp.end(), 0.0);
+			matrix_multiply_vector<T>(derivative, func_strip, strip_tmp);
+			func_strip.swap(strip_tmp);
 		}
 
 		// Save result.
 		for (int j = 0; j != n_points_1; ++j) {
 			index = factor_i * i + factor_j * j;
-			func_return[index] = func_strip[j];
+			result[index] = func_strip[j];
 		}
 
 	}
 
+}
+
+
+// Evaulation of differential operator expression, 2-dimensional.
+// Differential operator is wrt. first coordinate ("n_points_1").
+// solve_equation
+//	- true: differential * x = func
+//  - false: x = differential * func
+// Assume order of func to be (x, y).
+template <class T>
+std::vector<double> action_2d(
+	const int n_points_1,
+	const int n_points_2,
+	const int filter,
+	const bool solve_equation,
+	T& derivative,
+	const std::vector<double>& func) {
+
+	std::vector<double> func_return(n_points_1 * n_points_2, 0.0);
+
+	Workspace workspace;
+	action_2d(n_points_1, n_points_2, filter, solve_equation, derivative, func, func_return, workspace);
+
 	return func_return;
 
 }
@@ -186,6 +194,8 @@ std::vector<double> action_2d(
 	std::vector<T>& derivatives,
 	const std::vector<double>& func) {
 
+	NFS_SCOPE_BYTES("action_2d", 32.0 * func.size());
+
 	int factor_i = 1;
 	int factor_j = 1;
 
@@ -215,6 +225,11 @@ std::vector<double> action_2d(
 		+ adi_factors[1] * (prefactors[0] * derivatives[1]
 			+ prefactors[1] * derivatives[2]);
 
+	// Boundary rows are eliminated and the matrix is factorized once for
+	// all function strips.
+	const FactorizedBandDiagonal factorized = solve_equation
+		? FactorizedBandDiagonal(derivative) : FactorizedBandDiagonal();
+
 	for (int i = 0; i != n_points_2; ++i) {
 
 		// Function strip along 1st dimension.
@@ -225,7 +240,7 @@ std::vector<double> action_2d(
 
 		// Evaluate differential operator expression.
 		if (solve_equation) {
-			solver::band(derivative, func_strip);
+			factorized.solve(func_strip);
 		}
 		else {
 			func_strip = derivative * func_strip;
@@ -261,6 +276,8 @@ std::vector<double> action_2d(
 	std::vector<T>& derivatives,
 	const std::vector<double>& func) {
 
+	NFS_SCOPE_BYTES("action_2d", 32.0 * func.size());
+
 	int factor_i = 1;
 	int factor_j = 1;
 
@@ -394,6 +411,8 @@ std::vector<double> action_3d(
 	T& derivative,
 	const std::vector<double>& func) {
 
+	NFS_SCOPE_BYTES("action_3d", 32.0 * func.size());
+
 	int factor_i = 1;
 	int factor_j = 1;
 	int factor_k = 1;
@@ -428,6 +447,11 @@ std::vector<double> action_3d(
 
 	int index = 0;
 
+	// Boundary rows are eliminated and the matrix is factorized once for
+	// all function strips.
+	const FactorizedBandDiagonal factorized = solve_equation
+		? FactorizedBandDiagonal(derivative) : FactorizedBandDiagonal();
+
 	for (int i = 0; i != n_points_2; ++i) {
 
 		for (int j = 0; j != n_points_3; ++j) {
@@ -440,7 +464,7 @@ std::vector<double> action_3d(
 
 			// Evaluate differential operator expression.
 			if (solve_equation) {
-				solver::band(derivative, func_strip);
+				factorized.solve(func_strip);
 			}
 			else {
 				func_strip = derivative * func_strip;
@@ -478,6 +502,8 @@ std::vector<double> action_4d(
 	T& derivative,
 	const std::vector<double>& func) {
 
+	NFS_SCOPE_BYTES("action_4d", 32.0 * func.size());
+
 	int factor_i = 1;
 	int factor_j = 1;
 	int factor_k = 1;
@@ -524,6 +550,11 @@ std::vector<double> action_4d(
 
 	int index = 0;
 
+	// Boundary rows are eliminated and the matrix is factorized once for
+	// all function strips.
+	const FactorizedBandDiagonal factorized = solve_equation
+		? FactorizedBandDiagonal(derivative) : FactorizedBandDiagonal();
+
 	for (int i = 0; i != n_points_2; ++i) {
 
 		for (int j = 0; j != n_points_3; ++j) {
@@ -539,7 +570,7 @@ std::vector<double> action_4d(
 
 				// Evaluate differential operator expression.
 				if (solve_equation) {
-					solver::band(derivative, func_strip);
+					factorized.solve(func_strip);
 				}
 				else {
 					func_strip = derivative * func_strip;
@@ -561,3 +592,81 @@ std::vector<double> action_4d(
 	return func_result;
 
 }
+
+
+// Evaulation of differential operator expression, N-dimensional.
+// Differential operator is wrt. coordinate "dimension" (zero-based).
+// solve_equation
+//	- true: differential * x = func
+//  - false: x = differential * func
+// Assume order of func to be (x1, x2, ..., xN), i.e. the last coordinate
+// has unit stride.
+template <class T>
+std::vector<double> action_nd(
+	const std::vector<int>& n_points,
+	const int dimension,
+	const bool solve_equation,
+	T& derivative,
+	const std::vector<double>& func) {
+
+	NFS_SCOPE_BYTES("action_nd", 32.0 * func.size());
+
+	if (dimension < 0 || dimension >= (int)n_points.size()) {
+		throw std::invalid_argument("Unknown dimension.");
+	}
+
+	// Number of strips before and after the dimension in question.
+	int n_outer = 1;
+	for (int i = 0; i != dimension; ++i) {
+		n_outer *= n_points[i];
+	}
+
+	int stride = 1;
+	for (int i = dimension + 1; i != n_points.size(); ++i) {
+		stride *= n_points[i];
+	}
+
+	const int n_strip = n_points[dimension];
+
+	std::vector<double> func_strip(n_strip, 0.0);
+
+	std::vector<double> func_return(func.size(), 0.0);
+
+	int index = 0;
+
+	// Boundary rows are eliminated and the matrix is factorized once for
+	// all function strips.
+	const FactorizedBandDiagonal factorized = solve_equation
+		? FactorizedBandDiagonal(derivative) : FactorizedBandDiagonal();
+
+	for (int i = 0; i != n_outer; ++i) {
+
+		for (int j = 0; j != stride; ++j) {
+
+			// Function strip along dimension.
+			for (int k = 0; k != n_strip; ++k) {
+				index = (i * n_strip + k) * stride + j;
+				func_strip[k] = func[index];
+			}
+
+			// Evaluate differential operator expression.
+			if (solve_equation) {
+				factorized.solve(func_strip);
+			}
+			else {
+				func_strip = derivative * func_strip;
+			}
+
+			// Save result.
+			for (int k = 0; k != n_strip; ++k) {
+				index = (i * n_strip + k) * stride + j;
+				func_return[index] = func_strip[k];
+			}
+
+		}
+
+	}
+
+	return func_return;
+
+}
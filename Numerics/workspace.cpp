@@ -0,0 +1,37 @@
+#include <stdexcept>
+#include <vector>
+
+#include "instrumentation.h"
+#include "workspace.h"
+
+
+std::vector<double>& Workspace::vector(const int size) {
+
+	if (n_used_ == buffers_.size()) {
+		buffers_.emplace_back();
+	}
+
+	std::vector<double>& buffer = buffers_[n_used_];
+	++n_used_;
+
+	if (buffer.capacity() < size) {
+		++n_allocations_;
+		NFS_COUNT_ALLOCATIONS(1);
+	}
+
+	buffer.assign(size, 0.0);
+
+	return buffer;
+
+}
+
+
+void Workspace::release(const int position) {
+
+	if (position < 0 || position > n_used_) {
+		throw std::invalid_argument("Position outside of workspace.");
+	}
+
+	n_used_ = position;
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+
+
+// Scratch memory for propagation drivers and solvers.
+//
+// Buffers are handed out stack-wise and returned when the enclosing Frame
+// goes out of scope. Their capacity is retained, hence once a time step has
+// been carried out, subsequent steps of the same size do not allocate.
+// A workspace is not thread-safe; use one per pricing thread.
+class Workspace {
+
+private:
+
+	// Deque: References to buffers stay valid as the workspace grows.
+	std::deque<std::vector<double>> buffers_;
+
+	// Number of buffers currently handed out.
+	int n_used_;
+
+	// Number of heap allocations (new buffers or growth of existing ones).
+	int n_allocations_;
+
+public:
+
+	Workspace() : n_used_(0), n_allocations_(0) {}
+
+	// Scope of buffers. Buffers obtained within the frame are returned to
+	// the workspace when the frame is destroyed.
+	class Frame {
+
+	private:
+
+		Workspace& workspace_;
+		int position_;
+
+	public:
+
+		Frame(Workspace& workspace) :
+			workspace_(workspace), position_(workspace.position()) {}
+
+		~Frame() {
+			workspace_.release(position_);
+		}
+
+		Frame(const Frame&) = delete;
+		Frame& operator=(const Frame&) = delete;
+
+	};
+
+	// Zero-initialized buffer of given size, valid until released.
+	std::vector<double>& vector(const int size);
+
+	// Number of buffers currently handed out.
+	int position() const {
+		return n_used_;
+	}
+
+	// Return all buffers obtained after position.
+	void release(const int position);
+
+	// Return all buffers.
+	void reset() {
+		release(0);
+	}
+
+	int n_buffers() const {
+		return (int)buffers_.size();
+	}
+
+	int n_allocations() const {
+		return n_allocations_;
+	}
+
+};
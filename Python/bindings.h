@@ -0,0 +1,136 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+namespace py = pybind11;
+
+// C-contiguous array of doubles. Arguments of other dtype or layout are
+// converted (copied) by pybind11.
+typedef py::array_t<double, py::array::c_style | py::array::forcecast> Array;
+
+// Read-only view of the data of an array, flattened. Reading does not
+// require the GIL, but the array must outlive the view.
+struct ArrayView {
+
+    const double* data;
+    py::ssize_t size;
+
+    const double* begin() const {
+        return data;
+    }
+
+    const double* end() const {
+        return data + size;
+    }
+
+    double operator[](const py::ssize_t i) const {
+        return data[i];
+    }
+
+};
+
+// View of array without copy. Used for inputs that are only read, e.g.
+// parameters of batched pricers.
+inline ArrayView to_view(const Array& array) {
+    return { array.data(), array.size() };
+}
+
+inline ArrayView to_view(const std::vector<double>& vector) {
+    return { vector.data(), (py::ssize_t)vector.size() };
+}
+
+// Copy of array, flattened. Only used where the C++ interface takes a
+// std::vector (grids, operators), where the data is modified (initial
+// values propagated in place and returned), or where the data must outlive
+// the call (asynchronous tasks).
+inline std::vector<double> to_vector(const Array& array) {
+    return std::vector<double>(array.data(), array.data() + array.size());
+}
+
+// Array taking ownership of vector. The vector is moved into a capsule that
+// is released together with the array, hence the data is not copied. The
+// GIL must be held.
+inline py::array_t<double> to_array(
+    std::vector<double>&& vector,
+    const std::vector<py::ssize_t>& shape) {
+
+    std::vector<double>* storage = new std::vector<double>(std::move(vector));
+    py::capsule owner(storage, [](void* p) {
+        delete reinterpret_cast<std::vector<double>*>(p);
+    });
+
+    return py::array_t<double>(shape, storage->data(), owner);
+
+}
+
+inline py::array_t<double> to_array(std::vector<double>&& vector) {
+    const py::ssize_t size = (py::ssize_t)vector.size();
+    return to_array(std::move(vector), { size });
+}
+
+// Writable view of vector owned by the Python object "base". The array keeps
+// base alive; the view is invalidated if the vector is resized.
+inline py::array_t<double> view(std::vector<double>& vector, py::handle base) {
+    return py::array_t<double>((py::ssize_t)vector.size(), vector.data(), base);
+}
+
+// Pricing jobs on C++ data, see models.cpp. They do not access Python
+// objects and are run without the GIL, synchronously or as tasks.
+namespace pricing {
+
+    // Payoff of European option, option "call" or "put".
+    std::function<double(double)> payoff(const std::string& option, const double strike);
+
+    // Black-Scholes PDE for each (rate[i], sigma[i], strike[i]) on common
+    // grids, order (problem, grid point).
+    std::vector<double> bs_pde_batch(
+        const std::vector<double>& time_grid,
+        const std::vector<double>& spatial_grid,
+        const ArrayView rate,
+        const ArrayView sigma,
+        const ArrayView strike,
+        const std::string& option,
+        const double theta,
+        const int width);
+
+    // Heston closed form prices of (strike[i], tau[i]) pairs.
+    std::vector<double> heston_strip(
+        const double price,
+        const double variance,
+        const double rate,
+        const double lambda,
+        const double theta,
+        const double eta,
+        const double rho,
+        const ArrayView strike,
+        const ArrayView tau,
+        const std::string& option);
+
+    // Heston PDE solution on grid (S, v), order (S, v).
+    std::vector<double> heston_pde(
+        const std::vector<double>& time_grid,
+        const std::vector<double>& grid_s,
+        const std::vector<double>& grid_v,
+        const double rate,
+        const double lambda,
+        const double theta,
+        const double eta,
+        const double rho,
+        const double strike,
+        const std::string& option,
+        const std::string& scheme);
+
+}
+
+// Submodules of nfs, see numerics.cpp, models.cpp and tasks.cpp.
+void bind_grid(py::module_& m);
+void bind_operators(py::module_& m);
+void bind_propagation(py::module_& m);
+void bind_models(py::module_& m);
+void bind_tasks(py::module_& m);
@@ -0,0 +1,344 @@
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pybind11/stl.h>
+
+#include "BlackScholesUtility.h"
+#include "HestonUtility.h"
+#include "SabrUtility.h"
+#include "VasicekUtility.h"
+#include "derivatives.h"
+
+#include "bindings.h"
+
+
+namespace {
+
+    // Constant rate overloads; the pricers are overloaded for zero curves.
+    typedef double (*BsPricer)(double, double, double, double, double);
+    typedef double (*HestonPricer)(double, double, double, double, double, double, double, double, double);
+
+    void bind_bs(py::module_& m) {
+
+        py::module_ bs_ = m.def_submodule("bs", R"pbdoc(Black-Scholes model. Functions broadcast over array arguments.)pbdoc");
+
+        py::module_ call = bs_.def_submodule("call", R"pbdoc(European call option.)pbdoc");
+        call.def("price", py::vectorize(static_cast<BsPricer>(bs::call::price)),
+            py::arg("spot_price"), py::arg("rate"), py::arg("sigma"), py::arg("strike"), py::arg("tau"));
+        call.def("delta", py::vectorize(bs::call::delta),
+            py::arg("spot_price"), py::arg("rate"), py::arg("sigma"), py::arg("strike"), py::arg("tau"));
+        call.def("gamma", py::vectorize(bs::call::gamma),
+            py::arg("spot_price"), py::arg("rate"), py::arg("sigma"), py::arg("strike"), py::arg("tau"));
+        call.def("vega", py::vectorize(bs::call::vega),
+            py::arg("spot_price"), py::arg("rate"), py::arg("sigma"), py::arg("strike"), py::arg("tau"));
+        call.def("theta", py::vectorize(bs::call::theta),
+            py::arg("spot_price"), py::arg("rate"), py::arg("sigma"), py::arg("strike"), py::arg("tau"));
+        call.def("rho", py::vectorize(bs::call::rho),
+            py::arg("spot_price"), py::arg("rate"), py::arg("sigma"), py::arg("strike"), py::arg("tau"));
+        call.def("implied_vol", py::vectorize(bs::call::implied_vol),
+            py::arg("option_price"), py::arg("spot_price"), py::arg("rate"), py::arg("strike"), py::arg("tau"));
+
+        py::module_ put = bs_.def_submodule("put", R"pbdoc(European put option.)pbdoc");
+        put.def("price", py::vectorize(static_cast<BsPricer>(bs::put::price)),
+            py::arg("spot_price"), py::arg("rate"), py::arg("sigma"), py::arg("strike"), py::arg("tau"));
+        put.def("delta", py::vectorize(bs::put::delta),
+            py::arg("spot_price"), py::arg("rate"), py::arg("sigma"), py::arg("strike"), py::arg("tau"));
+        put.def("gamma", py::vectorize(bs::put::gamma),
+            py::arg("spot_price"), py::arg("rate"), py::arg("sigma"), py::arg("strike"), py::arg("tau"));
+        put.def("vega", py::vectorize(bs::put::vega),
+            py::arg("spot_price"), py::arg("rate"), py::arg("sigma"), py::arg("strike"), py::arg("tau"));
+        put.def("theta", py::vectorize(bs::put::theta),
+            py::arg("spot_price"), py::arg("rate"), py::arg("sigma"), py::arg("strike"), py::arg("tau"));
+        put.def("rho", py::vectorize(bs::put::rho),
+            py::arg("spot_price"), py::arg("rate"), py::arg("sigma"), py::arg("strike"), py::arg("tau"));
+        put.def("implied_vol", py::vectorize(bs::put::implied_vol),
+            py::arg("option_price"), py::arg("spot_price"), py::arg("rate"), py::arg("strike"), py::arg("tau"));
+
+        py::module_ pde = bs_.def_submodule("pde", R"pbdoc(Black-Scholes PDE.)pbdoc");
+
+        pde.def("batch", [](
+            const Array& time_grid,
+            const Array& spatial_grid,
+            const Array& rate,
+            const Array& sigma,
+            const Array& strike,
+            const std::string& option,
+            const double theta,
+            const int width) {
+
+                const std::vector<double> time_grid_ = to_vector(time_grid);
+                const std::vector<double> spatial_grid_ = to_vector(spatial_grid);
+
+                const py::ssize_t n_problems = strike.size();
+                const py::ssize_t n_points = spatial_grid.size();
+
+                std::vector<double> result;
+                {
+                    py::gil_scoped_release release;
+                    result = pricing::bs_pde_batch(
+                        time_grid_, spatial_grid_, to_view(rate), to_view(sigma), to_view(strike),
+                        option, theta, width);
+                }
+                return to_array(std::move(result), { n_problems, n_points });
+
+            }, py::arg("time_grid"), py::arg("spatial_grid"), py::arg("rate"), py::arg("sigma"),
+            py::arg("strike"), py::arg("option") = "call", py::arg("theta") = 0.5, py::arg("width") = 8,
+            R"pbdoc(Batch of PDE solutions on a common grid, shape (n_problems, n_points). The GIL is released.)pbdoc");
+
+    }
+
+    void bind_heston(py::module_& m) {
+
+        py::module_ heston_ = m.def_submodule("heston", R"pbdoc(Heston model.)pbdoc");
+
+        heston_.def("call", py::vectorize(static_cast<HestonPricer>(heston::call)),
+            py::arg("price"), py::arg("variance"), py::arg("rate"), py::arg("lambda_"),
+            py::arg("theta"), py::arg("eta"), py::arg("rho"), py::arg("strike"), py::arg("tau"),
+            R"pbdoc(Closed form call price. Broadcasts over array arguments.)pbdoc");
+        heston_.def("put", py::vectorize(static_cast<HestonPricer>(heston::put)),
+            py::arg("price"), py::arg("variance"), py::arg("rate"), py::arg("lambda_"),
+            py::arg("theta"), py::arg("eta"), py::arg("rho"), py::arg("strike"), py::arg("tau"),
+            R"pbdoc(Closed form put price. Broadcasts over array arguments.)pbdoc");
+
+        heston_.def("strip", [](
+            const double price,
+            const double variance,
+            const double rate,
+            const double lambda,
+            const double theta,
+            const double eta,
+            const double rho,
+            const Array& strike,
+            const Array& tau,
+            const std::string& option) {
+
+                std::vector<double> result;
+                {
+                    py::gil_scoped_release release;
+                    result = pricing::heston_strip(price, variance, rate, lambda, theta, eta, rho,
+                        to_view(strike), to_view(tau), option);
+                }
+                return to_array(std::move(result));
+
+            }, py::arg("price"), py::arg("variance"), py::arg("rate"), py::arg("lambda_"),
+            py::arg("theta"), py::arg("eta"), py::arg("rho"), py::arg("strike"), py::arg("tau"),
+            py::arg("option") = "call",
+            R"pbdoc(Closed form prices of (strike[i], tau[i]) pairs. The GIL is released.)pbdoc");
+
+        py::module_ pde = heston_.def_submodule("pde", R"pbdoc(Heston PDE.)pbdoc");
+
+        pde.def("grid", [](
+            const double s_max,
+            const int n_points_s,
+            const double strike,
+            const double v_max,
+            const int n_points_v,
+            const double variance,
+            const double scaling_s,
+            const double scaling_v) {
+
+                std::vector<std::vector<double>> grid = heston::pde::generator::grid(
+                    s_max, n_points_s, strike, v_max, n_points_v, variance, scaling_s, scaling_v);
+
+                return py::make_tuple(to_array(std::move(grid[0])), to_array(std::move(grid[1])));
+
+            }, py::arg("s_max"), py::arg("n_points_s"), py::arg("strike"), py::arg("v_max"),
+            py::arg("n_points_v"), py::arg("variance"), py::arg("scaling_s") = 0.1,
+            py::arg("scaling_v") = 0.1, R"pbdoc(Spatial grids (S, v).)pbdoc");
+
+        pde.def("solve", [](
+            const Array& time_grid,
+            const Array& grid_s,
+            const Array& grid_v,
+            const double rate,
+            const double lambda,
+            const double theta,
+            const double eta,
+            const double rho,
+            const double strike,
+            const std::string& option,
+            const std::string& scheme) {
+
+                const std::vector<double> time_grid_ = to_vector(time_grid);
+                const std::vector<double> grid_s_ = to_vector(grid_s);
+                const std::vector<double> grid_v_ = to_vector(grid_v);
+
+                std::vector<double> result;
+                {
+                    py::gil_scoped_release release;
+                    result = pricing::heston_pde(time_grid_, grid_s_, grid_v_,
+                        rate, lambda, theta, eta, rho, strike, option, scheme);
+                }
+                return to_array(std::move(result), { grid_s.size(), grid_v.size() });
+
+            }, py::arg("time_grid"), py::arg("grid_s"), py::arg("grid_v"), py::arg("rate"),
+            py::arg("lambda_"), py::arg("theta"), py::arg("eta"), py::arg("rho"), py::arg("strike"),
+            py::arg("option") = "call", py::arg("scheme") = "HV",
+            R"pbdoc(Solution on grid (S, v) at the end of time grid, shape (n_points_s, n_points_v). The GIL is released.)pbdoc");
+
+        pde.def("interpolate", [](
+            const Array& grid_s,
+            const Array& grid_v,
+            const Array& func,
+            const double price,
+            const double variance) {
+
+                const std::vector<std::vector<double>> spatial_grid{ to_vector(grid_s), to_vector(grid_v) };
+                return heston::pde::interpolate(spatial_grid, to_vector(func), price, variance);
+
+            }, py::arg("grid_s"), py::arg("grid_v"), py::arg("func"), py::arg("price"), py::arg("variance"),
+            R"pbdoc(Bilinear interpolation of solution on grid (S, v).)pbdoc");
+
+    }
+
+    void bind_sabr(py::module_& m) {
+
+        py::module_ sabr_ = m.def_submodule("sabr", R"pbdoc(SABR model. Functions broadcast over array arguments.)pbdoc");
+
+        py::module_ implied_vol = sabr_.def_submodule("implied_vol", R"pbdoc(Implied volatility approximations.)pbdoc");
+        implied_vol.def("black_scholes", py::vectorize(sabr::implied_vol::black_scholes),
+            py::arg("spot_forward"), py::arg("spot_vol"), py::arg("alpha"), py::arg("beta"),
+            py::arg("rho"), py::arg("strike"), py::arg("tau"));
+        implied_vol.def("bachelier", py::vectorize(sabr::implied_vol::bachelier),
+            py::arg("spot_forward"), py::arg("spot_vol"), py::arg("alpha"), py::arg("beta"),
+            py::arg("rho"), py::arg("strike"), py::arg("tau"));
+
+        py::module_ call = sabr_.def_submodule("call", R"pbdoc(European call option.)pbdoc");
+        call.def("price", py::vectorize(sabr::call::price),
+            py::arg("spot_forward"), py::arg("spot_vol"), py::arg("alpha"), py::arg("beta"),
+            py::arg("rho"), py::arg("rate"), py::arg("strike"), py::arg("tau"));
+
+    }
+
+    void bind_vasicek(py::module_& m) {
+
+        py::module_ vasicek_ = m.def_submodule("vasicek",
+            R"pbdoc(Vasicek model, coefficients of affine zero-coupon bond price. Functions broadcast over array arguments.)pbdoc");
+
+        vasicek_.def("a_func", py::vectorize(vasicek::a_func),
+            py::arg("time_1"), py::arg("time_2"), py::arg("kappa"), py::arg("theta"), py::arg("sigma"));
+        vasicek_.def("dadt_func", py::vectorize(vasicek::dadt_func),
+            py::arg("time_1"), py::arg("time_2"), py::arg("kappa"), py::arg("theta"), py::arg("sigma"));
+        vasicek_.def("b_func", py::vectorize(vasicek::b_func),
+            py::arg("time_1"), py::arg("time_2"), py::arg("kappa"));
+        vasicek_.def("dbdt_func", py::vectorize(vasicek::dbdt_func),
+            py::arg("time_1"), py::arg("time_2"), py::arg("kappa"));
+
+    }
+
+}
+
+
+std::function<double(double)> pricing::payoff(const std::string& option, const double strike) {
+
+    if (option == "call") {
+        return [strike](double spot) { return std::max(spot - strike, 0.0); };
+    }
+    else if (option == "put") {
+        return [strike](double spot) { return std::max(strike - spot, 0.0); };
+    }
+    else {
+        throw std::invalid_argument("Option type should be \"call\" or \"put\".");
+    }
+
+}
+
+
+std::vector<double> pricing::bs_pde_batch(
+    const std::vector<double>& time_grid,
+    const std::vector<double>& spatial_grid,
+    const ArrayView rate,
+    const ArrayView sigma,
+    const ArrayView strike,
+    const std::string& option,
+    const double theta,
+    const int width) {
+
+    const int n_problems = (int)strike.size;
+    if (rate.size != n_problems || sigma.size != n_problems) {
+        throw std::invalid_argument("rate, sigma and strike should have equal size.");
+    }
+
+    std::vector<bs::pde::Parameters> parameters;
+    for (int i = 0; i != n_problems; ++i) {
+        parameters.push_back({ rate[i], sigma[i], payoff(option, strike[i]) });
+    }
+
+    const std::vector<std::function<TriDiagonal(std::vector<double>)>>
+        deriv{ d1dx1::nonuniform::c2b2, d2dx2::nonuniform::c2b1 };
+
+    std::vector<std::vector<double>> func =
+        bs::pde::batch<TriDiagonal>(time_grid, spatial_grid, parameters, deriv, theta, width);
+
+    const int n_points = (int)spatial_grid.size();
+    std::vector<double> result(n_problems * n_points);
+    for (int i = 0; i != n_problems; ++i) {
+        std::copy(func[i].begin(), func[i].end(), result.begin() + i * n_points);
+    }
+
+    return result;
+
+}
+
+
+std::vector<double> pricing::heston_strip(
+    const double price,
+    const double variance,
+    const double rate,
+    const double lambda,
+    const double theta,
+    const double eta,
+    const double rho,
+    const ArrayView strike,
+    const ArrayView tau,
+    const std::string& option) {
+
+    if (strike.size != tau.size) {
+        throw std::invalid_argument("strike and tau should have equal size.");
+    }
+    if (option != "call" && option != "put") {
+        throw std::invalid_argument("Option type should be \"call\" or \"put\".");
+    }
+
+    std::vector<double> result(strike.size);
+    for (int i = 0; i != strike.size; ++i) {
+        result[i] = option == "call"
+            ? heston::call(price, variance, rate, lambda, theta, eta, rho, strike[i], tau[i])
+            : heston::put(price, variance, rate, lambda, theta, eta, rho, strike[i], tau[i]);
+    }
+
+    return result;
+
+}
+
+
+std::vector<double> pricing::heston_pde(
+    const std::vector<double>& time_grid,
+    const std::vector<double>& grid_s,
+    const std::vector<double>& grid_v,
+    const double rate,
+    const double lambda,
+    const double theta,
+    const double eta,
+    const double rho,
+    const double strike,
+    const std::string& option,
+    const std::string& scheme) {
+
+    return heston::pde::solve(time_grid, { grid_s, grid_v },
+        rate, lambda, theta, eta, rho, payoff(option, strike), scheme);
+
+}
+
+
+void bind_models(py::module_& m) {
+
+    bind_bs(m);
+    bind_heston(m);
+    bind_sabr(m);
+    bind_vasicek(m);
+
+}
@@ -1,7 +1,12 @@
-#include <pybind11/pybind11.h>
-#include <Windows.h>
 #include <cmath>
 
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "instrumentation.h"
+
+#include "bindings.h"
+
 const double e = 2.7182818284590452353602874713527;
 
 double sinh_impl(double x) {
@@ -17,11 +22,39 @@ double tanh_impl(double x) {
 }
 
 
-namespace py = pybind11;
-
 PYBIND11_MODULE(nfs, m) {
     m.def("fast_tanh2", &tanh_impl, R"pbdoc(Compute a hyperbolic tangent of a single argument expressed in radians.)pbdoc");
 
+    bind_grid(m);
+    bind_operators(m);
+    bind_propagation(m);
+    bind_models(m);
+    bind_tasks(m);
+
+    py::module_ instr = m.def_submodule("instrumentation",
+        R"pbdoc(Phase timers and counters of propagators, sweeps, solvers and operator assembly.)pbdoc");
+
+    instr.def("report", []() {
+        py::list result;
+        for (const instrumentation::PhaseStatistics& s : instrumentation::report()) {
+            py::dict phase;
+            phase["name"] = s.name;
+            phase["n_calls"] = s.n_calls;
+            phase["wall_time"] = s.wall_time;
+            phase["self_time"] = s.self_time;
+            phase["bytes"] = s.bytes;
+            phase["n_allocations"] = s.n_allocations;
+            result.append(phase);
+        }
+        return result;
+    }, R"pbdoc(Statistics of each phase as list of dicts; times in seconds.)pbdoc");
+    instr.def("summary", &instrumentation::summary, R"pbdoc(Report as text table, sorted by self time.)pbdoc");
+    instr.def("reset", &instrumentation::reset, R"pbdoc(Clear statistics and trace events.)pbdoc");
+    instr.def("set_tracing", &instrumentation::set_tracing, py::arg("enable"),
+        R"pbdoc(Record Chrome trace events.)pbdoc");
+    instr.def("write_chrome_trace", &instrumentation::write_chrome_trace, py::arg("file_name"),
+        R"pbdoc(Write recorded trace events in Chrome trace event format.)pbdoc");
+
 #ifdef VERSION_INFO
     m.attr("__version__") = VERSION_INFO;
 #else
@@ -0,0 +1,443 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <pybind11/stl.h>
+
+#include "band_diagonal_matrix.h"
+#include "derivatives.h"
+#include "grid.h"
+#include "matrix_equation_solver.h"
+#include "propagation.h"
+#include "utility.h"
+
+#include "bindings.h"
+
+
+namespace {
+
+    // Check that array matches order of matrix.
+    void check_order(const BandDiagonal& matrix, const Array& vector) {
+        if (vector.size() != matrix.order()) {
+            throw std::invalid_argument("Size of array does not match order of matrix.");
+        }
+    }
+
+    // Operators shared by TriDiagonal and PentaDiagonal.
+    template <class T>
+    void bind_band(py::module_& m, const char* name, const char* doc) {
+
+        py::class_<T, BandDiagonal>(m, name, doc)
+            .def("__mul__", [](T& self, const Array& vector) {
+                check_order(self, vector);
+                return to_array(self * to_vector(vector));
+            }, py::is_operator(), R"pbdoc(Matrix-vector product.)pbdoc")
+            .def("__mul__", [](T& self, const double scalar) {
+                return self * scalar;
+            }, py::is_operator())
+            .def("__rmul__", [](T& self, const double scalar) {
+                return self * scalar;
+            }, py::is_operator())
+            .def("__add__", [](T& self, const T& rhs) {
+                return self + rhs;
+            }, py::is_operator())
+            .def("__sub__", [](T& self, const T& rhs) {
+                return self - rhs;
+            }, py::is_operator())
+            .def("identity", &T::identity,
+                R"pbdoc(Identity operator with the same structure.)pbdoc")
+            .def("pre_vector", [](T& self, const Array& vector) {
+                check_order(self, vector);
+                return self.pre_vector(to_vector(vector));
+            }, py::arg("vector"), R"pbdoc(Row i multiplied by vector[i].)pbdoc")
+            .def("solve", [](const T& self, const Array& column) {
+                check_order(self, column);
+                T matrix = self;
+                std::vector<double> result = to_vector(column);
+                {
+                    py::gil_scoped_release release;
+                    solver::band(matrix, result);
+                }
+                return to_array(std::move(result));
+            }, py::arg("column"), R"pbdoc(Solution x of matrix * x = column.)pbdoc");
+
+    }
+
+    // Derivative operator on grid given as array.
+    template <class T>
+    void def_derivative(
+        py::module_& m,
+        const char* name,
+        T (*func)(const std::vector<double>&),
+        const char* doc) {
+
+        m.def(name, [func](const Array& grid) {
+            return func(to_vector(grid));
+        }, py::arg("grid"), doc);
+
+    }
+
+    // 1-dimensional action, see action_2d.
+    template <class T>
+    void def_action_2d(py::module_& m) {
+
+        m.def("action_2d", [](
+            const int n_points_1,
+            const int n_points_2,
+            const int filter,
+            const bool solve_equation,
+            T derivative,
+            const Array& func) {
+
+                if (func.size() != n_points_1 * n_points_2) {
+                    throw std::invalid_argument("Size of func does not match grid.");
+                }
+
+                std::vector<double> result = to_vector(func);
+                {
+                    py::gil_scoped_release release;
+                    Workspace workspace;
+                    action_2d(n_points_1, n_points_2, filter, solve_equation, derivative,
+                        result, result, workspace);
+                }
+                return to_array(std::move(result));
+
+            }, py::arg("n_points_1"), py::arg("n_points_2"), py::arg("filter"),
+            py::arg("solve_equation"), py::arg("derivative"), py::arg("func"),
+            R"pbdoc(Apply (or solve) derivative along dimension "filter" of 2-dimensional func, order (x, y).)pbdoc");
+
+    }
+
+    // Shape of array.
+    std::vector<py::ssize_t> shape(const Array& array) {
+        return std::vector<py::ssize_t>(array.shape(), array.shape() + array.ndim());
+    }
+
+    template <class T>
+    void def_theta_1d(py::module_& m) {
+
+        m.def("theta_1d", [](
+            const Array& time_grid,
+            T derivative,
+            const Array& func,
+            const double theta) {
+
+                check_order(derivative, func);
+
+                const std::vector<double> time_grid_ = to_vector(time_grid);
+                std::vector<double> result = to_vector(func);
+                {
+                    py::gil_scoped_release release;
+                    propagation::theta_1d::full(time_grid_, derivative, result, theta);
+                }
+                return to_array(std::move(result));
+
+            }, py::arg("time_grid"), py::arg("derivative"), py::arg("func"),
+            py::arg("theta") = 0.5,
+            R"pbdoc(Theta scheme on time grid, returns func at the end of the time grid.)pbdoc");
+
+    }
+
+    // Batched theta scheme, tri-diagonal operators only (see
+    // propagation::batch::theta_1d).
+    void def_theta_1d_batch(py::module_& m) {
+
+        m.def("theta_1d_batch", [](
+            const Array& time_grid,
+            std::vector<TriDiagonal> derivatives,
+            const Array& func,
+            const double theta,
+            const int width) {
+
+                const int n_problems = (int)derivatives.size();
+                if (n_problems == 0 || func.ndim() != 2 || func.shape(0) != n_problems
+                    || func.shape(1) != derivatives[0].order()) {
+                    throw std::invalid_argument("func should have shape (n_problems, order).");
+                }
+
+                const std::vector<double> time_grid_ = to_vector(time_grid);
+                const int n_points = (int)func.shape(1);
+
+                std::vector<std::vector<double>> func_(n_problems);
+                for (int i = 0; i != n_problems; ++i) {
+                    func_[i].assign(func.data(i, 0), func.data(i, 0) + n_points);
+                }
+
+                std::vector<double> result(func.size());
+                {
+                    py::gil_scoped_release release;
+                    propagation::batch::theta_1d(time_grid_, derivatives, func_, theta, width);
+                    for (int i = 0; i != n_problems; ++i) {
+                        std::copy(func_[i].begin(), func_[i].end(), result.begin() + i * n_points);
+                    }
+                }
+                return to_array(std::move(result), shape(func));
+
+            }, py::arg("time_grid"), py::arg("derivatives"), py::arg("func"),
+            py::arg("theta") = 0.5, py::arg("width") = 8,
+            R"pbdoc(Theta scheme for a batch of problems, func of shape (n_problems, order).)pbdoc");
+
+    }
+
+    // Check that func matches 2-dimensional grid of operators.
+    void check_order_2d(
+        const BandDiagonal& derivative_1,
+        const BandDiagonal& derivative_2,
+        const Array& func) {
+        if (func.size() != derivative_1.order() * derivative_2.order()) {
+            throw std::invalid_argument("Size of func does not match order of operators.");
+        }
+    }
+
+}
+
+
+void bind_grid(py::module_& m) {
+
+    py::module_ g = m.def_submodule("grid", R"pbdoc(1-dimensional grids.)pbdoc");
+
+    g.def("uniform", [](const double x_min, const double x_max, const int n_points) {
+        return to_array(grid::uniform(x_min, x_max, n_points));
+    }, py::arg("x_min"), py::arg("x_max"), py::arg("n_points"));
+
+    g.def("exponential_full", [](
+        const double x_min, const double x_max, const int n_points, const double scaling) {
+            return to_array(grid::exponential_full(x_min, x_max, n_points, scaling));
+        }, py::arg("x_min"), py::arg("x_max"), py::arg("n_points"), py::arg("scaling") = 2.0);
+
+    g.def("exponential", [](const double x_min, const double x_max, const int n_points) {
+        return to_array(grid::exponential(x_min, x_max, n_points));
+    }, py::arg("x_min"), py::arg("x_max"), py::arg("n_points"));
+
+    g.def("hyperbolic_full", [](
+        const double x_min, const double x_max, const int n_points,
+        const double x_center, const double scaling) {
+            return to_array(grid::hyperbolic_full(x_min, x_max, n_points, x_center, scaling));
+        }, py::arg("x_min"), py::arg("x_max"), py::arg("n_points"),
+        py::arg("x_center") = 0.0, py::arg("scaling") = 0.1,
+        R"pbdoc(Grid points concentrated around x_center.)pbdoc");
+
+    g.def("hyperbolic", [](const double x_min, const double x_max, const int n_points) {
+        return to_array(grid::hyperbolic(x_min, x_max, n_points));
+    }, py::arg("x_min"), py::arg("x_max"), py::arg("n_points"));
+
+    g.def("coarsen", [](const Array& grid) {
+        return to_array(grid::coarsen(to_vector(grid)));
+    }, py::arg("grid"), R"pbdoc(Remove every second grid point.)pbdoc");
+
+    py::class_<grid::Builder>(g, "Builder",
+        R"pbdoc(Grid concentrated around several points, with aligned grid points.)pbdoc")
+        .def(py::init<double, double, double>(),
+            py::arg("x_min"), py::arg("x_max"), py::arg("uniform_weight") = 0.0)
+        .def("concentrate", &grid::Builder::concentrate,
+            py::arg("x_center"), py::arg("scaling") = 0.1, py::arg("weight") = 1.0,
+            py::return_value_policy::reference_internal)
+        .def("align", &grid::Builder::align, py::arg("x"),
+            py::return_value_policy::reference_internal)
+        .def("build", [](const grid::Builder& self, const int n_points) {
+            return to_array(self.build(n_points));
+        }, py::arg("n_points"))
+        .def("hierarchy", [](const grid::Builder& self, const int n_points, const int n_levels) {
+            py::list result;
+            for (std::vector<double>& level : self.hierarchy(n_points, n_levels)) {
+                result.append(to_array(std::move(level)));
+            }
+            return result;
+        }, py::arg("n_points"), py::arg("n_levels"),
+            R"pbdoc(Nested grids, coarsest first.)pbdoc");
+
+}
+
+
+void bind_operators(py::module_& m) {
+
+    py::class_<BandDiagonal>(m, "BandDiagonal",
+        R"pbdoc(Band-diagonal matrix in compact form.)pbdoc")
+        .def_property_readonly("order", &BandDiagonal::order)
+        .def_property_readonly("bandwidth", &BandDiagonal::bandwidth)
+        .def_property_readonly("n_diagonals", &BandDiagonal::n_diagonals)
+        .def_property_readonly("n_boundary_rows", &BandDiagonal::n_boundary_rows)
+        .def_property_readonly("n_boundary_elements", &BandDiagonal::n_boundary_elements)
+        .def_property_readonly("diagonals", [](py::object self) {
+            py::list result;
+            for (std::vector<double>& diagonal : self.cast<BandDiagonal&>().matrix) {
+                result.append(view(diagonal, self));
+            }
+            return result;
+        }, R"pbdoc(Writable views of diagonals, lowest sub-diagonal first. Element i of each diagonal belongs to row i.)pbdoc")
+        .def_property_readonly("boundary_rows", [](py::object self) {
+            py::list result;
+            for (std::vector<double>& row : self.cast<BandDiagonal&>().boundary_rows) {
+                result.append(view(row, self));
+            }
+            return result;
+        }, R"pbdoc(Writable views of boundary rows, lower boundary first.)pbdoc");
+
+    bind_band<TriDiagonal>(m, "TriDiagonal", R"pbdoc(Tri-diagonal matrix.)pbdoc");
+    bind_band<PentaDiagonal>(m, "PentaDiagonal", R"pbdoc(Penta-diagonal matrix.)pbdoc");
+
+    py::module_ d1 = m.def_submodule("d1dx1", R"pbdoc(First order derivative operators.)pbdoc");
+    py::module_ d1_u = d1.def_submodule("uniform");
+    def_derivative(d1_u, "c2b1", d1dx1::uniform::c2b1, R"pbdoc(2nd order central difference, 1st order boundary.)pbdoc");
+    def_derivative(d1_u, "c2b2", d1dx1::uniform::c2b2, R"pbdoc(2nd order central difference, 2nd order boundary.)pbdoc");
+    def_derivative(d1_u, "c4b2", d1dx1::uniform::c4b2, R"pbdoc(4th order central difference, 2nd order boundary.)pbdoc");
+    def_derivative(d1_u, "c4b4", d1dx1::uniform::c4b4, R"pbdoc(4th order central difference, 4th order boundary.)pbdoc");
+    py::module_ d1_n = d1.def_submodule("nonuniform");
+    def_derivative(d1_n, "c2b1", d1dx1::nonuniform::c2b1, R"pbdoc(2nd order central difference, 1st order boundary.)pbdoc");
+    def_derivative(d1_n, "c2b2", d1dx1::nonuniform::c2b2, R"pbdoc(2nd order central difference, 2nd order boundary.)pbdoc");
+    def_derivative(d1_n, "c4b2", d1dx1::nonuniform::c4b2, R"pbdoc(4th order central difference, 2nd order boundary.)pbdoc");
+    def_derivative(d1_n, "c4b4", d1dx1::nonuniform::c4b4, R"pbdoc(4th order central difference, 4th order boundary.)pbdoc");
+
+    py::module_ d2 = m.def_submodule("d2dx2", R"pbdoc(Second order derivative operators.)pbdoc");
+    py::module_ d2_u = d2.def_submodule("uniform");
+    def_derivative(d2_u, "c2b0", d2dx2::uniform::c2b0, R"pbdoc(2nd order central difference, zero boundary.)pbdoc");
+    def_derivative(d2_u, "c2b1", d2dx2::uniform::c2b1, R"pbdoc(2nd order central difference, 1st order boundary.)pbdoc");
+    def_derivative(d2_u, "c2b2", d2dx2::uniform::c2b2, R"pbdoc(2nd order central difference, 2nd order boundary.)pbdoc");
+    def_derivative(d2_u, "c4b0", d2dx2::uniform::c4b0, R"pbdoc(4th order central difference, zero boundary.)pbdoc");
+    def_derivative(d2_u, "c4b2", d2dx2::uniform::c4b2, R"pbdoc(4th order central difference, 2nd order boundary.)pbdoc");
+    def_derivative(d2_u, "c4b4", d2dx2::uniform::c4b4, R"pbdoc(4th order central difference, 4th order boundary.)pbdoc");
+    py::module_ d2_n = d2.def_submodule("nonuniform");
+    def_derivative(d2_n, "c2b0", d2dx2::nonuniform::c2b0, R"pbdoc(2nd order central difference, zero boundary.)pbdoc");
+    def_derivative(d2_n, "c2b1", d2dx2::nonuniform::c2b1, R"pbdoc(2nd order central difference, 1st order boundary.)pbdoc");
+    def_derivative(d2_n, "c2b2", d2dx2::nonuniform::c2b2, R"pbdoc(2nd order central difference, 2nd order boundary.)pbdoc");
+    def_derivative(d2_n, "c4b0", d2dx2::nonuniform::c4b0, R"pbdoc(4th order central difference, zero boundary.)pbdoc");
+    def_derivative(d2_n, "c4b4", d2dx2::nonuniform::c4b4, R"pbdoc(4th order central difference, 4th order boundary.)pbdoc");
+
+    typedef MixedDerivative<TriDiagonal, TriDiagonal> Mixed;
+
+    py::class_<Mixed>(m, "MixedDerivative",
+        R"pbdoc(Mixed derivative on 2-dimensional grid, product of first order derivative operators.)pbdoc")
+        .def(py::init<const TriDiagonal&, const TriDiagonal&>(), py::arg("d1dx1"), py::arg("d1dy1"))
+        .def_property_readonly("separable", &Mixed::separable)
+        .def("set_prefactors", [](Mixed& self, const double scalar) {
+            self.set_prefactors(scalar);
+        }, py::arg("scalar"))
+        .def("set_prefactors", [](Mixed& self, const Array& coef_x, const Array& coef_y) {
+            self.set_prefactors(to_vector(coef_x), to_vector(coef_y));
+        }, py::arg("coef_x"), py::arg("coef_y"), R"pbdoc(Separable prefactors coef_x[i] * coef_y[j].)pbdoc")
+        .def("set_prefactors", [](Mixed& self, const Array& factors) {
+            self.set_prefactors(to_vector(factors));
+        }, py::arg("factors"), R"pbdoc(Prefactors on the full grid, order (x, y).)pbdoc")
+        .def("d2dxdy", [](Mixed& self, const Array& func) {
+            std::vector<double> result = to_vector(func);
+            {
+                py::gil_scoped_release release;
+                Workspace workspace;
+                self.d2dxdy(result, result, workspace);
+            }
+            return to_array(std::move(result), shape(func));
+        }, py::arg("func"));
+
+    def_action_2d<TriDiagonal>(m);
+    def_action_2d<PentaDiagonal>(m);
+
+}
+
+
+void bind_propagation(py::module_& m) {
+
+    py::module_ p = m.def_submodule("propagation",
+        R"pbdoc(Time propagation. The GIL is released during propagation; operators and func are copied.)pbdoc");
+
+    def_theta_1d<TriDiagonal>(p);
+    def_theta_1d<PentaDiagonal>(p);
+    def_theta_1d_batch(p);
+
+    typedef MixedDerivative<TriDiagonal, TriDiagonal> Mixed;
+
+    py::module_ adi = p.def_submodule("adi",
+        R"pbdoc(ADI schemes on 2-dimensional grids, func of shape (order of derivative_1, order of derivative_2).)pbdoc");
+
+    adi.def("dr_2d", [](
+        const Array& time_grid,
+        TriDiagonal derivative_1,
+        TriDiagonal derivative_2,
+        const Array& func,
+        const double theta) {
+
+            check_order_2d(derivative_1, derivative_2, func);
+
+            const std::vector<double> time_grid_ = to_vector(time_grid);
+            std::vector<double> result = to_vector(func);
+            {
+                py::gil_scoped_release release;
+                propagation::adi::dr_2d(time_grid_, derivative_1, derivative_2, result, theta);
+            }
+            return to_array(std::move(result), shape(func));
+
+        }, py::arg("time_grid"), py::arg("derivative_1"), py::arg("derivative_2"),
+        py::arg("func"), py::arg("theta") = 0.5, R"pbdoc(Douglas-Rachford.)pbdoc");
+
+    adi.def("cs_2d", [](
+        const Array& time_grid,
+        TriDiagonal derivative_1,
+        TriDiagonal derivative_2,
+        Mixed mixed,
+        const Array& func,
+        const double theta,
+        const double lambda,
+        const int n_iterations) {
+
+            check_order_2d(derivative_1, derivative_2, func);
+
+            const std::vector<double> time_grid_ = to_vector(time_grid);
+            std::vector<double> result = to_vector(func);
+            {
+                py::gil_scoped_release release;
+                propagation::adi::cs_2d(time_grid_, derivative_1, derivative_2, mixed, result,
+                    theta, lambda, n_iterations);
+            }
+            return to_array(std::move(result), shape(func));
+
+        }, py::arg("time_grid"), py::arg("derivative_1"), py::arg("derivative_2"),
+        py::arg("mixed"), py::arg("func"), py::arg("theta") = 0.5, py::arg("lambda_") = 0.5,
+        py::arg("n_iterations") = 1, R"pbdoc(Craig-Sneyd.)pbdoc");
+
+    adi.def("mcs_2d", [](
+        const Array& time_grid,
+        TriDiagonal derivative_1,
+        TriDiagonal derivative_2,
+        Mixed mixed,
+        const Array& func,
+        const double theta) {
+
+            check_order_2d(derivative_1, derivative_2, func);
+
+            const std::vector<double> time_grid_ = to_vector(time_grid);
+            std::vector<double> result = to_vector(func);
+            {
+                py::gil_scoped_release release;
+                propagation::adi::mcs_2d(time_grid_, derivative_1, derivative_2, mixed, result, theta);
+            }
+            return to_array(std::move(result), shape(func));
+
+        }, py::arg("time_grid"), py::arg("derivative_1"), py::arg("derivative_2"),
+        py::arg("mixed"), py::arg("func"), py::arg("theta") = 1.0 / 3.0,
+        R"pbdoc(Modified Craig-Sneyd.)pbdoc");
+
+    adi.def("hv_2d", [](
+        const Array& time_grid,
+        TriDiagonal derivative_1,
+        TriDiagonal derivative_2,
+        Mixed mixed,
+        const Array& func,
+        const double theta,
+        const double mu) {
+
+            check_order_2d(derivative_1, derivative_2, func);
+
+            const std::vector<double> time_grid_ = to_vector(time_grid);
+            std::vector<double> result = to_vector(func);
+            {
+                py::gil_scoped_release release;
+                propagation::adi::hv_2d(time_grid_, derivative_1, derivative_2, mixed, result,
+                    theta, mu);
+            }
+            return to_array(std::move(result), shape(func));
+
+        }, py::arg("time_grid"), py::arg("derivative_1"), py::arg("derivative_2"),
+        py::arg("mixed"), py::arg("func"), py::arg("theta") = 0.5 + std::sqrt(3.0) / 6.0,
+        py::arg("mu") = 0.5, R"pbdoc(Hundsdorfer-Verwer.)pbdoc");
+
+}
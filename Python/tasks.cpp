@@ -0,0 +1,272 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <pybind11/stl.h>
+
+#include "scheduler.h"
+
+#include "bindings.h"
+
+
+namespace {
+
+    // Scheduler owned by Python. The workers may acquire the GIL (completion
+    // callbacks), hence the GIL is released while they are joined.
+    class Executor {
+
+    public:
+
+        std::unique_ptr<tasks::Scheduler> scheduler;
+
+        Executor(const int n_threads, const int capacity) :
+            scheduler(new tasks::Scheduler(n_threads, capacity)) {}
+
+        ~Executor() {
+            py::gil_scoped_release release;
+            scheduler.reset();
+        }
+
+        // Submit job; blocks without the GIL while the scheduler is full.
+        template <class F>
+        tasks::Future<std::vector<double>> submit(F func, const tasks::Priority priority) {
+            py::gil_scoped_release release;
+            return scheduler->submit(func, priority);
+        }
+
+    };
+
+    // Pending result of a pricing job, see nfs.tasks.Task.
+    class Task {
+
+    public:
+
+        tasks::Future<std::vector<double>> future;
+        std::vector<py::ssize_t> shape;
+
+        // Result array, set by the first call to result.
+        py::object value;
+
+        Task(
+            tasks::Future<std::vector<double>> future_,
+            const std::vector<py::ssize_t>& shape_) :
+            future(future_), shape(shape_) {}
+
+        // Array of result; blocks without the GIL. The result vector is moved
+        // into the array by the first caller; value is checked again after
+        // the wait, since another caller may have done so meanwhile.
+        py::object result() {
+
+            if (value) {
+                return value;
+            }
+
+            {
+                py::gil_scoped_release release;
+                future.wait();
+            }
+
+            if (value) {
+                return value;
+            }
+
+            value = to_array(std::move(future.get()), shape);
+
+            return value;
+
+        }
+
+    };
+
+    // Complete asyncio future on its event loop once task has finished.
+    void set_asyncio_future(py::object task, py::object future) {
+
+        Task& t = task.cast<Task&>();
+
+        if (future.attr("done")().cast<bool>()) {
+            return;
+        }
+
+        if (t.future.status() == tasks::Status::cancelled) {
+            future.attr("cancel")();
+            return;
+        }
+
+        // Through Python, such that errors of the job are translated.
+        try {
+            future.attr("set_result")(task.attr("result")());
+        }
+        catch (py::error_already_set& e) {
+            future.attr("set_exception")(e.value());
+        }
+
+    }
+
+    // Awaitable of task, compatible with asyncio.
+    py::object await(py::object self) {
+
+        Task& task = self.cast<Task&>();
+
+        py::object loop = py::module_::import("asyncio").attr("get_running_loop")();
+        py::object future = loop.attr("create_future")();
+
+        // Cancellation of the awaiting coroutine cancels the job.
+        future.attr("add_done_callback")(py::cpp_function([self](py::object f) {
+            if (f.attr("cancelled")().cast<bool>()) {
+                self.cast<Task&>().future.cancel();
+            }
+        }));
+
+        // Python objects referenced by the completion callback. The callback
+        // runs on a worker thread, the objects are released with the GIL held.
+        struct Pending {
+            py::object loop;
+            py::object callback;
+        };
+
+        Pending* pending = new Pending{ loop, py::cpp_function([self, future]() {
+            set_asyncio_future(self, future);
+        }) };
+
+        task.future.then([pending]() {
+            py::gil_scoped_acquire acquire;
+            std::unique_ptr<Pending> p(pending);
+            try {
+                p->loop.attr("call_soon_threadsafe")(p->callback);
+            }
+            catch (py::error_already_set&) {
+                // Event loop closed, nobody is awaiting the result.
+            }
+        });
+
+        return future.attr("__await__")();
+
+    }
+
+}
+
+
+void bind_tasks(py::module_& m) {
+
+    py::module_ t = m.def_submodule("tasks",
+        R"pbdoc(Asynchronous pricing. Jobs are run by a work-stealing scheduler; submission returns a Task, which can be awaited in asyncio.)pbdoc");
+
+    py::register_exception<tasks::Cancelled>(t, "CancelledError");
+
+    py::enum_<tasks::Priority>(t, "Priority")
+        .value("high", tasks::Priority::high)
+        .value("normal", tasks::Priority::normal)
+        .value("low", tasks::Priority::low);
+
+    py::class_<Task>(t, "Task", R"pbdoc(Pending result of a pricing job.)pbdoc")
+        .def("done", [](const Task& self) {
+            return self.future.done();
+        })
+        .def("cancelled", [](const Task& self) {
+            return self.future.status() == tasks::Status::cancelled;
+        })
+        .def("cancel", [](const Task& self) {
+            return self.future.cancel();
+        }, R"pbdoc(Cancel job. True if the job had not started.)pbdoc")
+        .def("result", &Task::result,
+            R"pbdoc(Result array, blocks until the job has finished. Raises CancelledError or the error of the job.)pbdoc")
+        .def("__await__", &await);
+
+    py::class_<Executor>(t, "Scheduler", R"pbdoc(Work-stealing scheduler of pricing jobs.)pbdoc")
+        .def(py::init<int, int>(), py::arg("n_threads") = 0, py::arg("capacity") = 1024,
+            R"pbdoc(n_threads = 0: Number of hardware threads. At most capacity jobs are queued; submission blocks while full.)pbdoc")
+        .def_property_readonly("n_threads", [](const Executor& self) {
+            return self.scheduler->n_threads();
+        })
+        .def_property_readonly("n_queued", [](const Executor& self) {
+            return self.scheduler->n_queued();
+        })
+        .def("wait_idle", [](const Executor& self) {
+            py::gil_scoped_release release;
+            self.scheduler->wait_idle();
+        })
+        .def("bs_pde_batch", [](
+            Executor& self,
+            const Array& time_grid,
+            const Array& spatial_grid,
+            const Array& rate,
+            const Array& sigma,
+            const Array& strike,
+            const std::string& option,
+            const double theta,
+            const int width,
+            const tasks::Priority priority) {
+
+                // Copies, the job runs after the arrays may have been released.
+                std::vector<double> time_grid_ = to_vector(time_grid);
+                std::vector<double> spatial_grid_ = to_vector(spatial_grid);
+                std::vector<double> rate_ = to_vector(rate);
+                std::vector<double> sigma_ = to_vector(sigma);
+                std::vector<double> strike_ = to_vector(strike);
+
+                return Task(self.submit([=]() {
+                    return pricing::bs_pde_batch(
+                        time_grid_, spatial_grid_, to_view(rate_), to_view(sigma_), to_view(strike_),
+                        option, theta, width);
+                }, priority), { strike.size(), spatial_grid.size() });
+
+            }, py::arg("time_grid"), py::arg("spatial_grid"), py::arg("rate"), py::arg("sigma"),
+            py::arg("strike"), py::arg("option") = "call", py::arg("theta") = 0.5, py::arg("width") = 8,
+            py::arg("priority") = tasks::Priority::normal, R"pbdoc(See nfs.bs.pde.batch.)pbdoc")
+        .def("heston_strip", [](
+            Executor& self,
+            const double price,
+            const double variance,
+            const double rate,
+            const double lambda,
+            const double theta,
+            const double eta,
+            const double rho,
+            const Array& strike,
+            const Array& tau,
+            const std::string& option,
+            const tasks::Priority priority) {
+
+                std::vector<double> strike_ = to_vector(strike);
+                std::vector<double> tau_ = to_vector(tau);
+
+                return Task(self.submit([=]() {
+                    return pricing::heston_strip(
+                        price, variance, rate, lambda, theta, eta, rho, to_view(strike_), to_view(tau_),
+                        option);
+                }, priority), { strike.size() });
+
+            }, py::arg("price"), py::arg("variance"), py::arg("rate"), py::arg("lambda_"),
+            py::arg("theta"), py::arg("eta"), py::arg("rho"), py::arg("strike"), py::arg("tau"),
+            py::arg("option") = "call", py::arg("priority") = tasks::Priority::normal,
+            R"pbdoc(See nfs.heston.strip.)pbdoc")
+        .def("heston_pde", [](
+            Executor& self,
+            const Array& time_grid,
+            const Array& grid_s,
+            const Array& grid_v,
+            const double rate,
+            const double lambda,
+            const double theta,
+            const double eta,
+            const double rho,
+            const double strike,
+            const std::string& option,
+            const std::string& scheme,
+            const tasks::Priority priority) {
+
+                std::vector<double> time_grid_ = to_vector(time_grid);
+                std::vector<double> grid_s_ = to_vector(grid_s);
+                std::vector<double> grid_v_ = to_vector(grid_v);
+
+                return Task(self.submit([=]() {
+                    return pricing::heston_pde(time_grid_, grid_s_, grid_v_,
+                        rate, lambda, theta, eta, rho, strike, option, scheme);
+                }, priority), { grid_s.size(), grid_v.size() });
+
+            }, py::arg("time_grid"), py::arg("grid_s"), py::arg("grid_v"), py::arg("rate"),
+            py::arg("lambda_"), py::arg("theta"), py::arg("eta"), py::arg("rho"), py::arg("strike"),
+            py::arg("option") = "call", py::arg("scheme") = "HV",
+            py::arg("priority") = tasks::Priority::normal, R"pbdoc(See nfs.heston.pde.solve.)pbdoc");
+
+}
@@ -0,0 +1,207 @@
+#include "pch.h"
+
+
+namespace {
+
+	const double spot = 100.0;
+	const double rate = 0.03;
+	const double sigma = 0.25;
+
+	const std::vector<std::function<TriDiagonal(std::vector<double>)>>
+		deriv{ d1dx1::nonuniform::c2b2, d2dx2::nonuniform::c2b1 };
+
+	bs::barrier::Option option(
+		const bs::barrier::Type type,
+		const bool call,
+		const double strike,
+		const double lower,
+		const double upper) {
+
+		bs::barrier::Option result;
+		result.type = type;
+		result.call = call;
+		result.strike = strike;
+		result.lower = lower;
+		result.upper = upper;
+		return result;
+
+	}
+
+	// PDE solution at spot.
+	double pde_price(
+		const bs::barrier::Option& option,
+		const int n_points,
+		const int n_steps,
+		const bool smoothing = true) {
+
+		const std::vector<double> spatial_grid =
+			bs::barrier::pde::grid(option, spot, 400.0, n_points);
+		const std::vector<double> time_grid =
+			bs::barrier::pde::time_grid(option, n_steps);
+
+		const std::vector<double> func = bs::barrier::pde::solve<TriDiagonal>(
+			time_grid, spatial_grid, option, rate, sigma, deriv, 0.5, smoothing);
+
+		return func[grid::find(spatial_grid, spot)];
+
+	}
+
+}
+
+
+TEST(Barrier, ClosedForm) {
+
+	const double strike = 105.0;
+	const double tau = 1.0;
+
+	// Digital put-call parity.
+	EXPECT_NEAR(bs::digital::call::price(spot, rate, sigma, strike, tau)
+		+ bs::digital::put::price(spot, rate, sigma, strike, tau), std::exp(-rate * tau), 1.0e-14);
+
+	// Without barriers.
+	bs::barrier::Option vanilla = option(bs::barrier::Type::none, true, strike, 0.0, 0.0);
+	EXPECT_NEAR(bs::barrier::price(spot, rate, sigma, vanilla),
+		bs::call::price(spot, rate, sigma, strike, tau), 1.0e-12);
+	vanilla.call = false;
+	EXPECT_NEAR(bs::barrier::price(spot, rate, sigma, vanilla),
+		bs::put::price(spot, rate, sigma, strike, tau), 1.0e-12);
+
+	// Down-and-in call, barrier below strike, see Hull (2018), Section 26.9.
+	const double barrier = 90.0;
+	const double lambda = (rate + 0.5 * sigma * sigma) / (sigma * sigma);
+	const double y = std::log(barrier * barrier / (spot * strike)) / (sigma * std::sqrt(tau))
+		+ lambda * sigma * std::sqrt(tau);
+	const double down_in = spot * std::pow(barrier / spot, 2.0 * lambda) * normal::cdf(y)
+		- strike * std::exp(-rate * tau) * std::pow(barrier / spot, 2.0 * lambda - 2.0)
+		* normal::cdf(y - sigma * std::sqrt(tau));
+
+	EXPECT_NEAR(bs::barrier::price(spot, rate, sigma,
+		option(bs::barrier::Type::down_in, true, strike, barrier, 0.0)), down_in, 1.0e-12);
+
+	// In-out parity, calls, puts and digitals.
+	for (const bool call : { true, false }) {
+		for (const bool digital : { true, false }) {
+
+			bs::barrier::Option o = option(bs::barrier::Type::none, call, strike, 80.0, 130.0);
+			o.digital = digital;
+			const double none = bs::barrier::price(spot, rate, sigma, o);
+
+			const std::vector<std::pair<bs::barrier::Type, bs::barrier::Type>> pairs{
+				{ bs::barrier::Type::down_out, bs::barrier::Type::down_in },
+				{ bs::barrier::Type::up_out, bs::barrier::Type::up_in },
+				{ bs::barrier::Type::double_out, bs::barrier::Type::double_in } };
+
+			for (const auto& p : pairs) {
+				o.type = p.first;
+				const double out = bs::barrier::price(spot, rate, sigma, o);
+				o.type = p.second;
+				const double in = bs::barrier::price(spot, rate, sigma, o);
+				EXPECT_GE(out, 0.0);
+				EXPECT_GE(in, 0.0);
+				EXPECT_NEAR(out + in, none, 1.0e-12);
+			}
+
+		}
+	}
+
+	// Double barrier far away.
+	EXPECT_NEAR(bs::barrier::price(spot, rate, sigma,
+		option(bs::barrier::Type::double_out, true, strike, 1.0, 1.0e4)),
+		bs::call::price(spot, rate, sigma, strike, tau), 1.0e-8);
+
+	// Knocked out.
+	EXPECT_EQ(bs::barrier::price(80.0, rate, sigma,
+		option(bs::barrier::Type::down_out, true, strike, barrier, 0.0)), 0.0);
+
+	// Discrete monitoring is less likely to knock out.
+	bs::barrier::Option discrete = option(bs::barrier::Type::up_out, true, strike, 0.0, 130.0);
+	const double continuous = bs::barrier::price(spot, rate, sigma, discrete);
+	discrete.monitoring = grid::uniform(0.1, 1.0, 10);
+	EXPECT_GT(bs::barrier::price(spot, rate, sigma, discrete), continuous);
+
+	// Solution on grid.
+	const std::vector<double> spatial_grid = grid::uniform(50.0, 150.0, 11);
+	const std::vector<double> solution =
+		bs::barrier::solution_func(rate, sigma, discrete)(0.5, { spatial_grid });
+	discrete.tau = 0.5;
+	for (int i = 0; i != spatial_grid.size(); ++i) {
+		EXPECT_EQ(solution[i], bs::barrier::price(spatial_grid[i], rate, sigma, discrete));
+	}
+
+}
+
+
+TEST(Barrier, Smoothing) {
+
+	const std::vector<double> grid{ 0.0, 1.0, 2.0, 4.0 };
+
+	// Cells: [0, 0.5], [0.5, 1.5], [1.5, 3], [3, 4].
+	const std::vector<double> digital = bs::barrier::pde::smooth(
+		[](const double s) { return bs::digital::call::payoff(s, 1.0); }, grid, { 1.0 });
+	EXPECT_EQ(digital, std::vector<double>({ 0.0, 0.5, 1.0, 1.0 }));
+
+	// Exact for piecewise linear payoffs.
+	const std::vector<double> call = bs::barrier::pde::smooth(
+		[](const double s) { return bs::call::payoff(s, 1.0); }, grid, { 1.0 });
+	EXPECT_NEAR(call[1], 0.125, 1.0e-15);
+	EXPECT_NEAR(call[2], 1.25, 1.0e-15);
+
+	// Knock-out projection: Parts of cells inside barriers.
+	std::vector<double> func(4, 1.0);
+	bs::barrier::pde::project(
+		option(bs::barrier::Type::double_out, true, 1.0, 1.0, 2.0), grid, func);
+	EXPECT_EQ(func, std::vector<double>({ 0.0, 0.5, 1.0 / 3.0, 0.0 }));
+
+}
+
+
+TEST(Barrier, Pde) {
+
+	const double strike = 105.0;
+
+	// Digital call: Smoothing on aligned grid.
+	bs::barrier::Option digital = option(bs::barrier::Type::none, true, strike, 0.0, 0.0);
+	digital.digital = true;
+	const double digital_exact = bs::barrier::price(spot, rate, sigma, digital);
+	const double error_smooth = std::abs(pde_price(digital, 101, 50) - digital_exact);
+	const double error_raw = std::abs(pde_price(digital, 101, 50, false) - digital_exact);
+	EXPECT_LT(error_smooth, 1.0e-4);
+	EXPECT_LT(100.0 * error_smooth, error_raw);
+
+	// Second order convergence.
+	const double error_fine = std::abs(pde_price(digital, 201, 100) - digital_exact);
+	EXPECT_LT(error_fine, 0.3 * error_smooth);
+
+	// Continuously monitored barriers.
+	const std::vector<bs::barrier::Option> options{
+		option(bs::barrier::Type::down_out, true, strike, 90.0, 0.0),
+		option(bs::barrier::Type::down_in, true, strike, 90.0, 0.0),
+		option(bs::barrier::Type::up_out, true, strike, 0.0, 130.0),
+		option(bs::barrier::Type::up_in, false, strike, 0.0, 120.0),
+		option(bs::barrier::Type::double_out, false, strike, 80.0, 120.0) };
+
+	for (const bs::barrier::Option& o : options) {
+		EXPECT_NEAR(pde_price(o, 201, 100), bs::barrier::price(spot, rate, sigma, o), 5.0e-3);
+	}
+
+	// Discretely monitored up-and-out call, weekly monitoring, against
+	// continuity correction.
+	bs::barrier::Option discrete = option(bs::barrier::Type::up_out, true, strike, 0.0, 130.0);
+	discrete.monitoring = grid::uniform(0.0, 1.0, 53);
+	discrete.monitoring.erase(discrete.monitoring.begin());
+	const double discrete_pde = pde_price(discrete, 401, 2 * 52);
+	EXPECT_NEAR(discrete_pde, bs::barrier::price(spot, rate, sigma, discrete), 2.0e-2);
+	EXPECT_GT(discrete_pde, bs::barrier::price(spot, rate, sigma, options[2]));
+
+	// Discrete knock-in on the whole grid.
+	discrete.type = bs::barrier::Type::up_in;
+	EXPECT_NEAR(pde_price(discrete, 401, 2 * 52) + discrete_pde,
+		bs::call::price(spot, rate, sigma, strike, 1.0), 1.0e-2);
+
+	// Barriers should be on grid nodes.
+	EXPECT_THROW(bs::barrier::pde::solve<TriDiagonal>(
+		grid::uniform(0.0, 1.0, 11), grid::uniform(0.0, 400.0, 101),
+		option(bs::barrier::Type::down_out, true, strike, 91.0, 0.0), rate, sigma, deriv),
+		std::invalid_argument);
+
+}
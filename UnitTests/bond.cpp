@@ -0,0 +1,138 @@
+#include "pch.h"
+
+
+namespace {
+
+	const double rate = 0.03;
+	const double kappa = 0.5;
+	const double theta = 0.04;
+	const double sigma = 0.01;
+
+	// Ladder of annual coupon bonds, maturities 1 to 10 years. Event dates
+	// start at the valuation date.
+	std::vector<Bond> ladder() {
+
+		std::vector<Bond> bonds;
+
+		for (int maturity = 1; maturity != 11; ++maturity) {
+
+			std::vector<double> event_grid{ 0.0 };
+			std::vector<double> cash_flows{ 0.0 };
+			for (int i = 1; i <= maturity; ++i) {
+				event_grid.push_back((double)i);
+				cash_flows.push_back(0.04);
+			}
+			cash_flows.back() += 1.0;
+
+			bonds.push_back(Bond(event_grid, cash_flows));
+
+		}
+
+		return bonds;
+
+	}
+
+	// Closed form price, delta and gamma at time of cash flows paid at or
+	// after time.
+	std::vector<double> closed_form(
+		const Bond& bond,
+		const double r,
+		const double time,
+		const double theta_) {
+
+		double price = 0.0;
+		double delta = 0.0;
+		double gamma = 0.0;
+
+		for (int i = 0; i != bond.events().size(); ++i) {
+
+			const double t = bond.events()[i];
+			if (t < time) {
+				continue;
+			}
+
+			const double cash_flow = i == 0 ? 0.0 : (t == bond.maturity() ? 1.04 : 0.04);
+			const double b = vasicek::b_func(time, t, kappa);
+			const double p = cash_flow * vasicek::zcb::price(r, time, t, kappa, theta_, sigma);
+
+			price += p;
+			delta -= b * p;
+			gamma += b * b * p;
+
+		}
+
+		return { price, delta, gamma };
+
+	}
+
+}
+
+
+TEST(Bond, Ladder) {
+
+	const std::vector<double> spatial_grid =
+		vasicek::pde::generator::grid(rate, kappa, theta, sigma, 10.0, 201);
+
+	BondRollback rollback(ladder(), spatial_grid);
+	rollback.solve(kappa, theta, sigma);
+
+	for (const Bond& bond : rollback.bonds()) {
+
+		EXPECT_DOUBLE_EQ(bond.price(rate, (int)bond.events().size() - 1), bond.payoff(rate));
+
+		for (int e = 0; e != bond.events().size(); ++e) {
+
+			const double r = rate + 0.005 * (e % 3 - 1);
+			const std::vector<double> expected = closed_form(bond, r, bond.events()[e], theta);
+
+			EXPECT_NEAR(bond.price(r, e), expected[0], 1.0e-5);
+			EXPECT_NEAR(bond.delta(r, e), expected[1], 1.0e-3);
+			EXPECT_NEAR(bond.gamma(r, e), expected[2], 1.0e-2);
+
+			// Theta from the PDE, just before the event date.
+			const double expected_theta = r * expected[0]
+				- kappa * (theta - r) * expected[1] - 0.5 * sigma * sigma * expected[2];
+			EXPECT_NEAR(bond.theta(r, e), expected_theta, 1.0e-4);
+
+		}
+
+	}
+
+	EXPECT_THROW(rollback.bond(0).price(rate, 3), std::invalid_argument);
+
+}
+
+
+TEST(Bond, ShiftedCurve) {
+
+	const std::vector<double> spatial_grid =
+		vasicek::pde::generator::grid(rate, kappa, theta, sigma, 10.0, 201);
+
+	BondRollback rollback(ladder(), spatial_grid);
+
+	const std::vector<Bond> bonds = ladder();
+	EXPECT_THROW(bonds[0].price(rate, 0), std::runtime_error);
+
+	// Parallel shifts of the mean reversion level.
+	for (int k = 0; k != 3; ++k) {
+
+		const double shift = 0.001 * k;
+		rollback.solve(kappa, [shift](const double) { return theta + shift; }, sigma);
+
+		for (const Bond& bond : rollback.bonds()) {
+			EXPECT_NEAR(bond.price(rate, 0), closed_form(bond, rate, 0.0, theta + shift)[0], 1.0e-5);
+		}
+
+	}
+
+	// Hull-White fitted to the Vasicek curve.
+	const std::function<double(double)> theta_t = vasicek::hull_white::theta(
+		[](const double t) { return vasicek::zcb::price(rate, 0.0, t, kappa, theta, sigma); },
+		kappa, sigma);
+	rollback.solve(kappa, theta_t, sigma);
+
+	for (const Bond& bond : rollback.bonds()) {
+		EXPECT_NEAR(bond.price(rate, 0), closed_form(bond, rate, 0.0, theta)[0], 1.0e-5);
+	}
+
+}
@@ -0,0 +1,186 @@
+#include "pch.h"
+
+
+namespace {
+
+	const std::vector<double> node_times{ 0.25, 0.5, 1.0, 2.0, 3.0, 5.0, 7.0, 10.0, 20.0 };
+	const std::vector<double> node_rates{ 0.030, 0.032, 0.031, 0.035, 0.037, 0.036, 0.040, 0.041, 0.039 };
+
+	const std::vector<curve::Interpolation> interpolations{
+		curve::Interpolation::linear, curve::Interpolation::monotone_convex };
+
+	std::vector<curve::Quote> quotes() {
+
+		std::vector<curve::Quote> quotes;
+
+		for (double maturity : { 0.25, 0.5, 1.0 }) {
+			curve::Quote q;
+			q.kind = curve::QuoteKind::deposit;
+			q.maturity = maturity;
+			q.rate = 0.03 + 0.002 * maturity;
+			quotes.push_back(q);
+		}
+		for (double maturity : { 2.0, 3.0, 5.0, 7.0, 10.0, 15.0, 20.0, 30.0 }) {
+			curve::Quote q;
+			q.kind = curve::QuoteKind::swap;
+			q.maturity = maturity;
+			q.rate = 0.032 + 0.004 * std::log(maturity);
+			q.tenor = 0.5;
+			quotes.push_back(q);
+		}
+
+		return quotes;
+
+	}
+
+}
+
+
+TEST(Curve, Interpolation) {
+
+	std::vector<double> times;
+	for (double t = 0.0; t < 25.0; t += 0.01) {
+		times.push_back(t);
+	}
+
+	for (curve::Interpolation interpolation : interpolations) {
+
+		const curve::ZeroCurve curve(node_times, node_rates, interpolation);
+
+		for (int i = 0; i != node_times.size(); ++i) {
+			EXPECT_NEAR(curve.zero(node_times[i]), node_rates[i], 1.0e-15);
+			EXPECT_NEAR(curve.df(node_times[i]), std::exp(-node_rates[i] * node_times[i]), 1.0e-15);
+		}
+
+		// Batch evaluation, ascending, descending and unsorted.
+		const std::vector<double> df = curve.df(times);
+		std::vector<double> reversed(times.rbegin(), times.rend());
+		const std::vector<double> df_reversed = curve.df(reversed);
+		for (int k = 0; k != times.size(); ++k) {
+			EXPECT_EQ(df[k], curve.df(times[k]));
+			EXPECT_EQ(df_reversed[times.size() - 1 - k], df[k]);
+		}
+
+		const std::vector<double> unsorted{ 7.5, 0.1, 30.0, 2.0, 0.0 };
+		const std::vector<double> df_unsorted = curve.df(unsorted);
+		for (int k = 0; k != unsorted.size(); ++k) {
+			EXPECT_EQ(df_unsorted[k], curve.df(unsorted[k]));
+		}
+
+		// Forward rates consistent with discount factors, and instantaneous
+		// forward rate as limit (away from nodes, where forward rates of
+		// linear interpolation jump).
+		std::vector<double> times_1(times.begin(), times.end() - 1);
+		std::vector<double> times_2(times.begin() + 1, times.end());
+		const std::vector<double> fwd = curve.fwd(times_1, times_2);
+		for (int k = 0; k != times_1.size(); ++k) {
+			EXPECT_NEAR(std::exp(-fwd[k] * (times_2[k] - times_1[k])), df[k + 1] / df[k], 1.0e-14);
+			const bool node = std::any_of(node_times.begin(), node_times.end(), [&](const double t) {
+				return t > times_1[k] - 1.0e-9 && t < times_2[k] + 1.0e-9;
+			});
+			if (!node) {
+				EXPECT_NEAR(curve.fwd(0.5 * (times_1[k] + times_2[k])), fwd[k], 1.0e-5);
+			}
+		}
+
+	}
+
+	// Monotone convex: Instantaneous forward rate continuous at nodes.
+	const curve::ZeroCurve curve(node_times, node_rates, curve::Interpolation::monotone_convex);
+	for (double t : node_times) {
+		EXPECT_NEAR(curve.fwd(t - 1.0e-9), curve.fwd(t + 1.0e-9), 1.0e-7);
+	}
+
+	EXPECT_THROW(curve::ZeroCurve({ 1.0, 0.5 }, { 0.01, 0.01 }), std::invalid_argument);
+
+}
+
+
+TEST(Curve, Shifts) {
+
+	std::vector<double> times;
+	for (double t = 0.0; t < 25.0; t += 0.1) {
+		times.push_back(t);
+	}
+
+	for (curve::Interpolation interpolation : interpolations) {
+
+		curve::ZeroCurve curve(node_times, node_rates, interpolation);
+
+		// Parallel shift.
+		curve.shift(0.001);
+		std::vector<double> shifted = node_rates;
+		for (double& rate : shifted) {
+			rate += 0.001;
+		}
+		std::vector<double> expected = curve::ZeroCurve(node_times, shifted, interpolation).df(times);
+		std::vector<double> df = curve.df(times);
+		for (int k = 0; k != times.size(); ++k) {
+			EXPECT_NEAR(df[k], expected[k], 1.0e-15);
+		}
+
+		// Key rate shifts.
+		for (int node : { 0, 1, 4, (int)node_times.size() - 1 }) {
+			curve.shift(node, 0.002);
+			shifted[node] += 0.002;
+		}
+		expected = curve::ZeroCurve(node_times, shifted, interpolation).df(times);
+		df = curve.df(times);
+		for (int k = 0; k != times.size(); ++k) {
+			EXPECT_NEAR(df[k], expected[k], 1.0e-15);
+		}
+
+	}
+
+}
+
+
+TEST(Curve, Bootstrap) {
+
+	for (curve::Interpolation interpolation : interpolations) {
+
+		const curve::ZeroCurve curve = curve::bootstrap(quotes(), interpolation);
+
+		EXPECT_EQ(curve.times().size(), quotes().size());
+		for (const curve::Quote& quote : quotes()) {
+			EXPECT_NEAR(curve::residual(curve, quote), 0.0, 1.0e-12);
+		}
+
+	}
+
+}
+
+
+TEST(Curve, Pricers) {
+
+	const curve::ZeroCurve curve(node_times, node_rates, curve::Interpolation::monotone_convex);
+
+	const double spot = 100.0;
+	const double sigma = 0.2;
+	const double strike = 105.0;
+	const double tau = 2.0;
+
+	// Flat curve.
+	const curve::ZeroCurve flat({ 1.0 }, { 0.03 });
+	EXPECT_DOUBLE_EQ(bs::call::price(spot, flat, sigma, strike, tau),
+		bs::call::price(spot, 0.03, sigma, strike, tau));
+
+	// PDE with term-structured rate against closed form.
+	const std::vector<double> time_grid = grid::uniform(0.0, tau, 201);
+	const std::vector<double> spatial_grid = grid::uniform(0.0, 400.0, 801);
+
+	const std::vector<std::function<TriDiagonal(std::vector<double>)>>
+		deriv{ d1dx1::uniform::c2b2, d2dx2::uniform::c2b1 };
+
+	const std::vector<double> func = bs::pde::solve<TriDiagonal>(
+		time_grid, spatial_grid, curve, sigma,
+		[strike](const double s) { return std::max(s - strike, 0.0); }, deriv);
+
+	EXPECT_NEAR(func[200], bs::call::price(spot, curve, sigma, strike, tau), 1.0e-2);
+
+	// Heston put-call parity with curve discounting.
+	const double call = heston::call(spot, 0.04, curve, 2.0, 0.04, 0.3, -0.7, strike, tau);
+	const double put = heston::put(spot, 0.04, curve, 2.0, 0.04, 0.3, -0.7, strike, tau);
+	EXPECT_NEAR(call - put, spot - strike * curve.df(tau), 1.0e-10);
+
+}
@@ -97,6 +97,11 @@ std::vector<double> test_fd_approximation(
 			deriv_fd = dndxn * func;
 		}
 
+		else if (fd_deriv_type == "d1dx1::nonuniform::c4b4") {
+			PentaDiagonal dndxn = d1dx1::nonuniform::c4b4(grid);
+			deriv_fd = dndxn * func;
+		}
+
 		else if (fd_deriv_type == "d2dx2::uniform::c2b1") {
 			TriDiagonal dndxn = d2dx2::uniform::c2b1(grid);
 			deriv_fd = dndxn * func;
@@ -111,11 +116,19 @@ std::vector<double> test_fd_approximation(
 			TriDiagonal dndxn = d2dx2::uniform::c2b2(grid);
 			deriv_fd = dndxn * func;
 		}
+		else if (fd_deriv_type == "d2dx2::nonuniform::c2b2") {
+			TriDiagonal dndxn = d2dx2::nonuniform::c2b2(grid);
+			deriv_fd = dndxn * func;
+		}
 		else if (fd_deriv_type == "d2dx2::uniform::c4b4") {
 			PentaDiagonal dndxn = d2dx2::uniform::c4b4(grid);
 			deriv_fd = dndxn * func;
 
 		}
+		else if (fd_deriv_type == "d2dx2::nonuniform::c4b4") {
+			PentaDiagonal dndxn = d2dx2::nonuniform::c4b4(grid);
+			deriv_fd = dndxn * func;
+		}
 		else {
 			throw std::invalid_argument("FD derivative unknown.");
 		}
@@ -613,6 +626,44 @@ TEST(FirstOrderDerivativeNonuniform, EXPc4b2) {
 }
 
 
+TEST(FirstOrderDerivativeNonuniform, EXPc4b4) {
+
+	// Compare FD representations based on uniform and non-uniform grids.
+
+	const int n_points = 21;
+
+	// Grid.
+	const std::vector<double> grid_eq = grid::uniform(-0.4, 0.4, n_points);
+
+	PentaDiagonal d1dx1_eq = d1dx1::uniform::c4b4(grid_eq);
+
+	PentaDiagonal d1dx1_neq = d1dx1::nonuniform::c4b4(grid_eq);
+
+	EXPECT_TRUE(d1dx1_eq == d1dx1_neq);
+
+	std::vector<double> slope_eq = test_fd_approximation(0, 1, "d1dx1::nonuniform::c4b4", 51, 5, "uniform", false, false);
+
+	std::vector<double> slope_exp = test_fd_approximation(0, 1, "d1dx1::nonuniform::c4b4", 51, 5, "exponential", false, false);
+
+	std::vector<double> slope_hyper = test_fd_approximation(0, 1, "d1dx1::nonuniform::c4b4", 51, 5, "hyperbolic", false, false);
+
+	// Maximum norm.
+	EXPECT_NEAR(slope_eq[0], 4.0, 0.020);
+
+	EXPECT_NEAR(slope_exp[0], 4.0, 0.100);
+
+	EXPECT_NEAR(slope_hyper[0], 4.0, 0.170);
+
+	// L1 function norm.
+	EXPECT_NEAR(slope_eq[3], 4.0, 0.090);
+
+	EXPECT_NEAR(slope_exp[3], 4.0, 0.020);
+
+	EXPECT_NEAR(slope_hyper[3], 4.0, 0.100);
+
+}
+
+
 TEST(SecondOrderDerivativeNonuniform, EXPc2b1) {
 
 	// Compare FD representations based on uniform and non-uniform grids.
@@ -658,6 +709,146 @@ TEST(SecondOrderDerivativeNonuniform, EXPc2b1) {
 }
 
 
+TEST(SecondOrderDerivativeNonuniform, EXPc2b2) {
+
+	// Compare FD representations based on uniform and non-uniform grids.
+
+	const int n_points = 21;
+
+	// Grid.
+	const std::vector<double> grid_eq = grid::uniform(-0.4, 0.4, n_points);
+
+	TriDiagonal d2dx2_eq = d2dx2::uniform::c2b2(grid_eq);
+	TriDiagonal d2dx2_neq = d2dx2::nonuniform::c2b2(grid_eq);
+
+	EXPECT_TRUE(d2dx2_eq == d2dx2_neq);
+
+	std::vector<double> slope_eq = test_fd_approximation(0, 2, "d2dx2::uniform::c2b2", 51, 5, "uniform", false, false);
+
+	std::vector<double> slope_exp = test_fd_approximation(0, 2, "d2dx2::nonuniform::c2b2", 51, 5, "exponential", false, false);
+
+	std::vector<double> slope_hyper = test_fd_approximation(0, 2, "d2dx2::nonuniform::c2b2", 51, 5, "hyperbolic", false, false);
+
+	// Maximum norm.
+	EXPECT_NEAR(slope_eq[0], 2.0, 0.015);
+
+	EXPECT_NEAR(slope_exp[0], 2.0, 0.055);
+
+	EXPECT_NEAR(slope_hyper[0], 2.0, 0.085);
+
+	// L1 function norm.
+	EXPECT_NEAR(slope_eq[3], 2.0, 0.055);
+
+	EXPECT_NEAR(slope_exp[3], 2.0, 0.010);
+
+	EXPECT_NEAR(slope_hyper[3], 2.0, 0.035);
+
+}
+
+
+TEST(SecondOrderDerivativeNonuniform, EXPc4b4) {
+
+	// Compare FD representations based on uniform and non-uniform grids.
+
+	const int n_points = 21;
+
+	// Grid.
+	const std::vector<double> grid_eq = grid::uniform(-0.4, 0.4, n_points);
+
+	PentaDiagonal d2dx2_eq = d2dx2::uniform::c4b4(grid_eq);
+	PentaDiagonal d2dx2_neq = d2dx2::nonuniform::c4b4(grid_eq);
+
+	EXPECT_TRUE(d2dx2_eq == d2dx2_neq);
+
+	std::vector<double> slope_eq = test_fd_approximation(0, 2, "d2dx2::uniform::c4b4", 51, 2, "uniform", false, false);
+
+	std::vector<double> slope_exp = test_fd_approximation(0, 2, "d2dx2::nonuniform::c4b4", 51, 2, "exponential", false, false);
+
+	std::vector<double> slope_hyper = test_fd_approximation(0, 2, "d2dx2::nonuniform::c4b4", 51, 2, "hyperbolic", false, false);
+
+	// Maximum norm.
+	EXPECT_NEAR(slope_eq[0], 4.0, 0.063);
+
+	EXPECT_NEAR(slope_exp[0], 4.0, 0.180);
+
+	EXPECT_NEAR(slope_hyper[0], 4.0, 0.190);
+
+	// L1 function norm.
+	EXPECT_NEAR(slope_eq[3], 4.0, 0.600);
+
+	EXPECT_NEAR(slope_exp[3], 4.0, 0.070);
+
+	EXPECT_NEAR(slope_hyper[3], 4.0, 0.130);
+
+}
+
+
+TEST(CoefficientCache, SharedGrid) {
+
+	coefficient_cache::clear();
+
+	const std::vector<double> grid_1 = grid::hyperbolic(-0.4, 0.4, 51);
+	const std::vector<double> grid_2 = grid::hyperbolic(-0.4, 0.4, 61);
+
+	// Coefficients evaluated once per grid and stencil.
+	PentaDiagonal d1dx1_1 = d1dx1::nonuniform::c4b2(grid_1);
+	PentaDiagonal d1dx1_2 = d1dx1::nonuniform::c4b4(grid_1);
+	EXPECT_EQ(coefficient_cache::n_evaluations(), 1);
+
+	PentaDiagonal d2dx2_1 = d2dx2::nonuniform::c4b0(grid_1);
+	PentaDiagonal d2dx2_2 = d2dx2::nonuniform::c4b4(grid_1);
+	EXPECT_EQ(coefficient_cache::n_evaluations(), 2);
+
+	PentaDiagonal d1dx1_3 = d1dx1::nonuniform::c4b4(grid_2);
+	EXPECT_EQ(coefficient_cache::n_evaluations(), 3);
+	EXPECT_EQ(coefficient_cache::size(), 3);
+
+	// Cached coefficients versus direct evaluation.
+	for (int i = 2; i != (int)grid_1.size() - 2; ++i) {
+
+		const std::vector<double> dx_vector = {
+			grid_1[i - 1] - grid_1[i - 2], grid_1[i] - grid_1[i - 1],
+			grid_1[i + 1] - grid_1[i], grid_1[i + 2] - grid_1[i + 1] };
+
+		const std::vector<double> coef = coef_x1::nonuniform::c4(dx_vector);
+
+		for (int j = 0; j != 5; ++j) {
+			EXPECT_DOUBLE_EQ(d1dx1_2.matrix[j][i], coef[j]);
+		}
+
+	}
+
+	// Concurrent lookups share one entry.
+	const std::vector<double> grid_3 = grid::hyperbolic(-0.4, 0.4, 71);
+	tasks::Scheduler scheduler(4);
+	std::vector<tasks::Future<std::shared_ptr<const coefficient_cache::Diagonals>>> futures;
+	for (int i = 0; i != 8; ++i) {
+		futures.push_back(scheduler.submit([&]() {
+			return coefficient_cache::diagonals(coef_x1::nonuniform::c4, grid_3, 2);
+		}));
+	}
+	for (int i = 0; i != 8; ++i) {
+		EXPECT_EQ(futures[i].get(), futures[0].get());
+	}
+	EXPECT_EQ(coefficient_cache::size(), 4);
+
+	// The oldest entries are discarded first.
+	for (int i = 0; i != coefficient_cache::max_size; ++i) {
+		coefficient_cache::diagonals(coef_x1::nonuniform::c2, grid::hyperbolic(-0.4, 0.4, 21 + i), 1);
+	}
+	EXPECT_EQ(coefficient_cache::size(), coefficient_cache::max_size);
+	const int n_evaluations = coefficient_cache::n_evaluations();
+	coefficient_cache::diagonals(coef_x1::nonuniform::c2, grid::hyperbolic(-0.4, 0.4, 21), 1);
+	EXPECT_EQ(coefficient_cache::n_evaluations(), n_evaluations);
+	coefficient_cache::diagonals(coef_x1::nonuniform::c4, grid_2, 2);
+	EXPECT_EQ(coefficient_cache::n_evaluations(), n_evaluations + 1);
+
+	coefficient_cache::clear();
+	EXPECT_EQ(coefficient_cache::size(), 0);
+
+}
+
+
 TEST(SecondOrderMixedDerivative, Test1) {
 
 	const int n_iterations = 21;
@@ -832,3 +1023,89 @@ TEST(SecondOrderMixedDerivative, Test1) {
 	}
 
 }
+
+
+// Separable prefactors, kept in factored form, should reproduce prefactors
+// on the full grid.
+TEST(SecondOrderMixedDerivative, Separable) {
+
+	const std::vector<double> grid_x = grid::uniform(-1.0, 1.0, 21);
+	const std::vector<double> grid_y = grid::hyperbolic_full(0.0, 2.0, 17, 0.5, 0.2);
+	const std::vector<double> grid_z = grid::uniform(0.0, 1.0, 7);
+
+	std::vector<double> coef_x(grid_x.size(), 0.0);
+	std::vector<double> coef_y(grid_y.size(), 0.0);
+	for (int i = 0; i != grid_x.size(); ++i) {
+		coef_x[i] = 1.0 + grid_x[i] * grid_x[i];
+	}
+	for (int j = 0; j != grid_y.size(); ++j) {
+		coef_y[j] = 0.5 * grid_y[j];
+	}
+
+	// 2-dimensional grid, order (x, y).
+	std::vector<double> func(grid_x.size() * grid_y.size(), 0.0);
+	std::vector<double> prefactors(func.size(), 0.0);
+	int index = 0;
+	for (int i = 0; i != grid_x.size(); ++i) {
+		for (int j = 0; j != grid_y.size(); ++j) {
+			func[index] = std::sin(grid_x[i]) * std::exp(-grid_y[j]);
+			prefactors[index] = coef_x[i] * coef_y[j];
+			++index;
+		}
+	}
+
+	MixedDerivative<TriDiagonal, TriDiagonal> separable(
+		d1dx1::uniform::c2b1(grid_x), d1dx1::nonuniform::c2b1(grid_y));
+	MixedDerivative<TriDiagonal, TriDiagonal> dense = separable;
+
+	separable.set_prefactors(coef_x, coef_y);
+	dense.set_prefactors(prefactors);
+
+	EXPECT_TRUE(separable.separable());
+	EXPECT_FALSE(dense.separable());
+
+	std::vector<double> result_separable = separable.d2dxdy(func);
+	std::vector<double> result_dense = dense.d2dxdy(func);
+
+	for (int i = 0; i != func.size(); ++i) {
+		EXPECT_NEAR(result_separable[i], result_dense[i], 1.0e-12 * (1.0 + std::abs(result_dense[i])));
+	}
+
+	// 3-dimensional grid, order (x, z, y), mixed derivative wrt. (x, y).
+	const std::vector<int> n_points{ (int)grid_x.size(), (int)grid_z.size(), (int)grid_y.size() };
+
+	std::vector<double> func_nd(grid_x.size() * grid_z.size() * grid_y.size(), 0.0);
+	std::vector<double> prefactors_nd(func_nd.size(), 0.0);
+	index = 0;
+	for (int i = 0; i != grid_x.size(); ++i) {
+		for (int k = 0; k != grid_z.size(); ++k) {
+			for (int j = 0; j != grid_y.size(); ++j) {
+				func_nd[index] = std::sin(grid_x[i]) * std::exp(-grid_y[j]) * (1.0 + grid_z[k]);
+				prefactors_nd[index] = coef_x[i] * coef_y[j];
+				++index;
+			}
+		}
+	}
+
+	dense.set_prefactors(prefactors_nd);
+
+	result_separable = separable.d2dxdy(func_nd, n_points, 0, 2);
+	result_dense = dense.d2dxdy(func_nd, n_points, 0, 2);
+
+	for (int i = 0; i != func_nd.size(); ++i) {
+		EXPECT_NEAR(result_separable[i], result_dense[i], 1.0e-12 * (1.0 + std::abs(result_dense[i])));
+	}
+
+	// Scalar prefactor.
+	separable.set_prefactors(0.3);
+	dense.set_prefactors(std::vector<double>(func_nd.size(), 0.3));
+
+	result_separable = separable.d2dxdy(func_nd, n_points, 0, 2);
+	result_dense = dense.d2dxdy(func_nd, n_points, 0, 2);
+
+	for (int i = 0; i != func_nd.size(); ++i) {
+		EXPECT_NEAR(result_separable[i], result_dense[i], 1.0e-12 * (1.0 + std::abs(result_dense[i])));
+	}
+
+}
+
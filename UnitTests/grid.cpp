@@ -0,0 +1,134 @@
+#include "pch.h"
+
+
+TEST(Grid, BuilderHyperbolic) {
+
+	// Single concentration point reproduces hyperbolic grid.
+	const std::vector<double> grid_hyper = grid::hyperbolic_full(0.0, 400.0, 41, 100.0, 0.1);
+
+	const std::vector<double> grid = grid::Builder(0.0, 400.0).concentrate(100.0, 0.1).build(41);
+
+	ASSERT_EQ(grid.size(), grid_hyper.size());
+
+	for (int i = 0; i != grid.size(); ++i) {
+		EXPECT_NEAR(grid[i], grid_hyper[i], 1.0e-10);
+	}
+
+	// Without concentration points the grid is uniform.
+	const std::vector<double> grid_eq = grid::uniform(-1.0, 2.0, 31);
+
+	const std::vector<double> grid_builder = grid::Builder(-1.0, 2.0).build(31);
+
+	for (int i = 0; i != grid_eq.size(); ++i) {
+		EXPECT_NEAR(grid_builder[i], grid_eq[i], 1.0e-12);
+	}
+
+}
+
+
+TEST(Grid, BuilderAlignment) {
+
+	const double spot = 100.0;
+	const double strike = 110.0;
+	const double barrier = 130.0;
+
+	const int n_points = 61;
+
+	const std::vector<double> grid = grid::Builder(0.0, 400.0, 0.2)
+		.concentrate(spot, 0.05)
+		.concentrate(strike, 0.05)
+		.concentrate(barrier, 0.02, 0.5)
+		.align(strike)
+		.align(barrier)
+		.build(n_points);
+
+	ASSERT_EQ(grid.size(), n_points);
+
+	EXPECT_EQ(grid.front(), 0.0);
+	EXPECT_EQ(grid.back(), 400.0);
+
+	for (int i = 0; i != n_points - 1; ++i) {
+		EXPECT_GT(grid[i + 1], grid[i]);
+	}
+
+	EXPECT_TRUE(std::find(grid.begin(), grid.end(), strike) != grid.end());
+	EXPECT_TRUE(std::find(grid.begin(), grid.end(), barrier) != grid.end());
+
+	// Grid points are concentrated around critical points.
+	const double dx_average = 400.0 / (n_points - 1);
+	for (const double x : { spot, strike, barrier }) {
+		const int i = (int)(std::lower_bound(grid.begin(), grid.end(), x) - grid.begin());
+		EXPECT_LT(grid[i] - grid[i - 1], 0.5 * dx_average);
+	}
+
+	// Aligned points too close for number of grid points.
+	EXPECT_THROW(grid::Builder(0.0, 400.0).align(100.0).align(101.0).build(11), std::invalid_argument);
+
+}
+
+
+TEST(Grid, BuilderHierarchy) {
+
+	const int n_points = 21;
+	const int n_levels = 4;
+
+	const std::vector<std::vector<double>> levels = grid::Builder(0.0, 5.0, 0.5)
+		.concentrate(1.0, 0.05)
+		.concentrate(2.0, 0.05)
+		.align(std::log(2.5))
+		.hierarchy(n_points, n_levels);
+
+	ASSERT_EQ(levels.size(), n_levels);
+
+	for (int l = 0; l != n_levels; ++l) {
+
+		EXPECT_EQ(levels[l].size(), ((n_points - 1) << l) + 1);
+
+		EXPECT_TRUE(std::find(levels[l].begin(), levels[l].end(), std::log(2.5)) != levels[l].end());
+
+		for (int i = 0; i != levels[l].size() - 1; ++i) {
+			EXPECT_GT(levels[l][i + 1], levels[l][i]);
+		}
+
+		// Grid points of parent level are reused.
+		if (l > 0) {
+			EXPECT_TRUE(grid::coarsen(levels[l]) == levels[l - 1]);
+		}
+
+	}
+
+	// Without alignment, refined levels coincide with grids built directly.
+	const std::vector<double> grid_fine = grid::Builder(0.0, 5.0, 0.5)
+		.concentrate(1.0, 0.05)
+		.concentrate(2.0, 0.05)
+		.build(2 * n_points - 1);
+
+	const std::vector<double> grid_refined = grid::Builder(0.0, 5.0, 0.5)
+		.concentrate(1.0, 0.05)
+		.concentrate(2.0, 0.05)
+		.hierarchy(n_points, 2)[1];
+
+	for (int i = 0; i != grid_fine.size(); ++i) {
+		EXPECT_NEAR(grid_refined[i], grid_fine[i], 1.0e-12);
+	}
+
+}
+
+
+TEST(Grid, Eigen) {
+
+	const std::vector<double> grid_eq = grid::uniform(-0.4, 0.4, 21);
+	const std::vector<double> grid_exp = grid::exponential(-0.4, 0.4, 21);
+	const std::vector<double> grid_hyper = grid::hyperbolic(-0.4, 0.4, 21);
+
+	const Eigen::VectorXd eigen_eq = grid::eigen::uniform(-0.4, 0.4, 21);
+	const Eigen::VectorXd eigen_exp = grid::eigen::exponential(-0.4, 0.4, 21);
+	const Eigen::VectorXd eigen_hyper = grid::eigen::hyperbolic(-0.4, 0.4, 21);
+
+	for (int i = 0; i != grid_eq.size(); ++i) {
+		EXPECT_EQ(eigen_eq(i), grid_eq[i]);
+		EXPECT_EQ(eigen_exp(i), grid_exp[i]);
+		EXPECT_EQ(eigen_hyper(i), grid_hyper[i]);
+	}
+
+}
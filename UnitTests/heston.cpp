@@ -117,3 +117,61 @@ TEST(CallOption, FD1) {
 	}
 
 }
+
+
+TEST(CallOption, PDE) {
+
+	const double spot_price = 100.0;
+	const double spot_variance = 0.04;
+
+	const double rate = 0.025;
+
+	const double lambda = 1.5;
+	const double theta = 0.04;
+	const double rho = -0.9;
+
+	const double strike = 100.0;
+
+	const double tau = 1.0;
+
+	// Feller condition satisfied and violated, respectively.
+	const std::vector<double> eta{ 0.3, 0.6 };
+	const std::vector<double> tolerance{ 0.01, 0.05 };
+
+	EXPECT_TRUE(heston::pde::feller(lambda, theta, eta[0]));
+	EXPECT_FALSE(heston::pde::feller(lambda, theta, eta[1]));
+
+	const std::vector<double> time_grid = grid::uniform(0.0, tau, 41);
+
+	const std::vector<std::vector<double>> spatial_grid =
+		heston::pde::generator::grid(800.0, 101, strike, 5.0, 51, spot_variance, 0.1, 0.01);
+
+	auto payoff = [strike](const double price) {
+		return std::max(price - strike, 0.0);
+	};
+
+	for (int i = 0; i != eta.size(); ++i) {
+
+		const double call_closed_form = heston::call(
+			spot_price, spot_variance, rate, lambda, theta, eta[i], rho, strike, tau);
+
+		for (const std::string scheme : { "DR", "CS", "MCS", "HV" }) {
+
+			std::vector<double> func = heston::pde::solve(
+				time_grid, spatial_grid, rate, lambda, theta, eta[i], rho, payoff, scheme);
+
+			const double call_pde =
+				heston::pde::interpolate(spatial_grid, func, spot_price, spot_variance);
+
+			EXPECT_NEAR(call_pde, call_closed_form, tolerance[i]);
+
+		}
+
+	}
+
+	EXPECT_THROW(
+		heston::pde::solve(
+			time_grid, spatial_grid, rate, lambda, theta, eta[0], rho, payoff, "XX"),
+		std::invalid_argument);
+
+}
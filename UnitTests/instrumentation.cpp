@@ -0,0 +1,163 @@
+#include "pch.h"
+
+#ifdef NFS_INSTRUMENTATION
+
+
+// Statistics of phase, zero calls if the phase has not been entered.
+instrumentation::PhaseStatistics find_phase(const std::string& name) {
+
+	for (const instrumentation::PhaseStatistics& phase : instrumentation::report()) {
+		if (phase.name == name) {
+			return phase;
+		}
+	}
+
+	return { name, 0, 0.0, 0.0, 0, 0 };
+
+}
+
+
+TEST(Instrumentation, PhaseStatistics) {
+
+	const int n_steps = 10;
+
+	const std::vector<double> time_grid = grid::uniform(0.0, 1.0, n_steps + 1);
+	const std::vector<double> spatial_grid = grid::uniform(0.0, 200.0, 101);
+
+	const std::vector<std::function<TriDiagonal(std::vector<double>)>>
+		deriv{ d1dx1::uniform::c2b2, d2dx2::uniform::c2b1 };
+
+	TriDiagonal derivative =
+		bs::pde::generator::derivative_full<TriDiagonal>(0.03, 0.2, spatial_grid, deriv);
+
+	std::vector<double> func(spatial_grid.size(), 0.0);
+	for (int i = 0; i != spatial_grid.size(); ++i) {
+		func[i] = bs::call::payoff(spatial_grid[i], 100.0);
+	}
+
+	instrumentation::reset();
+
+	propagation::theta_1d::full(time_grid, derivative, func);
+
+	const instrumentation::PhaseStatistics full = find_phase("propagation::theta_1d::full");
+	const instrumentation::PhaseStatistics step_1 = find_phase("propagator::theta_1d::step_1");
+	const instrumentation::PhaseStatistics step_2 = find_phase("propagator::theta_1d::step_2");
+	const instrumentation::PhaseStatistics band = find_phase("solver::band");
+
+	EXPECT_EQ(full.n_calls, 1);
+	EXPECT_EQ(step_1.n_calls, n_steps);
+	EXPECT_EQ(step_2.n_calls, n_steps);
+	EXPECT_EQ(band.n_calls, n_steps);
+
+	// Nested phases are excluded from self time.
+	EXPECT_LE(step_2.self_time, step_2.wall_time);
+	EXPECT_LE(band.wall_time, step_2.wall_time);
+	EXPECT_LE(step_1.wall_time + step_2.wall_time, full.wall_time);
+	EXPECT_NEAR(full.self_time, full.wall_time - step_1.wall_time - step_2.wall_time, 1.0e-9);
+
+	EXPECT_EQ(band.bytes, n_steps * 8 * 101 * (3 + 2));
+
+	EXPECT_NE(instrumentation::summary().find("solver::band"), std::string::npos);
+
+	instrumentation::reset();
+	EXPECT_EQ(find_phase("solver::band").n_calls, 0);
+
+}
+
+
+TEST(Instrumentation, Allocations) {
+
+	instrumentation::reset();
+
+	{
+		NFS_SCOPE("test::allocations");
+
+		Workspace workspace;
+		{
+			Workspace::Frame frame(workspace);
+			workspace.vector(10);
+			workspace.vector(20);
+		}
+		{
+			Workspace::Frame frame(workspace);
+			workspace.vector(10);
+			workspace.vector(20);
+		}
+	}
+
+	const instrumentation::PhaseStatistics phase = find_phase("test::allocations");
+
+	EXPECT_EQ(phase.n_calls, 1);
+	EXPECT_EQ(phase.n_allocations, 2);
+
+}
+
+
+// Statistics of all threads are merged, also after the threads finished.
+TEST(Instrumentation, Threads) {
+
+	const int n_threads = 4;
+	const int n_calls = 5;
+
+	instrumentation::reset();
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i != n_threads; ++i) {
+		threads.emplace_back([]() {
+			for (int n = 0; n != n_calls; ++n) {
+				NFS_SCOPE("test::threads");
+				NFS_COUNT_ALLOCATIONS(1);
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	const instrumentation::PhaseStatistics phase = find_phase("test::threads");
+
+	EXPECT_EQ(phase.n_calls, n_threads * n_calls);
+	EXPECT_EQ(phase.n_allocations, n_threads * n_calls);
+
+	instrumentation::reset();
+	EXPECT_EQ(find_phase("test::threads").n_calls, 0);
+
+}
+
+
+TEST(Instrumentation, ChromeTrace) {
+
+	instrumentation::reset();
+	instrumentation::set_tracing(true);
+
+	for (int i = 0; i != 3; ++i) {
+		NFS_SCOPE("test::trace");
+	}
+
+	instrumentation::set_tracing(false);
+
+	// Not recorded.
+	{
+		NFS_SCOPE("test::trace");
+	}
+
+	instrumentation::write_chrome_trace("trace.json");
+
+	std::ifstream file("trace.json");
+	const std::string content(
+		(std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	EXPECT_EQ(content.find("{\"traceEvents\":["), 0);
+
+	int n_events = 0;
+	for (size_t pos = content.find("test::trace"); pos != std::string::npos;
+		pos = content.find("test::trace", pos + 1)) {
+		++n_events;
+	}
+	EXPECT_EQ(n_events, 3);
+	EXPECT_EQ(find_phase("test::trace").n_calls, 4);
+
+}
+
+
+#endif
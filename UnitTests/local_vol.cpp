@@ -0,0 +1,131 @@
+#include "pch.h"
+
+
+namespace {
+
+	const std::vector<std::function<TriDiagonal(std::vector<double>)>>
+		deriv{ d1dx1::uniform::c2b2, d2dx2::uniform::c2b1 };
+
+}
+
+
+TEST(LocalVol, Surface) {
+
+	// variance = 0.01 * (1 + time) * (1 + spot / 100) on a 2 x 3 grid.
+	const std::vector<double> times{ 0.0, 1.0 };
+	const std::vector<double> spots{ 50.0, 100.0, 150.0 };
+	const std::vector<double> variance{ 0.015, 0.02, 0.025, 0.03, 0.04, 0.05 };
+
+	const local_vol::Surface surface(times, spots, variance);
+
+	EXPECT_DOUBLE_EQ(surface.variance(0.5, 75.0), 0.01 * 1.5 * 1.75);
+	EXPECT_DOUBLE_EQ(surface.vol(1.0, 100.0), 0.2);
+	EXPECT_EQ(surface.row(1)[2], 0.05);
+
+	// Flat beyond grid.
+	EXPECT_DOUBLE_EQ(surface.variance(2.0, 200.0), 0.05);
+	EXPECT_DOUBLE_EQ(surface.variance(-1.0, 10.0), 0.015);
+
+	// Rows.
+	std::vector<double> row(3, 0.0);
+	surface.variance(0.25, row);
+	for (int j = 0; j != 3; ++j) {
+		EXPECT_DOUBLE_EQ(row[j], surface.variance(0.25, spots[j]));
+	}
+	surface.variance(1.0, row);
+	EXPECT_EQ(row, std::vector<double>(variance.begin() + 3, variance.end()));
+
+	EXPECT_THROW(local_vol::Surface(times, spots, { 0.04 }), std::invalid_argument);
+	EXPECT_THROW(local_vol::Surface({ 1.0, 0.0 }, spots, variance), std::invalid_argument);
+
+}
+
+
+TEST(LocalVol, Dupire) {
+
+	const curve::ZeroCurve curve({ 1.0, 5.0 }, { 0.02, 0.04 }, curve::Interpolation::monotone_convex);
+	const double spot = 100.0;
+
+	const std::vector<double> times = grid::uniform(0.0, 2.0, 11);
+	const std::vector<double> spots = grid::uniform(0.0, 300.0, 31);
+
+	// Flat implied volatility.
+	const local_vol::Surface flat = local_vol::dupire(
+		[](const double, const double) { return 0.2; }, spot, curve, times, spots);
+
+	for (int i = 0; i != times.size(); ++i) {
+		for (int j = 0; j != spots.size(); ++j) {
+			EXPECT_NEAR(flat.row(i)[j], 0.04, 1.0e-8);
+		}
+	}
+
+	// Term structure, total implied variance w = a * T + b * T^2, gives
+	// local variance a + 2 * b * t.
+	const double a = 0.04;
+	const double b = 0.01;
+	const local_vol::Surface term = local_vol::dupire(
+		[a, b](const double maturity, const double) { return std::sqrt(a + b * maturity); },
+		spot, 0.03, times, spots);
+
+	for (int i = 1; i != times.size(); ++i) {
+		EXPECT_NEAR(term.variance(times[i], 120.0), a + 2.0 * b * times[i], 1.0e-8);
+	}
+
+	// Smile: Local volatility is steeper than implied volatility, and
+	// equals it at the money for short maturities.
+	const local_vol::ImpliedVol implied = local_vol::sabr(spot, curve, 2.0, 0.4, 0.5, -0.3);
+	const local_vol::Surface smile = local_vol::dupire(implied, spot, curve, times, spots);
+
+	EXPECT_NEAR(smile.vol(0.0, spot), implied(0.002, spot), 1.0e-3);
+	EXPECT_GT(smile.vol(1.0, 80.0) - smile.vol(1.0, 120.0), implied(1.0, 80.0) - implied(1.0, 120.0));
+
+}
+
+
+TEST(LocalVol, Pde) {
+
+	const double spot = 100.0;
+	const double rate = 0.03;
+	const double tau = 1.0;
+
+	const std::vector<double> time_grid = grid::uniform(0.0, tau, 201);
+	const std::vector<double> spatial_grid = grid::uniform(0.0, 400.0, 801);
+	const std::vector<double> times = grid::uniform(0.0, tau, 51);
+
+	// Flat local volatility reproduces Black-Scholes PDE.
+	const local_vol::Surface flat = local_vol::dupire(
+		[](const double, const double) { return 0.2; }, spot, rate, times, spatial_grid);
+
+	const double strike = 105.0;
+	auto payoff = [strike](const double s) { return std::max(s - strike, 0.0); };
+
+	const std::vector<double> func = local_vol::pde::solve<TriDiagonal>(
+		time_grid, spatial_grid, flat, rate, payoff, deriv);
+
+	const curve::ZeroCurve curve({ 1.0 }, { rate });
+	const std::vector<double> func_bs = bs::pde::solve<TriDiagonal>(
+		time_grid, spatial_grid, curve, 0.2, payoff, deriv);
+
+	for (int j = 0; j != spatial_grid.size(); ++j) {
+		EXPECT_NEAR(func[j], func_bs[j], 1.0e-6);
+	}
+	EXPECT_NEAR(func[200], bs::call::price(spot, rate, 0.2, strike, tau), 1.0e-2);
+
+	// SABR smile: Local volatility prices reprice the implied volatilities.
+	const local_vol::ImpliedVol implied = local_vol::sabr(spot, curve, 2.0, 0.4, 0.5, -0.3);
+	const local_vol::Surface smile = local_vol::dupire(implied, spot, curve, times, spatial_grid);
+
+	for (double k = 80.0; k <= 120.0; k += 10.0) {
+
+		const std::vector<double> solution = local_vol::pde::solve<TriDiagonal>(
+			time_grid, spatial_grid, smile, curve,
+			[k](const double s) { return std::max(s - k, 0.0); }, deriv);
+
+		EXPECT_NEAR(solution[200], bs::call::price(spot, rate, implied(tau, k), k, tau), 5.0e-2);
+
+	}
+
+	EXPECT_THROW(local_vol::pde::solve<TriDiagonal>(
+		time_grid, grid::uniform(0.0, 400.0, 401), smile, curve, payoff, deriv), std::invalid_argument);
+
+}
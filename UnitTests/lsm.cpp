@@ -0,0 +1,107 @@
+#include "pch.h"
+
+
+TEST(Lsm, Simulation) {
+
+	const double spot = 100.0;
+	const double rate = 0.05;
+	const double dividend = 0.02;
+	const std::vector<double> times = grid::uniform(0.0, 1.0, 5);
+
+	const lsm::Paths paths = lsm::simulate(
+		{ spot, spot }, rate, { dividend, 0.0 }, { 0.2, 0.3 }, { { 1.0, 0.5 }, { 0.5, 1.0 } }, times, 100000);
+
+	EXPECT_EQ(paths.n_assets(), 2);
+	EXPECT_EQ(paths.n_paths(), 100000);
+	EXPECT_EQ(paths.n_dates(), 5);
+
+	// Forward prices, and correlation of log-returns.
+	const int n = paths.n_paths();
+	const double* s0 = paths.spots(4, 0);
+	const double* s1 = paths.spots(4, 1);
+
+	double mean0 = 0.0;
+	double mean1 = 0.0;
+	double cov = 0.0;
+	double var0 = 0.0;
+	double var1 = 0.0;
+	for (int p = 0; p != n; ++p) {
+		mean0 += s0[p] / n;
+		mean1 += s1[p] / n;
+		const double r0 = std::log(s0[p] / spot) - (rate - dividend - 0.02);
+		const double r1 = std::log(s1[p] / spot) - (rate - 0.045);
+		cov += r0 * r1 / n;
+		var0 += r0 * r0 / n;
+		var1 += r1 * r1 / n;
+	}
+
+	EXPECT_NEAR(mean0, spot * std::exp(rate - dividend), 0.2);
+	EXPECT_NEAR(mean1, spot * std::exp(rate), 0.3);
+	EXPECT_NEAR(cov / std::sqrt(var0 * var1), 0.5, 0.01);
+
+	EXPECT_THROW(lsm::simulate({ spot }, rate, { 0.0 }, { 0.2 }, {}, times, 101), std::invalid_argument);
+
+}
+
+
+TEST(Lsm, American) {
+
+	// American put, Longstaff and Schwartz (2001), Table 1: 4.472 (finite
+	// difference), with 50 exercise dates per year.
+	const double strike = 40.0;
+	const double rate = 0.06;
+	const std::vector<double> times = grid::uniform(0.0, 1.0, 51);
+
+	const lsm::Paths paths = lsm::simulate({ 36.0 }, rate, { 0.0 }, { 0.2 }, {}, times, 100000);
+
+	const double american = lsm::price(paths, rate, lsm::put(strike));
+	EXPECT_NEAR(american, 4.472, 0.05);
+
+	// Early exercise premium over the European put.
+	const double european = bs::put::price(36.0, rate, 0.2, strike, 1.0);
+	EXPECT_GT(american - european, 0.5);
+
+	// Monomial basis.
+	lsm::Options options;
+	options.basis = regression::Basis::monomial;
+	EXPECT_NEAR(lsm::price(paths, rate, lsm::put(strike), options), 4.472, 0.05);
+
+	// Exercise now or at expiry only: Maximum of intrinsic and European value.
+	const lsm::Paths european_paths = lsm::simulate({ 36.0 }, rate, { 0.0 }, { 0.2 }, {}, { 0.0, 1.0 }, 100000);
+	EXPECT_EQ(lsm::price(european_paths, rate, lsm::put(strike)), strike - 36.0);
+	const lsm::Paths otm_paths = lsm::simulate({ 44.0 }, rate, { 0.0 }, { 0.2 }, {}, { 0.0, 1.0 }, 100000);
+	EXPECT_NEAR(lsm::price(otm_paths, rate, lsm::put(strike)),
+		bs::put::price(44.0, rate, 0.2, strike, 1.0), 0.03);
+
+	// Deep in the money: Immediate exercise.
+	const lsm::Paths deep_paths = lsm::simulate({ 10.0 }, rate, { 0.0 }, { 0.2 }, {}, times, 10000);
+	EXPECT_EQ(lsm::price(deep_paths, rate, lsm::put(strike)), strike - 10.0);
+
+	// Call without dividends: Early exercise is never optimal.
+	EXPECT_NEAR(lsm::price(paths, rate, lsm::call(strike)),
+		bs::call::price(36.0, rate, 0.2, strike, 1.0), 0.05);
+
+}
+
+
+TEST(Lsm, MaxCall) {
+
+	// Bermudan max-call on two assets, Andersen and Broadie (2004),
+	// Table 2: 13.90 (spot 100, 9 exercise dates).
+	const double rate = 0.05;
+	const std::vector<double> times = grid::uniform(0.0, 3.0, 10);
+
+	const lsm::Paths paths = lsm::simulate(
+		{ 100.0, 100.0 }, rate, { 0.1, 0.1 }, { 0.2, 0.2 }, {}, times, 100000);
+
+	lsm::Options single;
+	single.n_threads = 1;
+	const double price = lsm::price(paths, rate, lsm::max_call(100.0), single);
+	EXPECT_NEAR(price, 13.90, 0.2);
+
+	// Threads do not change the price beyond rounding.
+	lsm::Options multi;
+	multi.n_threads = 4;
+	EXPECT_NEAR(lsm::price(paths, rate, lsm::max_call(100.0), multi), price, 1.0e-6);
+
+}
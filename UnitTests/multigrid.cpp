@@ -0,0 +1,199 @@
+#include "pch.h"
+
+
+// Convection-diffusion operators with mixed derivative terms on N-dimensional
+// uniform grid. Convection and mixed derivative terms vanish at the boundary,
+// and the second order derivative operators have vanishing boundary rows.
+void multigrid_operators(
+	const std::vector<double>& grid,
+	const int n_dimensions,
+	const double correlation,
+	std::vector<TriDiagonal>& derivatives,
+	std::vector<MixedDerivative<TriDiagonal, TriDiagonal>>& mixed) {
+
+	const int n_points = (int)grid.size();
+
+	int n_total = 1;
+	for (int i = 0; i != n_dimensions; ++i) {
+		n_total *= n_points;
+	}
+
+	derivatives.clear();
+	for (int i = 0; i != n_dimensions; ++i) {
+		std::vector<double> drift(n_points, 0.3 - 0.2 * i);
+		drift.front() = 0.0;
+		drift.back() = 0.0;
+		TriDiagonal derivative = d2dx2::uniform::c2b0(grid);
+		derivative *= 0.4 - 0.1 * i;
+		derivative += d1dx1::uniform::c2b1(grid).pre_vector(drift);
+		derivatives.push_back(derivative);
+	}
+
+	mixed.clear();
+	for (int i = 0; i != n_dimensions; ++i) {
+		for (int j = i + 1; j != n_dimensions; ++j) {
+			std::vector<double> prefactors(n_total, correlation * std::sqrt((0.4 - 0.1 * i) * (0.4 - 0.1 * j)));
+			for (int k = 0; k != n_total; ++k) {
+				int index = k;
+				for (int d = n_dimensions - 1; d != -1; --d) {
+					if (index % n_points == 0 || index % n_points == n_points - 1) {
+						prefactors[k] = 0.0;
+					}
+					index /= n_points;
+				}
+			}
+			MixedDerivative<TriDiagonal, TriDiagonal> term(
+				d1dx1::uniform::c2b1(grid), d1dx1::uniform::c2b1(grid));
+			term.set_prefactors(prefactors);
+			mixed.push_back(term);
+		}
+	}
+
+}
+
+
+// Multigrid solver on [-1, 1]^N, see multigrid_operators. Coarsest level has
+// 9 points per dimension.
+Multigrid<TriDiagonal> multigrid_generator(
+	const int n_points,
+	const int n_dimensions,
+	const double correlation) {
+
+	Multigrid<TriDiagonal> solver;
+
+	std::vector<double> grid_1d = grid::uniform(-1.0, 1.0, n_points);
+
+	std::vector<TriDiagonal> derivatives;
+	std::vector<MixedDerivative<TriDiagonal, TriDiagonal>> mixed;
+
+	while (true) {
+
+		multigrid_operators(grid_1d, n_dimensions, correlation, derivatives, mixed);
+		solver.add_level(std::vector<std::vector<double>>(n_dimensions, grid_1d), derivatives, mixed);
+
+		if (grid_1d.size() <= 9) {
+			break;
+		}
+
+		grid_1d = grid::coarsen(grid_1d);
+
+	}
+
+	return solver;
+
+}
+
+
+// Gaussian on N-dimensional grid, [-1, 1]^N.
+std::vector<double> gaussian_nd(
+	const int n_points,
+	const int n_dimensions) {
+
+	const std::vector<double> grid_1d = grid::uniform(-1.0, 1.0, n_points);
+
+	int n_total = 1;
+	for (int i = 0; i != n_dimensions; ++i) {
+		n_total *= n_points;
+	}
+
+	std::vector<double> func(n_total, 0.0);
+	for (int k = 0; k != n_total; ++k) {
+		double exponent = 0.0;
+		int index = k;
+		for (int i = n_dimensions - 1; i != -1; --i) {
+			const double x = grid_1d[index % n_points];
+			exponent -= (2.0 + i) * x * x;
+			index /= n_points;
+		}
+		func[k] = std::exp(exponent);
+	}
+
+	return func;
+
+}
+
+
+// Multigrid V-cycles and BiCGSTAB should converge with mesh-independent
+// number of iterations, also for strong correlation.
+TEST(Multigrid, Convergence2D) {
+
+	std::vector<int> n_iterations;
+	std::vector<int> n_iterations_bicgstab;
+
+	for (const int n_points : { 33, 65, 129 }) {
+
+		Multigrid<TriDiagonal> solver = multigrid_generator(n_points, 2, 0.9);
+		solver.assemble(0.5 * 0.5);
+
+		const std::vector<double> func = gaussian_nd(n_points, 2);
+
+		std::vector<double> x(func.size(), 0.0);
+		n_iterations.push_back(solver.solve(func, x));
+		EXPECT_LE(solver.relative_residual(), 1.0e-10);
+
+		std::vector<double> x_bicgstab(func.size(), 0.0);
+		n_iterations_bicgstab.push_back(solver.solve_bicgstab(func, x_bicgstab));
+		EXPECT_LE(solver.relative_residual(), 1.0e-10);
+
+		for (int i = 0; i != x.size(); ++i) {
+			EXPECT_NEAR(x[i], x_bicgstab[i], 1.0e-8);
+		}
+
+	}
+
+	for (int i = 0; i != n_iterations.size(); ++i) {
+		EXPECT_LE(n_iterations[i], 20);
+		EXPECT_LE(n_iterations_bicgstab[i], n_iterations[i]);
+		EXPECT_LE(std::abs(n_iterations[i] - n_iterations[0]), 2);
+	}
+
+}
+
+
+TEST(Multigrid, Convergence3D) {
+
+	Multigrid<TriDiagonal> solver = multigrid_generator(33, 3, 0.5);
+	solver.assemble(0.5 * 0.5);
+
+	const std::vector<double> func = gaussian_nd(33, 3);
+
+	std::vector<double> x(func.size(), 0.0);
+	EXPECT_LE(solver.solve(func, x), 20);
+	EXPECT_LE(solver.relative_residual(), 1.0e-10);
+
+	std::vector<double> x_bicgstab(func.size(), 0.0);
+	EXPECT_LE(solver.solve_bicgstab(func, x_bicgstab), 10);
+	EXPECT_LE(solver.relative_residual(), 1.0e-10);
+
+}
+
+
+// Fully implicit Crank-Nicolson and Craig-Sneyd should agree for small time steps.
+TEST(Multigrid, ThetaScheme) {
+
+	const int n_points = 65;
+	const double dt = 0.001;
+
+	Multigrid<TriDiagonal> solver = multigrid_generator(n_points, 2, 0.5);
+
+	const std::vector<double> grid_1d = grid::uniform(-1.0, 1.0, n_points);
+
+	std::vector<TriDiagonal> derivative;
+	std::vector<MixedDerivative<TriDiagonal, TriDiagonal>> mixed_nd;
+	multigrid_operators(grid_1d, 2, 0.5, derivative, mixed_nd);
+
+	const std::vector<TriDiagonal> identity(2, derivative[0].identity());
+
+	std::vector<double> func_mg = gaussian_nd(n_points, 2);
+	std::vector<double> func_cs = func_mg;
+
+	for (int n = 0; n != 10; ++n) {
+		EXPECT_LE(propagator::implicit::theta_nd(dt, solver, func_mg), 10);
+		propagator::adi::cs_nd(dt, identity, derivative, mixed_nd, func_cs);
+	}
+
+	for (int i = 0; i != func_mg.size(); ++i) {
+		EXPECT_NEAR(func_mg[i], func_cs[i], 1.0e-5);
+	}
+
+}
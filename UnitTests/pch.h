@@ -16,23 +16,39 @@
 
 #include "gtest/gtest.h"
 
+#include "band_diagonal_batch.h"
+#include "band_diagonal_factorized.h"
 #include "band_diagonal_matrix.h"
+#include "coefficient_cache.h"
 #include "coefficients.h"
 #include "convergence.h"
 #include "derivatives.h"
 #include "distributions.h"
+#include "fused_operator.h"
 #include "grid.h"
 #include "heat_equation.h"
+#include "instrumentation.h"
 #include "matrix_equation_solver.h"
+#include "multigrid.h"
 #include "norm.h"
+#include "parallel.h"
 #include "propagation.h"
 #include "propagator.h"
 #include "regression.h"
+#include "scheduler.h"
+#include "sparse_matrix.h"
 
 // Models
 #include "BlackScholesUtility.h"
 #include "HestonUtility.h"
 #include "SabrUtility.h"
+#include "VasicekUtility.h"
+#include "curve.h"
+#include "instrument.h"
+#include "local_vol.h"
+#include "lsm.h"
+#include "portfolio.h"
 
 #include "test_util.h"
 #include "utility.h"
+#include "workspace.h"
@@ -0,0 +1,134 @@
+#include "pch.h"
+
+
+namespace {
+
+	// Mixed portfolio: closed form, batched 1-dimensional PDEs on two grids,
+	// and 2-dimensional PDEs.
+	std::vector<portfolio::Trade> mixed_portfolio() {
+
+		std::vector<portfolio::Trade> trades;
+
+		for (int i = 0; i != 40; ++i) {
+
+			portfolio::Trade t;
+			t.strike = 80.0 + i;
+			t.call = i % 2 == 0;
+			t.rate = 0.03;
+			t.sigma = 0.2 + 0.002 * i;
+			t.variance = 0.04;
+			t.lambda = 2.0;
+			t.theta = 0.04;
+			t.eta = 0.3;
+			t.rho = -0.7;
+
+			if (i % 4 == 0) {
+				t.kind = portfolio::Kind::bs_closed_form;
+			}
+			else if (i % 4 == 1) {
+				t.kind = portfolio::Kind::heston_closed_form;
+			}
+			else if (i % 4 == 2) {
+				t.kind = portfolio::Kind::bs_pde;
+				t.n_points_s = i % 8 == 2 ? 401 : 201;
+			}
+			else if (i % 8 == 3) {
+				t.call = true;
+				t.kind = portfolio::Kind::heston_pde;
+				t.n_points_s = 81;
+				t.n_points_v = 41;
+				t.n_steps = 40;
+			}
+			else {
+				t.kind = portfolio::Kind::bs_closed_form;
+			}
+
+			trades.push_back(t);
+
+		}
+
+		return trades;
+
+	}
+
+}
+
+
+TEST(Portfolio, Prices) {
+
+	const std::vector<portfolio::Trade> trades = mixed_portfolio();
+
+	tasks::Scheduler scheduler(4);
+
+	portfolio::Statistics statistics;
+	const std::vector<double> prices = portfolio::price(trades, scheduler, statistics);
+
+	for (int i = 0; i != trades.size(); ++i) {
+
+		const portfolio::Trade& t = trades[i];
+
+		if (t.kind == portfolio::Kind::bs_closed_form) {
+			const double expected = t.call
+				? bs::call::price(t.spot, t.rate, t.sigma, t.strike, t.tau)
+				: bs::put::price(t.spot, t.rate, t.sigma, t.strike, t.tau);
+			EXPECT_EQ(prices[i], expected);
+		}
+		else if (t.kind == portfolio::Kind::bs_pde) {
+			const double expected = t.call
+				? bs::call::price(t.spot, t.rate, t.sigma, t.strike, t.tau)
+				: bs::put::price(t.spot, t.rate, t.sigma, t.strike, t.tau);
+			EXPECT_NEAR(prices[i], expected, 2.0e-2);
+		}
+		else {
+			const double expected = t.call
+				? heston::call(t.spot, t.variance, t.rate, t.lambda, t.theta, t.eta, t.rho, t.strike, t.tau)
+				: heston::put(t.spot, t.variance, t.rate, t.lambda, t.theta, t.eta, t.rho, t.strike, t.tau);
+			const double tolerance = t.kind == portfolio::Kind::heston_pde ? 0.1 : 0.0;
+			EXPECT_NEAR(prices[i], expected, tolerance);
+		}
+
+	}
+
+	// Each Heston closed form trade exceeds the grain and closes a chunk of
+	// closed form trades (10 + remainder); 10 BS PDEs on two grids; 5 Heston PDEs.
+	EXPECT_EQ(statistics.n_trades, 40);
+	EXPECT_EQ(statistics.n_batches, 2);
+	EXPECT_EQ(statistics.n_jobs, 11 + 2 + 5);
+	EXPECT_EQ(statistics.busy_time.size(), 4);
+	EXPECT_GE(statistics.imbalance, 0.0);
+	EXPECT_GE(statistics.tail_time, 0.0);
+	EXPECT_LE(statistics.tail_time, statistics.wall_time);
+	EXPECT_GT(statistics.utilization, 0.0);
+	EXPECT_LE(statistics.utilization, 1.0);
+	EXPECT_NE(portfolio::summary(statistics).find("Imbalance"), std::string::npos);
+
+	// Same prices with static partitioning.
+	portfolio::Options options;
+	options.schedule = portfolio::Schedule::static_partition;
+	EXPECT_EQ(portfolio::price(trades, scheduler, options), prices);
+
+}
+
+
+TEST(Portfolio, Cost) {
+
+	portfolio::Trade t;
+	const portfolio::CostModel model;
+
+	t.kind = portfolio::Kind::bs_pde;
+	const double cost_1d = portfolio::cost(t, model);
+	EXPECT_DOUBLE_EQ(cost_1d, model.bs_pde * t.n_points_s * t.n_steps);
+
+	t.n_steps *= 2;
+	EXPECT_DOUBLE_EQ(portfolio::cost(t, model), 2.0 * cost_1d);
+
+	t.kind = portfolio::Kind::heston_pde;
+	const double cost_hv = portfolio::cost(t, model);
+	t.scheme = "DR";
+	EXPECT_LT(portfolio::cost(t, model), cost_hv);
+	EXPECT_GT(cost_hv, portfolio::cost(portfolio::Trade(), model));
+
+	t.scheme = "ADI";
+	EXPECT_THROW(portfolio::cost(t, model), std::invalid_argument);
+
+}
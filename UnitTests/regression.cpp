@@ -0,0 +1,122 @@
+#include "pch.h"
+
+
+namespace {
+
+	// Observations on a uniform 2D grid in [1, 2] x [0.5, 3].
+	std::vector<std::vector<double>> regressors(const int n) {
+
+		std::vector<std::vector<double>> x(2, std::vector<double>(n * n, 0.0));
+		for (int i = 0; i != n; ++i) {
+			for (int j = 0; j != n; ++j) {
+				x[0][i * n + j] = 1.0 + i / (n - 1.0);
+				x[1][i * n + j] = 0.5 + 2.5 * j / (n - 1.0);
+			}
+		}
+		return x;
+
+	}
+
+	double polynomial(const double x, const double y) {
+		return 1.0 - 2.0 * x + 0.5 * y + 3.0 * x * y - x * x + 0.25 * y * y * y;
+	}
+
+}
+
+
+TEST(Regression, LeastSquares) {
+
+	// Terms of total degree <= 3 in two regressors.
+	const regression::LeastSquares cubic(2, 3);
+	EXPECT_EQ(cubic.n_terms(), 10);
+	EXPECT_EQ(cubic.powers()[0], std::vector<int>({ 0, 0 }));
+	EXPECT_EQ(cubic.powers()[1], std::vector<int>({ 1, 0 }));
+	EXPECT_EQ(cubic.powers()[2], std::vector<int>({ 0, 1 }));
+	EXPECT_EQ(cubic.powers()[9], std::vector<int>({ 0, 3 }));
+	EXPECT_EQ(regression::LeastSquares(3, 2).n_terms(), 10);
+
+	// Polynomials in the span of the basis are recovered exactly.
+	const std::vector<std::vector<double>> x = regressors(30);
+	std::vector<double> y(x[0].size(), 0.0);
+	for (int i = 0; i != y.size(); ++i) {
+		y[i] = polynomial(x[0][i], x[1][i]);
+	}
+
+	for (const regression::Basis basis : { regression::Basis::monomial, regression::Basis::laguerre }) {
+
+		regression::LeastSquares ls(2, 3, basis);
+		ls.fit(x, y);
+
+		const std::vector<double> fitted = ls.predict(x);
+		for (int i = 0; i != y.size(); ++i) {
+			EXPECT_NEAR(fitted[i], y[i], 1.0e-10);
+		}
+
+		// Out of sample.
+		const std::vector<double> point = ls.predict({ { 1.3 }, { 2.2 } });
+		EXPECT_NEAR(point[0], polynomial(1.3, 2.2), 1.0e-10);
+
+	}
+
+	// Zero weights exclude observations.
+	std::vector<double> weights(y.size(), 1.0);
+	std::vector<double> y_corrupt = y;
+	for (int i = 0; i != y.size(); i += 3) {
+		weights[i] = 0.0;
+		y_corrupt[i] += 100.0;
+	}
+	regression::LeastSquares weighted(2, 3);
+	weighted.fit(x, y_corrupt, weights);
+	EXPECT_NEAR(weighted.predict({ { 1.3 }, { 2.2 } })[0], polynomial(1.3, 2.2), 1.0e-10);
+
+	// Simple linear regression.
+	const std::vector<double> x_slr{ 0.0, 1.0, 2.0, 3.0 };
+	const std::vector<double> y_slr{ 1.0, 2.9, 5.2, 6.9 };
+	regression::LeastSquares linear(1, 1);
+	linear.fit({ x_slr }, y_slr);
+	const std::vector<double> slr = regression::slr(x_slr, y_slr);
+	for (int i = 0; i != x_slr.size(); ++i) {
+		EXPECT_NEAR(linear.predict({ { x_slr[i] } })[0], slr[0] * x_slr[i] + slr[1], 1.0e-12);
+	}
+
+	// Fewer observations than basis functions.
+	EXPECT_THROW(regression::LeastSquares(2, 3).fit({ { 1.0, 2.0 }, { 1.0, 2.0 } }, { 1.0, 2.0 }),
+		std::invalid_argument);
+
+}
+
+
+TEST(Regression, Threads) {
+
+	EXPECT_EQ(regression::n_threads(regression::thread_threshold - 1, 8), 1);
+	EXPECT_EQ(regression::n_threads(1 << 20, 4), 4);
+	EXPECT_EQ(regression::n_threads(regression::thread_threshold, 8),
+		regression::thread_threshold / regression::observations_per_thread_min);
+
+	// Noisy data, larger than the thread threshold.
+	const std::vector<std::vector<double>> x = regressors(200);
+	std::vector<double> y(x[0].size(), 0.0);
+	for (int i = 0; i != y.size(); ++i) {
+		y[i] = polynomial(x[0][i], x[1][i]) + std::sin(1.0e3 * i);
+	}
+
+	for (const regression::Basis basis : { regression::Basis::monomial, regression::Basis::laguerre }) {
+
+		regression::LeastSquares single(2, 4, basis);
+		single.fit(x, y, {}, 1);
+		const std::vector<double> fitted = single.predict(x);
+
+		// Partial sums are added in a different order; fitted values agree to
+		// rounding, amplified by the condition number of the Gram matrix.
+		for (const int n_threads : { 2, 3, 4 }) {
+			regression::LeastSquares multi(2, 4, basis);
+			multi.fit(x, y, {}, n_threads);
+			const std::vector<double> fitted_multi = multi.predict(x);
+			for (int i = 0; i < (int)y.size(); i += 97) {
+				EXPECT_NEAR(fitted_multi[i], fitted[i], 1.0e-7);
+			}
+		}
+
+	}
+
+}
@@ -0,0 +1,288 @@
+#include "pch.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+
+namespace {
+
+	// Gate blocking jobs until opened.
+	class Gate {
+
+	private:
+
+		std::mutex mutex_;
+		std::condition_variable opened_;
+		bool open_ = false;
+
+	public:
+
+		void wait() {
+			std::unique_lock<std::mutex> lock(mutex_);
+			opened_.wait(lock, [this]() { return open_; });
+		}
+
+		void open() {
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				open_ = true;
+			}
+			opened_.notify_all();
+		}
+
+	};
+
+}
+
+
+TEST(Scheduler, Futures) {
+
+	const std::vector<double> time_grid = grid::uniform(0.0, 1.0, 21);
+	const std::vector<double> spatial_grid = grid::uniform(0.0, 200.0, 101);
+
+	const std::vector<std::function<TriDiagonal(std::vector<double>)>>
+		deriv{ d1dx1::uniform::c2b2, d2dx2::uniform::c2b1 };
+
+	// Synchronous solution.
+	std::vector<std::vector<double>> expected;
+	for (int i = 0; i != 8; ++i) {
+		const double strike = 80.0 + 5.0 * i;
+		TriDiagonal derivative =
+			bs::pde::generator::derivative_full<TriDiagonal>(0.03, 0.2, spatial_grid, deriv);
+		std::vector<double> func(spatial_grid.size());
+		for (int j = 0; j != spatial_grid.size(); ++j) {
+			func[j] = bs::call::payoff(spatial_grid[j], strike);
+		}
+		propagation::theta_1d::full(time_grid, derivative, func);
+		expected.push_back(func);
+	}
+
+	tasks::Scheduler scheduler(4);
+
+	std::vector<tasks::Future<std::vector<double>>> futures;
+	for (int i = 0; i != 8; ++i) {
+		const double strike = 80.0 + 5.0 * i;
+		futures.push_back(scheduler.submit([&, strike]() {
+			TriDiagonal derivative =
+				bs::pde::generator::derivative_full<TriDiagonal>(0.03, 0.2, spatial_grid, deriv);
+			std::vector<double> func(spatial_grid.size());
+			for (int j = 0; j != spatial_grid.size(); ++j) {
+				func[j] = bs::call::payoff(spatial_grid[j], strike);
+			}
+			propagation::theta_1d::full(time_grid, derivative, func);
+			return func;
+		}));
+	}
+
+	for (int i = 0; i != 8; ++i) {
+		EXPECT_EQ(futures[i].get(), expected[i]);
+		EXPECT_EQ(futures[i].status(), tasks::Status::done);
+	}
+
+	// Exceptions are rethrown by get.
+	tasks::Future<double> failed = scheduler.submit([]() -> double {
+		throw std::invalid_argument("Failed.");
+	});
+	EXPECT_THROW(failed.get(), std::invalid_argument);
+	EXPECT_EQ(failed.status(), tasks::Status::failed);
+
+	// Jobs returning void.
+	std::atomic<int> n_runs(0);
+	tasks::Future<void> done = scheduler.submit([&]() { ++n_runs; });
+	done.get();
+	EXPECT_EQ(n_runs, 1);
+	EXPECT_EQ(done.status(), tasks::Status::done);
+	tasks::Future<void> failed_void = scheduler.submit([]() {
+		throw std::invalid_argument("Failed.");
+	});
+	EXPECT_THROW(failed_void.get(), std::invalid_argument);
+
+	// Completion callback.
+	std::atomic<int> n_callbacks(0);
+	tasks::Future<int> future = scheduler.submit([]() { return 1; });
+	future.then([&]() { ++n_callbacks; });
+	future.wait();
+	scheduler.wait_idle();
+	future.then([&]() { ++n_callbacks; });
+	EXPECT_EQ(n_callbacks, 2);
+
+}
+
+
+TEST(Scheduler, Priorities) {
+
+	tasks::Scheduler scheduler(1);
+
+	Gate gate;
+	scheduler.submit([&]() { gate.wait(); return 0; });
+
+	std::mutex mutex;
+	std::vector<int> order;
+	auto record = [&](const int i) {
+		return [&, i]() {
+			std::lock_guard<std::mutex> lock(mutex);
+			order.push_back(i);
+			return i;
+		};
+	};
+
+	scheduler.submit(record(2), tasks::Priority::low);
+	scheduler.submit(record(1), tasks::Priority::normal);
+	scheduler.submit(record(0), tasks::Priority::high);
+	scheduler.submit(record(3), tasks::Priority::low);
+
+	gate.open();
+	scheduler.wait_idle();
+
+	EXPECT_EQ(order, std::vector<int>({ 0, 1, 2, 3 }));
+
+}
+
+
+TEST(Scheduler, Cancellation) {
+
+	tasks::Scheduler scheduler(1);
+
+	Gate gate;
+	std::atomic<bool> started(false);
+
+	// Running job, cancelled cooperatively.
+	tasks::Future<int> running = scheduler.submit([&]() {
+		started = true;
+		gate.wait();
+		if (tasks::Scheduler::cancellation_requested()) {
+			throw tasks::Cancelled();
+		}
+		return 0;
+	});
+
+	std::atomic<bool> executed(false);
+	tasks::Future<int> pending = scheduler.submit([&]() { executed = true; return 1; });
+
+	while (!started) {
+		std::this_thread::yield();
+	}
+
+	// Pending jobs finish immediately.
+	EXPECT_TRUE(pending.cancel());
+	EXPECT_TRUE(pending.done());
+	EXPECT_THROW(pending.get(), tasks::Cancelled);
+
+	EXPECT_FALSE(running.cancel());
+	gate.open();
+	EXPECT_THROW(running.get(), tasks::Cancelled);
+
+	scheduler.wait_idle();
+	EXPECT_FALSE(executed);
+	EXPECT_FALSE(tasks::Scheduler::cancellation_requested());
+
+}
+
+
+TEST(Scheduler, CapacityAndStealing) {
+
+	const int n_threads = 4;
+	tasks::Scheduler scheduler(n_threads, 2);
+
+	// Jobs submitted by a job are queued on its worker, idle workers steal.
+	std::mutex mutex;
+	std::vector<std::thread::id> threads;
+	Gate gate;
+
+	tasks::Future<int> parent = scheduler.submit([&]() {
+		for (int i = 0; i != 4 * n_threads; ++i) {
+			scheduler.submit([&]() {
+				gate.wait();
+				std::lock_guard<std::mutex> lock(mutex);
+				threads.push_back(std::this_thread::get_id());
+				return 0;
+			});
+		}
+		return 0;
+	});
+	parent.get();
+
+	// Nested submission is not bounded.
+	EXPECT_GT(scheduler.n_queued(), scheduler.capacity());
+
+	// Each worker blocks on one job.
+	while (scheduler.n_queued() != 3 * n_threads) {
+		std::this_thread::yield();
+	}
+
+	gate.open();
+	scheduler.wait_idle();
+
+	std::sort(threads.begin(), threads.end());
+	const int n_distinct = (int)(std::unique(threads.begin(), threads.end()) - threads.begin());
+	EXPECT_EQ(threads.size(), 4 * n_threads);
+	EXPECT_EQ(n_distinct, n_threads);
+
+	// External submission blocks while full.
+	Gate block;
+	for (int i = 0; i != n_threads; ++i) {
+		scheduler.submit([&]() { block.wait(); return 0; });
+	}
+	while (scheduler.n_queued() != 0) {
+		std::this_thread::yield();
+	}
+	scheduler.submit([]() { return 0; });
+	scheduler.submit([]() { return 0; });
+
+	std::atomic<bool> submitted(false);
+	std::thread producer([&]() {
+		scheduler.submit([]() { return 0; });
+		submitted = true;
+	});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	EXPECT_FALSE(submitted);
+
+	block.open();
+	producer.join();
+	EXPECT_TRUE(submitted);
+	scheduler.wait_idle();
+
+}
+
+
+TEST(Scheduler, ParallelRanges) {
+
+	// Ranges cover [0, n) once, with aligned boundaries.
+	const int n = 1000;
+	std::vector<int> count(n, 0);
+	std::vector<int> thread_of(n, -1);
+	parallel::for_ranges(n, 4, 64, [&](const int thread, const int begin, const int end) {
+		EXPECT_EQ(begin % 64, 0);
+		for (int i = begin; i != end; ++i) {
+			++count[i];
+			thread_of[i] = thread;
+		}
+	});
+	EXPECT_EQ(count, std::vector<int>(n, 1));
+	EXPECT_EQ(thread_of.front(), 0);
+	EXPECT_EQ(thread_of.back(), 3);
+
+	// Exceptions are rethrown on the calling thread.
+	EXPECT_THROW(parallel::for_ranges(n, 4, 1, [](const int thread, const int, const int) {
+		if (thread == 2) {
+			throw std::invalid_argument("Failed.");
+		}
+	}), std::invalid_argument);
+
+	EXPECT_EQ(parallel::n_threads(100, 1000, 10), 1);
+	EXPECT_EQ(parallel::n_threads(1 << 20, 1000, 10, 3), 3);
+	EXPECT_FALSE(parallel::nested());
+
+	// Loops within scheduler jobs run on the worker only.
+	tasks::Scheduler scheduler(2);
+	tasks::Future<int> future = scheduler.submit([&]() {
+		int n_ranges = 0;
+		parallel::for_ranges(n, 4, 1, [&](const int, const int, const int) { ++n_ranges; });
+		return 10 * parallel::n_threads(1 << 20, 1000, 10) + n_ranges;
+	});
+	EXPECT_EQ(future.get(), 11);
+
+}
@@ -0,0 +1,230 @@
+#include "pch.h"
+
+
+// CSR conversion should reproduce band-diagonal matrix-vector product.
+template <class T>
+void sparse_conversion_test(T derivative) {
+
+	const int n = derivative.order();
+
+	std::vector<double> vector(n, 0.0);
+	for (int i = 0; i != n; ++i) {
+		vector[i] = std::sin(0.3 * i) + 0.1 * i;
+	}
+
+	const std::vector<double> expected = derivative * vector;
+	const std::vector<double> result = SparseMatrix(derivative) * vector;
+
+	for (int i = 0; i != n; ++i) {
+		EXPECT_NEAR(result[i], expected[i], 1.0e-12 * (1.0 + std::abs(expected[i])));
+	}
+
+}
+
+
+TEST(SparseMatrix, BandConversion) {
+
+	const std::vector<double> grid = grid::uniform(0.0, 1.0, 41);
+	const std::vector<double> grid_nonuniform = grid::hyperbolic_full(0.0, 1.0, 41, 0.5, 0.1);
+
+	sparse_conversion_test(d1dx1::uniform::c2b1(grid));
+	sparse_conversion_test(d2dx2::uniform::c2b1(grid));
+	sparse_conversion_test(d2dx2::nonuniform::c2b1(grid_nonuniform));
+
+	sparse_conversion_test(d1dx1::uniform::c4b2(grid));
+	sparse_conversion_test(d2dx2::uniform::c4b4(grid));
+	sparse_conversion_test(d1dx1::nonuniform::c4b4(grid_nonuniform));
+
+}
+
+
+// Assembled generator should reproduce strip-wise actions, in CSR and
+// SELL-C-sigma format, sequentially and concurrently.
+TEST(SparseMatrix, Generator) {
+
+	for (const int n_dimensions : { 2, 3 }) {
+
+		const std::vector<double> grid_x = grid::uniform(-1.0, 1.0, 21);
+		const std::vector<double> grid_y = grid::hyperbolic_full(-1.0, 1.0, 17, 0.2, 0.3);
+		const std::vector<double> grid_z = grid::uniform(0.0, 1.0, 11);
+
+		std::vector<std::vector<double>> grids{ grid_x, grid_y, grid_z };
+		grids.resize(n_dimensions);
+
+		std::vector<int> n_points;
+		int n_total = 1;
+		for (const std::vector<double>& grid : grids) {
+			n_points.push_back((int)grid.size());
+			n_total *= (int)grid.size();
+		}
+
+		std::vector<PentaDiagonal> derivatives;
+		for (int i = 0; i != n_dimensions; ++i) {
+			PentaDiagonal derivative = d2dx2::nonuniform::c4b4(grids[i]);
+			derivative *= 0.4 - 0.1 * i;
+			derivative += (0.2 - 0.1 * i) * d1dx1::nonuniform::c4b4(grids[i]);
+			derivatives.push_back(derivative);
+		}
+
+		std::vector<MixedDerivative<PentaDiagonal, PentaDiagonal>> mixed;
+		for (int i = 0; i != n_dimensions; ++i) {
+			for (int j = i + 1; j != n_dimensions; ++j) {
+				MixedDerivative<PentaDiagonal, PentaDiagonal> term(
+					d1dx1::nonuniform::c4b4(grids[i]), d1dx1::nonuniform::c4b4(grids[j]));
+				std::vector<double> prefactors(n_total, 0.0);
+				for (int k = 0; k != n_total; ++k) {
+					prefactors[k] = 0.1 * (i + j) + 0.01 * (k % 7);
+				}
+				term.set_prefactors(prefactors);
+				mixed.push_back(term);
+			}
+		}
+
+		std::vector<double> func(n_total, 0.0);
+		for (int k = 0; k != n_total; ++k) {
+			func[k] = std::cos(0.01 * k) + 0.001 * k;
+		}
+
+		std::vector<double> expected = d2dxdy_nd(n_points, mixed, func);
+		for (int j = 0; j != n_dimensions; ++j) {
+			const std::vector<double> tmp = action_nd(n_points, j, false, derivatives[j], func);
+			for (int k = 0; k != n_total; ++k) {
+				expected[k] += tmp[k];
+			}
+		}
+
+		const SparseMatrix generator = sparse::generator(n_points, derivatives, mixed);
+
+		std::vector<std::vector<double>> results;
+
+		results.push_back(generator * func);
+
+		std::vector<double> result;
+		generator.multiply(func, result, 4);
+		results.push_back(result);
+
+		for (const int chunk : { 1, 4, 8 }) {
+			for (const int sigma : { 1, 64 }) {
+				const SlicedEllpack sell(generator, chunk, sigma);
+				results.push_back(sell * func);
+				sell.multiply(func, result, 3);
+				results.push_back(result);
+			}
+		}
+
+		// ELLPACK.
+		results.push_back(SlicedEllpack(generator, n_total, 1) * func);
+
+		for (const std::vector<double>& r : results) {
+			ASSERT_EQ(r.size(), n_total);
+			for (int k = 0; k != n_total; ++k) {
+				EXPECT_NEAR(r[k], expected[k], 1.0e-9 * (1.0 + std::abs(expected[k])));
+			}
+		}
+
+	}
+
+}
+
+
+// Explicit Euler steps with assembled generator, in CSR and SELL-C-sigma
+// format, versus Craig-Sneyd scheme with theta = lambda = 0.
+TEST(SparseMatrix, ExplicitEuler) {
+
+	const double dt = 0.0005;
+
+	const std::vector<std::vector<double>> grids{
+		grid::uniform(-1.0, 1.0, 21), grid::hyperbolic_full(-1.0, 1.0, 17, 0.2, 0.3) };
+
+	std::vector<int> n_points;
+	int n_total = 1;
+	for (const std::vector<double>& grid : grids) {
+		n_points.push_back((int)grid.size());
+		n_total *= (int)grid.size();
+	}
+
+	std::vector<TriDiagonal> identity;
+	std::vector<TriDiagonal> derivatives;
+	for (int i = 0; i != 2; ++i) {
+		TriDiagonal derivative = d2dx2::nonuniform::c2b0(grids[i]);
+		derivative *= 0.4 - 0.1 * i;
+		derivative += (0.2 - 0.1 * i) * d1dx1::nonuniform::c2b1(grids[i]);
+		derivatives.push_back(derivative);
+		identity.push_back(derivative.identity());
+	}
+
+	std::vector<MixedDerivative<TriDiagonal, TriDiagonal>> mixed{
+		MixedDerivative<TriDiagonal, TriDiagonal>(
+			d1dx1::nonuniform::c2b1(grids[0]), d1dx1::nonuniform::c2b1(grids[1])) };
+	mixed[0].set_prefactors(std::vector<double>(n_total, 0.1));
+
+	std::vector<double> expected(n_total, 0.0);
+	for (int k = 0; k != n_total; ++k) {
+		const double x = grids[0][k / n_points[1]];
+		const double y = grids[1][k % n_points[1]];
+		expected[k] = std::exp(-2.0 * x * x - 3.0 * y * y);
+	}
+
+	const SparseMatrix generator = sparse::generator(n_points, derivatives, mixed);
+	const SlicedEllpack sell(generator);
+
+	std::vector<double> func_csr = expected;
+	std::vector<double> func_sell = expected;
+
+	Workspace workspace;
+
+	for (int n = 0; n != 10; ++n) {
+		propagator::assembled::euler_nd(dt, generator, func_csr, workspace);
+		propagator::assembled::euler_nd(dt, sell, func_sell, workspace);
+		propagator::adi::cs_nd(dt, identity, derivatives, mixed, expected, 0.0, 0.0);
+	}
+
+	// Scratch memory is allocated in the first step only.
+	EXPECT_EQ(workspace.n_allocations(), 1);
+	EXPECT_EQ(workspace.position(), 0);
+
+	for (int k = 0; k != n_total; ++k) {
+		EXPECT_NEAR(func_csr[k], expected[k], 1.0e-12);
+		EXPECT_NEAR(func_sell[k], expected[k], 1.0e-12);
+	}
+
+	std::vector<double> func_short(n_total - 1, 0.0);
+	EXPECT_THROW(propagator::assembled::euler_nd(dt, generator, func_short, workspace), std::invalid_argument);
+
+}
+
+
+TEST(SparseMatrix, Kronecker) {
+
+	const std::vector<double> grid = grid::uniform(0.0, 1.0, 5);
+
+	const SparseMatrix a(d1dx1::uniform::c2b1(grid));
+	const SparseMatrix b(d2dx2::uniform::c2b1(grid));
+
+	const SparseMatrix product = sparse::kronecker(a, b);
+
+	EXPECT_EQ(product.n_rows(), 25);
+	EXPECT_EQ(product.n_nonzeros(), a.n_nonzeros() * b.n_nonzeros());
+
+	// (a (x) b) * (u (x) v) = (a * u) (x) (b * v).
+	const std::vector<double> u{ 1.0, 2.0, -1.0, 0.5, 3.0 };
+	const std::vector<double> v{ 0.2, -1.0, 4.0, 1.0, 2.0 };
+
+	std::vector<double> uv(25, 0.0);
+	for (int i = 0; i != 5; ++i) {
+		for (int j = 0; j != 5; ++j) {
+			uv[i * 5 + j] = u[i] * v[j];
+		}
+	}
+
+	const std::vector<double> au = a * u;
+	const std::vector<double> bv = b * v;
+	const std::vector<double> result = product * uv;
+
+	for (int i = 0; i != 5; ++i) {
+		for (int j = 0; j != 5; ++j) {
+			EXPECT_NEAR(result[i * 5 + j], au[i] * bv[j], 1.0e-9);
+		}
+	}
+
+}
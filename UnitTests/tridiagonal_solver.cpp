@@ -872,6 +872,462 @@ TEST(TriDiagonalSolver, HeatEquation2D_new) {
 
 
 
+TEST(TriDiagonalSolver, HeatEquation2D_MCS_HV) {
+
+	// Initial time grid.
+	std::vector<double> time_grid = grid::uniform(0.0, 0.03, 201);
+
+	// Initial spatial grid.
+	std::vector<double> spatial_grid_x = grid::uniform(0.0, 1.0, 11);
+	std::vector<double> spatial_grid_y = grid::uniform(0.0, 1.0, 201);
+	std::vector<std::vector<double>> spatial_grid{ spatial_grid_x, spatial_grid_y };
+
+	// Order of solution.
+	const std::vector<int> inner_order(2, 1);
+	const std::vector<std::vector<int>> order(1, inner_order);
+
+	// Prefactors.
+	const std::vector<double> inner_prefactor(2, 1.0);
+	const std::vector<std::vector<double>> prefactor(1, inner_prefactor);
+
+	// Diffusivity.
+	const double diffusivity = 1.0;
+
+	std::function<std::vector<double>
+		(const double, const std::vector<std::vector<double>>&)>
+		solution_generator = heat_eq::solution_func(
+			order,
+			prefactor,
+			diffusivity
+		);
+
+	std::vector<std::function<TriDiagonal(std::vector<double>)>>
+		deriv_1{ d1dx1::uniform::c2b1, d2dx2::uniform::c2b0 };
+	std::vector<std::function<TriDiagonal(std::vector<double>)>>
+		deriv_2{ d1dx1::uniform::c2b1, d2dx2::uniform::c2b0 };
+
+	// Modified Craig-Sneyd.
+	{
+		std::vector<double> time_grid_tmp = time_grid;
+		std::vector<std::vector<double>> spatial_grid_tmp = spatial_grid;
+
+		std::vector<std::vector<double>>
+			norm = convergence::adi::mcs_2d<TriDiagonal, TriDiagonal>(
+				time_grid_tmp,
+				spatial_grid_tmp,
+				grid::uniform,
+				prefactor_generator,
+				prefactor_generator,
+				mixed_prefactor_generator,
+				deriv_1,
+				deriv_2,
+				solution_generator,
+				"space_1",
+				11,
+				5);
+
+		std::vector<double> result = linear_regression(norm, true);
+
+		// Maximum norm.
+		EXPECT_NEAR(result[0], 2.0, 0.050);
+
+		// L1 function norm.
+		EXPECT_NEAR(result[3], 2.0, 0.055);
+
+	}
+
+	// Hundsdorfer-Verwer.
+	{
+		std::vector<double> time_grid_tmp = time_grid;
+		std::vector<std::vector<double>> spatial_grid_tmp = spatial_grid;
+
+		std::vector<std::vector<double>>
+			norm = convergence::adi::hv_2d<TriDiagonal, TriDiagonal>(
+				time_grid_tmp,
+				spatial_grid_tmp,
+				grid::uniform,
+				prefactor_generator,
+				prefactor_generator,
+				mixed_prefactor_generator,
+				deriv_1,
+				deriv_2,
+				solution_generator,
+				"space_1",
+				11,
+				5);
+
+		std::vector<double> result = linear_regression(norm, true);
+
+		// Maximum norm.
+		EXPECT_NEAR(result[0], 2.0, 0.050);
+
+		// L1 function norm.
+		EXPECT_NEAR(result[3], 2.0, 0.055);
+
+	}
+
+}
+
+
+// N-dimensional ADI schemes applied to 2-dimensional problem should 
+// reproduce the 2-dimensional schemes.
+TEST(TriDiagonalSolver, AdiND) {
+
+	std::vector<double> time_grid = grid::uniform(0.0, 0.1, 11);
+
+	std::vector<double> grid_x = grid::uniform(-1.0, 1.0, 31);
+	std::vector<double> grid_y = grid::uniform(-1.0, 1.0, 21);
+
+	// Convection-diffusion operators.
+	TriDiagonal derivative_1 = d2dx2::uniform::c2b1(grid_x);
+	derivative_1 *= 0.4;
+	derivative_1 += 0.3 * d1dx1::uniform::c2b2(grid_x);
+
+	TriDiagonal derivative_2 = d2dx2::uniform::c2b1(grid_y);
+	derivative_2 *= 0.2;
+	derivative_2 += -0.1 * d1dx1::uniform::c2b2(grid_y);
+
+	std::vector<TriDiagonal> derivative{ derivative_1, derivative_2 };
+
+	MixedDerivative<TriDiagonal, TriDiagonal> mixed(
+		d1dx1::uniform::c2b2(grid_x), d1dx1::uniform::c2b2(grid_y));
+	mixed.set_prefactors(0.15);
+
+	std::vector<MixedDerivative<TriDiagonal, TriDiagonal>> mixed_nd{ mixed };
+
+	std::vector<double> func_initial(grid_x.size() * grid_y.size(), 0.0);
+	int index = 0;
+	for (int i = 0; i != grid_x.size(); ++i) {
+		for (int j = 0; j != grid_y.size(); ++j) {
+			func_initial[index] = std::exp(-4.0 * grid_x[i] * grid_x[i] - 2.0 * grid_y[j] * grid_y[j]);
+			++index;
+		}
+	}
+
+	std::vector<double> func_2d;
+	std::vector<double> func_nd;
+
+	// Douglas-Rachford.
+	func_2d = func_initial;
+	func_nd = func_initial;
+	propagation::adi::dr_2d(time_grid, derivative_1, derivative_2, func_2d);
+	propagation::adi::dr_nd(time_grid, derivative, func_nd);
+	for (int i = 0; i != func_2d.size(); ++i) {
+		EXPECT_NEAR(func_2d[i], func_nd[i], 1.0e-12);
+	}
+
+	// Craig-Sneyd.
+	func_2d = func_initial;
+	func_nd = func_initial;
+	propagation::adi::cs_2d(time_grid, derivative_1, derivative_2, mixed, func_2d);
+	propagation::adi::cs_nd(time_grid, derivative, mixed_nd, func_nd);
+	for (int i = 0; i != func_2d.size(); ++i) {
+		EXPECT_NEAR(func_2d[i], func_nd[i], 1.0e-12);
+	}
+
+	// Modified Craig-Sneyd.
+	func_2d = func_initial;
+	func_nd = func_initial;
+	propagation::adi::mcs_2d(time_grid, derivative_1, derivative_2, mixed, func_2d);
+	propagation::adi::mcs_nd(time_grid, derivative, mixed_nd, func_nd);
+	for (int i = 0; i != func_2d.size(); ++i) {
+		EXPECT_NEAR(func_2d[i], func_nd[i], 1.0e-12);
+	}
+
+	// Hundsdorfer-Verwer.
+	func_2d = func_initial;
+	func_nd = func_initial;
+	propagation::adi::hv_2d(time_grid, derivative_1, derivative_2, mixed, func_2d);
+	propagation::adi::hv_nd(time_grid, derivative, mixed_nd, func_nd);
+	for (int i = 0; i != func_2d.size(); ++i) {
+		EXPECT_NEAR(func_2d[i], func_nd[i], 1.0e-12);
+	}
+
+}
+
+
+// Pre-assembled operators should reproduce action_2d.
+TEST(TriDiagonalSolver, FusedOperator) {
+
+	const std::vector<double> grid_s = grid::hyperbolic_full(0.0, 400.0, 41, 100.0, 0.1);
+	const std::vector<double> grid_v = grid::hyperbolic_full(0.0, 2.0, 21, 0.04, 0.05);
+	const std::vector<std::vector<double>> spatial_grid{ grid_s, grid_v };
+
+	const int n_s = (int)grid_s.size();
+	const int n_v = (int)grid_v.size();
+
+	std::vector<std::vector<double>> prefactors_s =
+		heston::pde::generator::prefactor_s(0.03, spatial_grid);
+	std::vector<std::vector<double>> prefactors_v =
+		heston::pde::generator::prefactor_v(0.03, 1.5, 0.04, 0.3, spatial_grid);
+
+	std::vector<TriDiagonal> derivatives_s = heston::pde::generator::derivatives_s(grid_s);
+	std::vector<TriDiagonal> derivatives_v = 
+		heston::pde::generator::derivatives_v(grid_v, 1.5, 0.04, 0.3);
+
+	FusedOperator<TriDiagonal> operator_s(n_s, n_v, 1, prefactors_s, derivatives_s);
+	FusedOperator<TriDiagonal> operator_v(n_v, n_s, 2, prefactors_v, derivatives_v);
+
+	std::vector<double> func(n_s * n_v, 0.0);
+	for (int i = 0; i != func.size(); ++i) {
+		func[i] = std::cos(0.1 * i) + 0.01 * i;
+	}
+
+	std::vector<double> expected;
+	std::vector<double> result;
+
+	for (const std::vector<double>& adi_factors : 
+		std::vector<std::vector<double>>{ { 0.0, 1.0 }, { 1.0, 0.01 }, { 1.0, -0.01 } }) {
+
+		for (const bool solve_equation : { false, true }) {
+
+			expected = action_2d(n_s, n_v, 1, solve_equation, adi_factors, prefactors_s, derivatives_s, func);
+			result = action_2d(solve_equation, adi_factors, operator_s, func);
+			for (int i = 0; i != func.size(); ++i) {
+				EXPECT_NEAR(result[i], expected[i], 1.0e-10 * (1.0 + std::abs(expected[i])));
+			}
+
+			expected = action_2d(n_v, n_s, 2, solve_equation, adi_factors, prefactors_v, derivatives_v, func);
+			result = action_2d(solve_equation, adi_factors, operator_v, func);
+			for (int i = 0; i != func.size(); ++i) {
+				EXPECT_NEAR(result[i], expected[i], 1.0e-10 * (1.0 + std::abs(expected[i])));
+			}
+
+		}
+
+	}
+
+}
+
+
+// Theta-scheme system (I - dt * derivative) x = column, with a smooth
+// right-hand-side and the reference solution from solver::band.
+template <class T>
+struct ThetaSystem {
+
+	ThetaSystem(
+		const T& derivative,
+		const double dt,
+		const double frequency = 0.3,
+		const double slope = 0.1,
+		const double phase = 0.0) : lhs(derivative) {
+
+		lhs *= -dt;
+		lhs += lhs.identity();
+
+		column.resize(lhs.order());
+		for (int i = 0; i != column.size(); ++i) {
+			column[i] = std::cos(frequency * i + phase) + slope * i;
+		}
+
+		expected = column;
+		T matrix = lhs;
+		solver::band(matrix, expected);
+
+	}
+
+	T lhs;
+	std::vector<double> column;
+	std::vector<double> expected;
+
+};
+
+
+// Element-wise comparison with relative error tolerance.
+void expect_relative_near(
+	const std::vector<double>& result,
+	const std::vector<double>& expected,
+	const double tolerance) {
+
+	ASSERT_EQ(result.size(), expected.size());
+	for (int i = 0; i != expected.size(); ++i) {
+		EXPECT_NEAR(result[i], expected[i], tolerance * (1.0 + std::abs(expected[i])));
+	}
+
+}
+
+
+// Factorized matrix equation solver versus solver::band.
+template <class T>
+void factorized_solver_test(const T& derivative) {
+
+	const FactorizedBandDiagonal factorized(ThetaSystem<T>(derivative, 0.001).lhs);
+
+	// Repeated solves reuse the same factorization.
+	for (int n = 0; n != 3; ++n) {
+
+		const ThetaSystem<T> system(derivative, 0.001, 0.3, 0.1, n);
+
+		std::vector<double> result = system.column;
+		factorized.solve(result);
+
+		expect_relative_near(result, system.expected, 1.0e-10);
+
+	}
+
+}
+
+
+TEST(BandDiagonalSolver, Factorized) {
+
+	const std::vector<double> grid = grid::uniform(0.0, 1.0, 21);
+	const std::vector<double> grid_nonuniform = grid::hyperbolic_full(0.0, 1.0, 21, 0.5, 0.1);
+
+	factorized_solver_test(d1dx1::uniform::c2b1(grid));
+	factorized_solver_test(d1dx1::uniform::c2b2(grid));
+	factorized_solver_test(d2dx2::uniform::c2b0(grid));
+	factorized_solver_test(d2dx2::uniform::c2b1(grid));
+	factorized_solver_test(d2dx2::uniform::c2b2(grid));
+	factorized_solver_test(d1dx1::nonuniform::c2b1(grid_nonuniform));
+	factorized_solver_test(d2dx2::nonuniform::c2b1(grid_nonuniform));
+
+	factorized_solver_test(d1dx1::uniform::c4b2(grid));
+	factorized_solver_test(d2dx2::uniform::c4b0(grid));
+	factorized_solver_test(d2dx2::uniform::c4b4(grid));
+	factorized_solver_test(d1dx1::nonuniform::c4b2(grid_nonuniform));
+	factorized_solver_test(d1dx1::nonuniform::c4b4(grid_nonuniform));
+	factorized_solver_test(d2dx2::nonuniform::c4b4(grid_nonuniform));
+
+}
+
+
+// Boundary row elimination: Solve lhs * x = lhs * column.
+template <class T>
+void boundary_elimination_test(const T& derivative) {
+
+	ThetaSystem<T> system(derivative, 0.001);
+
+	std::vector<double> result = system.lhs * system.column;
+
+	T matrix = system.lhs;
+	solver::band(matrix, result);
+
+	expect_relative_near(result, system.column, 1.0e-10);
+
+}
+
+
+TEST(BandDiagonalSolver, BoundaryElimination) {
+
+	const std::vector<double> grid = grid::uniform(0.0, 1.0, 21);
+	const std::vector<double> grid_nonuniform = grid::hyperbolic_full(0.0, 1.0, 21, 0.5, 0.1);
+
+	boundary_elimination_test(d1dx1::uniform::c2b2(grid));
+	boundary_elimination_test(d2dx2::nonuniform::c2b2(grid_nonuniform));
+
+	boundary_elimination_test(d1dx1::uniform::c4b4(grid));
+	boundary_elimination_test(d2dx2::uniform::c4b4(grid));
+	boundary_elimination_test(d1dx1::nonuniform::c4b4(grid_nonuniform));
+	boundary_elimination_test(d2dx2::nonuniform::c4b4(grid_nonuniform));
+
+}
+
+
+// Mixed-precision solver versus double precision solver. Relative error
+// tolerance before and after refinement.
+template <class T>
+void mixed_precision_solver_test(
+	const T& derivative,
+	const double tolerance_single = 1.0e-3,
+	const double tolerance_refined = 1.0e-11,
+	const int n_refinements = 2) {
+
+	const ThetaSystem<T> system(derivative, 0.001);
+
+	// Single precision, no refinement.
+	std::vector<double> result = system.column;
+	MixedPrecisionBandDiagonal(system.lhs, 0).solve(result);
+	expect_relative_near(result, system.expected, tolerance_single);
+
+	// Iterative refinement.
+	result = system.column;
+	MixedPrecisionBandDiagonal(system.lhs, n_refinements).solve(result);
+	expect_relative_near(result, system.expected, tolerance_refined);
+
+}
+
+
+TEST(BandDiagonalSolver, MixedPrecision) {
+
+	const std::vector<double> grid = grid::uniform(0.0, 1.0, 101);
+	const std::vector<double> grid_nonuniform = grid::hyperbolic_full(0.0, 1.0, 101, 0.5, 0.1);
+
+	mixed_precision_solver_test(d1dx1::uniform::c2b1(grid));
+	mixed_precision_solver_test(d2dx2::uniform::c2b1(grid));
+	mixed_precision_solver_test(d2dx2::nonuniform::c2b1(grid_nonuniform));
+
+	mixed_precision_solver_test(d1dx1::uniform::c4b2(grid));
+	mixed_precision_solver_test(d2dx2::uniform::c4b0(grid));
+	// Condition number ~1e6 with boundary elimination: Larger errors, and
+	// more refinement steps.
+	mixed_precision_solver_test(d2dx2::uniform::c4b4(grid), 5.0e-2, 1.0e-8, 6);
+	mixed_precision_solver_test(d1dx1::uniform::c4b4(grid));
+	mixed_precision_solver_test(d1dx1::nonuniform::c4b2(grid_nonuniform));
+	mixed_precision_solver_test(d1dx1::nonuniform::c4b4(grid_nonuniform));
+
+}
+
+
+// Cyclic reduction and partition solvers versus sequential solver.
+template <class T>
+void parallel_solver_test(const T& derivative) {
+
+	const ThetaSystem<T> system(derivative, 0.0007, 0.03, 0.001);
+
+	std::vector<double> result = system.column;
+	T matrix = system.lhs;
+	solver::cyclic_reduction(matrix, result);
+
+	expect_relative_near(result, system.expected, 1.0e-10);
+
+	for (const int n_partitions : { 1, 2, 3, 7 }) {
+
+		result = system.column;
+		matrix = system.lhs;
+		solver::partition(matrix, result, n_partitions);
+
+		expect_relative_near(result, system.expected, 1.0e-10);
+
+	}
+
+}
+
+
+TEST(BandDiagonalSolver, CyclicReductionPartition) {
+
+	for (const int n_points : { 1000, 1001 }) {
+
+		const std::vector<double> grid = grid::uniform(0.0, 1.0, n_points);
+		const std::vector<double> grid_nonuniform = grid::hyperbolic_full(0.0, 1.0, n_points, 0.5, 0.1);
+
+		parallel_solver_test(d1dx1::uniform::c2b1(grid));
+		parallel_solver_test(d2dx2::uniform::c2b1(grid));
+		parallel_solver_test(d2dx2::nonuniform::c2b1(grid_nonuniform));
+
+		parallel_solver_test(d1dx1::uniform::c4b2(grid));
+		parallel_solver_test(d2dx2::uniform::c4b0(grid));
+		parallel_solver_test(d1dx1::nonuniform::c4b2(grid_nonuniform));
+
+	}
+
+	// Levels of 1 << 15 equations may be reduced concurrently. Step size as above.
+	const std::vector<double> grid = grid::uniform(0.0, 32.0, (1 << 15) + 1);
+	parallel_solver_test(d2dx2::uniform::c2b1(grid));
+	parallel_solver_test(d2dx2::uniform::c4b0(grid));
+
+	EXPECT_EQ(solver::n_partitions(solver::partition_threshold - 1), 1);
+	EXPECT_EQ(solver::n_cyclic_reduction_threads(solver::cyclic_reduction_threshold - 1), 1);
+
+	// Solvers called from scheduler jobs do not partition.
+	tasks::Scheduler scheduler(2);
+	tasks::Future<int> future = scheduler.submit([]() {
+		return solver::n_partitions(1 << 20) + solver::n_cyclic_reduction_threads(1 << 20);
+	});
+	EXPECT_EQ(future.get(), 2);
+
+}
+
+
 // Prefactors C * f(grid_1) * g(grid_2) * ... for 1st and 2nd order derivatives.
 std::vector<std::vector<double>> prefactor_generator_heston_s(
 	const std::vector<std::vector<double>>& grid,
@@ -1258,6 +1714,53 @@ TEST(TriDiagonalSolver, BlackScholesCall_new) {
 
 
 
+TEST(TriDiagonalSolver, BlackScholesCallBatch) {
+
+	const double tau = 1.0;
+
+	// Initial time grid.
+	std::vector<double> time_grid = grid::uniform(0.0, tau, 101);
+
+	// Spatial grid.
+	std::vector<double> spatial_grid = grid::uniform(0.0, 200.0, 101);
+
+	std::vector<std::function<TriDiagonal(std::vector<double>)>>
+		deriv{ d1dx1::uniform::c2b2, d2dx2::uniform::c2b1 };
+
+	// Batch of 11 problems; the last group of lanes is incomplete.
+	std::vector<bs::pde::Parameters> parameters;
+	for (int i = 0; i != 11; ++i) {
+		const double rate = 0.01 + 0.005 * i;
+		const double sigma = 0.15 + 0.01 * i;
+		const double strike = 90.0 + 2.0 * i;
+		parameters.push_back({ rate, sigma,
+			[strike](const double spot) { return bs::call::payoff(spot, strike); } });
+	}
+
+	std::vector<std::vector<double>> func_batch =
+		bs::pde::batch<TriDiagonal>(time_grid, spatial_grid, parameters, deriv, 0.5, 4);
+
+	for (int i = 0; i != parameters.size(); ++i) {
+
+		TriDiagonal derivative = bs::pde::generator::derivative_full<TriDiagonal>(
+			parameters[i].rate, parameters[i].sigma, spatial_grid, deriv);
+
+		std::vector<double> func(spatial_grid.size(), 0.0);
+		for (int j = 0; j != spatial_grid.size(); ++j) {
+			func[j] = parameters[i].payoff(spatial_grid[j]);
+		}
+
+		propagation::theta_1d::full(time_grid, derivative, func, 0.5);
+
+		for (int j = 0; j != spatial_grid.size(); ++j) {
+			EXPECT_NEAR(func_batch[i][j], func[j], 1.0e-9);
+		}
+
+	}
+
+}
+
+
 // TODO: Should be time-dependent!!!
 // Prefactors C * f(grid_1) * g(grid_2) * ... for 1st and 2nd order derivatives.
 std::vector<std::vector<double>> prefactor_generator_sabr_s(
@@ -0,0 +1,123 @@
+#include "pch.h"
+
+
+namespace {
+
+	const double rate = 0.03;
+	const double kappa = 0.5;
+	const double theta = 0.04;
+	const double sigma = 0.01;
+
+	// Annual coupon bonds, and options on these.
+	std::vector<vasicek::Claim> claims() {
+
+		std::vector<vasicek::Claim> claims;
+
+		for (int maturity = 1; maturity != 11; ++maturity) {
+
+			vasicek::Claim bond;
+			for (int i = 1; i <= maturity; ++i) {
+				bond.times.push_back((double)i);
+				bond.cash_flows.push_back(0.04);
+			}
+			bond.cash_flows.back() += 1.0;
+			claims.push_back(bond);
+
+			if (maturity > 2) {
+				vasicek::Claim option = bond;
+				option.option = true;
+				option.call = maturity % 2 == 0;
+				option.expiry = 1.5;
+				option.strike = vasicek::price({ bond }, rate, kappa, theta, sigma)[0] * 1.02;
+				claims.push_back(option);
+			}
+
+		}
+
+		return claims;
+
+	}
+
+}
+
+
+TEST(Vasicek, ZeroCouponBond) {
+
+	const std::vector<double> maturities{ 0.5, 1.0, 2.0, 5.0, 10.0 };
+	const std::vector<double> prices =
+		vasicek::zcb::price(rate, 0.0, maturities, kappa, theta, sigma);
+
+	for (int i = 0; i != maturities.size(); ++i) {
+		EXPECT_LT(prices[i], 1.0);
+		EXPECT_DOUBLE_EQ(prices[i],
+			vasicek::zcb::price(rate, 0.0, maturities[i], kappa, theta, sigma));
+	}
+
+	// Put-call parity, C - P = P(0, maturity) - K * P(0, expiry).
+	const double strike = 0.85;
+	const double call = vasicek::zcb::call(rate, 0.0, 1.0, 5.0, strike, kappa, theta, sigma);
+	const double put = vasicek::zcb::put(rate, 0.0, 1.0, 5.0, strike, kappa, theta, sigma);
+	EXPECT_NEAR(call - put, prices[3] - strike * prices[1], 1.0e-14);
+
+}
+
+
+TEST(Vasicek, Claims) {
+
+	const std::vector<vasicek::Claim> claims_ = claims();
+
+	const std::vector<double> expected = vasicek::price(claims_, rate, kappa, theta, sigma);
+	const std::vector<double> pde = vasicek::pde::price(claims_, rate, kappa, theta, sigma);
+
+	const vasicek::tree::Tree tree = vasicek::tree::build(kappa, sigma, 10.0, 500,
+		[](const double t) { return vasicek::zcb::price(rate, 0.0, t, kappa, theta, sigma); });
+	const std::vector<double> lattice = vasicek::tree::price(tree, claims_);
+
+	for (int c = 0; c != claims_.size(); ++c) {
+		const double tolerance = claims_[c].option ? 2.0e-4 : 1.0e-5;
+		EXPECT_NEAR(pde[c], expected[c], tolerance);
+		EXPECT_NEAR(lattice[c], expected[c], tolerance);
+	}
+
+	// The tree is fitted to the discount curve.
+	vasicek::Claim zcb;
+	zcb.times = { 7.0 };
+	zcb.cash_flows = { 1.0 };
+	EXPECT_NEAR(vasicek::tree::price(tree, { zcb })[0],
+		vasicek::zcb::price(rate, 0.0, 7.0, kappa, theta, sigma), 1.0e-12);
+
+	zcb.times = { 11.0 };
+	EXPECT_THROW(vasicek::tree::price(tree, { zcb }), std::invalid_argument);
+
+}
+
+
+TEST(Vasicek, HullWhite) {
+
+	const std::function<double(double)> discount = [](const double t) {
+		return vasicek::zcb::price(rate, 0.0, t, kappa, theta, sigma);
+	};
+
+	// Fitted to a Vasicek curve, the mean reversion level is constant.
+	const std::function<double(double)> theta_t =
+		vasicek::hull_white::theta(discount, kappa, sigma);
+	for (double t = 0.0; t < 10.0; t += 0.5) {
+		EXPECT_NEAR(theta_t(t), theta, 1.0e-6);
+	}
+
+	const std::vector<vasicek::Claim> claims_ = claims();
+	const std::vector<double> spatial_grid =
+		vasicek::pde::generator::grid(rate, kappa, theta, sigma, 10.0, 201);
+
+	const std::vector<std::vector<double>> constant =
+		vasicek::pde::rollback(spatial_grid, claims_, kappa, theta, sigma);
+	const std::vector<std::vector<double>> fitted =
+		vasicek::pde::rollback(spatial_grid, claims_, kappa, theta_t, sigma);
+
+	for (int c = 0; c != claims_.size(); ++c) {
+		for (int i = 0; i != spatial_grid.size(); ++i) {
+			EXPECT_NEAR(fitted[c][i], constant[c][i], 1.0e-5);
+		}
+	}
+
+}
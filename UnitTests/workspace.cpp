@@ -0,0 +1,218 @@
+#include "pch.h"
+
+
+TEST(Workspace, Buffers) {
+
+	Workspace workspace;
+
+	{
+		Workspace::Frame frame(workspace);
+		std::vector<double>& a = workspace.vector(10);
+		a.assign(10, 1.0);
+		{
+			Workspace::Frame inner(workspace);
+			std::vector<double>& b = workspace.vector(20);
+			EXPECT_EQ(b.size(), 20);
+			EXPECT_EQ(workspace.position(), 2);
+		}
+		EXPECT_EQ(workspace.position(), 1);
+		EXPECT_EQ(a[9], 1.0);
+	}
+	EXPECT_EQ(workspace.position(), 0);
+	EXPECT_EQ(workspace.n_buffers(), 2);
+
+	const int n_allocations = workspace.n_allocations();
+
+	// Released buffers are zero-initialized and reused.
+	{
+		Workspace::Frame frame(workspace);
+		std::vector<double>& a = workspace.vector(10);
+		std::vector<double>& b = workspace.vector(15);
+		EXPECT_EQ(a[0], 0.0);
+		EXPECT_EQ(b.size(), 15);
+	}
+	EXPECT_EQ(workspace.n_allocations(), n_allocations);
+	EXPECT_EQ(workspace.n_buffers(), 2);
+
+	EXPECT_THROW(workspace.release(1), std::invalid_argument);
+
+}
+
+
+// Time steps with pre-assembled operators should not allocate workspace
+// buffers once the workspace has been sized.
+TEST(Workspace, AllocationFreeSteps) {
+
+	const std::vector<double> grid_s = grid::hyperbolic_full(0.0, 400.0, 41, 100.0, 0.1);
+	const std::vector<double> grid_v = grid::hyperbolic_full(0.0, 2.0, 21, 0.04, 0.05);
+	const std::vector<std::vector<double>> spatial_grid{ grid_s, grid_v };
+
+	const int n_s = (int)grid_s.size();
+	const int n_v = (int)grid_v.size();
+
+	std::vector<std::vector<double>> prefactors_s =
+		heston::pde::generator::prefactor_s(0.03, spatial_grid);
+	std::vector<std::vector<double>> prefactors_v =
+		heston::pde::generator::prefactor_v(0.03, 1.5, 0.04, 0.3, spatial_grid);
+
+	std::vector<TriDiagonal> derivatives_s = heston::pde::generator::derivatives_s(grid_s);
+	std::vector<TriDiagonal> derivatives_v =
+		heston::pde::generator::derivatives_v(grid_v, 1.5, 0.04, 0.3);
+
+	FusedOperator<TriDiagonal> operator_s(n_s, n_v, 1, prefactors_s, derivatives_s);
+	FusedOperator<TriDiagonal> operator_v(n_v, n_s, 2, prefactors_v, derivatives_v);
+
+	// Separable and dense mixed derivative prefactors.
+	MixedDerivative<TriDiagonal, TriDiagonal> mixed(
+		d1dx1::nonuniform::c2b1(grid_s), d1dx1::nonuniform::c2b1(grid_v));
+	std::vector<double> coef_s = grid_s;
+	for (int i = 0; i != n_s; ++i) {
+		coef_s[i] *= -0.7 * 0.3;
+	}
+	mixed.set_prefactors(coef_s, grid_v);
+
+	MixedDerivative<TriDiagonal, TriDiagonal> mixed_dense = mixed;
+	std::vector<double> dense(n_s * n_v, 0.0);
+	for (int j = 0; j != n_v; ++j) {
+		for (int i = 0; i != n_s; ++i) {
+			dense[i + n_s * j] = -0.7 * 0.3 * grid_s[i] * grid_v[j];
+		}
+	}
+	mixed_dense.set_prefactors(dense);
+
+	std::vector<double> func_initial(n_s * n_v, 0.0);
+	for (int j = 0; j != n_v; ++j) {
+		for (int i = 0; i != n_s; ++i) {
+			func_initial[i + n_s * j] = std::max(grid_s[i] - 100.0, 0.0);
+		}
+	}
+
+	const double dt = 0.01;
+	const int n_steps = 10;
+
+	// DR, CS, CS with dense mixed derivative prefactors, MCS and HV.
+	for (const int scheme : { 0, 1, 2, 3, 4 }) {
+
+		MixedDerivative<TriDiagonal, TriDiagonal>& mixed_term =
+			scheme == 2 ? mixed_dense : mixed;
+
+		std::vector<double> func = func_initial;
+		std::vector<double> expected = func_initial;
+
+		Workspace workspace;
+
+		auto step = [&](std::vector<double>& f, const bool use_workspace) {
+			if (scheme == 0 && use_workspace) {
+				propagator::adi::dr_2d(dt, operator_s, operator_v, f, workspace);
+			}
+			else if (scheme == 0) {
+				propagator::adi::dr_2d(dt, operator_s, operator_v, f);
+			}
+			else if (scheme <= 2 && use_workspace) {
+				propagator::adi::cs_2d(dt, operator_s, operator_v, mixed_term, f, workspace);
+			}
+			else if (scheme <= 2) {
+				propagator::adi::cs_2d(dt, operator_s, operator_v, mixed_term, f);
+			}
+			else if (scheme == 3 && use_workspace) {
+				propagator::adi::mcs_2d(dt, operator_s, operator_v, mixed_term, f, workspace);
+			}
+			else if (scheme == 3) {
+				propagator::adi::mcs_2d(dt, operator_s, operator_v, mixed_term, f);
+			}
+			else if (use_workspace) {
+				propagator::adi::hv_2d(dt, operator_s, operator_v, mixed_term, f, workspace);
+			}
+			else {
+				propagator::adi::hv_2d(dt, operator_s, operator_v, mixed_term, f);
+			}
+		};
+
+		// Warm-up step sizes the workspace.
+		step(func, true);
+		step(expected, false);
+
+		const int n_allocations = workspace.n_allocations();
+		const int n_buffers = workspace.n_buffers();
+
+		for (int n = 0; n != n_steps; ++n) {
+			step(func, true);
+			step(expected, false);
+		}
+
+		EXPECT_EQ(workspace.n_allocations(), n_allocations);
+		EXPECT_EQ(workspace.n_buffers(), n_buffers);
+		EXPECT_EQ(workspace.position(), 0);
+
+		for (int i = 0; i != func.size(); ++i) {
+			EXPECT_NEAR(func[i], expected[i], 1.0e-12 * (1.0 + std::abs(expected[i])));
+		}
+
+	}
+
+}
+
+
+// Theta scheme with factorized left-hand-side operator.
+template <class T>
+void theta_1d_workspace_test(T derivative) {
+
+	std::vector<double> func_initial(derivative.order(), 0.0);
+	for (int i = 0; i != func_initial.size(); ++i) {
+		func_initial[i] = std::cos(0.1 * i);
+	}
+
+	const double dt = 0.01;
+	const int n_steps = 10;
+
+	const T identity = derivative.identity();
+
+	T rhs = derivative;
+	rhs *= 0.5 * dt;
+	rhs += identity;
+
+	T lhs = derivative;
+	lhs *= -0.5 * dt;
+	lhs += identity;
+	const FactorizedBandDiagonal lhs_factorized(lhs);
+
+	std::vector<double> func = func_initial;
+	Workspace workspace;
+	propagator::theta_1d::full(rhs, lhs_factorized, func, workspace);
+
+	const int n_allocations = workspace.n_allocations();
+	for (int n = 0; n != n_steps; ++n) {
+		propagator::theta_1d::full(rhs, lhs_factorized, func, workspace);
+	}
+	EXPECT_EQ(workspace.n_allocations(), n_allocations);
+
+	// Driver without workspace, operators assembled in every step.
+	std::vector<double> expected = func_initial;
+	propagation::theta_1d::full(grid::uniform(0.0, (n_steps + 1) * dt, n_steps + 2), derivative, expected);
+
+	// Driver with workspace: Buffers are allocated in the first step only.
+	for (const int n : { n_steps + 1, 10 * n_steps }) {
+		std::vector<double> func_driver = func_initial;
+		Workspace workspace_driver;
+		propagation::theta_1d::full(
+			grid::uniform(0.0, n * dt, n + 1), derivative, func_driver, workspace_driver);
+		EXPECT_EQ(workspace_driver.n_allocations(), 1);
+		if (n == n_steps + 1) {
+			for (int i = 0; i != func.size(); ++i) {
+				EXPECT_NEAR(func[i], expected[i], 1.0e-12 * (1.0 + std::abs(expected[i])));
+				EXPECT_NEAR(func_driver[i], expected[i], 1.0e-12 * (1.0 + std::abs(expected[i])));
+			}
+		}
+	}
+
+}
+
+
+TEST(Workspace, AllocationFreeTheta1d) {
+
+	const std::vector<double> grid = grid::uniform(0.0, 1.0, 51);
+
+	theta_1d_workspace_test(d2dx2::uniform::c2b1(grid));
+	theta_1d_workspace_test(d2dx2::uniform::c4b0(grid));
+
+}
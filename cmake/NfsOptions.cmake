@@ -0,0 +1,61 @@
+# Compiler flags shared by all targets: warnings, -march, LTO and PGO.
+#
+# PGO workflow (GCC or Clang), profiles are matched by object file path,
+# hence the same build directory is used for both passes:
+#   cmake -B build -DNFS_PGO=GENERATE && cmake --build build
+#   ./build/Benchmarks/bench                  (writes profiles to NFS_PGO_DIR)
+#   cmake -B build -DNFS_PGO=USE && cmake --build build
+# Clang profiles have to be merged with llvm-profdata into
+# NFS_PGO_DIR/default.profdata before the USE pass.
+
+add_library(nfs_options INTERFACE)
+
+if(MSVC)
+	target_compile_options(nfs_options INTERFACE /W3 /permissive- /bigobj)
+	target_compile_definitions(nfs_options INTERFACE _USE_MATH_DEFINES)
+else()
+	target_compile_options(nfs_options INTERFACE -Wall -Wno-sign-compare)
+endif()
+
+if(NFS_MARCH)
+	if(MSVC)
+		message(WARNING "NFS_MARCH is ignored for MSVC, use /arch via CMAKE_CXX_FLAGS.")
+	else()
+		target_compile_options(nfs_options INTERFACE -march=${NFS_MARCH})
+	endif()
+endif()
+
+if(NFS_LTO)
+	include(CheckIPOSupported)
+	check_ipo_supported(RESULT nfs_ipo_supported OUTPUT nfs_ipo_output)
+	if(nfs_ipo_supported)
+		set(CMAKE_INTERPROCEDURAL_OPTIMIZATION ON)
+	else()
+		message(WARNING "LTO not supported: ${nfs_ipo_output}")
+	endif()
+endif()
+
+string(TOUPPER "${NFS_PGO}" nfs_pgo)
+if(nfs_pgo STREQUAL "GENERATE" OR nfs_pgo STREQUAL "USE")
+	if(MSVC)
+		message(FATAL_ERROR "NFS_PGO is only supported for GCC and Clang.")
+	endif()
+	file(MAKE_DIRECTORY "${NFS_PGO_DIR}")
+	if(nfs_pgo STREQUAL "GENERATE")
+		if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+			set(nfs_pgo_flag "-fprofile-generate=${NFS_PGO_DIR}")
+		else()
+			set(nfs_pgo_flag "-fprofile-generate=${NFS_PGO_DIR}" "-fprofile-update=atomic")
+		endif()
+	else()
+		if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+			set(nfs_pgo_flag "-fprofile-use=${NFS_PGO_DIR}/default.profdata")
+		else()
+			set(nfs_pgo_flag "-fprofile-use=${NFS_PGO_DIR}" "-fprofile-correction" "-Wno-missing-profile")
+		endif()
+	endif()
+	target_compile_options(nfs_options INTERFACE ${nfs_pgo_flag})
+	target_link_options(nfs_options INTERFACE ${nfs_pgo_flag})
+elseif(NOT nfs_pgo STREQUAL "OFF")
+	message(FATAL_ERROR "NFS_PGO should be OFF, GENERATE or USE.")
+endif()